@@ -0,0 +1,198 @@
+#include <benchmark/benchmark.h>
+
+#include <binary_tree/binary_tree.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <stack>
+#include <vector>
+
+// Full in-order scans. StackIterator is the iterator the BinaryTree had before the nodes got parent
+// links - it carries the nodes it returns to on a std::stack, so every copy copies the stack and the
+// scan allocates as the stack grows. Both iterate the same nodes, allocated one at a time - in key
+// order like a tree built from sorted inserts (range(1) == 0) or in random order (range(1) == 1).
+// BM_TreeScan and BM_MapScan scan an AVLTree and a std::map built from random inserts for reference.
+//
+//   ./BinaryTreeScan_BM
+namespace
+{
+
+using Key = std::uint64_t;
+using Node = BT_Node<Key, Key>;
+using Reference = std::pair<Key const, Key>&;
+using ParentIterator = BinaryTree_iterator<Node, Reference, BT_Iterator_Inorder_Tag>;
+
+class StackIterator {
+public:
+    StackIterator() = default;
+    explicit StackIterator(Node* root) : current_{root}
+    {
+        if (current_ != nullptr) { traverse_minimum(); }
+    }
+    StackIterator(StackIterator const&) = default;
+    StackIterator& operator=(StackIterator const&) = default;
+
+    Reference operator*() const noexcept { return current_->data; }
+    auto* operator->() const noexcept { return &current_->data; }
+
+    StackIterator& operator++()
+    {
+        current_ = current_->right;
+        if (current_ != nullptr) {
+            traverse_minimum();
+        }
+        else if (!nodes_.empty()) {
+            current_ = nodes_.top();
+            nodes_.pop();
+        }
+        return *this;
+    }
+
+    StackIterator operator++(int)
+    {
+        auto ret{*this};
+        ++*this;
+        return ret;
+    }
+
+    friend bool operator!=(StackIterator const& lhs, StackIterator const& rhs) noexcept
+    {
+        return lhs.current_ != rhs.current_;
+    }
+
+private:
+    void traverse_minimum()
+    {
+        while (current_->left != nullptr) {
+            nodes_.push(current_);
+            current_ = current_->left;
+        }
+    }
+
+    std::stack<Node*> nodes_{};
+    Node* current_{nullptr};
+};
+
+// Balanced tree of the keys 0..count-1
+class Nodes {
+public:
+    Nodes(std::size_t count, bool shuffled)
+    {
+        std::vector<Key> order(count);
+        std::iota(order.begin(), order.end(), Key{0});
+        if (shuffled) { std::shuffle(order.begin(), order.end(), std::mt19937_64{1}); }
+        nodes_.resize(count);
+        for (auto const key : order) {
+            nodes_[key] = std::make_unique<Node>(key, key);
+        }
+        root_ = build(nullptr, 0, count);
+    }
+    Nodes(Nodes const&) = delete;
+    Nodes& operator=(Nodes const&) = delete;
+
+    Node* root() const noexcept { return root_; }
+
+private:
+    Node* build(Node* parent, std::size_t first, std::size_t last)
+    {
+        if (first == last) { return nullptr; }
+        auto const mid{first + (last - first) / 2};
+        Node* const node{nodes_[mid].get()};
+        node->parent = parent;
+        node->left = build(node, first, mid);
+        node->right = build(node, mid + 1, last);
+        return node;
+    }
+
+    std::vector<std::unique_ptr<Node>> nodes_{};
+    Node* root_{nullptr};
+};
+
+template<typename Iterator>
+void BM_Scan(benchmark::State& state)
+{
+    Nodes const nodes{static_cast<std::size_t>(state.range(0)), state.range(1) != 0};
+    for (auto _ : state) {
+        Key sum{0};
+        for (Iterator it{nodes.root()}, last{}; it != last; ++it) {
+            sum += it->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Post-increment copies the iterator on every step, as the algorithms taking iterators by value do
+template<typename Iterator>
+void BM_ScanCopying(benchmark::State& state)
+{
+    Nodes const nodes{static_cast<std::size_t>(state.range(0)), state.range(1) != 0};
+    for (auto _ : state) {
+        Key sum{0};
+        for (Iterator it{nodes.root()}, last{}; it != last; ) {
+            sum += (it++)->second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_TreeScan(benchmark::State& state)
+{
+    AVLTree<Key, Key> tree{};
+    std::vector<Key> keys(static_cast<std::size_t>(state.range(0)));
+    std::iota(keys.begin(), keys.end(), Key{0});
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64{1});
+    for (auto const key : keys) {
+        tree.insert({key, key});
+    }
+    for (auto _ : state) {
+        Key sum{0};
+        for (auto const& kv : tree) {
+            sum += kv.second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_MapScan(benchmark::State& state)
+{
+    std::map<Key, Key> map{};
+    std::vector<Key> keys(static_cast<std::size_t>(state.range(0)));
+    std::iota(keys.begin(), keys.end(), Key{0});
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64{1});
+    for (auto const key : keys) {
+        map.insert({key, key});
+    }
+    for (auto _ : state) {
+        Key sum{0};
+        for (auto const& kv : map) {
+            sum += kv.second;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void Layouts(benchmark::internal::Benchmark* bm)
+{
+    for (std::int64_t shuffled : {0, 1}) {
+        for (std::int64_t count{1 << 8}; count <= (1 << 20); count *= 16) {
+            bm->Args({count, shuffled});
+        }
+    }
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Scan, StackIterator)->Apply(Layouts);
+BENCHMARK_TEMPLATE(BM_Scan, ParentIterator)->Apply(Layouts);
+BENCHMARK_TEMPLATE(BM_ScanCopying, StackIterator)->Apply(Layouts);
+BENCHMARK_TEMPLATE(BM_ScanCopying, ParentIterator)->Apply(Layouts);
+BENCHMARK(BM_TreeScan)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
+BENCHMARK(BM_MapScan)->RangeMultiplier(16)->Range(1 << 8, 1 << 20);
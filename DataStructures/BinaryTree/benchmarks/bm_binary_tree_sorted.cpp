@@ -0,0 +1,147 @@
+#include <benchmark/benchmark.h>
+
+#include <binary_tree/binary_tree.hpp>
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+// Monotonically increasing keys (e.g. timestamps) - the unbalanced BinaryTree degenerates to a list,
+// every insert and lookup walks all the nodes. Compares it with the AVL balanced BinaryTree and std::map.
+//
+// Loading a sorted snapshot: element by element inserts against the O(n) bulk build of the range
+// constructor, and applying a sorted delta of a quarter of the snapshot's size spread over its keys,
+// half of it updates: insert_or_assign per element against merge_union.
+//
+//   ./BinaryTreeSorted_BM
+namespace
+{
+
+using Key = std::uint64_t;
+using Value = std::uint64_t;
+
+using Unbalanced = BinaryTree<Key, Value>;
+using Balanced = AVLTree<Key, Value>;
+using StdMap = std::map<Key, Value>;
+
+template<typename Tree>
+void BM_SortedInsert(benchmark::State& state)
+{
+    auto const count{static_cast<Key>(state.range(0))};
+    for (auto _ : state) {
+        Tree tree{};
+        for (Key key{0}; key != count; ++key) {
+            tree.insert_or_assign(key, key);
+        }
+        benchmark::DoNotOptimize(tree);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename Tree>
+void BM_FindAfterSortedInsert(benchmark::State& state)
+{
+    auto const count{static_cast<Key>(state.range(0))};
+    Tree tree{};
+    for (Key key{0}; key != count; ++key) {
+        tree.insert_or_assign(key, key);
+    }
+    for (auto _ : state) {
+        for (Key key{0}; key < count; key += 7) {
+            benchmark::DoNotOptimize(tree.find(key));
+            benchmark::DoNotOptimize(tree.lower_bound(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>((count + 6) / 7));
+}
+
+std::vector<std::pair<Key, Value>> sorted_range(Key first, Key count, Key step)
+{
+    std::vector<std::pair<Key, Value>> range{};
+    range.reserve(count);
+    for (Key key{first}; key != first + count * step; key += step) { range.emplace_back(key, key); }
+    return range;
+}
+
+template<typename Tree>
+void BM_InsertSnapshot(benchmark::State& state)
+{
+    auto const snapshot{sorted_range(0, static_cast<Key>(state.range(0)), 1)};
+    for (auto _ : state) {
+        Tree tree{};
+        for (auto const& [key, value] : snapshot) { tree.try_emplace(key, value); }
+        benchmark::DoNotOptimize(tree);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename Tree>
+void BM_BuildSnapshot(benchmark::State& state)
+{
+    auto const snapshot{sorted_range(0, static_cast<Key>(state.range(0)), 1)};
+    for (auto _ : state) {
+        Tree tree{snapshot.cbegin(), snapshot.cend()};
+        benchmark::DoNotOptimize(tree);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Snapshot of the even keys below 2 * count, every other key of the delta is odd (new)
+std::vector<std::pair<Key, Value>> sorted_delta(Key count)
+{
+    std::vector<std::pair<Key, Value>> delta{};
+    for (Key i{0}; i != count / 4; ++i) { delta.emplace_back(i * 8 + i % 2, i); }
+    return delta;
+}
+
+template<typename Tree>
+void BM_ApplyDelta(benchmark::State& state)
+{
+    auto const count{static_cast<Key>(state.range(0))};
+    auto const snapshot{sorted_range(0, count, 2)};
+    auto const delta{sorted_delta(count)};
+    for (auto _ : state) {
+        state.PauseTiming();
+        Tree tree{snapshot.cbegin(), snapshot.cend()};
+        state.ResumeTiming();
+        for (auto const& [key, value] : delta) { tree.insert_or_assign(key, value); }
+        benchmark::DoNotOptimize(tree);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(delta.size()));
+}
+
+template<typename Tree>
+void BM_MergeDelta(benchmark::State& state)
+{
+    auto const count{static_cast<Key>(state.range(0))};
+    auto const snapshot{sorted_range(0, count, 2)};
+    auto const delta{sorted_delta(count)};
+    for (auto _ : state) {
+        state.PauseTiming();
+        Tree tree{snapshot.cbegin(), snapshot.cend()};
+        state.ResumeTiming();
+        tree.merge_union(Tree{delta.cbegin(), delta.cend()}, BT_Union_Overwrite{});
+        benchmark::DoNotOptimize(tree);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(delta.size()));
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_SortedInsert, Unbalanced)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+BENCHMARK_TEMPLATE(BM_SortedInsert, Balanced)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+BENCHMARK_TEMPLATE(BM_SortedInsert, StdMap)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+BENCHMARK_TEMPLATE(BM_FindAfterSortedInsert, Unbalanced)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+BENCHMARK_TEMPLATE(BM_FindAfterSortedInsert, Balanced)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+BENCHMARK_TEMPLATE(BM_FindAfterSortedInsert, StdMap)->RangeMultiplier(4)->Range(1 << 8, 1 << 14);
+
+BENCHMARK_TEMPLATE(BM_InsertSnapshot, Balanced)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_InsertSnapshot, StdMap)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_BuildSnapshot, Unbalanced)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_BuildSnapshot, Balanced)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_BuildSnapshot, StdMap)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_ApplyDelta, Balanced)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_ApplyDelta, StdMap)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MergeDelta, Unbalanced)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_MergeDelta, Balanced)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+
+#include <binary_tree/binary_tree.hpp>
+#include <binary_tree/btree_map.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Ordered index of small keys inserted in random order, from cache resident to far larger than the
+// last level cache. Point lookups find the keys in random order, range scans iterate 64 elements
+// from the lower bound of a random key. Compares BTreeMap of 256, 512 (default) and 1024 bytes
+// nodes with the AVL balanced BinaryTree and std::map.
+//
+//   ./BTreeMap_BM
+namespace
+{
+
+using Key = std::uint64_t;
+using Value = std::uint64_t;
+using Alloc = std::allocator<std::pair<const Key, Value>>;
+
+using Balanced = AVLTree<Key, Value>;
+using StdMap = std::map<Key, Value>;
+using BTree = BTreeMap<Key, Value>;
+using BTree256 = BTreeMap<Key, Value, Alloc, std::less<Key>, 256>;
+using BTree1024 = BTreeMap<Key, Value, Alloc, std::less<Key>, 1024>;
+
+constexpr std::size_t Scan_Length{64};
+
+// Even keys - every other key misses
+std::vector<Key> shuffled_keys(std::size_t count)
+{
+    std::vector<Key> keys(count);
+    std::iota(keys.begin(), keys.end(), Key{0});
+    std::transform(keys.cbegin(), keys.cend(), keys.begin(), [](Key key) { return key * 2; });
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64{42});
+    return keys;
+}
+
+template<typename Tree>
+Tree make_tree(std::vector<Key> const& keys)
+{
+    Tree tree{};
+    for (Key const key : keys) { tree.try_emplace(key, key); }
+    return tree;
+}
+
+template<typename Tree>
+void BM_RandomInsert(benchmark::State& state)
+{
+    auto const keys{shuffled_keys(static_cast<std::size_t>(state.range(0)))};
+    for (auto _ : state) {
+        Tree tree{make_tree<Tree>(keys)};
+        benchmark::DoNotOptimize(tree);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename Tree>
+void BM_Find(benchmark::State& state)
+{
+    auto const keys{shuffled_keys(static_cast<std::size_t>(state.range(0)))};
+    Tree const tree{make_tree<Tree>(keys)};
+    std::vector<Key> lookups{keys};
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937_64{7});
+    for (auto _ : state) {
+        Value sum{0};
+        for (Key const key : lookups) {
+            if (auto it{tree.find(key)}; it != tree.end()) { sum += it->second; }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename Tree>
+void BM_LowerBoundScan(benchmark::State& state)
+{
+    auto const keys{shuffled_keys(static_cast<std::size_t>(state.range(0)))};
+    Tree const tree{make_tree<Tree>(keys)};
+    std::vector<Key> lookups(std::min<std::size_t>(keys.size(), 1 << 14));
+    std::transform(keys.cbegin(), keys.cbegin() + static_cast<std::ptrdiff_t>(lookups.size()), lookups.begin(),
+                   [](Key key) { return key + 1; });
+    for (auto _ : state) {
+        Value sum{0};
+        for (Key const key : lookups) {
+            auto it{tree.lower_bound(key)};
+            for (std::size_t i{0}; i != Scan_Length && it != tree.end(); ++i, ++it) { sum += it->second; }
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(lookups.size() * Scan_Length));
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_RandomInsert, BTree256)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_RandomInsert, BTree)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_RandomInsert, BTree1024)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_RandomInsert, Balanced)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_RandomInsert, StdMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+
+BENCHMARK_TEMPLATE(BM_Find, BTree256)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Find, BTree)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Find, BTree1024)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Find, Balanced)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Find, StdMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_TEMPLATE(BM_LowerBoundScan, BTree256)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_LowerBoundScan, BTree)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_LowerBoundScan, BTree1024)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_LowerBoundScan, Balanced)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_LowerBoundScan, StdMap)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
@@ -6,8 +6,12 @@
 
 #include <map>
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <cstddef>
+#include <exception>
+#include <functional>
 #include <stack>
 #include <iterator>
 #include <memory>
@@ -21,9 +25,154 @@ struct BT_Iterator_Preorder_Tag {};
 struct BT_Iterator_Postorder_Tag {};
 struct BT_Iterator_Inorder_Tag {};
 
-template<typename Key, typename T>
-struct BT_Node {
-    using Node = BT_Node<Key, T>;
+// Tag of the BinaryTree constructor taking a range sorted by key, without equal keys
+struct BT_Sorted_Unique_Tag {};
+inline constexpr BT_Sorted_Unique_Tag BT_Sorted_Unique{};
+
+// Conflict policies of BinaryTree::merge_union - called with the mapped value of a key present in
+// both trees, the one of the tree merged into and the one of the tree merged from
+struct BT_Union_Keep_Existing {
+    template<typename T>
+    void operator()(T&, T&&) const noexcept { }
+};
+
+struct BT_Union_Overwrite {
+    template<typename T>
+    void operator()(T& existing, T&& other) const noexcept(std::is_nothrow_move_assignable_v<T>)
+    {
+        existing = std::move(other);
+    }
+};
+
+// Links (the root pointer or child pointers) walked down from the root of a BinaryTree - the balancing
+// policies walk the path back up after an insert or an erase, rotating the subtrees the links hold.
+// Capacity bounds the height of the tree, a path of Capacity 0 records nothing.
+template<typename Node, std::size_t Capacity>
+class BT_Link_Path {
+public:
+    void push(Node** link) noexcept
+    {
+        JAM_ASSERT(size_ != Capacity, "tree height exceeds the path capacity");
+        links_[size_++] = link;
+    }
+
+    Node** pop() noexcept { return links_[--size_]; }
+    bool empty() const noexcept { return size_ == 0; }
+
+private:
+    std::array<Node**, Capacity> links_{};
+    std::size_t size_{0};
+};
+
+template<typename Node>
+class BT_Link_Path<Node, 0> {
+public:
+    void push(Node**) noexcept { }
+    Node** pop() noexcept { return nullptr; }
+    bool empty() const noexcept { return true; }
+};
+
+// Balancing policies - the Balance parameter of BinaryTree. A policy keeps its per node state in
+// `node_state` (a base of BT_Node) and restores its invariant in `rebalance`, given the path from the
+// root to the modified link. `max_height` bounds the height of the balanced tree, 0 if it is unbounded.
+// `rebuilt` sets the state of a node whose subtrees were built bottom up by a bulk build - the built
+// tree is perfectly balanced.
+
+// The tree keeps the shape the insertion order gives it - sorted input degenerates to a list
+struct BT_Balance_None {
+    struct node_state {};
+    static constexpr std::size_t max_height{0};
+
+    template<typename Node>
+    static void rebalance(BT_Link_Path<Node, max_height>&) noexcept { }
+
+    template<typename Node>
+    static void rebuilt(Node*) noexcept { }
+};
+
+// AVL tree - the heights of the subtrees of every node differ by one at most, a tree of n nodes is
+// at most 1.44 * log2(n + 2) high. The max_height holds any tree that fits in the address space.
+struct BT_Balance_AVL {
+    struct node_state {
+        std::uint8_t height{1};
+    };
+    static constexpr std::size_t max_height{96};
+
+    template<typename Node>
+    static void rebalance(BT_Link_Path<Node, max_height>& path) noexcept
+    {
+        while (!path.empty()) {
+            Node** const link{path.pop()};
+            if (*link != nullptr) { balance(link); }
+        }
+    }
+
+    template<typename Node>
+    static void rebuilt(Node* node) noexcept { update_height(node); }
+
+private:
+    template<typename Node>
+    static int height(Node const* node) noexcept { return node != nullptr ? node->height : 0; }
+
+    template<typename Node>
+    static void update_height(Node* node) noexcept
+    {
+        node->height = static_cast<std::uint8_t>(1 + std::max(height(node->left), height(node->right)));
+    }
+
+    template<typename Node>
+    static void rotate_left(Node** link) noexcept
+    {
+        Node* const node{*link};
+        Node* const pivot{node->right};
+        node->right = pivot->left;
+        if (node->right != nullptr) { node->right->parent = node; }
+        pivot->left = node;
+        pivot->parent = node->parent;
+        node->parent = pivot;
+        update_height(node);
+        update_height(pivot);
+        *link = pivot;
+    }
+
+    template<typename Node>
+    static void rotate_right(Node** link) noexcept
+    {
+        Node* const node{*link};
+        Node* const pivot{node->left};
+        node->left = pivot->right;
+        if (node->left != nullptr) { node->left->parent = node; }
+        pivot->right = node;
+        pivot->parent = node->parent;
+        node->parent = pivot;
+        update_height(node);
+        update_height(pivot);
+        *link = pivot;
+    }
+
+    // Subtrees of the node are balanced and differ in height by two at most
+    template<typename Node>
+    static void balance(Node** link) noexcept
+    {
+        Node* const node{*link};
+        int const skew{height(node->right) - height(node->left)};
+        if (skew > 1) {
+            if (height(node->right->left) > height(node->right->right)) { rotate_right(&node->right); }
+            rotate_left(link);
+        }
+        else if (skew < -1) {
+            if (height(node->left->right) > height(node->left->left)) { rotate_left(&node->left); }
+            rotate_right(link);
+        }
+        else {
+            update_height(node);
+        }
+    }
+};
+
+template<typename Key, typename T, typename Balance = BT_Balance_None>
+struct BT_Node : Balance::node_state {
+    using Node = BT_Node<Key, T, Balance>;
     using key_type = Key;
     using mapped_type = T;
     using value_type = std::pair<const Key, T>;
@@ -31,23 +180,55 @@ struct BT_Node {
     template<typename... Args>
     explicit BT_Node(Args&&... args) noexcept(std::is_nothrow_constructible_v<value_type, Args&&...>)
         : data{std::forward<Args>(args)...} { }
+    BT_Node(BT_Node const&) = delete;
+    BT_Node& operator=(BT_Node const&) = delete;
 
     Node* left{nullptr};
     Node* right{nullptr};
+    Node* parent{nullptr};
     value_type data;
 };
 
-template <typename Key, typename T, typename Allocator = std::allocator<std::pair<const Key, T>>>
+// Keys are ordered by Compare. A transparent Compare (one declaring `is_transparent`, e.g. std::less<>)
+// enables the lookup overloads templated on K - find, contains, count, equal_range, lower_bound,
+// upper_bound and erase then take any type Compare orders against Key, without constructing a Key.
+//
+// Balance selects the balancing policy, BT_Balance_None keeps the tree unbalanced. A balanced tree
+// descends from the root on every insertion - the hint overloads take the hint as a hint only.
+template <typename Key, typename T, typename Allocator = std::allocator<std::pair<const Key, T>>,
+          typename Compare = std::less<Key>, typename Balance = BT_Balance_None>
 class BinaryTree {
-    using Node = BT_Node<Key, T>;
+    using Node = BT_Node<Key, T, Balance>;
+    using link_path = BT_Link_Path<Node, Balance::max_height>;
     using alloc_traits = std::allocator_traits<Allocator>;
     using Nalloc = typename alloc_traits::template rebind_alloc<Node>;
     using nalloc_traits = std::allocator_traits<Nalloc>;
     using SwapAlloctors = SwapAllocators<typename nalloc_traits::propagate_on_container_swap>;
-    using self = BinaryTree<Key, T, Allocator>;
+    using self = BinaryTree<Key, T, Allocator, Compare, Balance>;
+
+    // Block of nodes allocated by a bulk build - freed with the tree
+    struct Slab {
+        Slab* next;
+        Node* nodes;
+        std::size_t count;
+    };
+    using Salloc = typename alloc_traits::template rebind_alloc<Slab>;
+    using salloc_traits = std::allocator_traits<Salloc>;
+
+    // Erased node of a block, waiting for an insertion to reuse it
+    struct Spare {
+        Spare* next;
+    };
 
     Nalloc alloc_{Nalloc{}};
+    Compare comp_{};
     Node* root_{nullptr};
+    // first and last node in order, kept up to date by every insert and erase
+    Node* leftmost_{nullptr};
+    Node* rightmost_{nullptr};
+    std::size_t size_{0};
+    Slab* slabs_{nullptr};
+    Spare* spare_{nullptr};
 public:
     using key_type = Key;
     using mapped_type = T;
@@ -55,6 +236,7 @@ public:
     using size_type = std::size_t;
     using difference_type = std::ptrdiff_t;
     using allocator_type = Allocator;
+    using key_compare = Compare;
     using reference = std::add_lvalue_reference_t<value_type>;
     using const_reference = std::add_lvalue_reference_t<std::add_const_t<value_type>>;
     using pointer = typename alloc_traits::pointer;
@@ -66,8 +248,12 @@ public:
 
 
     explicit BinaryTree(Allocator const& = Allocator{});
+    explicit BinaryTree(Compare const& comp, Allocator const& alloc = Allocator{});
     template<typename InputIt>
     explicit BinaryTree(InputIt first, InputIt last, Allocator const& alloc = Allocator{});
+    // The keys of the range are sorted and unique - the tree is built in O(n)
+    template<typename ForwardIt>
+    BinaryTree(BT_Sorted_Unique_Tag, ForwardIt first, ForwardIt last, Allocator const& alloc = Allocator{});
     BinaryTree(BinaryTree const& other);
     BinaryTree(BinaryTree const& other, Allocator const& alloc);
     BinaryTree(BinaryTree&& other);
@@ -81,6 +267,9 @@ public:
     // allocator access
     allocator_type get_allocator() const noexcept { return alloc_; }
 
+    // observers
+    key_compare key_comp() const { return comp_; }
+
     // element access
     reference at(Key const& key);
     const_reference at(Key const& key) const;
@@ -88,28 +277,25 @@ public:
     reference operator[](Key&& key);
 
     // iterators
-    iterator begin() noexcept { return iterator{root_}; }
-    const_iterator begin() const noexcept { return const_iterator{root_}; }
-    const_iterator cbegin() const noexcept { return const_iterator{root_}; }
+    iterator begin() noexcept { return make_iterator<iterator>(leftmost_); }
+    const_iterator begin() const noexcept { return make_iterator<const_iterator>(leftmost_); }
+    const_iterator cbegin() const noexcept { return make_iterator<const_iterator>(leftmost_); }
     iterator end() noexcept { return iterator{}; }
     const_iterator end() const noexcept { return const_iterator{}; }
     const_iterator cend() const noexcept { return const_iterator{}; }
 
-    reverse_iterator rbegin() noexcept { return reverse_iterator{root_}; }
-    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator{root_}; }
-    const_reverse_iterator crbegin() const noexcept { return const_reverse_iterator{root_}; }
+    reverse_iterator rbegin() noexcept { return make_iterator<reverse_iterator>(rightmost_); }
+    const_reverse_iterator rbegin() const noexcept { return make_iterator<const_reverse_iterator>(rightmost_); }
+    const_reverse_iterator crbegin() const noexcept { return make_iterator<const_reverse_iterator>(rightmost_); }
     reverse_iterator rend() noexcept { return reverse_iterator{}; }
     const_reverse_iterator rend() const noexcept { return const_reverse_iterator{}; }
     const_reverse_iterator crend() const noexcept { return const_reverse_iterator{}; }
 
     // capacity
     bool empty() const noexcept { return root_ == nullptr; }
-    size_type size() const noexcept {
-        size_type count{0};
-        auto const counter{[&count](Node*) noexcept { ++count; }};
-        traverse_preorder(root_, counter);
-        return count;
-    }
+    size_type size() const noexcept { return size_; }
+    // Nodes on the longest path from the root, 0 for an empty tree - O(n)
+    size_type height() const noexcept;
 
     // modifiers
     void clear() noexcept { free(); }
@@ -156,161 +342,342 @@ public:
     iterator erase(iterator pos);
     iterator erase(const_iterator first, const_iterator last);
     size_type erase(key_type const& key);
-
-    // lookup
-    size_type count(Key const& key)
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    size_type erase(K const& key);
+
+    // Moves the elements of the other tree into this one in O(size() + other.size()) - the nodes move
+    // over, iterators to the elements stay valid. Keys present in both trees keep one element, the
+    // conflict policy is called with its mapped value and the mapped value of the other tree's
+    // element, which is destroyed. Should the policy throw, the merge completes keeping the existing
+    // values of the remaining conflicts and the exception propagates.
+    template<typename Conflict = BT_Union_Keep_Existing>
+    void merge_union(BinaryTree&& other, Conflict conflict = Conflict{});
+
+    // lookup - O(height), the returned iterators are built on the way down
+    size_type count(Key const& key) const noexcept { return contains(key) ? size_type{1} : size_type{0}; }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    size_type count(K const& key) const noexcept { return contains(key) ? size_type{1} : size_type{0}; }
+
+    iterator find(key_type const& key) noexcept { return find_impl<iterator>(key); }
+    const_iterator find(key_type const& key) const noexcept { return find_impl<const_iterator>(key); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    iterator find(K const& key) noexcept { return find_impl<iterator>(key); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    const_iterator find(K const& key) const noexcept { return find_impl<const_iterator>(key); }
+
+    bool contains(Key const& key) const noexcept { return find_node(key) != nullptr; }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    bool contains(K const& key) const noexcept { return find_node(key) != nullptr; }
+
+    std::pair<iterator, iterator> equal_range(Key const& key) noexcept
     {
-        return count_impl(key);
+        return {bound<iterator>(key, false), bound<iterator>(key, true)};
     }
-    template<typename K, typename = std::enable_if_t<std::is_convertible_v<K, key_type>>>
-    size_type count(K const& key)
+    std::pair<const_iterator, const_iterator> equal_range(Key const& key) const noexcept
     {
-        return count_impl(key);
+        return {bound<const_iterator>(key, false), bound<const_iterator>(key, true)};
+    }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    std::pair<iterator, iterator> equal_range(K const& key) noexcept
+    {
+        return {bound<iterator>(key, false), bound<iterator>(key, true)};
+    }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    std::pair<const_iterator, const_iterator> equal_range(K const& key) const noexcept
+    {
+        return {bound<const_iterator>(key, false), bound<const_iterator>(key, true)};
     }
 
-    iterator find(key_type const& key) noexcept;
-    const_iterator find(key_type const& key) const noexcept;
-    template<typename K> iterator find(K const& key) noexcept;
-    template<typename K> const_iterator find(K const& key) const noexcept;
-
-    bool contains(Key const& key) const noexcept;
-    template<typename K> bool contains(K const& key) const noexcept;
-
-    std::pair<iterator, iterator> equal_range(Key const& key) noexcept;
-    std::pair<const_iterator, const_iterator> equal_range(Key const& key) const noexcept;
-    template<typename K>
-    std::pair<iterator, iterator> equal_range(K const& key) noexcept;
-    template<typename K>
-    std::pair<const_iterator, const_iterator> equal_range(K const& key) const noexcept;
-
-    iterator lower_bound(Key const& key) noexcept;
-    const_iterator lower_bound(Key const& key) const noexcept;
-    template<typename K>
-    iterator lower_bound(K const& key) noexcept;
-    template<typename K>
-    const_iterator lower_bound(K const& key) const noexcept;
+    iterator lower_bound(Key const& key) noexcept { return bound<iterator>(key, false); }
+    const_iterator lower_bound(Key const& key) const noexcept { return bound<const_iterator>(key, false); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    iterator lower_bound(K const& key) noexcept { return bound<iterator>(key, false); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    const_iterator lower_bound(K const& key) const noexcept { return bound<const_iterator>(key, false); }
 
-    iterator upper_bound(Key const& key) noexcept;
-    const_iterator upper_bound(Key const& key) const noexcept;
-    template<typename K>
-    iterator upper_bound(K const& key) noexcept;
-    template<typename K>
-    const_iterator upper_bound(K const& key) const noexcept;
+    iterator upper_bound(Key const& key) noexcept { return bound<iterator>(key, true); }
+    const_iterator upper_bound(Key const& key) const noexcept { return bound<const_iterator>(key, true); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    iterator upper_bound(K const& key) noexcept { return bound<iterator>(key, true); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    const_iterator upper_bound(K const& key) const noexcept { return bound<const_iterator>(key, true); }
 
 private:
     void free(Node* node) noexcept
     {
         nalloc_traits::destroy(alloc_, node);
-        nalloc_traits::deallocate(alloc_, node, 1);
+        if (slabs_ != nullptr && in_slab(node)) { spare_ = ::new (static_cast<void*>(node)) Spare{spare_}; }
+        else { nalloc_traits::deallocate(alloc_, node, 1); }
     }
 
+    bool in_slab(Node const* node) const noexcept
+    {
+        std::less<Node const*> const less{};
+        for (Slab const* slab{slabs_}; slab != nullptr; slab = slab->next) {
+            if (!less(node, slab->nodes) && less(node, slab->nodes + slab->count)) { return true; }
+        }
+        return false;
+    }
+
+    // The nodes of the blocks have been destroyed
+    void release_slabs() noexcept
+    {
+        Salloc salloc{alloc_};
+        while (slabs_ != nullptr) {
+            Slab* const slab{std::exchange(slabs_, slabs_->next)};
+            nalloc_traits::deallocate(alloc_, slab->nodes, slab->count);
+            salloc_traits::destroy(salloc, slab);
+            salloc_traits::deallocate(salloc, slab, 1);
+        }
+        spare_ = nullptr;
+    }
+
+    // Frees the subtree bottom up, the parent links lead back up - no recursion, no stack
     void free_traverse(Node* node) noexcept
     {
-        if (node) {
-            free_traverse(node->left);
-            free_traverse(node->right);
-            free(node);
+        Node* const top{node != nullptr ? node->parent : nullptr};
+        while (node != top) {
+            if (node->left != nullptr) { node = std::exchange(node->left, nullptr); }
+            else if (node->right != nullptr) { node = std::exchange(node->right, nullptr); }
+            else { free(std::exchange(node, node->parent)); }
         }
     }
 
     void free() noexcept
     {
         free_traverse(root_);
+        release_slabs();
+        root_ = nullptr;
+        leftmost_ = nullptr;
+        rightmost_ = nullptr;
+        size_ = 0;
+    }
+
+    // The node has just been linked into the tree
+    void track_insert(Node* node) noexcept
+    {
+        ++size_;
+        if (leftmost_ == nullptr || comp_(node->data.first, leftmost_->data.first)) { leftmost_ = node; }
+        if (rightmost_ == nullptr || comp_(rightmost_->data.first, node->data.first)) { rightmost_ = node; }
     }
 
+    // The node has just been unlinked from the tree - a new leftmost (rightmost) node is found in
+    // O(height), the old one was at the end of the left (right) spine
+    void track_erase(Node* node) noexcept
+    {
+        --size_;
+        if (node == leftmost_) { leftmost_ = extreme(&Node::left); }
+        if (node == rightmost_) { rightmost_ = extreme(&Node::right); }
+    }
+
+    Node* extreme(Node* Node::* side) const noexcept
+    {
+        Node* node{root_};
+        while (node != nullptr && node->*side != nullptr) { node = node->*side; }
+        return node;
+    }
+
+    // Spare nodes first
     template<typename... Args>
     Node* make_node(Args&&... args)
     {
-        auto* const nn{nalloc_traits::allocate(alloc_, 1)};
-        nalloc_traits::construct(alloc_, nn, std::forward<Args>(args)...);
+        Spare* const spare{spare_};
+        Node* const nn{spare != nullptr ? reinterpret_cast<Node*>(spare) : nalloc_traits::allocate(alloc_, 1)};
+        if (spare != nullptr) { spare_ = spare->next; }
+        try {
+            nalloc_traits::construct(alloc_, nn, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            if (spare != nullptr) { spare_ = ::new (static_cast<void*>(nn)) Spare{spare_}; }
+            else { nalloc_traits::deallocate(alloc_, nn, 1); }
+            throw;
+        }
         return nn;
     }
 
+    template<typename It>
+    using FirstOf = decltype(std::declval<typename std::iterator_traits<It>::reference>().first);
+
+    // Sorted input into an empty tree takes the bulk build
     template<typename InputIt>
-    Node* make_range(InputIt first, InputIt last)
+    void make_range(InputIt first, InputIt last)
     {
-        JAM_ASSERT(first != last, "range must contain at least one element");
-        auto* root = make_node(*first);
-        while (++first != last) {
-            auto n = make_node(*first);
-            insert_at(root, n);
+        using category = typename std::iterator_traits<InputIt>::iterator_category;
+        if constexpr (std::is_convertible_v<category, std::forward_iterator_tag> && is_detected_v<FirstOf, InputIt>) {
+            if (root_ == nullptr && is_sorted_unique(first, last)) {
+                build_sorted(first, last, static_cast<size_type>(std::distance(first, last)));
+                return;
+            }
+        }
+        for (; first != last; ++first) {
+            insert_node(make_node(*first));
         }
-        return root;
     }
 
-    std::pair<iterator, bool> insert_node(Node* node);
-
-    template<typename K>
-    size_type count_impl(K const& key)
+    template<typename ForwardIt>
+    bool is_sorted_unique(ForwardIt first, ForwardIt last) const
     {
-        size_type count{0};
-        traverse_preorder_recursive(root_, [&count, &key](Node* n){
-                if (n->data.first == key) { ++count; }
-            }
-        );
-        return count;
+        return std::adjacent_find(first, last, [this](auto const& lhs, auto const& rhs) {
+            return !comp_(lhs.first, rhs.first);
+        }) == last;
     }
 
-    static std::pair<Node**, Node*> find_node_with_link(Node* root, key_type const& key) noexcept;
-    std::pair<Node**, Node*> find_node_with_link(key_type const& key) noexcept;
+    // Builds the empty tree from the sorted range in O(n)
+    template<typename ForwardIt>
+    void build_sorted(ForwardIt first, ForwardIt last, size_type count);
 
-    static std::pair<Node*, bool> insert_at(Node* root, Node* n) noexcept
+    // Unlinks the subtree into a list in key order, linked through `right`, by right rotations - O(n)
+    static Node* flatten(Node* root) noexcept
     {
-        JAM_ASSERT(root != nullptr, "null root");
-        JAM_ASSERT(n != nullptr, "null node");
-        if (n->data < root->data) {
-            if (root->left == nullptr) {
-                root->left = n;
-                return {root->left, true};
+        Node* list{nullptr};
+        Node** tail{&list};
+        Node* rest{root};
+        while (rest != nullptr) {
+            if (rest->left == nullptr) {
+                *tail = rest;
+                tail = &rest->right;
+                rest = rest->right;
             }
             else {
-                return insert_at(root->left, n);
+                Node* const pivot{rest->left};
+                rest->left = pivot->right;
+                pivot->right = rest;
+                rest = pivot;
             }
         }
-        else if (n->data > root->data) {
-            if (root->right == nullptr) {
-                root->right = n;
-                return {root->right, true};
+        return list;
+    }
+
+    // Links the first `count` nodes of the list into a perfectly balanced tree and advances the list
+    // past them. Recurses as deep as the built tree is high.
+    static Node* build_balanced(Node*& list, size_type count, Node* parent) noexcept
+    {
+        if (count == 0) { return nullptr; }
+        Node* const left{build_balanced(list, (count - 1) / 2, nullptr)};
+        Node* const node{list};
+        list = list->right;
+        node->left = left;
+        node->parent = parent;
+        if (left != nullptr) { left->parent = node; }
+        node->right = build_balanced(list, count - 1 - (count - 1) / 2, node);
+        Balance::rebuilt(node);
+        return node;
+    }
+
+    template<typename Iterator = iterator>
+    static Iterator make_iterator(Node* node) noexcept
+    {
+        Iterator it{};
+        it.current = node;
+        return it;
+    }
+
+    std::pair<iterator, bool> insert_node(Node* node);
+
+    template<typename K>
+    Node* find_node(K const& key) const noexcept
+    {
+        Node* node{root_};
+        while (node != nullptr) {
+            if (comp_(node->data.first, key)) { node = node->right; }
+            else if (comp_(key, node->data.first)) { node = node->left; }
+            else break;
+        }
+        return node;
+    }
+
+    // Inorder iterator at the first element not ordered before the key - or, if `upper`, at the first
+    // element ordered after it: the last node the descent turned left at, unless it meets the key.
+    template<typename Iterator, typename K>
+    Iterator bound(K const& key, bool upper) const noexcept
+    {
+        Node* candidate{nullptr};
+        Node* node{root_};
+        while (node != nullptr) {
+            if (comp_(key, node->data.first)) {
+                candidate = node;
+                node = node->left;
+            }
+            else if (upper || comp_(node->data.first, key)) {
+                node = node->right;
             }
             else {
-                return insert_at(root->right, n);
+                candidate = node;
+                break;
             }
         }
-        else {
-            return {nullptr, false};
-        }
+        return make_iterator<Iterator>(candidate);
+    }
+
+    template<typename Iterator, typename K>
+    Iterator find_impl(K const& key) const noexcept
+    {
+        auto it{bound<Iterator>(key, false)};
+        if (it.current != nullptr && !comp_(key, it.current->data.first)) { return it; }
+        return Iterator{};
+    }
+
+    // The link holding the node and the node's parent - a null node if the link is where a missing key belongs
+    struct NodeLink {
+        Node** link;
+        Node* node;
+        Node* parent;
+    };
+
+    // Descends from the link to the node with the key - or to the null link the key belongs at, if there
+    // is no such node. The path records the links on the way.
+    template<typename K>
+    NodeLink find_node_with_link(Node** link, K const& key, link_path& path) noexcept;
+
+    // Insertions descend from the hint if the tree is unbalanced, balanced trees need the path from the root
+    Node** descent_link(Node*& hint) noexcept
+    {
+        if (Balance::max_height == 0 && hint != nullptr) { return &hint; }
+        return &root_;
     }
 
-    iterator erase_leaf(Node** link, Node* node);
-    iterator erase_semibranch(Node** link, Node* node);
-    iterator erase_branch(Node** link, Node* node);
+    template<typename K>
+    size_type erase_impl(K const& key);
+
+    // The path leads to the link of the erased node, the erase rebalances the tree
+    iterator erase_leaf(Node** link, Node* node, link_path& path);
+    iterator erase_semibranch(Node** link, Node* node, link_path& path);
+    iterator erase_branch(Node** link, Node* node, link_path& path);
 
     template<typename KeyType, typename ValueType>
-    std::pair<Node*, bool> insert_or_assign_impl(Node* root, KeyType&& key, ValueType&& value)
+    std::pair<Node*, bool> insert_or_assign_impl(Node* hint, KeyType&& key, ValueType&& value)
     {
-        auto link_node{find_node_with_link(root, key)};
-        if (link_node.second != nullptr) {
-            link_node.second->data.second = std::forward<ValueType>(value);
-            return {link_node.second, false};
+        link_path path{};
+        auto link_node{find_node_with_link(descent_link(hint), key, path)};
+        if (link_node.node != nullptr) {
+            link_node.node->data.second = std::forward<ValueType>(value);
+            return {link_node.node, false};
         }
         else {
             Node* nn{make_node(std::forward<KeyType>(key), std::forward<ValueType>(value))};
-            *link_node.first = nn;
-            return {*link_node.first, true};
+            nn->parent = link_node.parent;
+            *link_node.link = nn;
+            track_insert(nn);
+            Balance::rebalance(path);
+            return {nn, true};
         }
     }
 
     template<typename KeyType, typename... Args>
-    std::pair<Node*, bool> try_emplace_impl(Node* root, KeyType&& key, Args&&... args)
+    std::pair<Node*, bool> try_emplace_impl(Node* hint, KeyType&& key, Args&&... args)
     {
-        auto link_node{find_node_with_link(root, key)};
-        if (link_node.second == nullptr) {
+        link_path path{};
+        auto link_node{find_node_with_link(descent_link(hint), key, path)};
+        if (link_node.node == nullptr) {
             Node* nn{make_node(std::forward<KeyType>(key), std::forward<Args>(args)...)};
-            *link_node.first = nn;
-            return {*link_node.first, true};
+            nn->parent = link_node.parent;
+            *link_node.link = nn;
+            track_insert(nn);
+            Balance::rebalance(path);
+            return {nn, true};
         }
         else {
-            return {link_node.second, false};
+            return {link_node.node, false};
         }
     }
 
@@ -397,250 +764,392 @@ private:
 };
 
 
-template <typename Key, typename T, typename Allocator>
-BinaryTree<Key, T, Allocator>::BinaryTree(Allocator const& alloc)
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+BinaryTree<Key, T, Allocator, Compare, Balance>::BinaryTree(Allocator const& alloc)
     : alloc_{Nalloc{alloc}}
 {
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+BinaryTree<Key, T, Allocator, Compare, Balance>::BinaryTree(Compare const& comp, Allocator const& alloc)
+    : alloc_{Nalloc{alloc}}, comp_{comp}
+{
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename InputIt>
-BinaryTree<Key, T, Allocator>::BinaryTree(InputIt first, InputIt last, Allocator const& alloc)
+BinaryTree<Key, T, Allocator, Compare, Balance>::BinaryTree(InputIt first, InputIt last, Allocator const& alloc)
     : alloc_{Nalloc{alloc}}
 {
-    if (first != last) {
-        root_ = make_range(first, last);
-    }
+    make_range(first, last);
 }
 
-template <typename Key, typename T, typename Allocator>
-BinaryTree<Key, T, Allocator>::BinaryTree(BinaryTree const& other)
-    : alloc_{nalloc_traits::select_on_container_copy_construction(other.alloc_)}
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+template<typename ForwardIt>
+BinaryTree<Key, T, Allocator, Compare, Balance>::BinaryTree(BT_Sorted_Unique_Tag, ForwardIt first, ForwardIt last,
+                                                            Allocator const& alloc)
+    : alloc_{Nalloc{alloc}}
 {
-    if (other.root_) {
-        root_ = make_range(other.cbegin(), other.cend());
-    }
+    build_sorted(first, last, static_cast<size_type>(std::distance(first, last)));
 }
 
-template <typename Key, typename T, typename Allocator>
-BinaryTree<Key, T, Allocator>::BinaryTree(BinaryTree const& other, Allocator const& alloc)
-    : alloc_{Nalloc{alloc}}
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+BinaryTree<Key, T, Allocator, Compare, Balance>::BinaryTree(BinaryTree const& other)
+    : alloc_{nalloc_traits::select_on_container_copy_construction(other.alloc_)}, comp_{other.comp_}
 {
-    if (other.root_) {
-        root_ = make_range(other.cbegin(), other.cend());
-    }
+    build_sorted(other.cbegin(), other.cend(), other.size());
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+BinaryTree<Key, T, Allocator, Compare, Balance>::BinaryTree(BinaryTree const& other, Allocator const& alloc)
+    : alloc_{Nalloc{alloc}}, comp_{other.comp_}
+{
+    build_sorted(other.cbegin(), other.cend(), other.size());
 }
 
-template <typename Key, typename T, typename Allocator>
-BinaryTree<Key, T, Allocator>::BinaryTree(BinaryTree&& other)
-    : alloc_{std::move(other.alloc_)}, root_{std::exchange(other.root_, nullptr)}
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+BinaryTree<Key, T, Allocator, Compare, Balance>::BinaryTree(BinaryTree&& other)
+    : alloc_{std::move(other.alloc_)}, comp_{other.comp_}, root_{std::exchange(other.root_, nullptr)},
+      leftmost_{std::exchange(other.leftmost_, nullptr)}, rightmost_{std::exchange(other.rightmost_, nullptr)},
+      size_{std::exchange(other.size_, 0)}, slabs_{std::exchange(other.slabs_, nullptr)},
+      spare_{std::exchange(other.spare_, nullptr)}
 {
 }
 
-template <typename Key, typename T, typename Allocator>
-BinaryTree<Key, T, Allocator>::BinaryTree(BinaryTree&& other, Allocator const& alloc)
-    : alloc_{Nalloc{alloc}}, root_{std::exchange(other.root_, nullptr)}
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+BinaryTree<Key, T, Allocator, Compare, Balance>::BinaryTree(BinaryTree&& other, Allocator const& alloc)
+    : alloc_{Nalloc{alloc}}, comp_{other.comp_}, root_{std::exchange(other.root_, nullptr)},
+      leftmost_{std::exchange(other.leftmost_, nullptr)}, rightmost_{std::exchange(other.rightmost_, nullptr)},
+      size_{std::exchange(other.size_, 0)}, slabs_{std::exchange(other.slabs_, nullptr)},
+      spare_{std::exchange(other.spare_, nullptr)}
 {
     JAM_EXPECT(get_allocator() == other.get_allocator(),
         "Move constructed BinaryTree instance with incompatible allocator");
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::operator=(BinaryTree const& other) -> BinaryTree&
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::operator=(BinaryTree const& other) -> BinaryTree&
 {
     if (this != &other) {
         free();
-        if (nalloc_traits::propagte_on_container_copy_assignment) {
+        if (nalloc_traits::propagate_on_container_copy_assignment::value) {
             alloc_ = other.alloc_;
         }
-        if (other.root_) {
-            root_ = make_range(other.cbegin(), other.cend());
-        }
+        comp_ = other.comp_;
+        build_sorted(other.cbegin(), other.cend(), other.size());
     }
     return *this;
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::operator=(BinaryTree&& other) noexcept -> BinaryTree&
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::operator=(BinaryTree&& other) noexcept -> BinaryTree&
 {
     if (this != &other) {
         free();
-        if (nalloc_traits::propagate_on_container_move_assignment) {
+        if (nalloc_traits::propagate_on_container_move_assignment::value) {
             alloc_ = std::move(other.alloc_);
         }
+        comp_ = other.comp_;
         root_ = std::exchange(other.root_, nullptr);
+        leftmost_ = std::exchange(other.leftmost_, nullptr);
+        rightmost_ = std::exchange(other.rightmost_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        slabs_ = std::exchange(other.slabs_, nullptr);
+        spare_ = std::exchange(other.spare_, nullptr);
     }
     return *this;
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::find_node_with_link(Node* root, key_type const& key) noexcept -> std::pair<Node**, Node*>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+void BinaryTree<Key, T, Allocator, Compare, Balance>::swap(BinaryTree& other) noexcept
 {
-    Node* node{root};
-    Node** link{&root};
-    while (node != nullptr) {
-        if (node->data.first < key) {
-            link = &node->right;
-            node = node->right;
+    using std::swap;
+    SwapAlloctors{}(alloc_, other.alloc_);
+    swap(comp_, other.comp_);
+    swap(root_, other.root_);
+    swap(leftmost_, other.leftmost_);
+    swap(rightmost_, other.rightmost_);
+    swap(size_, other.size_);
+    swap(slabs_, other.slabs_);
+    swap(spare_, other.spare_);
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::height() const noexcept -> size_type
+{
+    size_type max_height{0};
+    std::stack<std::pair<Node*, size_type>> nodes{};
+    if (root_ != nullptr) { nodes.push({root_, 1}); }
+    while (!nodes.empty()) {
+        auto const [node, depth] = nodes.top();
+        nodes.pop();
+        max_height = std::max(max_height, depth);
+        if (node->left != nullptr) { nodes.push({node->left, depth + 1}); }
+        if (node->right != nullptr) { nodes.push({node->right, depth + 1}); }
+    }
+    return max_height;
+}
+
+// The nodes take one block in key order - an inorder scan of the built tree walks the block
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+template<typename ForwardIt>
+void BinaryTree<Key, T, Allocator, Compare, Balance>::build_sorted(ForwardIt first, ForwardIt last, size_type count)
+{
+    JAM_EXPECT(root_ == nullptr, "Bulk build into a non empty BinaryTree");
+    if (count == 0) { return; }
+
+    Salloc salloc{alloc_};
+    Slab* const slab{salloc_traits::allocate(salloc, 1)};
+    Node* nodes{nullptr};
+    size_type built{0};
+    try {
+        nodes = nalloc_traits::allocate(alloc_, count);
+        for (; first != last; ++first, ++built) { nalloc_traits::construct(alloc_, nodes + built, *first); }
+    }
+    catch (...) {
+        for (size_type i{0}; i != built; ++i) { nalloc_traits::destroy(alloc_, nodes + i); }
+        if (nodes != nullptr) { nalloc_traits::deallocate(alloc_, nodes, count); }
+        salloc_traits::deallocate(salloc, slab, 1);
+        throw;
+    }
+    salloc_traits::construct(salloc, slab, Slab{slabs_, nodes, count});
+    slabs_ = slab;
+
+    for (size_type i{0}; i + 1 != count; ++i) {
+        JAM_EXPECT(comp_(nodes[i].data.first, nodes[i + 1].data.first), "Bulk build of unsorted keys");
+        nodes[i].right = nodes + i + 1;
+    }
+    Node* list{nodes};
+    root_ = build_balanced(list, count, nullptr);
+    leftmost_ = nodes;
+    rightmost_ = nodes + count - 1;
+    size_ = count;
+}
+
+// Both trees flatten into lists, merged like sorted lists and built back into a balanced tree
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+template<typename Conflict>
+void BinaryTree<Key, T, Allocator, Compare, Balance>::merge_union(BinaryTree&& other, Conflict conflict)
+{
+    JAM_EXPECT(get_allocator() == other.get_allocator(), "Merged BinaryTree instance with incompatible allocator");
+    if (this == &other) { return; }
+
+    // The blocks and spare nodes of the other tree come along with its nodes
+    if (other.slabs_ != nullptr) {
+        Slab* tail{other.slabs_};
+        while (tail->next != nullptr) { tail = tail->next; }
+        tail->next = std::exchange(slabs_, std::exchange(other.slabs_, nullptr));
+    }
+    if (other.spare_ != nullptr) {
+        Spare* tail{other.spare_};
+        while (tail->next != nullptr) { tail = tail->next; }
+        tail->next = std::exchange(spare_, std::exchange(other.spare_, nullptr));
+    }
+
+    Node* mine{flatten(std::exchange(root_, nullptr))};
+    Node* theirs{flatten(std::exchange(other.root_, nullptr))};
+    other.leftmost_ = nullptr;
+    other.rightmost_ = nullptr;
+    other.size_ = 0;
+
+    Node* list{nullptr};
+    Node** tail{&list};
+    Node* last{nullptr};
+    size_type count{0};
+    std::exception_ptr failure{};
+    while (mine != nullptr && theirs != nullptr) {
+        if (comp_(mine->data.first, theirs->data.first)) {
+            last = std::exchange(mine, mine->right);
         }
-        else if (key < node->data.first) {
-            link = &node->left;
-            node = node->left;
+        else if (comp_(theirs->data.first, mine->data.first)) {
+            last = std::exchange(theirs, theirs->right);
         }
-        else break;
+        else {
+            Node* const duplicate{std::exchange(theirs, theirs->right)};
+            if (!failure) {
+                try {
+                    conflict(mine->data.second, std::move(duplicate->data.second));
+                }
+                catch (...) {
+                    failure = std::current_exception();
+                }
+            }
+            free(duplicate);
+            last = std::exchange(mine, mine->right);
+        }
+        *tail = last;
+        tail = &last->right;
+        ++count;
+    }
+    *tail = mine != nullptr ? mine : theirs;
+    for (Node* node{*tail}; node != nullptr; node = node->right) {
+        last = node;
+        ++count;
     }
-    return {link, node};
-}
 
+    leftmost_ = list;
+    rightmost_ = last;
+    size_ = count;
+    root_ = build_balanced(list, count, nullptr);
+    if (failure) { std::rethrow_exception(failure); }
+}
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::find_node_with_link(key_type const& key) noexcept -> std::pair<Node**, Node*>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+template<typename K>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::find_node_with_link(Node** link, K const& key, link_path& path) noexcept
+    -> NodeLink
 {
-    Node* node{root_};
-    Node** link{&root_};
+    Node* node{*link};
+    Node* parent{node != nullptr ? node->parent : nullptr};
+    path.push(link);
     while (node != nullptr) {
-        if (node->data.first < key) {
+        if (comp_(node->data.first, key)) {
             link = &node->right;
-            node = node->right;
         }
-        else if (key < node->data.first) {
+        else if (comp_(key, node->data.first)) {
             link = &node->left;
-            node = node->left;
         }
         else break;
+        parent = node;
+        node = *link;
+        path.push(link);
     }
-    return {link, node};
+    return {link, node, parent};
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::insert_node(Node* node) -> std::pair<iterator, bool>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::insert_node(Node* node) -> std::pair<iterator, bool>
 {
-    auto node_inserted{insert_at(root_, node)};
-    if (node_inserted.second) {
-        return {iterator{root_, node->data.first}, node_inserted.second};
+    link_path path{};
+    auto const link_node{find_node_with_link(&root_, node->data.first, path)};
+    if (link_node.node == nullptr) {
+        node->parent = link_node.parent;
+        *link_node.link = node;
+        track_insert(node);
+        Balance::rebalance(path);
+        return {make_iterator(node), true};
     }
     else {
-        return {end(), node_inserted.second};
+        free(node);
+        return {end(), false};
     }
 }
 
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::insert(value_type const& value) -> std::pair<iterator, bool>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::insert(value_type const& value) -> std::pair<iterator, bool>
 {
     Node* node{make_node(value)};
     return insert_node(node);
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename P, typename>
-auto BinaryTree<Key, T, Allocator>::insert(P&& value) -> std::pair<iterator, bool>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::insert(P&& value) -> std::pair<iterator, bool>
 {
     Node* node{make_node(std::forward<P>(value))};
     return insert_node(node);
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::insert(value_type&& value) -> std::pair<iterator, bool>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::insert(value_type&& value) -> std::pair<iterator, bool>
 {
     Node* node{make_node(std::move(value))};
     return insert_node(node);
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename InputIt>
-void BinaryTree<Key, T, Allocator>::insert(InputIt first, InputIt last)
+void BinaryTree<Key, T, Allocator, Compare, Balance>::insert(InputIt first, InputIt last)
 {
-    while (first != last) {
-        Node* node{make_node(*first)};
-        insert_node(node);
-        ++first;
-    }
+    make_range(first, last);
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename M, typename>
-auto BinaryTree<Key, T, Allocator>::insert_or_assign(key_type const& key, M&& value) -> std::pair<iterator, bool>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::insert_or_assign(key_type const& key, M&& value) -> std::pair<iterator, bool>
 {
     auto node_inserted{insert_or_assign_impl(root_, key, std::forward<M>(value))};
-    return {iterator{root_, node_inserted.first->data.first}, node_inserted.second};
+    return {make_iterator(node_inserted.first), node_inserted.second};
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename M, typename>
-auto BinaryTree<Key, T, Allocator>::insert_or_assign(key_type&& key, M&& value) -> std::pair<iterator, bool>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::insert_or_assign(key_type&& key, M&& value) -> std::pair<iterator, bool>
 {
     auto node_inserted{insert_or_assign_impl(root_, std::move(key), std::forward<M>(value))};
-    return {iterator{root_, node_inserted.first->data.first}, node_inserted.second};
+    return {make_iterator(node_inserted.first), node_inserted.second};
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename M, typename>
-auto BinaryTree<Key, T, Allocator>::insert_or_assign(const_iterator hint, key_type const& key, M&& value) -> iterator
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::insert_or_assign(const_iterator hint, key_type const& key, M&& value) -> iterator
 {
     auto node_inserted{insert_or_assign_impl(hint.current, key, std::forward<M>(value))};
-    return iterator{root_, node_inserted.first->data.first};
+    return make_iterator(node_inserted.first);
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename M, typename>
-auto BinaryTree<Key, T, Allocator>::insert_or_assign(const_iterator hint, key_type&& key, M&& value) -> iterator
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::insert_or_assign(const_iterator hint, key_type&& key, M&& value) -> iterator
 {
     auto node_inserted{insert_or_assign_impl(hint.current, std::move(key), std::forward<M>(value))};
-    return iterator{root_, node_inserted.first->data.first};
+    return make_iterator(node_inserted.first);
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename... Args>
-auto BinaryTree<Key, T, Allocator>::emplace(Args&&... args) -> std::pair<iterator, bool>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::emplace(Args&&... args) -> std::pair<iterator, bool>
 {
     Node* node{make_node(std::forward<Args>(args)...)};
     return insert_node(node);
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename... Args>
-auto BinaryTree<Key, T, Allocator>::try_emplace(key_type const& key, Args&&... args) -> std::pair<iterator, bool>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::try_emplace(key_type const& key, Args&&... args) -> std::pair<iterator, bool>
 {
     auto node_emplaced{try_emplace_impl(root_, key, std::forward<Args>(args)...)};
-    return {iterator{root_, node_emplaced.first->data.first}, node_emplaced.second};
+    return {make_iterator(node_emplaced.first), node_emplaced.second};
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename... Args>
-auto BinaryTree<Key, T, Allocator>::try_emplace(key_type&& key, Args&&... args) -> std::pair<iterator, bool>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::try_emplace(key_type&& key, Args&&... args) -> std::pair<iterator, bool>
 {
     auto node_emplaced{try_emplace_impl(root_, std::move(key), std::forward<Args>(args)...)};
-    return {iterator{root_, node_emplaced.first->data.first}, node_emplaced.second};
+    return {make_iterator(node_emplaced.first), node_emplaced.second};
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename... Args>
-auto BinaryTree<Key, T, Allocator>::try_emplace(const_iterator hint, key_type const& key, Args&&... args) -> iterator
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::try_emplace(const_iterator hint, key_type const& key, Args&&... args) -> iterator
 {
     auto node_emplaced{try_emplace_impl(hint.current, key, std::forward<Args>(args)...)};
-    return {iterator{root_, node_emplaced.first->data.first}, node_emplaced.second};
+    return make_iterator(node_emplaced.first);
 }
 
-template <typename Key, typename T, typename Allocator>
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
 template<typename... Args>
-auto BinaryTree<Key, T, Allocator>::try_emplace(const_iterator hint, key_type&& key, Args&&... args) -> iterator
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::try_emplace(const_iterator hint, key_type&& key, Args&&... args) -> iterator
 {
     auto node_emplaced{try_emplace_impl(hint.current, std::move(key), std::forward<Args>(args)...)};
-    return {iterator{root_, node_emplaced.first->data.first}, node_emplaced.second};
+    return make_iterator(node_emplaced.first);
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::erase_leaf(Node** link, Node* node) -> iterator
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::erase_leaf(Node** link, Node* node, link_path& path) -> iterator
 {
     // erase leaf
     *link = nullptr;
+    track_erase(node);
     free(node);
+    Balance::rebalance(path);
     return iterator{};
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::erase_semibranch(Node** link, Node* node) -> iterator
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::erase_semibranch(Node** link, Node* node, link_path& path) -> iterator
 {
     // whichever link is not null, is the correct child
     Node* const new_child = [to_erase=node]() {
@@ -656,65 +1165,86 @@ auto BinaryTree<Key, T, Allocator>::erase_semibranch(Node** link, Node* node) ->
         }
     }();
 
+    new_child->parent = node->parent;
     *link = new_child;
+    track_erase(node);
     free(node);
-    return iterator{root_, new_child->data.first};
+    Balance::rebalance(path);
+    return make_iterator(new_child);
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::erase_branch(Node** link, Node* node) -> iterator
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::erase_branch(Node** link, Node* node, link_path& path) -> iterator
 {
     // find smallest node following the right link (the appropriate parent for the left link node)
-    Node* const successor = [cur=node->right]() mutable {
+    auto const [successor, successor_parent] = [cur=node->right]() mutable {
         auto* pred{cur};
         while (cur->left != nullptr) {
             pred = cur;
             cur = cur->left;
         }
-        if (pred != cur) { pred->left = cur->right; }
-        return cur;
+        if (pred != cur) {
+            pred->left = cur->right;
+            if (pred->left != nullptr) { pred->left->parent = pred; }
+        }
+        return std::pair{cur, pred};
     }();
 
     // left successor link needs to point at the node the erase target points at
     successor->left = node->left;
+    successor->left->parent = successor;
     // point the right successor link at the right erase target link, but only if
     // successor is not the node on the right of the erase target - this would cause the right successor
     // link to point at the successor (circular)
     if (successor != node->right) {
         successor->right = node->right;
+        successor->right->parent = successor;
     }
+    successor->parent = node->parent;
     *link = successor;
+    track_erase(node);
     free(node);
-    return iterator{root_, successor->data.first};
+    // the nodes on the way down to the former parent of the successor lost a descendant
+    if constexpr (Balance::max_height != 0) {
+        if (successor != successor_parent) {
+            for (Node** l{&successor->right}; ; l = &(*l)->left) {
+                path.push(l);
+                if (*l == successor_parent) { break; }
+            }
+        }
+    }
+    Balance::rebalance(path);
+    return make_iterator(successor);
 }
 
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::erase(const_iterator pos) -> iterator
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::erase(const_iterator pos) -> iterator
 {
-    auto link_node{find_node_with_link(pos->first)};
-    if (link_node.second != nullptr) {
-        if (link_node.second->left != nullptr && link_node.second->right != nullptr) {
-            return erase_branch(link_node.first, link_node.second);
+    link_path path{};
+    auto link_node{find_node_with_link(&root_, pos->first, path)};
+    if (link_node.node != nullptr) {
+        if (link_node.node->left != nullptr && link_node.node->right != nullptr) {
+            return erase_branch(link_node.link, link_node.node, path);
         }
-        else if (link_node.second->left != nullptr || link_node.second->right != nullptr) {
-            return erase_semibranch(link_node.first, link_node.second);
+        else if (link_node.node->left != nullptr || link_node.node->right != nullptr) {
+            return erase_semibranch(link_node.link, link_node.node, path);
         }
         else {
-            return erase_leaf(link_node.first, link_node.second);
+            return erase_leaf(link_node.link, link_node.node, path);
         }
     }
     else { return iterator{}; }
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::erase(iterator pos) -> iterator
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::erase(iterator pos) -> iterator
 {
     return erase(const_iterator{pos});
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::erase(const_iterator first, const_iterator last) -> iterator
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::erase(const_iterator first, const_iterator last) -> iterator
 {
     iterator it;
     while (first != last) {
@@ -723,167 +1253,44 @@ auto BinaryTree<Key, T, Allocator>::erase(const_iterator first, const_iterator l
     return it;
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::erase(key_type const& key) -> size_type
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::erase(key_type const& key) -> size_type
+{
+    return erase_impl(key);
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+template<typename K, typename C, typename>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::erase(K const& key) -> size_type
 {
-    auto link_node{find_node_with_link(key)};
-    if (link_node.second != nullptr) {
-        if (link_node.second->left != nullptr && link_node.second->right != nullptr) {
-            erase_branch(link_node.first, link_node.second);
+    return erase_impl(key);
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, typename Balance>
+template<typename K>
+auto BinaryTree<Key, T, Allocator, Compare, Balance>::erase_impl(K const& key) -> size_type
+{
+    link_path path{};
+    auto link_node{find_node_with_link(&root_, key, path)};
+    if (link_node.node != nullptr) {
+        if (link_node.node->left != nullptr && link_node.node->right != nullptr) {
+            erase_branch(link_node.link, link_node.node, path);
             return 1u;
         }
-        else if (link_node.second->left != nullptr || link_node.second->right != nullptr) {
-            erase_semibranch(link_node.first, link_node.second);
+        else if (link_node.node->left != nullptr || link_node.node->right != nullptr) {
+            erase_semibranch(link_node.link, link_node.node, path);
             return 1u;
         }
         else {
-            erase_leaf(link_node.first, link_node.second);
+            erase_leaf(link_node.link, link_node.node, path);
             return 1u;
         }
     }
     else { return 0u; }
 }
 
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::find(key_type const& key) noexcept -> iterator
-{
-    // If we had an implementation that allowed for O(1) iterators this would be ideal implementation:
-    // Node* node{root_};
-    // while (node != nullptr && node->data.first != key) {
-    //     if (node->data.first < key) { node = node->right; }
-    //     else if (key < node->data.first) { node = node->left; }
-    // }
-    // return iterator{node};
-
-    // But with the current implementation we can't do better than this:
-    return iterator{root_, key};
-}
-
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::find(key_type const& key) const noexcept -> const_iterator
-{
-    return const_iterator{root_, key};
-}
-
-template <typename Key, typename T, typename Allocator>
-template<typename K> auto BinaryTree<Key, T, Allocator>::find(K const& key) noexcept -> iterator
-{
-    return iterator{root_, key};
-}
-
-template <typename Key, typename T, typename Allocator>
-template<typename K> auto BinaryTree<Key, T, Allocator>::find(K const& key) const noexcept -> const_iterator
-{
-    return const_iterator{root_, key};
-}
-
-template <typename Key, typename T, typename Allocator>
-bool BinaryTree<Key, T, Allocator>::contains(Key const& key) const noexcept
-{
-    Node* node{root_};
-    while (node != nullptr && node->data.first != key) {
-        if (node->data.first < key) { node = node->right; }
-        else if (key < node->data.first) { node = node->left; }
-    }
-    return node != nullptr;
-}
-
-template <typename Key, typename T, typename Allocator>
-template<typename K>
-bool BinaryTree<Key, T, Allocator>::contains(K const& key) const noexcept
-{
-    Node* node{root_};
-    while (node != nullptr && node->data.first != key) {
-        if (node->data.first < key) { node = node->right; }
-        else if (key < node->data.first) { node = node->left; }
-    }
-    return node != nullptr;
-}
-
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::equal_range(Key const& key) noexcept -> std::pair<iterator, iterator>
-{
-    Node* node{root_};
-    while (node != nullptr && node->data.first != key) {
-        if (node->data.first < key) { node = node->right; }
-        else if (key < node->data.first) { node = node->left; }
-    }
-    return node != nullptr;
-}
-
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::equal_range(Key const& key) const noexcept -> std::pair<const_iterator, const_iterator>
-{
-    return {const_iterator{root_, key}, std::next(const_iterator{root_, key})};
-}
-
-template <typename Key, typename T, typename Allocator>
-template<typename K>
-auto BinaryTree<Key, T, Allocator>::equal_range(K const& key) noexcept -> std::pair<iterator, iterator>
-{
-    return {iterator{root_, key}, std::next(iterator{root_, key})};
-}
-
-template <typename Key, typename T, typename Allocator>
-template<typename K>
-auto BinaryTree<Key, T, Allocator>::equal_range(K const& key) const noexcept -> std::pair<const_iterator, const_iterator>
-{
-    return {const_iterator{root_, key}, std::next(const_iterator{root_, key})};
-}
-
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::lower_bound(Key const& key) noexcept -> iterator
-{
-    return {iterator{root_, key}, std::next(iterator{root_, key})};
-}
-
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::lower_bound(Key const& key) const noexcept -> const_iterator
-{
-    return const_iterator{root_, key};
-}
-
-template <typename Key, typename T, typename Allocator>
-template<typename K>
-auto BinaryTree<Key, T, Allocator>::lower_bound(K const& key) noexcept -> iterator
-{
-    return iterator{root_, key};
-}
-
-template <typename Key, typename T, typename Allocator>
-template<typename K>
-auto BinaryTree<Key, T, Allocator>::lower_bound(K const& key) const noexcept -> const_iterator
-{
-    return const_iterator{root_, key};
-}
-
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::upper_bound(Key const& key) noexcept -> iterator
-{
-    return std::next(iterator{root_, key});
-}
-
-template <typename Key, typename T, typename Allocator>
-auto BinaryTree<Key, T, Allocator>::upper_bound(Key const& key) const noexcept -> const_iterator
-{
-    return std::next(const_iterator{root_, key});
-}
-
-template <typename Key, typename T, typename Allocator>
-template<typename K>
-auto BinaryTree<Key, T, Allocator>::upper_bound(K const& key) noexcept -> iterator
-{
-    return std::next(iterator{root_, key});
-}
-
-template <typename Key, typename T, typename Allocator>
-template<typename K>
-auto BinaryTree<Key, T, Allocator>::upper_bound(K const& key) const noexcept -> const_iterator
-{
-    return std::next(const_iterator{root_, key});
-}
-
-
+// The iterators are a single node pointer - every step follows the child and parent links of the
+// nodes, iterators are trivially copyable and never allocate. The end iterator holds a null node.
 template<typename NodeType, typename Reference>
 class BinaryTree_iterator_base
 {
@@ -891,8 +1298,8 @@ protected:
     using self              = BinaryTree_iterator_base;
     using Node              = NodeType;
     using key_type          = typename Node::key_type;
-    using stack_type        = std::stack<Node*>;
-    template<typename Key, typename T, typename Alloc> friend class BinaryTree;
+    template<typename Key, typename T, typename Alloc, typename Compare, typename Balance> friend class BinaryTree;
+    template<typename OtherNodeType, typename OtherReference> friend class BinaryTree_iterator_base;
 public:
     using value_type        = std::remove_cv_t<std::remove_reference_t<Reference>>;
     using reference         = Reference;
@@ -906,16 +1313,10 @@ public:
         : current{n} { }
 
     template<typename OtherNodePointer, typename OtherReference,
-        typename = std::enable_if_t<std::is_convertible_v<OtherNodePointer, NodeType>>
+        typename = std::enable_if_t<std::is_convertible_v<OtherNodePointer*, NodeType*>>
         >
     BinaryTree_iterator_base(BinaryTree_iterator_base<OtherNodePointer, OtherReference> const& other)
-        : node_stack{other.node_stack}, current{other.current} { }
-
-    template<typename OtherNodePointer, typename OtherReference,
-        typename = std::enable_if_t<std::is_convertible_v<OtherNodePointer, NodeType>>
-        >
-    BinaryTree_iterator_base(BinaryTree_iterator_base<OtherNodePointer, OtherReference>&& other) noexcept
-        : node_stack{std::move(other.node_stack)}, current{std::move(other.current)} { }
+        : current{other.current} { }
 
     BinaryTree_iterator_base(BinaryTree_iterator_base const&) = default;
     BinaryTree_iterator_base(BinaryTree_iterator_base&&) = default;
@@ -939,19 +1340,18 @@ friend bool operator!=( const BinaryTree_iterator<T1,NP1,R1>& lhs,
                         const BinaryTree_iterator<T2,NP2,R2>& rhs ) noexcept;
 
 protected:
-    inline Node* pop_stack()
-    {
-        Node* node{node_stack.top()};
-        node_stack.pop();
-        return node;
-    }
-
-    inline void push_stack(Node* node)
+    // Climbs from the node while it is the `side` child of its parent - the parent the climb stops
+    // at is the next node of the iteration, null past the root
+    static Node* climb(Node* node, Node* Node::* side) noexcept
     {
-        node_stack.push(node);
+        Node* parent{node->parent};
+        while (parent != nullptr && parent->*side == node) {
+            node = parent;
+            parent = parent->parent;
+        }
+        return parent;
     }
 
-    stack_type node_stack{};
     Node*      current{nullptr};
 };
 
@@ -959,14 +1359,14 @@ template<typename NP1, typename R1, typename T1, typename NP2, typename R2, type
 bool operator==( const BinaryTree_iterator<NP1,R1,T1>& lhs,
                         const BinaryTree_iterator<NP2,R2,T2>& rhs ) noexcept
 {
-    return lhs.current == rhs.current && lhs.node_stack.empty() == rhs.node_stack.empty();
+    return lhs.current == rhs.current;
 }
 
 template<typename NP1, typename R1, typename T1, typename NP2, typename R2, typename T2>
 bool operator!=( const BinaryTree_iterator<NP1,R1,T1>& lhs,
                         const BinaryTree_iterator<NP2,R2,T2>& rhs ) noexcept
 {
-    return lhs.current != rhs.current /* && lhs.node_stack.empty() == rhs.node_stack.empty() */;
+    return lhs.current != rhs.current;
 }
 
 
@@ -981,13 +1381,6 @@ class BinaryTree_iterator : public BinaryTree_iterator_base<NodeType, Reference>
 public:
     using BinaryTree_iterator_base<NodeType,Reference>::BinaryTree_iterator_base;
 
-    // explicit BinaryTree_iterator(Node* first, Node* target)
-    //     : base{first}
-    //     {
-    //         while(this->current != target)
-    //             ++*this;
-    //     }
-
     explicit BinaryTree_iterator(Node* first, key_type const& key)
         : base{first}
         {
@@ -997,15 +1390,21 @@ public:
 
     self& operator++() noexcept
     {
-        if(this->current->right)
-            this->node_stack.push(this->current->right);
-            // push_stack(this->current->right);
-        this->current = this->current->left;
-        if(!this->current && !this->node_stack.empty()){
-            this->current = this->node_stack.top();
-            this->node_stack.pop();
-            // this->current = pop_stack();
-        } // else == end iterator
+        Node* const node{this->current};
+        if(node->left) {
+            this->current = node->left;
+        } else if(node->right) {
+            this->current = node->right;
+        } else {
+            // back up to the closest ancestor with a right subtree not visited yet
+            Node* child{node};
+            Node* parent{node->parent};
+            while(parent && (parent->right == child || parent->right == nullptr)) {
+                child = parent;
+                parent = parent->parent;
+            }
+            this->current = parent ? parent->right : nullptr;
+        } // null == end iterator
         return *this;
     }
 
@@ -1036,13 +1435,6 @@ public:
             traverse_minimum();
         }
 
-    // BinaryTree_iterator(Node* first, Node* target)
-    //     : base{first}
-    //     {
-    //         while(this->current != target)
-    //             ++*this;
-    //     }
-
     explicit BinaryTree_iterator(Node* first, key_type const& key)
         : BinaryTree_iterator{first}
     {
@@ -1052,14 +1444,12 @@ public:
 
     self& operator++() noexcept
     {
-        this->current = this->current->right;
-        if(this->current){
+        if(this->current->right){
+            this->current = this->current->right;
             traverse_minimum();
-        } else if(!this->node_stack.empty()){
-            this->current = this->node_stack.top();
-            this->node_stack.pop();
-            // this->current = pop_stack();
-        } // else == end iterator
+        } else {
+            this->current = base::climb(this->current, &Node::right);
+        } // null == end iterator
 
         return *this;
     }
@@ -1072,11 +1462,9 @@ public:
     }
 
 private:
-    void traverse_minimum()
+    void traverse_minimum() noexcept
     {
         while(this->current->left){
-            // push_stack(this->current);
-            this->node_stack.push(this->current);
             this->current = this->current->left;
         }
     }
@@ -1101,31 +1489,21 @@ public:
             traverse_maximum();
         }
 
-    // BinaryTree_iterator(Node* first, Node* target)
-    //     : base{first}
-    //     {
-    //         while(this->current != target)
-    //             ++*this;
-    //     }
-
     explicit BinaryTree_iterator(Node* first, key_type const& key)
         : BinaryTree_iterator{first}
     {
-        traverse_maximum();
         while(this->current && this->current->data.first != key)
             ++*this;
     }
 
     self& operator++() noexcept
     {
-        this->current = this->current->left;
-        if(this->current){
+        if(this->current->left){
+            this->current = this->current->left;
             traverse_maximum();
-        } else if(!this->node_stack.empty()){
-            this->current = this->node_stack.top();
-            this->node_stack.pop();
-            // this->current = pop_stack();
-        } // else == end_iterator
+        } else {
+            this->current = base::climb(this->current, &Node::left);
+        } // null == end_iterator
         return *this;
     }
 
@@ -1137,14 +1515,16 @@ public:
     }
 
 private:
-    void traverse_maximum()
+    void traverse_maximum() noexcept
     {
         while(this->current->right){
-            // push_stack(this->current);
-            this->node_stack.push(this->current);
             this->current = this->current->right;
         }
     }
 };
 
+template <typename Key, typename T, typename Allocator = std::allocator<std::pair<const Key, T>>,
+          typename Compare = std::less<Key>>
+using AVLTree = BinaryTree<Key, T, Allocator, Compare, BT_Balance_AVL>;
+
 #endif  // DATA_STRUCTURES_BINARY_TREE_HPP
@@ -0,0 +1,1002 @@
+#ifndef DATA_STRUCTURES_BTREE_MAP_HPP
+#define DATA_STRUCTURES_BTREE_MAP_HPP
+
+#include <utils/Assertion.h>
+#include <utils/traits.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+template<typename Leaf, typename Reference, bool Reverse> class BTreeMap_iterator;
+
+namespace btree_detail
+{
+
+inline constexpr std::size_t Cache_Line{64};
+
+constexpr std::size_t round_up(std::size_t n, std::size_t alignment) noexcept
+{
+    return (n + alignment - 1) / alignment * alignment;
+}
+
+// Internal levels of a tree holding SIZE_MAX elements, when every internal node has at least
+// `fanout` children
+constexpr std::size_t max_height(std::size_t fanout) noexcept
+{
+    std::size_t height{1};
+    for (std::size_t reach{std::numeric_limits<std::size_t>::max()}; reach >= fanout; reach /= fanout) { ++height; }
+    return height;
+}
+
+struct BTree_Node {};
+
+// Elements in key order, the leaves are linked into a list in key order too. The slots past count
+// hold no objects.
+template<typename Value, std::size_t Capacity>
+struct alignas(Cache_Line) BTree_Leaf : BTree_Node {
+    BTree_Leaf* prev{nullptr};
+    BTree_Leaf* next{nullptr};
+    std::uint16_t count{0};
+    alignas(Value) std::byte storage[Capacity * sizeof(Value)];
+
+    BTree_Leaf() noexcept = default;
+    BTree_Leaf(BTree_Leaf const&) = delete;
+    BTree_Leaf& operator=(BTree_Leaf const&) = delete;
+
+    Value* slots() noexcept { return reinterpret_cast<Value*>(storage); }
+    Value const* slots() const noexcept { return reinterpret_cast<Value const*>(storage); }
+};
+
+// count separator keys and count + 1 children - the keys of children[i] are not less than keys[i - 1]
+// and less than keys[i]. The children pointers come first, a lookup reads the keys and then one
+// pointer.
+template<typename Key, std::size_t Capacity>
+struct alignas(Cache_Line) BTree_Internal : BTree_Node {
+    std::array<BTree_Node*, Capacity + 1> children{};
+    std::uint16_t count{0};
+    alignas(Key) std::byte storage[Capacity * sizeof(Key)];
+
+    BTree_Internal() noexcept = default;
+    BTree_Internal(BTree_Internal const&) = delete;
+    BTree_Internal& operator=(BTree_Internal const&) = delete;
+
+    Key* keys() noexcept { return reinterpret_cast<Key*>(storage); }
+    Key const* keys() const noexcept { return reinterpret_cast<Key const*>(storage); }
+};
+
+} // namespace btree_detail
+
+// Ordered map stored in a B+-tree: the elements live in leaves of up to Leaf_Capacity elements, the
+// internal nodes hold copies of the keys separating their children. Both kinds of nodes are sized
+// to NodeBytes and aligned to a cache line, a lookup touches a handful of cache lines per level
+// and a tree of n elements is about log(n) / log(Internal_Capacity) levels high - a BinaryTree
+// node is a cache miss per level of log2(n) levels.
+//
+// The public interface mirrors BinaryTree, the differences being:
+//  - Key must be copy constructible and copy assignable (the separators are copies of keys),
+//  - Key and T must be nothrow move constructible (the elements are moved between the slots),
+//  - insertion and erasure move the elements between the nodes and invalidate all iterators,
+//    references and pointers,
+//  - there is no hint overload taking the hint into account, every insertion descends from the root.
+template <typename Key, typename T, typename Allocator = std::allocator<std::pair<const Key, T>>,
+          typename Compare = std::less<Key>, std::size_t NodeBytes = 512>
+class BTreeMap {
+    using ValueType = std::pair<const Key, T>;
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using Valloc = typename alloc_traits::template rebind_alloc<ValueType>;
+    using valloc_traits = std::allocator_traits<Valloc>;
+
+    static constexpr std::size_t Leaf_Header{
+        btree_detail::round_up(2 * sizeof(void*) + sizeof(std::uint16_t), alignof(ValueType))};
+    static constexpr std::size_t Internal_Header{
+        sizeof(void*) + btree_detail::round_up(sizeof(std::uint16_t), alignof(Key))};
+public:
+    // Elements per leaf and separators per internal node - as many as NodeBytes holds
+    static constexpr std::size_t Leaf_Capacity{std::max<std::size_t>(
+        NodeBytes > Leaf_Header ? (NodeBytes - Leaf_Header) / sizeof(ValueType) : 0, 2)};
+    static constexpr std::size_t Internal_Capacity{std::max<std::size_t>(
+        NodeBytes > Internal_Header ? (NodeBytes - Internal_Header) / (sizeof(void*) + sizeof(Key)) : 0, 3)};
+private:
+    static_assert(Leaf_Capacity <= std::numeric_limits<std::uint16_t>::max(), "NodeBytes too large");
+    static_assert(Internal_Capacity <= std::numeric_limits<std::uint16_t>::max(), "NodeBytes too large");
+    // the elements and separators are shifted between the slots by moves which must not throw
+    static_assert(std::is_nothrow_move_constructible_v<Key>, "Key must be nothrow move constructible");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow move constructible");
+
+    // Nodes but the root hold at least that many elements (separators), erasure merges the nodes
+    // falling below
+    static constexpr std::size_t Leaf_Min{Leaf_Capacity / 2};
+    static constexpr std::size_t Internal_Min{(Internal_Capacity - 1) / 2};
+
+    using Node = btree_detail::BTree_Node;
+    using Leaf = btree_detail::BTree_Leaf<ValueType, Leaf_Capacity>;
+    using Internal = btree_detail::BTree_Internal<Key, Internal_Capacity>;
+    using Lalloc = typename alloc_traits::template rebind_alloc<Leaf>;
+    using lalloc_traits = std::allocator_traits<Lalloc>;
+    using Ialloc = typename alloc_traits::template rebind_alloc<Internal>;
+    using ialloc_traits = std::allocator_traits<Ialloc>;
+
+    // Internal nodes walked down from the root and the child taken in each of them
+    struct PathStep {
+        Internal* node;
+        std::size_t index;
+    };
+    using Path = std::array<PathStep, btree_detail::max_height(Internal_Min + 1)>;
+
+    Valloc alloc_{};
+    Compare comp_{};
+    Node* root_{nullptr};
+    // ends of the list of leaves
+    Leaf* first_{nullptr};
+    Leaf* last_{nullptr};
+    // internal levels above the leaves
+    std::size_t height_{0};
+    std::size_t size_{0};
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using allocator_type = Allocator;
+    using key_compare = Compare;
+    using reference = std::add_lvalue_reference_t<value_type>;
+    using const_reference = std::add_lvalue_reference_t<std::add_const_t<value_type>>;
+    using pointer = typename alloc_traits::pointer;
+    using const_pointer = typename alloc_traits::const_pointer;
+    using iterator = BTreeMap_iterator<Leaf, reference, false>;
+    using const_iterator = BTreeMap_iterator<Leaf, const_reference, false>;
+    using reverse_iterator = BTreeMap_iterator<Leaf, reference, true>;
+    using const_reverse_iterator = BTreeMap_iterator<Leaf, const_reference, true>;
+
+    BTreeMap() noexcept = default;
+    explicit BTreeMap(Allocator const& alloc) : alloc_{Valloc{alloc}} { }
+    explicit BTreeMap(Compare const& comp, Allocator const& alloc = Allocator{})
+        : alloc_{Valloc{alloc}}, comp_{comp}
+    {
+    }
+    template<typename InputIt, typename = RequiresInputIterator<InputIt>>
+    explicit BTreeMap(InputIt first, InputIt last, Allocator const& alloc = Allocator{})
+        : BTreeMap{alloc}
+    {
+        insert(first, last);
+    }
+
+    BTreeMap(BTreeMap const& other)
+        : BTreeMap{other.comp_, Allocator{valloc_traits::select_on_container_copy_construction(other.alloc_)}}
+    {
+        insert(other.begin(), other.end());
+    }
+
+    BTreeMap(BTreeMap&& other) noexcept
+        : alloc_{std::move(other.alloc_)},
+          comp_{std::move(other.comp_)},
+          root_{std::exchange(other.root_, nullptr)},
+          first_{std::exchange(other.first_, nullptr)},
+          last_{std::exchange(other.last_, nullptr)},
+          height_{std::exchange(other.height_, 0)},
+          size_{std::exchange(other.size_, 0)}
+    {
+    }
+
+    ~BTreeMap() noexcept { free(); }
+
+    BTreeMap& operator=(BTreeMap const& other)
+    {
+        if (this != &other) {
+            free();
+            if (valloc_traits::propagate_on_container_copy_assignment::value) {
+                alloc_ = other.alloc_;
+            }
+            comp_ = other.comp_;
+            insert(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    BTreeMap& operator=(BTreeMap&& other) noexcept
+    {
+        if (this != &other) {
+            free();
+            if (valloc_traits::propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(other.alloc_);
+            }
+            comp_ = std::move(other.comp_);
+            root_ = std::exchange(other.root_, nullptr);
+            first_ = std::exchange(other.first_, nullptr);
+            last_ = std::exchange(other.last_, nullptr);
+            height_ = std::exchange(other.height_, 0);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    void swap(BTreeMap& other) noexcept
+    {
+        using std::swap;
+        SwapAllocators<typename valloc_traits::propagate_on_container_swap>{}(alloc_, other.alloc_);
+        swap(comp_, other.comp_);
+        swap(root_, other.root_);
+        swap(first_, other.first_);
+        swap(last_, other.last_);
+        swap(height_, other.height_);
+        swap(size_, other.size_);
+    }
+
+    // allocator access
+    allocator_type get_allocator() const noexcept { return allocator_type{alloc_}; }
+
+    // observers
+    key_compare key_comp() const { return comp_; }
+
+    // element access
+    mapped_type& at(Key const& key);
+    mapped_type const& at(Key const& key) const;
+    mapped_type& operator[](Key const& key) { return try_emplace(key).first->second; }
+    mapped_type& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+    // iterators
+    iterator begin() noexcept { return size_ != 0 ? iterator{first_, 0} : iterator{}; }
+    const_iterator begin() const noexcept { return size_ != 0 ? const_iterator{first_, 0} : const_iterator{}; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    iterator end() noexcept { return iterator{}; }
+    const_iterator end() const noexcept { return const_iterator{}; }
+    const_iterator cend() const noexcept { return const_iterator{}; }
+
+    reverse_iterator rbegin() noexcept { return size_ != 0 ? reverse_iterator{last_, last_->count - 1u} : reverse_iterator{}; }
+    const_reverse_iterator rbegin() const noexcept
+    {
+        return size_ != 0 ? const_reverse_iterator{last_, last_->count - 1u} : const_reverse_iterator{};
+    }
+    const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+    reverse_iterator rend() noexcept { return reverse_iterator{}; }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator{}; }
+    const_reverse_iterator crend() const noexcept { return const_reverse_iterator{}; }
+
+    // capacity
+    bool empty() const noexcept { return size_ == 0; }
+    size_type size() const noexcept { return size_; }
+    // Levels of nodes, the leaves included
+    size_type height() const noexcept { return root_ != nullptr ? height_ + 1 : 0; }
+
+    // modifiers
+    void clear() noexcept { free(); }
+
+    std::pair<iterator, bool> insert(value_type const& value) { return emplace_unique(value.first, value); }
+    std::pair<iterator, bool> insert(value_type&& value) { return emplace_unique(value.first, std::move(value)); }
+    template<typename P, typename = std::enable_if_t<std::is_constructible_v<value_type, P&&>>>
+    std::pair<iterator, bool> insert(P&& value) { return emplace(std::forward<P>(value)); }
+    iterator insert(const_iterator, value_type const& value) { return insert(value).first; }
+    iterator insert(const_iterator, value_type&& value) { return insert(std::move(value)).first; }
+    template<typename P, typename = std::enable_if_t<std::is_constructible_v<value_type, P&&>>>
+    iterator insert(const_iterator, P&& value) { return emplace(std::forward<P>(value)).first; }
+    template<typename InputIt, typename = RequiresInputIterator<InputIt>>
+    void insert(InputIt first, InputIt last)
+    {
+        for (; first != last; ++first) { emplace(*first); }
+    }
+
+    template<typename M, typename = std::enable_if_t<std::is_assignable_v<mapped_type&, M&&>>>
+    std::pair<iterator, bool> insert_or_assign(key_type const& key, M&& value)
+    {
+        return insert_or_assign_impl(key, std::forward<M>(value));
+    }
+    template<typename M, typename = std::enable_if_t<std::is_assignable_v<mapped_type&, M&&>>>
+    std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& value)
+    {
+        return insert_or_assign_impl(std::move(key), std::forward<M>(value));
+    }
+    template<typename M, typename = std::enable_if_t<std::is_assignable_v<mapped_type&, M&&>>>
+    iterator insert_or_assign(const_iterator, key_type const& key, M&& value)
+    {
+        return insert_or_assign_impl(key, std::forward<M>(value)).first;
+    }
+    template<typename M, typename = std::enable_if_t<std::is_assignable_v<mapped_type&, M&&>>>
+    iterator insert_or_assign(const_iterator, key_type&& key, M&& value)
+    {
+        return insert_or_assign_impl(std::move(key), std::forward<M>(value)).first;
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args)
+    {
+        value_type value(std::forward<Args>(args)...);
+        return emplace_unique(value.first, std::move(value));
+    }
+    template<typename... Args>
+    iterator emplace_hint(const_iterator, Args&&... args) { return emplace(std::forward<Args>(args)...).first; }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type const& key, Args&&... args)
+    {
+        return emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(key),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+    {
+        // The key is compared against before it is moved into the element
+        return emplace_unique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                              std::forward_as_tuple(std::forward<Args>(args)...));
+    }
+    template<typename... Args>
+    iterator try_emplace(const_iterator, key_type const& key, Args&&... args)
+    {
+        return try_emplace(key, std::forward<Args>(args)...).first;
+    }
+    template<typename... Args>
+    iterator try_emplace(const_iterator, key_type&& key, Args&&... args)
+    {
+        return try_emplace(std::move(key), std::forward<Args>(args)...).first;
+    }
+
+    iterator erase(const_iterator pos);
+    iterator erase(iterator pos) { return erase(const_iterator{pos}); }
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase(key_type const& key) { return erase_impl(key); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    size_type erase(K const& key) { return erase_impl(key); }
+
+    // lookup
+    size_type count(Key const& key) const noexcept { return contains(key) ? size_type{1} : size_type{0}; }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    size_type count(K const& key) const noexcept { return contains(key) ? size_type{1} : size_type{0}; }
+
+    iterator find(key_type const& key) noexcept { return find_impl<iterator>(key); }
+    const_iterator find(key_type const& key) const noexcept { return find_impl<const_iterator>(key); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    iterator find(K const& key) noexcept { return find_impl<iterator>(key); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    const_iterator find(K const& key) const noexcept { return find_impl<const_iterator>(key); }
+
+    bool contains(Key const& key) const noexcept { return find(key) != end(); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    bool contains(K const& key) const noexcept { return find(key) != end(); }
+
+    std::pair<iterator, iterator> equal_range(Key const& key) noexcept
+    {
+        return {lower_bound(key), upper_bound(key)};
+    }
+    std::pair<const_iterator, const_iterator> equal_range(Key const& key) const noexcept
+    {
+        return {lower_bound(key), upper_bound(key)};
+    }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    std::pair<iterator, iterator> equal_range(K const& key) noexcept
+    {
+        return {lower_bound(key), upper_bound(key)};
+    }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    std::pair<const_iterator, const_iterator> equal_range(K const& key) const noexcept
+    {
+        return {lower_bound(key), upper_bound(key)};
+    }
+
+    iterator lower_bound(Key const& key) noexcept { return bound<iterator>(key, false); }
+    const_iterator lower_bound(Key const& key) const noexcept { return bound<const_iterator>(key, false); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    iterator lower_bound(K const& key) noexcept { return bound<iterator>(key, false); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    const_iterator lower_bound(K const& key) const noexcept { return bound<const_iterator>(key, false); }
+
+    iterator upper_bound(Key const& key) noexcept { return bound<iterator>(key, true); }
+    const_iterator upper_bound(Key const& key) const noexcept { return bound<const_iterator>(key, true); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    iterator upper_bound(K const& key) noexcept { return bound<iterator>(key, true); }
+    template<typename K, typename C = Compare, typename = RequiresTransparent<C>>
+    const_iterator upper_bound(K const& key) const noexcept { return bound<const_iterator>(key, true); }
+
+private:
+    // nodes
+    Leaf* make_leaf()
+    {
+        Lalloc alloc{alloc_};
+        return ::new (static_cast<void*>(lalloc_traits::allocate(alloc, 1))) Leaf;
+    }
+
+    Internal* make_internal()
+    {
+        Ialloc alloc{alloc_};
+        return ::new (static_cast<void*>(ialloc_traits::allocate(alloc, 1))) Internal;
+    }
+
+    // The node holds no objects any more
+    void free(Leaf* leaf) noexcept
+    {
+        Lalloc alloc{alloc_};
+        leaf->~Leaf();
+        lalloc_traits::deallocate(alloc, leaf, 1);
+    }
+
+    void free(Internal* inner) noexcept
+    {
+        Ialloc alloc{alloc_};
+        inner->~Internal();
+        ialloc_traits::deallocate(alloc, inner, 1);
+    }
+
+    // Frees the subtree `level` internal levels high - the recursion goes as deep as the tree is high
+    void free_subtree(Node* node, std::size_t level) noexcept
+    {
+        if (level == 0) {
+            auto* const leaf{static_cast<Leaf*>(node)};
+            std::for_each(leaf->slots(), leaf->slots() + leaf->count, [this](value_type& value) {
+                valloc_traits::destroy(alloc_, &value);
+            });
+            free(leaf);
+            return;
+        }
+        auto* const inner{static_cast<Internal*>(node)};
+        for (std::size_t i{0}; i <= inner->count; ++i) { free_subtree(inner->children[i], level - 1); }
+        std::destroy(inner->keys(), inner->keys() + inner->count);
+        free(inner);
+    }
+
+    void free() noexcept
+    {
+        if (root_ != nullptr) { free_subtree(root_, height_); }
+        root_ = nullptr;
+        first_ = nullptr;
+        last_ = nullptr;
+        height_ = 0;
+        size_ = 0;
+    }
+
+    // elements and keys are moved to another slot by move construction, the source is destroyed.
+    // The key of an element is moved too - moving the pair<const Key, T> would copy it - so that
+    // a shift of the slots cannot throw half way and leave holes behind
+    void relocate(value_type* to, value_type* from) noexcept
+    {
+        valloc_traits::construct(alloc_, to, std::piecewise_construct,
+                                 std::forward_as_tuple(std::move(const_cast<Key&>(from->first))),
+                                 std::forward_as_tuple(std::move(from->second)));
+        valloc_traits::destroy(alloc_, from);
+    }
+
+    static void relocate(Key* to, Key* from) noexcept
+    {
+        ::new (static_cast<void*>(to)) Key(std::move(*from));
+        std::destroy_at(from);
+    }
+
+    // Moves the slots [pos, end) one slot to the right
+    template<typename U>
+    void open_slot(U* slots, std::size_t pos, std::size_t end)
+    {
+        for (std::size_t i{end}; i != pos; --i) { relocate(slots + i, slots + i - 1); }
+    }
+
+    // Moves the slots (pos, end) one slot to the left, over the empty slot pos
+    template<typename U>
+    void close_slot(U* slots, std::size_t pos, std::size_t end)
+    {
+        for (std::size_t i{pos + 1}; i < end; ++i) { relocate(slots + i - 1, slots + i); }
+    }
+
+    // lookup
+    template<typename K>
+    std::size_t child_index(Internal const* inner, K const& key) const noexcept
+    {
+        auto const* const keys{inner->keys()};
+        return static_cast<std::size_t>(std::upper_bound(keys, keys + inner->count, key,
+            [this](K const& k, Key const& separator) { return comp_(k, separator); }) - keys);
+    }
+
+    template<typename K>
+    std::size_t leaf_lower_bound(Leaf const* leaf, K const& key) const noexcept
+    {
+        auto const* const slots{leaf->slots()};
+        return static_cast<std::size_t>(std::lower_bound(slots, slots + leaf->count, key,
+            [this](value_type const& value, K const& k) { return comp_(value.first, k); }) - slots);
+    }
+
+    template<typename K>
+    std::size_t leaf_upper_bound(Leaf const* leaf, K const& key) const noexcept
+    {
+        auto const* const slots{leaf->slots()};
+        return static_cast<std::size_t>(std::upper_bound(slots, slots + leaf->count, key,
+            [this](K const& k, value_type const& value) { return comp_(k, value.first); }) - slots);
+    }
+
+    // The leaf which holds the key if any element does
+    template<typename K>
+    Leaf* find_leaf(K const& key) const noexcept
+    {
+        Node* node{root_};
+        for (std::size_t level{0}; level != height_; ++level) {
+            auto* const inner{static_cast<Internal*>(node)};
+            node = inner->children[child_index(inner, key)];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    // find_leaf recording the path for the modifiers
+    template<typename K>
+    Leaf* find_leaf(K const& key, Path& path) const noexcept
+    {
+        Node* node{root_};
+        for (std::size_t level{0}; level != height_; ++level) {
+            auto* const inner{static_cast<Internal*>(node)};
+            std::size_t const index{child_index(inner, key)};
+            path[level] = PathStep{inner, index};
+            node = inner->children[index];
+        }
+        return static_cast<Leaf*>(node);
+    }
+
+    // Position past the end of a leaf is the first element of the next leaf
+    template<typename Iterator>
+    static Iterator make_iterator(Leaf* leaf, std::size_t pos) noexcept
+    {
+        return pos != leaf->count ? Iterator{leaf, pos} : Iterator{leaf->next, 0};
+    }
+
+    template<typename Iterator, typename K>
+    Iterator find_impl(K const& key) const noexcept;
+
+    template<typename Iterator, typename K>
+    Iterator bound(K const& key, bool upper) const noexcept;
+
+    // insertion
+    template<typename... Args>
+    std::pair<iterator, bool> emplace_unique(Key const& key, Args&&... args);
+
+    template<typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign_impl(K&& key, M&& value)
+    {
+        auto it_inserted{try_emplace(std::forward<K>(key), std::forward<M>(value))};
+        if (!it_inserted.second) { it_inserted.first->second = std::forward<M>(value); }
+        return it_inserted;
+    }
+
+    std::pair<Leaf*, std::size_t> split_leaf(Leaf* leaf, std::size_t pos, Key const& key, Path const& path);
+    void insert_child(Path const& path, std::size_t level, Key const& separator, Node* right);
+    void insert_separator(Internal* inner, std::size_t index, Key const& separator, Node* right);
+
+    // erasure
+    template<typename K>
+    size_type erase_impl(K const& key);
+
+    iterator erase_at(Leaf* leaf, std::size_t pos, Path const& path);
+    std::pair<Leaf*, std::size_t> rebalance_leaf(Leaf* leaf, std::size_t pos, Path const& path);
+    void rebalance_internal(Path const& path, std::size_t level);
+    void merge_leaves(Leaf* left, Leaf* right);
+    void merge_internals(Internal* left, Internal* right, Internal* parent, std::size_t index);
+    void remove_separator(Internal* inner, std::size_t index);
+};
+
+template<typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+void swap(BTreeMap<Key, T, Allocator, Compare, NodeBytes>& lhs, BTreeMap<Key, T, Allocator, Compare, NodeBytes>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+auto BTreeMap<Key, T, Allocator, Compare, NodeBytes>::at(Key const& key) -> mapped_type&
+{
+    if (auto it{find(key)}; it != end()) { return it->second; }
+    else { throw std::out_of_range{"BTreeMap: key not found"}; }
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+auto BTreeMap<Key, T, Allocator, Compare, NodeBytes>::at(Key const& key) const -> mapped_type const&
+{
+    if (auto it{find(key)}; it != end()) { return it->second; }
+    else { throw std::out_of_range{"BTreeMap: key not found"}; }
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+template<typename Iterator, typename K>
+Iterator BTreeMap<Key, T, Allocator, Compare, NodeBytes>::find_impl(K const& key) const noexcept
+{
+    if (root_ == nullptr) { return Iterator{}; }
+    Leaf* const leaf{find_leaf(key)};
+    std::size_t const pos{leaf_lower_bound(leaf, key)};
+    if (pos != leaf->count && !comp_(key, leaf->slots()[pos].first)) { return Iterator{leaf, pos}; }
+    return Iterator{};
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+template<typename Iterator, typename K>
+Iterator BTreeMap<Key, T, Allocator, Compare, NodeBytes>::bound(K const& key, bool upper) const noexcept
+{
+    if (root_ == nullptr) { return Iterator{}; }
+    // The elements of the next leaf are not less than a separator the key is less than
+    Leaf* const leaf{find_leaf(key)};
+    return make_iterator<Iterator>(leaf, upper ? leaf_upper_bound(leaf, key) : leaf_lower_bound(leaf, key));
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+template<typename... Args>
+auto BTreeMap<Key, T, Allocator, Compare, NodeBytes>::emplace_unique(Key const& key, Args&&... args)
+    -> std::pair<iterator, bool>
+{
+    if (root_ == nullptr) {
+        first_ = last_ = make_leaf();
+        root_ = first_;
+    }
+    Path path;
+    Leaf* leaf{find_leaf(key, path)};
+    std::size_t pos{leaf_lower_bound(leaf, key)};
+    if (pos != leaf->count && !comp_(key, leaf->slots()[pos].first)) { return {iterator{leaf, pos}, false}; }
+
+    if (leaf->count == Leaf_Capacity) {
+        // The element is built before the leaf splits, a throwing constructor leaves the tree as
+        // it was. Its key is the one to split at - `key` may be the argument moved into it.
+        alignas(value_type) unsigned char spare[sizeof(value_type)];
+        auto* const value{reinterpret_cast<value_type*>(spare)};
+        valloc_traits::construct(alloc_, value, std::forward<Args>(args)...);
+        try {
+            std::tie(leaf, pos) = split_leaf(leaf, pos, value->first, path);
+        }
+        catch (...) {
+            valloc_traits::destroy(alloc_, value);
+            throw;
+        }
+        open_slot(leaf->slots(), pos, leaf->count);
+        relocate(leaf->slots() + pos, value);
+    }
+    else {
+        value_type* const slots{leaf->slots()};
+        open_slot(slots, pos, leaf->count);
+        try {
+            valloc_traits::construct(alloc_, slots + pos, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            close_slot(slots, pos, leaf->count + 1u);
+            throw;
+        }
+    }
+    ++leaf->count;
+    ++size_;
+    return {iterator{leaf, pos}, true};
+}
+
+// Splits the full leaf, returns the leaf and the position the key goes to. The upper half of the
+// elements moves to a new right sibling, except at the ends of the tree: an element appended after
+// the last element goes alone to the new leaf (prepended before the first one - stays alone in the
+// leaf), so that sorted insertions leave full leaves behind.
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+auto BTreeMap<Key, T, Allocator, Compare, NodeBytes>::split_leaf(Leaf* leaf, std::size_t pos, Key const& key,
+                                                                 Path const& path) -> std::pair<Leaf*, std::size_t>
+{
+    std::size_t mid{Leaf_Capacity / 2};
+    if (leaf == last_ && pos == leaf->count) { mid = pos; }
+    else if (leaf == first_ && pos == 0) { mid = 0; }
+
+    Leaf* const right{make_leaf()};
+    for (std::size_t i{mid}; i != leaf->count; ++i) { relocate(right->slots() + (i - mid), leaf->slots() + i); }
+    right->count = static_cast<std::uint16_t>(leaf->count - mid);
+    leaf->count = static_cast<std::uint16_t>(mid);
+
+    right->prev = leaf;
+    right->next = leaf->next;
+    if (leaf->next != nullptr) { leaf->next->prev = right; }
+    else { last_ = right; }
+    leaf->next = right;
+
+    insert_child(path, height_, right->count != 0 ? right->slots()[0].first : key, right);
+    if (pos < mid || (pos == mid && mid != Leaf_Capacity)) { return {leaf, pos}; }
+    return {right, pos - mid};
+}
+
+// Links the new right sibling of the node at `level` into its parent, splitting the parents that
+// are full on the way up. A full root splits into a new root.
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+void BTreeMap<Key, T, Allocator, Compare, NodeBytes>::insert_child(Path const& path, std::size_t level,
+                                                                   Key const& separator, Node* right)
+{
+    if (level == 0) {
+        Internal* const root{make_internal()};
+        ::new (static_cast<void*>(root->keys())) Key(separator);
+        root->children[0] = root_;
+        root->children[1] = right;
+        root->count = 1;
+        root_ = root;
+        ++height_;
+        return;
+    }
+
+    auto const [inner, index] = path[level - 1];
+    if (inner->count != Internal_Capacity) {
+        insert_separator(inner, index, separator, right);
+        return;
+    }
+
+    // The middle separator goes up, the separators and children above it move to the sibling
+    std::size_t const mid{Internal_Capacity / 2};
+    Internal* const sibling{make_internal()};
+    Key* const keys{inner->keys()};
+    for (std::size_t i{mid + 1}; i != Internal_Capacity; ++i) {
+        relocate(sibling->keys() + (i - mid - 1), keys + i);
+        sibling->children[i - mid - 1] = inner->children[i];
+    }
+    sibling->children[Internal_Capacity - mid - 1] = inner->children[Internal_Capacity];
+    sibling->count = static_cast<std::uint16_t>(Internal_Capacity - mid - 1);
+    Key up{std::move(keys[mid])};
+    std::destroy_at(keys + mid);
+    inner->count = static_cast<std::uint16_t>(mid);
+
+    if (index <= mid) { insert_separator(inner, index, separator, right); }
+    else { insert_separator(sibling, index - mid - 1, separator, right); }
+    insert_child(path, level - 1, up, sibling);
+}
+
+// The separator goes in front of keys[index], the right child next to children[index]
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+void BTreeMap<Key, T, Allocator, Compare, NodeBytes>::insert_separator(Internal* inner, std::size_t index,
+                                                                       Key const& separator, Node* right)
+{
+    open_slot(inner->keys(), index, inner->count);
+    ::new (static_cast<void*>(inner->keys() + index)) Key(separator);
+    std::copy_backward(inner->children.begin() + index + 1, inner->children.begin() + inner->count + 1,
+                       inner->children.begin() + inner->count + 2);
+    inner->children[index + 1] = right;
+    ++inner->count;
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+template<typename K>
+auto BTreeMap<Key, T, Allocator, Compare, NodeBytes>::erase_impl(K const& key) -> size_type
+{
+    if (root_ == nullptr) { return 0; }
+    Path path;
+    Leaf* const leaf{find_leaf(key, path)};
+    std::size_t const pos{leaf_lower_bound(leaf, key)};
+    if (pos == leaf->count || comp_(key, leaf->slots()[pos].first)) { return 0; }
+    erase_at(leaf, pos, path);
+    return 1;
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+auto BTreeMap<Key, T, Allocator, Compare, NodeBytes>::erase(const_iterator pos) -> iterator
+{
+    JAM_EXPECT(pos != cend(), "Erasing the end iterator");
+    Path path;
+    find_leaf(pos->first, path);
+    return erase_at(pos.leaf_, pos.index_, path);
+}
+
+// Erasure moves the elements between the leaves, the iterator to the next element is tracked
+// instead of last - `last` is not valid past the first erasure
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+auto BTreeMap<Key, T, Allocator, Compare, NodeBytes>::erase(const_iterator first, const_iterator last) -> iterator
+{
+    iterator it{first.leaf_, first.index_};
+    for (auto n{std::distance(first, last)}; n != 0; --n) { it = erase(it); }
+    return it;
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+auto BTreeMap<Key, T, Allocator, Compare, NodeBytes>::erase_at(Leaf* leaf, std::size_t pos, Path const& path) -> iterator
+{
+    valloc_traits::destroy(alloc_, leaf->slots() + pos);
+    close_slot(leaf->slots(), pos, leaf->count);
+    --leaf->count;
+    --size_;
+
+    if (height_ == 0) {
+        if (leaf->count == 0) {
+            free(leaf);
+            root_ = nullptr;
+            first_ = nullptr;
+            last_ = nullptr;
+            return end();
+        }
+    }
+    else if (leaf->count < Leaf_Min) {
+        std::tie(leaf, pos) = rebalance_leaf(leaf, pos, path);
+    }
+    return make_iterator<iterator>(leaf, pos);
+}
+
+// Refills the leaf fallen below Leaf_Min from a sibling, or merges it with one. Returns where the
+// element at `pos` went.
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+auto BTreeMap<Key, T, Allocator, Compare, NodeBytes>::rebalance_leaf(Leaf* leaf, std::size_t pos, Path const& path)
+    -> std::pair<Leaf*, std::size_t>
+{
+    auto const [parent, index] = path[height_ - 1];
+    auto* const left{index != 0 ? static_cast<Leaf*>(parent->children[index - 1]) : nullptr};
+    auto* const right{index != parent->count ? static_cast<Leaf*>(parent->children[index + 1]) : nullptr};
+
+    if (left != nullptr && left->count > Leaf_Min) {
+        open_slot(leaf->slots(), 0, leaf->count);
+        relocate(leaf->slots(), left->slots() + left->count - 1);
+        --left->count;
+        ++leaf->count;
+        parent->keys()[index - 1] = leaf->slots()[0].first;
+        return {leaf, pos + 1};
+    }
+    if (right != nullptr && right->count > Leaf_Min) {
+        relocate(leaf->slots() + leaf->count, right->slots());
+        close_slot(right->slots(), 0, right->count);
+        --right->count;
+        ++leaf->count;
+        parent->keys()[index] = right->slots()[0].first;
+        return {leaf, pos};
+    }
+
+    if (left != nullptr) {
+        pos += left->count;
+        merge_leaves(left, leaf);
+        remove_separator(parent, index - 1);
+        leaf = left;
+    }
+    else {
+        merge_leaves(leaf, right);
+        remove_separator(parent, index);
+    }
+    rebalance_internal(path, height_ - 1);
+    return {leaf, pos};
+}
+
+// The node at `level` has lost a child - refills it from a sibling or merges it with one, up to the
+// root. A root left with a single child is replaced by the child.
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+void BTreeMap<Key, T, Allocator, Compare, NodeBytes>::rebalance_internal(Path const& path, std::size_t level)
+{
+    for (;; --level) {
+        Internal* const inner{path[level].node};
+        if (level == 0) {
+            if (inner->count == 0) {
+                root_ = inner->children[0];
+                free(inner);
+                --height_;
+            }
+            return;
+        }
+        if (inner->count >= Internal_Min) { return; }
+
+        auto const [parent, index] = path[level - 1];
+        auto* const left{index != 0 ? static_cast<Internal*>(parent->children[index - 1]) : nullptr};
+        auto* const right{index != parent->count ? static_cast<Internal*>(parent->children[index + 1]) : nullptr};
+
+        if (left != nullptr && left->count > Internal_Min) {
+            // The separator comes down in front, the last separator of the sibling goes up
+            Key* const separator{parent->keys() + index - 1};
+            open_slot(inner->keys(), 0, inner->count);
+            relocate(inner->keys(), separator);
+            relocate(separator, left->keys() + left->count - 1);
+            std::copy_backward(inner->children.begin(), inner->children.begin() + inner->count + 1,
+                               inner->children.begin() + inner->count + 2);
+            inner->children[0] = left->children[left->count];
+            --left->count;
+            ++inner->count;
+            return;
+        }
+        if (right != nullptr && right->count > Internal_Min) {
+            Key* const separator{parent->keys() + index};
+            relocate(inner->keys() + inner->count, separator);
+            relocate(separator, right->keys());
+            close_slot(right->keys(), 0, right->count);
+            inner->children[inner->count + 1u] = right->children[0];
+            std::copy(right->children.begin() + 1, right->children.begin() + right->count + 1, right->children.begin());
+            --right->count;
+            ++inner->count;
+            return;
+        }
+
+        if (left != nullptr) { merge_internals(left, inner, parent, index - 1); }
+        else { merge_internals(inner, right, parent, index); }
+    }
+}
+
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+void BTreeMap<Key, T, Allocator, Compare, NodeBytes>::merge_leaves(Leaf* left, Leaf* right)
+{
+    for (std::size_t i{0}; i != right->count; ++i) { relocate(left->slots() + left->count + i, right->slots() + i); }
+    left->count = static_cast<std::uint16_t>(left->count + right->count);
+    left->next = right->next;
+    if (right->next != nullptr) { right->next->prev = left; }
+    else { last_ = left; }
+    free(right);
+}
+
+// The right node and the separator parent->keys()[index] between them merge into the left node
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+void BTreeMap<Key, T, Allocator, Compare, NodeBytes>::merge_internals(Internal* left, Internal* right,
+                                                                      Internal* parent, std::size_t index)
+{
+    Key* const keys{left->keys()};
+    ::new (static_cast<void*>(keys + left->count)) Key(std::move(parent->keys()[index]));
+    for (std::size_t i{0}; i != right->count; ++i) {
+        relocate(keys + left->count + 1 + i, right->keys() + i);
+    }
+    std::copy(right->children.begin(), right->children.begin() + right->count + 1,
+              left->children.begin() + left->count + 1);
+    left->count = static_cast<std::uint16_t>(left->count + 1 + right->count);
+    free(right);
+    remove_separator(parent, index);
+}
+
+// Removes keys[index] and children[index + 1]
+template <typename Key, typename T, typename Allocator, typename Compare, std::size_t NodeBytes>
+void BTreeMap<Key, T, Allocator, Compare, NodeBytes>::remove_separator(Internal* inner, std::size_t index)
+{
+    std::destroy_at(inner->keys() + index);
+    close_slot(inner->keys(), index, inner->count);
+    std::copy(inner->children.begin() + index + 2, inner->children.begin() + inner->count + 1,
+              inner->children.begin() + index + 1);
+    --inner->count;
+}
+
+// Forward iterator over the elements in key order (in reverse order if Reverse) - the leaf and the
+// position of the element in the leaf. The end iterator has no leaf.
+template<typename Leaf, typename Reference, bool Reverse>
+class BTreeMap_iterator
+{
+    template<typename, typename, typename, typename, std::size_t> friend class BTreeMap;
+    template<typename, typename, bool> friend class BTreeMap_iterator;
+    using CvValue = std::remove_reference_t<Reference>;
+    using Self = BTreeMap_iterator;
+
+    Leaf* leaf_{nullptr};
+    std::size_t index_{0};
+
+    explicit BTreeMap_iterator(Leaf* leaf, std::size_t index) noexcept : leaf_{leaf}, index_{index} { }
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::remove_const_t<CvValue>;
+    using difference_type = std::ptrdiff_t;
+    using reference = Reference;
+    using pointer = CvValue*;
+
+    BTreeMap_iterator() noexcept = default;
+
+    // iterator to const_iterator
+    template<typename OtherReference, typename = std::enable_if_t<
+        std::is_convertible_v<std::remove_reference_t<OtherReference>*, CvValue*>>>
+    BTreeMap_iterator(BTreeMap_iterator<Leaf, OtherReference, Reverse> const& other) noexcept
+        : leaf_{other.leaf_}, index_{other.index_}
+    {
+    }
+
+    reference operator*() const noexcept { return leaf_->slots()[index_]; }
+    pointer operator->() const noexcept { return leaf_->slots() + index_; }
+
+    Self& operator++() noexcept
+    {
+        if constexpr (Reverse) {
+            if (index_ != 0) { --index_; }
+            else {
+                leaf_ = leaf_->prev;
+                index_ = leaf_ != nullptr ? leaf_->count - 1u : 0;
+            }
+        }
+        else {
+            if (++index_ == leaf_->count) {
+                leaf_ = leaf_->next;
+                index_ = 0;
+            }
+        }
+        return *this;
+    }
+
+    Self operator++(int) noexcept
+    {
+        Self tmp{*this};
+        ++*this;
+        return tmp;
+    }
+
+    friend bool operator==(Self const& lhs, Self const& rhs) noexcept
+    {
+        return lhs.leaf_ == rhs.leaf_ && lhs.index_ == rhs.index_;
+    }
+
+    friend bool operator!=(Self const& lhs, Self const& rhs) noexcept { return !(lhs == rhs); }
+};
+
+#endif // DATA_STRUCTURES_BTREE_MAP_HPP
@@ -2,9 +2,20 @@
 
 #include <binary_tree/binary_tree.hpp>
 
+#include <algorithm>
 #include <array>
+#include <cmath>
+#include <functional>
+#include <iterator>
+#include <map>
 #include <memory>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 namespace
 {
@@ -272,6 +283,7 @@ TEST_F(BinaryTreeErasingModifiersTest, erase_leaf_removes_node_preserves_sorting
     expected.erase(std::remove(expected.begin(), expected.end(), erase1));
     ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), expected.cbegin(), expected.cend(), Compare{}));
 
+    it = sut.cbegin();
     while (it != sut.cend() && it->first != erase6.first) {
         ++it;
     }
@@ -282,6 +294,7 @@ TEST_F(BinaryTreeErasingModifiersTest, erase_leaf_removes_node_preserves_sorting
     expected.erase(std::remove(expected.begin(), expected.end(), erase6));
     ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), expected.cbegin(), expected.cend(), Compare{}));
 
+    it = sut.cbegin();
     while (it != sut.cend() && it->first != erase10.first) {
         ++it;
     }
@@ -394,4 +407,441 @@ TEST_F(BinaryTreeLookupMembersTest, find_returns_end_iterator_if_key_is_not_foun
     ASSERT_EQ(it, sut.end());
 }
 
+TEST_F(BinaryTreeLookupMembersTest, bounds_iterate_in_order_from_the_bound)
+{
+    auto const lower{sut.lower_bound(4)};
+    ASSERT_TRUE(std::equal(lower, sut.end(), init_inorder.cbegin() + 3, init_inorder.cend(), Compare{}));
+    // 7 is missing - both bounds point at 8
+    ASSERT_EQ(sut.lower_bound(7)->first, 8);
+    ASSERT_EQ(sut.upper_bound(7)->first, 8);
+    auto const upper{sut.upper_bound(4)};
+    ASSERT_TRUE(std::equal(upper, sut.end(), init_inorder.cbegin() + 4, init_inorder.cend(), Compare{}));
+    ASSERT_EQ(sut.upper_bound(10), sut.end());
+    ASSERT_EQ(sut.lower_bound(0)->first, 1);
+}
+
+TEST_F(BinaryTreeLookupMembersTest, equal_range_holds_the_element_with_equal_key)
+{
+    auto const [first, last]{std::as_const(sut).equal_range(5)};
+    ASSERT_EQ(std::distance(first, last), 1);
+    ASSERT_EQ(first->first, 5);
+    auto const [missing_first, missing_last]{sut.equal_range(7)};
+    ASSERT_EQ(missing_first, missing_last);
+}
+
+class BinaryTreeTransparentLookupTest : public ::testing::Test {
+protected:
+    // std::string is not implicitly constructible from std::string_view - the lookups below only
+    // compile through the heterogeneous overloads
+    BinaryTree<std::string, int, std::allocator<std::pair<std::string const, int>>, std::less<>> sut{};
+
+    void SetUp() override
+    {
+        sut.insert({"b", 2});
+        sut.insert({"a", 1});
+        sut.insert({"d", 4});
+        sut.insert({"c", 3});
+    }
+};
+
+TEST_F(BinaryTreeTransparentLookupTest, find_contains_and_count_take_a_string_view)
+{
+    auto const it{sut.find(std::string_view{"c"})};
+    ASSERT_NE(it, sut.end());
+    ASSERT_EQ(it->second, 3);
+    ASSERT_EQ(std::as_const(sut).find(std::string_view{"e"}), sut.cend());
+    ASSERT_TRUE(sut.contains(std::string_view{"a"}));
+    ASSERT_FALSE(sut.contains(std::string_view{"aa"}));
+    ASSERT_EQ(sut.count(std::string_view{"d"}), 1u);
+    ASSERT_EQ(sut.count("e"), 0u);
+}
+
+TEST_F(BinaryTreeTransparentLookupTest, bounds_and_equal_range_take_a_string_view)
+{
+    ASSERT_EQ(sut.lower_bound(std::string_view{"bb"})->first, "c");
+    ASSERT_EQ(sut.upper_bound(std::string_view{"c"})->first, "d");
+    auto const [first, last]{sut.equal_range(std::string_view{"b"})};
+    ASSERT_EQ(std::distance(first, last), 1);
+    ASSERT_EQ(first->first, "b");
+}
+
+TEST_F(BinaryTreeTransparentLookupTest, erase_takes_a_string_view)
+{
+    ASSERT_EQ(sut.erase(std::string_view{"b"}), 1u);
+    ASSERT_EQ(sut.erase(std::string_view{"b"}), 0u);
+    ASSERT_EQ(sut.size(), 3u);
+    ASSERT_FALSE(sut.contains(std::string_view{"b"}));
+    ASSERT_TRUE(sut.contains(std::string{"a"}));
+}
+
+// Upper bound of the height of an AVL tree of n nodes
+std::size_t avl_height_bound(std::size_t n)
+{
+    return static_cast<std::size_t>(1.4405 * std::log2(static_cast<double>(n) + 2.0));
+}
+
+TEST(BinaryTreeBalanceTest, sorted_insert_degenerates_an_unbalanced_tree)
+{
+    BinaryTree<int, int> sut{};
+    for (int i{0}; i != 100; ++i) {
+        sut.insert({i, i});
+    }
+    ASSERT_EQ(sut.height(), 100u);
+}
+
+TEST(BinaryTreeBalanceTest, sorted_insert_keeps_an_avl_tree_balanced)
+{
+    constexpr int count{1000};
+    AVLTree<int, int> sut{};
+    for (int i{0}; i != count; ++i) {
+        sut.insert({i, i});
+        ASSERT_LE(sut.height(), avl_height_bound(static_cast<std::size_t>(i) + 1));
+    }
+    for (int i{2 * count - 1}; i >= count; --i) {
+        sut.insert_or_assign(i, i);
+    }
+    for (int i{2 * count}; i != 3 * count; ++i) {
+        sut.try_emplace(i, i);
+    }
+    ASSERT_EQ(sut.size(), 3u * count);
+    ASSERT_LE(sut.height(), avl_height_bound(sut.size()));
+
+    int expected{0};
+    for (auto const& [key, value] : sut) {
+        ASSERT_EQ(key, expected);
+        ASSERT_EQ(value, expected);
+        ++expected;
+    }
+    ASSERT_EQ(expected, 3 * count);
+}
+
+TEST(BinaryTreeBalanceTest, hint_inserts_keep_an_avl_tree_balanced)
+{
+    AVLTree<int, int> sut{};
+    sut.insert({0, 0});
+    for (int i{1}; i != 1000; ++i) {
+        auto const hint{sut.find(i - 1)};
+        auto const it{i % 2 == 0 ? sut.insert_or_assign(hint, i, i) : sut.try_emplace(hint, i, i)};
+        ASSERT_EQ(it->first, i);
+    }
+    ASSERT_EQ(sut.size(), 1000u);
+    ASSERT_LE(sut.height(), avl_height_bound(sut.size()));
+}
+
+TEST(BinaryTreeBalanceTest, erase_keeps_an_avl_tree_balanced_and_sorted)
+{
+    // Random inserts and erases take every erase path - leaf, semibranch and branch - at every depth
+    AVLTree<int, int> sut{};
+    std::map<int, int> expected{};
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<int> keys{0, 2000};
+    for (int i{0}; i != 20000; ++i) {
+        int const key{keys(gen)};
+        if (i % 3 == 0) {
+            ASSERT_EQ(sut.erase(key), expected.erase(key));
+        }
+        else if (i % 3 == 1) {
+            auto const it{sut.find(key)};
+            ASSERT_EQ(it == sut.end(), expected.count(key) == 0);
+            if (it != sut.end()) {
+                sut.erase(it);
+                expected.erase(key);
+            }
+        }
+        else {
+            ASSERT_EQ(sut.insert({key, i}).second, expected.insert({key, i}).second);
+        }
+        ASSERT_LE(sut.height(), avl_height_bound(expected.size()));
+    }
+    ASSERT_EQ(sut.size(), expected.size());
+    ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), expected.cbegin(), expected.cend()));
+
+    for (auto const& kv : expected) {
+        ASSERT_EQ(sut.erase(kv.first), 1u);
+    }
+    ASSERT_TRUE(sut.empty());
+}
+
+// size(), begin() and rbegin() come from the counters and the leftmost/rightmost nodes the tree
+// maintains - every modifier is checked against a walk of the tree
+template<typename Tree>
+class BinaryTreeSizeTest : public ::testing::Test {
+protected:
+    Tree tree_{};
+
+    static void expect_consistent(Tree const& tree)
+    {
+        ASSERT_EQ(tree.size(), static_cast<std::size_t>(std::distance(tree.cbegin(), tree.cend())));
+        ASSERT_EQ(tree.empty(), tree.size() == 0);
+        if (tree.empty()) {
+            ASSERT_EQ(tree.cbegin(), tree.cend());
+            ASSERT_EQ(tree.crbegin(), tree.crend());
+            return;
+        }
+        auto const [min, max]{std::minmax_element(tree.cbegin(), tree.cend(),
+            [](auto const& lhs, auto const& rhs) { return lhs.first < rhs.first; })};
+        ASSERT_EQ(tree.cbegin()->first, min->first);
+        ASSERT_EQ(tree.crbegin()->first, max->first);
+    }
+};
+
+using BalancePolicies = ::testing::Types<BinaryTree<int, int>, AVLTree<int, int>>;
+TYPED_TEST_SUITE(BinaryTreeSizeTest, BalancePolicies);
+
+TYPED_TEST(BinaryTreeSizeTest, every_insert_counts_new_keys_only)
+{
+    auto& sut{this->tree_};
+    std::pair<int const, int> const lvalue{5, 5};
+    ASSERT_TRUE(sut.insert(lvalue).second);
+    ASSERT_FALSE(sut.insert(lvalue).second);
+    this->expect_consistent(sut);
+    ASSERT_TRUE(sut.insert(std::pair<int const, int>{3, 3}).second);
+    ASSERT_TRUE(sut.insert(std::pair<int, int>{8, 8}).second);
+    ASSERT_TRUE(sut.emplace(1, 1).second);
+    ASSERT_FALSE(sut.emplace(1, 1).second);
+    this->expect_consistent(sut);
+
+    ASSERT_TRUE(sut.insert_or_assign(9, 9).second);
+    int const key{0};
+    ASSERT_TRUE(sut.insert_or_assign(key, 0).second);
+    ASSERT_FALSE(sut.insert_or_assign(key, 10).second);
+    sut.insert_or_assign(sut.find(3), 4, 4);
+    sut.insert_or_assign(sut.cend(), key, 0);
+    this->expect_consistent(sut);
+
+    ASSERT_TRUE(sut.try_emplace(10, 10).second);
+    int const other_key{-1};
+    ASSERT_TRUE(sut.try_emplace(other_key, -1).second);
+    ASSERT_FALSE(sut.try_emplace(other_key, -1).second);
+    sut.try_emplace(sut.find(8), 7, 7);
+    sut.try_emplace(sut.cend(), other_key, -1);
+    this->expect_consistent(sut);
+
+    std::array<std::pair<int, int>, 4> const range{{{12, 12}, {2, 2}, {12, 12}, {-2, -2}}};
+    sut.insert(range.cbegin(), range.cend());
+    this->expect_consistent(sut);
+    ASSERT_EQ(sut.size(), 13u);
+}
+
+TYPED_TEST(BinaryTreeSizeTest, every_erase_uncounts_erased_keys_only)
+{
+    auto& sut{this->tree_};
+    // erases hit leaves, semibranches, branches, the root and both ends of the tree
+    std::vector<int> keys(64);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{7});
+    for (auto const key : keys) {
+        sut.insert({key, key});
+    }
+    this->expect_consistent(sut);
+
+    ASSERT_EQ(sut.erase(0), 1u);
+    ASSERT_EQ(sut.erase(0), 0u);
+    ASSERT_EQ(sut.erase(63), 1u);
+    this->expect_consistent(sut);
+    sut.erase(sut.cbegin());
+    sut.erase(sut.find(62));
+    this->expect_consistent(sut);
+
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{8});
+    std::size_t expected{sut.size()};
+    for (auto const key : keys) {
+        if (sut.contains(key)) {
+            if (key % 2 == 0) { sut.erase(sut.find(key)); }
+            else { sut.erase(key); }
+            --expected;
+        }
+        ASSERT_EQ(sut.size(), expected);
+        this->expect_consistent(sut);
+    }
+    ASSERT_TRUE(sut.empty());
+}
+
+TYPED_TEST(BinaryTreeSizeTest, copies_moves_swaps_and_clear_carry_the_size)
+{
+    auto& sut{this->tree_};
+    for (int i{0}; i != 10; ++i) {
+        sut.insert({i * 7 % 10, i});
+    }
+    TypeParam copy{sut};
+    this->expect_consistent(copy);
+    ASSERT_EQ(copy.size(), 10u);
+
+    TypeParam moved{std::move(copy)};
+    this->expect_consistent(moved);
+    this->expect_consistent(copy);
+    ASSERT_EQ(moved.size(), 10u);
+    ASSERT_EQ(copy.size(), 0u);
+
+    TypeParam other{};
+    other.insert({42, 42});
+    other.swap(moved);
+    this->expect_consistent(other);
+    this->expect_consistent(moved);
+    ASSERT_EQ(other.size(), 10u);
+    ASSERT_EQ(moved.size(), 1u);
+
+    moved = std::move(other);
+    this->expect_consistent(moved);
+    ASSERT_EQ(moved.size(), 10u);
+    other = moved;
+    this->expect_consistent(other);
+    ASSERT_EQ(other.size(), 10u);
+
+    sut.clear();
+    this->expect_consistent(sut);
+    sut.insert({1, 1});
+    this->expect_consistent(sut);
+    ASSERT_EQ(sut.size(), 1u);
+}
+
+// Bulk builds and unions link the nodes into a perfectly balanced tree, whatever the balancing policy
+template<typename Tree>
+class BinaryTreeBulkTest : public BinaryTreeSizeTest<Tree> {
+protected:
+    static std::size_t balanced_height(std::size_t n)
+    {
+        return n == 0 ? 0 : static_cast<std::size_t>(std::log2(static_cast<double>(n))) + 1;
+    }
+
+    static std::vector<std::pair<int, int>> sorted_range(int first, int last, int value)
+    {
+        std::vector<std::pair<int, int>> range{};
+        for (int key{first}; key != last; ++key) { range.emplace_back(key, value); }
+        return range;
+    }
+};
+
+TYPED_TEST_SUITE(BinaryTreeBulkTest, BalancePolicies);
+
+TYPED_TEST(BinaryTreeBulkTest, sorted_range_builds_a_balanced_tree)
+{
+    auto const range{this->sorted_range(0, 1000, 1)};
+
+    TypeParam sut{range.cbegin(), range.cend()};
+    this->expect_consistent(sut);
+    ASSERT_EQ(sut.height(), this->balanced_height(1000));
+    ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), range.cbegin(), range.cend(), [](auto const& lhs, auto const& rhs) {
+        return lhs.first == rhs.first && lhs.second == rhs.second;
+    }));
+
+    TypeParam tagged{BT_Sorted_Unique, range.cbegin(), range.cend()};
+    this->expect_consistent(tagged);
+    ASSERT_EQ(tagged.height(), this->balanced_height(1000));
+
+    auto& inserted{this->tree_};
+    inserted.insert(range.cbegin(), range.cend());
+    this->expect_consistent(inserted);
+    ASSERT_EQ(inserted.height(), this->balanced_height(1000));
+}
+
+TYPED_TEST(BinaryTreeBulkTest, unsorted_range_is_inserted_element_by_element)
+{
+    std::array<std::pair<int, int>, 5> const duplicates{{{1, 1}, {1, 2}, {2, 2}, {3, 3}, {4, 4}}};
+    TypeParam sut{duplicates.cbegin(), duplicates.cend()};
+    this->expect_consistent(sut);
+    ASSERT_EQ(sut.size(), 4u);
+    ASSERT_EQ(sut.find(1)->second, 1);
+
+    // Sorted input into a non empty tree
+    auto const range{this->sorted_range(10, 20, 10)};
+    sut.insert(range.cbegin(), range.cend());
+    this->expect_consistent(sut);
+    ASSERT_EQ(sut.size(), 14u);
+}
+
+TYPED_TEST(BinaryTreeBulkTest, erased_nodes_of_a_bulk_build_are_reused)
+{
+    auto const range{this->sorted_range(0, 100, 1)};
+    auto& sut{this->tree_};
+    sut.insert(range.cbegin(), range.cend());
+    for (int key{0}; key != 100; key += 2) { sut.erase(key); }
+    this->expect_consistent(sut);
+    for (int key{100}; key != 200; ++key) { sut.try_emplace(key, key); }
+    this->expect_consistent(sut);
+    ASSERT_EQ(sut.size(), 150u);
+
+    TypeParam copy{sut};
+    this->expect_consistent(copy);
+    ASSERT_EQ(copy.height(), this->balanced_height(150));
+    sut.clear();
+    sut.try_emplace(1, 1);
+    this->expect_consistent(sut);
+}
+
+TYPED_TEST(BinaryTreeBulkTest, merge_union_keeps_existing_values_by_default)
+{
+    auto& sut{this->tree_};
+    std::vector<int> keys(100);
+    std::iota(keys.begin(), keys.end(), 0);
+    std::shuffle(keys.begin(), keys.end(), std::mt19937{9});
+    for (auto const key : keys) { sut.try_emplace(key, 0); }
+    auto const range{this->sorted_range(50, 150, 1)};
+    TypeParam other{range.cbegin(), range.cend()};
+    auto const moved_over{other.find(120)};
+    auto const kept{sut.find(10)};
+
+    sut.merge_union(std::move(other));
+    this->expect_consistent(sut);
+    this->expect_consistent(other);
+    ASSERT_TRUE(other.empty());
+    ASSERT_EQ(sut.size(), 150u);
+    ASSERT_EQ(sut.height(), this->balanced_height(150));
+    for (auto const& [key, value] : sut) { ASSERT_EQ(value, key < 100 ? 0 : 1); }
+
+    // The nodes moved over
+    ASSERT_EQ(moved_over->first, 120);
+    ASSERT_EQ(std::next(moved_over)->first, 121);
+    ASSERT_EQ(kept->first, 10);
+
+    // The merged tree is a valid tree of the policy
+    for (int key{0}; key != 150; key += 3) { sut.erase(key); }
+    for (int key{-50}; key != 0; ++key) { sut.try_emplace(key, key); }
+    this->expect_consistent(sut);
+    if constexpr (std::is_same_v<TypeParam, AVLTree<int, int>>) {
+        ASSERT_LE(sut.height(), avl_height_bound(sut.size()));
+    }
+}
+
+TYPED_TEST(BinaryTreeBulkTest, merge_union_applies_the_conflict_policy)
+{
+    auto const low{this->sorted_range(0, 60, 1)};
+    auto const high{this->sorted_range(40, 100, 2)};
+
+    TypeParam overwritten{low.cbegin(), low.cend()};
+    overwritten.merge_union(TypeParam{high.cbegin(), high.cend()}, BT_Union_Overwrite{});
+    this->expect_consistent(overwritten);
+    for (auto const& [key, value] : overwritten) { ASSERT_EQ(value, key < 40 ? 1 : 2); }
+
+    TypeParam summed{low.cbegin(), low.cend()};
+    summed.merge_union(TypeParam{high.cbegin(), high.cend()}, [](int& existing, int&& other) { existing += other; });
+    this->expect_consistent(summed);
+    ASSERT_EQ(summed.size(), 100u);
+    for (auto const& [key, value] : summed) { ASSERT_EQ(value, key < 40 ? 1 : key < 60 ? 3 : 2); }
+
+    TypeParam empty{};
+    empty.merge_union(std::move(summed));
+    this->expect_consistent(empty);
+    ASSERT_EQ(empty.size(), 100u);
+    empty.merge_union(TypeParam{});
+    ASSERT_EQ(empty.size(), 100u);
+}
+
+TYPED_TEST(BinaryTreeBulkTest, throwing_conflict_policy_completes_the_union)
+{
+    auto const low{this->sorted_range(0, 60, 1)};
+    auto const high{this->sorted_range(40, 100, 2)};
+    TypeParam sut{low.cbegin(), low.cend()};
+
+    int calls{0};
+    ASSERT_THROW(sut.merge_union(TypeParam{high.cbegin(), high.cend()}, [&calls](int& existing, int&& other) {
+        if (++calls == 5) { throw std::runtime_error{"conflict"}; }
+        existing = other;
+    }), std::runtime_error);
+    this->expect_consistent(sut);
+    ASSERT_EQ(calls, 5);
+    ASSERT_EQ(sut.size(), 100u);
+    for (auto const& [key, value] : sut) { ASSERT_EQ(value, key < 40 ? 1 : key < 44 ? 2 : key < 60 ? 1 : 2); }
+}
+
 } // namespace
@@ -4,7 +4,10 @@
 
 #include <algorithm>
 #include <array>
+#include <iterator>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace
 {
@@ -59,4 +62,57 @@ TEST_F(BinaryTreeIteratorTest, rbegin_returns_postorder_iterator)
     ASSERT_EQ(count, expected.size());
 }
 
+// The iterators are a single node pointer
+static_assert(std::is_trivially_copyable_v<BinaryTree<int, double>::iterator>);
+static_assert(std::is_trivially_copyable_v<BinaryTree<int, double>::const_reverse_iterator>);
+static_assert(sizeof(BinaryTree<int, double>::iterator) == sizeof(void*));
+static_assert(sizeof(AVLTree<int, double>::const_iterator) == sizeof(void*));
+
+TEST(BinaryTreeIteratorOrderTest, iterators_follow_the_parent_links_in_every_order)
+{
+    // 4 is the root, 2 and 6 its children - 1 and 3 are the children of 2, 7 is the right child of 6
+    using Node = BT_Node<int, int>;
+    Node n1{1, 1}, n2{2, 2}, n3{3, 3}, n4{4, 4}, n6{6, 6}, n7{7, 7};
+    auto const link{[](Node& parent, Node*& child, Node& node) { child = &node; node.parent = &parent; }};
+    link(n4, n4.left, n2);
+    link(n4, n4.right, n6);
+    link(n2, n2.left, n1);
+    link(n2, n2.right, n3);
+    link(n6, n6.right, n7);
+
+    auto const keys{[](auto first) {
+        std::vector<int> res{};
+        for (decltype(first) last{}; first != last; ++first) { res.push_back(first->first); }
+        return res;
+    }};
+    using Reference = std::pair<int const, int>&;
+    ASSERT_EQ(keys(BinaryTree_iterator<Node, Reference, BT_Iterator_Preorder_Tag>{&n4}),
+              (std::vector<int>{4, 2, 1, 3, 6, 7}));
+    ASSERT_EQ(keys(BinaryTree_iterator<Node, Reference, BT_Iterator_Inorder_Tag>{&n4}),
+              (std::vector<int>{1, 2, 3, 4, 6, 7}));
+    ASSERT_EQ(keys(BinaryTree_iterator<Node, Reference, BT_Iterator_Postorder_Tag>{&n4}),
+              (std::vector<int>{7, 6, 4, 3, 2, 1}));
+}
+
+TEST(BinaryTreeIteratorOrderTest, iterators_stay_valid_while_the_tree_rebalances)
+{
+    AVLTree<int, int> sut{};
+    for (int i{0}; i < 100; i += 2) {
+        sut.insert({i, i});
+    }
+    auto const it{sut.find(40)};
+    auto const rit{std::find_if(sut.rbegin(), sut.rend(), [](auto const& kv) { return kv.first == 60; })};
+    for (int i{1}; i < 100; i += 2) {
+        sut.insert({i, i});
+    }
+    for (int i{0}; i < 20; ++i) {
+        sut.erase(i);
+    }
+    ASSERT_EQ(it->first, 40);
+    ASSERT_EQ(std::next(it)->first, 41);
+    ASSERT_EQ(std::distance(it, sut.end()), 60);
+    ASSERT_EQ(std::next(rit)->first, 59);
+    ASSERT_EQ(std::distance(rit, sut.rend()), 41);
+}
+
 } // namespace
@@ -0,0 +1,370 @@
+#include <gtest/gtest.h>
+
+#include <binary_tree/btree_map.hpp>
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+// Tiny nodes - a few hundred elements make a tree of several levels
+template<typename Key, typename T, typename Compare = std::less<Key>>
+using SmallBTreeMap = BTreeMap<Key, T, std::allocator<std::pair<const Key, T>>, Compare, 64>;
+
+template<typename Map>
+std::vector<std::pair<int, int>> elements(Map const& map)
+{
+    return {map.cbegin(), map.cend()};
+}
+
+TEST(BTreeMapTest, default_constructed_map_is_empty)
+{
+    BTreeMap<int, double> sut{};
+    ASSERT_TRUE(sut.empty());
+    ASSERT_EQ(sut.size(), 0u);
+    ASSERT_EQ(sut.height(), 0u);
+    ASSERT_EQ(sut.cbegin(), sut.cend());
+    ASSERT_EQ(sut.crbegin(), sut.crend());
+}
+
+TEST(BTreeMapTest, nodes_fit_in_node_bytes)
+{
+    using Sut = BTreeMap<int, int>;
+    ASSERT_EQ(Sut::Leaf_Capacity, 61u);
+    ASSERT_EQ(Sut::Internal_Capacity, 41u);
+    ASSERT_EQ(sizeof(btree_detail::BTree_Leaf<std::pair<const int, int>, Sut::Leaf_Capacity>), 512u);
+    ASSERT_EQ(sizeof(btree_detail::BTree_Internal<int, Sut::Internal_Capacity>), 512u);
+}
+
+TEST(BTreeMapTest, range_constructed_map_holds_the_range_in_order)
+{
+    std::array<std::pair<int, int>, 5> init{{{4, 40}, {1, 10}, {3, 30}, {2, 20}, {1, 11}}};
+    BTreeMap<int, int> sut{init.cbegin(), init.cend()};
+
+    std::vector<std::pair<int, int>> const expected{{1, 10}, {2, 20}, {3, 30}, {4, 40}};
+    ASSERT_EQ(sut.size(), expected.size());
+    ASSERT_EQ(elements(sut), expected);
+}
+
+TEST(BTreeMapTest, copies_moves_and_swaps_carry_the_elements)
+{
+    SmallBTreeMap<int, int> sut{};
+    for (int i{0}; i != 500; ++i) { sut.try_emplace(i, i * 10); }
+    auto const expected{elements(sut)};
+
+    SmallBTreeMap<int, int> copy{sut};
+    ASSERT_EQ(copy.size(), 500u);
+    ASSERT_EQ(elements(copy), expected);
+
+    SmallBTreeMap<int, int> moved{std::move(copy)};
+    ASSERT_EQ(elements(moved), expected);
+    ASSERT_TRUE(copy.empty());
+    ASSERT_EQ(copy.cbegin(), copy.cend());
+
+    SmallBTreeMap<int, int> other{};
+    other.try_emplace(1000, 1);
+    other.swap(moved);
+    ASSERT_EQ(elements(other), expected);
+    ASSERT_EQ(moved.size(), 1u);
+
+    moved = other;
+    ASSERT_EQ(elements(moved), expected);
+    other.clear();
+    ASSERT_TRUE(other.empty());
+    other = std::move(moved);
+    ASSERT_EQ(elements(other), expected);
+}
+
+TEST(BTreeMapTest, reverse_iterators_visit_the_elements_in_reverse_order)
+{
+    SmallBTreeMap<int, int> sut{};
+    for (int i{0}; i != 300; ++i) { sut.try_emplace((i * 7) % 300, i); }
+
+    std::vector<int> keys{};
+    std::transform(sut.crbegin(), sut.crend(), std::back_inserter(keys), [](auto const& kv) { return kv.first; });
+    ASSERT_EQ(keys.size(), 300u);
+    ASSERT_TRUE(std::is_sorted(keys.crbegin(), keys.crend()));
+}
+
+class BTreeMapModifiersTest : public ::testing::Test
+{
+protected:
+    SmallBTreeMap<int, std::string> sut_{};
+};
+
+TEST_F(BTreeMapModifiersTest, insert_adds_new_keys_only)
+{
+    auto const [it, inserted]{sut_.insert({1, "one"})};
+    ASSERT_TRUE(inserted);
+    ASSERT_EQ(it->second, "one");
+
+    auto const [it2, inserted2]{sut_.insert(std::make_pair(1, "uno"))};
+    ASSERT_FALSE(inserted2);
+    ASSERT_EQ(it2, it);
+    ASSERT_EQ(it2->second, "one");
+    ASSERT_EQ(sut_.size(), 1u);
+}
+
+TEST_F(BTreeMapModifiersTest, insert_or_assign_assigns_existing_keys)
+{
+    ASSERT_TRUE(sut_.insert_or_assign(7, "seven").second);
+    auto const [it, inserted]{sut_.insert_or_assign(7, "sieben")};
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(it->second, "sieben");
+    ASSERT_EQ(sut_.at(7), "sieben");
+    ASSERT_EQ(sut_.size(), 1u);
+}
+
+TEST_F(BTreeMapModifiersTest, try_emplace_leaves_existing_values_and_arguments_alone)
+{
+    sut_.try_emplace(3, "three");
+    std::string value{"drei"};
+    auto const [it, inserted]{sut_.try_emplace(3, std::move(value))};
+    ASSERT_FALSE(inserted);
+    ASSERT_EQ(it->second, "three");
+    ASSERT_EQ(value, "drei");
+
+    sut_[4] = "four";
+    ASSERT_EQ(sut_.at(4), "four");
+    ASSERT_THROW(sut_.at(5), std::out_of_range);
+}
+
+TEST_F(BTreeMapModifiersTest, erase_returns_the_iterator_to_the_next_element)
+{
+    for (int i{0}; i != 200; ++i) { sut_.try_emplace(i, std::to_string(i)); }
+
+    // Every erasure underflows a leaf sooner or later - borrowing and merging move the next element
+    for (int i{0}; i != 200; i += 2) {
+        auto const next{sut_.erase(sut_.find(i))};
+        ASSERT_NE(next, sut_.end());
+        ASSERT_EQ(next->first, i + 1);
+    }
+    ASSERT_EQ(sut_.size(), 100u);
+    ASSERT_EQ(sut_.erase(sut_.find(199)), sut_.end());
+}
+
+TEST_F(BTreeMapModifiersTest, erase_range_removes_the_range)
+{
+    for (int i{0}; i != 200; ++i) { sut_.try_emplace(i, std::to_string(i)); }
+
+    auto const next{sut_.erase(sut_.find(50), sut_.find(150))};
+    ASSERT_EQ(next->first, 150);
+    ASSERT_EQ(sut_.size(), 100u);
+    ASSERT_EQ(sut_.lower_bound(50)->first, 150);
+
+    ASSERT_EQ(sut_.erase(sut_.cbegin(), sut_.cend()), sut_.end());
+    ASSERT_TRUE(sut_.empty());
+    ASSERT_EQ(sut_.height(), 0u);
+}
+
+TEST_F(BTreeMapModifiersTest, erase_key_erases_existing_keys_only)
+{
+    for (int i{0}; i != 100; ++i) { sut_.try_emplace(i, std::to_string(i)); }
+    ASSERT_EQ(sut_.erase(100), 0u);
+    ASSERT_EQ(sut_.erase(42), 1u);
+    ASSERT_EQ(sut_.erase(42), 0u);
+    ASSERT_FALSE(sut_.contains(42));
+    ASSERT_EQ(sut_.size(), 99u);
+}
+
+class BTreeMapLookupTest : public ::testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        for (int i{0}; i != 1000; i += 10) { sut_.try_emplace(i, i); }
+    }
+
+    SmallBTreeMap<int, int> sut_{};
+};
+
+TEST_F(BTreeMapLookupTest, find_and_count_find_existing_keys_only)
+{
+    ASSERT_EQ(sut_.find(420)->second, 420);
+    ASSERT_EQ(sut_.find(421), sut_.end());
+    ASSERT_EQ(sut_.count(0), 1u);
+    ASSERT_EQ(sut_.count(995), 0u);
+}
+
+TEST_F(BTreeMapLookupTest, bounds_iterate_in_order_from_the_bound)
+{
+    for (int key{-5}; key != 1000; ++key) {
+        auto const lower{sut_.lower_bound(key)};
+        auto const upper{sut_.upper_bound(key)};
+        int const expected_lower{(key + 9) / 10 * 10};
+        int const expected_upper{key < 0 ? 0 : (key / 10 + 1) * 10};
+        ASSERT_EQ(lower != sut_.end() ? lower->first : 1000, std::max(expected_lower, 0)) << key;
+        ASSERT_EQ(upper != sut_.end() ? upper->first : 1000, expected_upper) << key;
+    }
+    ASSERT_EQ(std::distance(sut_.lower_bound(250), sut_.upper_bound(500)), 26);
+}
+
+TEST_F(BTreeMapLookupTest, equal_range_holds_the_element_with_equal_key)
+{
+    auto const [first, last]{sut_.equal_range(500)};
+    ASSERT_EQ(std::distance(first, last), 1);
+    ASSERT_EQ(first->first, 500);
+
+    auto const [first2, last2]{sut_.equal_range(505)};
+    ASSERT_EQ(first2, last2);
+}
+
+TEST(BTreeMapTransparentLookupTest, lookups_and_erase_take_a_string_view)
+{
+    SmallBTreeMap<std::string, int, std::less<>> sut{};
+    for (int i{0}; i != 100; ++i) { sut.try_emplace(std::to_string(i), i); }
+
+    ASSERT_EQ(sut.find(std::string_view{"42"})->second, 42);
+    ASSERT_TRUE(sut.contains(std::string_view{"7"}));
+    ASSERT_EQ(sut.count(std::string_view{"100"}), 0u);
+    ASSERT_EQ(sut.lower_bound(std::string_view{"950"})->first, "96");
+    ASSERT_EQ(sut.erase(std::string_view{"42"}), 1u);
+    ASSERT_FALSE(sut.contains(std::string_view{"42"}));
+}
+
+// Counts its copies - the elements are moved between the slots, the keys included
+struct CopyCountingKey {
+    static inline int copies{0};
+
+    int value;
+
+    explicit CopyCountingKey(int v) noexcept : value{v} { }
+    CopyCountingKey(CopyCountingKey const& other) noexcept : value{other.value} { ++copies; }
+    CopyCountingKey(CopyCountingKey&& other) noexcept = default;
+    CopyCountingKey& operator=(CopyCountingKey const& other) noexcept = default;
+    CopyCountingKey& operator=(CopyCountingKey&& other) noexcept = default;
+    ~CopyCountingKey() = default;
+
+    friend bool operator<(CopyCountingKey const& lhs, CopyCountingKey const& rhs) noexcept
+    {
+        return lhs.value < rhs.value;
+    }
+};
+
+TEST(BTreeMapRelocationTest, shifting_the_elements_of_a_leaf_does_not_copy_the_keys)
+{
+    using Sut = SmallBTreeMap<CopyCountingKey, int>;
+    Sut sut{};
+    CopyCountingKey::copies = 0;
+    // every insert in front of the others shifts the whole leaf, which is never split
+    for (int i{static_cast<int>(Sut::Leaf_Capacity)}; i != 0; --i) {
+        ASSERT_TRUE(sut.try_emplace(CopyCountingKey{i}, i).second);
+    }
+    ASSERT_EQ(CopyCountingKey::copies, 0);
+    ASSERT_EQ(sut.size(), Sut::Leaf_Capacity);
+    int expected{1};
+    for (auto const& [key, value] : sut) {
+        ASSERT_EQ(key.value, expected);
+        ASSERT_EQ(value, expected);
+        ++expected;
+    }
+}
+
+// Throws when asked to - the element is not inserted then
+struct ThrowingValue {
+    int value;
+
+    explicit ThrowingValue(int v, bool do_throw = false) : value{v}
+    {
+        if (do_throw) { throw std::runtime_error{"ThrowingValue"}; }
+    }
+};
+
+TEST(BTreeMapExceptionTest, throwing_constructor_leaves_a_full_leaf_unsplit)
+{
+    using Sut = SmallBTreeMap<int, ThrowingValue>;
+    constexpr int count{static_cast<int>(Sut::Leaf_Capacity)};
+    Sut sut{};
+    for (int i{1}; i <= count; ++i) { sut.try_emplace(i, i); }
+
+    // appended after the last and prepended before the first element of the full leaf - the
+    // leaves split at the ends of the tree
+    ASSERT_THROW(sut.try_emplace(count + 1, count + 1, true), std::runtime_error);
+    ASSERT_THROW(sut.try_emplace(0, 0, true), std::runtime_error);
+
+    ASSERT_EQ(sut.size(), Sut::Leaf_Capacity);
+    ASSERT_EQ(std::distance(sut.begin(), sut.end()), count);
+    ASSERT_EQ(std::distance(sut.rbegin(), sut.rend()), count);
+    ASSERT_EQ(sut.begin()->first, 1);
+    ASSERT_EQ(sut.rbegin()->first, count);
+    int expected{1};
+    for (auto const& [key, value] : sut) {
+        ASSERT_EQ(key, expected);
+        ASSERT_EQ(value.value, expected);
+        ++expected;
+    }
+
+    // and takes the elements once they do not throw
+    sut.try_emplace(count + 1, count + 1);
+    sut.try_emplace(0, 0);
+    ASSERT_EQ(sut.size(), Sut::Leaf_Capacity + 2);
+    expected = 0;
+    for (auto const& [key, value] : sut) {
+        ASSERT_EQ(key, expected);
+        ASSERT_EQ(value.value, expected);
+        ++expected;
+    }
+    ASSERT_EQ(sut.rbegin()->first, count + 1);
+}
+
+// Random inserts and erases against std::map - splits, borrows and merges on every level
+TEST(BTreeMapRandomTest, random_modifications_match_std_map)
+{
+    SmallBTreeMap<int, int> sut{};
+    std::map<int, int> expected{};
+    std::mt19937 gen{42};
+    std::uniform_int_distribution<int> key{0, 2000};
+
+    for (int round{0}; round != 20000; ++round) {
+        int const k{key(gen)};
+        switch (gen() % 4) {
+        case 0:
+        case 1:
+            ASSERT_EQ(sut.try_emplace(k, round).second, expected.try_emplace(k, round).second);
+            break;
+        case 2:
+            ASSERT_EQ(sut.erase(k), expected.erase(k));
+            break;
+        default:
+            if (auto it{sut.lower_bound(k)}; it != sut.end()) {
+                auto const next{sut.erase(it)};
+                auto const expected_next{expected.erase(expected.lower_bound(k))};
+                ASSERT_EQ(next != sut.end(), expected_next != expected.end());
+                if (next != sut.end()) { ASSERT_EQ(next->first, expected_next->first); }
+            }
+            break;
+        }
+        ASSERT_EQ(sut.size(), expected.size());
+    }
+    ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), expected.cbegin(), expected.cend()));
+    ASSERT_TRUE(std::equal(sut.crbegin(), sut.crend(), expected.crbegin(), expected.crend()));
+}
+
+TEST(BTreeMapRandomTest, sorted_inserts_fill_the_leaves)
+{
+    using Sut = BTreeMap<int, int>;
+    // As many full leaves as the root holds children
+    int const count{static_cast<int>(Sut::Leaf_Capacity * (Sut::Internal_Capacity + 1))};
+    Sut sut{};
+    for (int i{0}; i != count; ++i) { sut.try_emplace(i, i); }
+    ASSERT_EQ(sut.height(), 2u);
+    sut.try_emplace(count, count);
+    ASSERT_EQ(sut.height(), 3u);
+
+    Sut reversed{};
+    for (int i{count}; i != 0; --i) { reversed.try_emplace(i, i); }
+    ASSERT_EQ(reversed.height(), 2u);
+    ASSERT_EQ(reversed.cbegin()->first, 1);
+}
+
+} // namespace
@@ -0,0 +1,126 @@
+#include <benchmark/benchmark.h>
+
+#include <hash_map/concurrent_hash_map.hpp>
+#include <hash_map/hash_map.hpp>
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <shared_mutex>
+#include <vector>
+
+// Lookups mixed with a share of writes from 1 to 32 threads over a map shared by all of them.
+// "GlobalMutex" is the HashMap wrapped in a single mutex, "GlobalSharedMutex" the same with a
+// reader-writer lock - ConcurrentHashMap should keep items_per_second growing with the thread
+// count on the read heavy runs, where both wrappers flatten out or drop.
+//
+//   ./ConcurrentHashMap_BM --benchmark_filter=/0/
+namespace
+{
+
+using Key = std::uint64_t;
+using Value = std::uint64_t;
+
+constexpr std::size_t Key_Count{1 << 16};
+
+std::vector<Key> const& keys()
+{
+    static std::vector<Key> const keys{[] {
+        std::mt19937_64 gen{1};
+        std::vector<Key> result(Key_Count);
+        for (auto& key : result) { key = gen(); }
+        return result;
+    }()};
+    return keys;
+}
+
+class GlobalMutex {
+    mutable std::mutex mutex_{};
+    HashMap<Key, Value> map_{};
+public:
+    std::optional<Value> find(Key key) const
+    {
+        std::lock_guard lock{mutex_};
+        auto const it{map_.find(key)};
+        if (it != map_.cend()) { return it->second; }
+        return std::nullopt;
+    }
+
+    bool insert_or_assign(Key key, Value value)
+    {
+        std::lock_guard lock{mutex_};
+        return map_.insert_or_assign(key, value).second;
+    }
+};
+
+class GlobalSharedMutex {
+    mutable std::shared_mutex mutex_{};
+    HashMap<Key, Value> map_{};
+public:
+    std::optional<Value> find(Key key) const
+    {
+        std::shared_lock lock{mutex_};
+        auto const it{map_.find(key)};
+        if (it != map_.cend()) { return it->second; }
+        return std::nullopt;
+    }
+
+    bool insert_or_assign(Key key, Value value)
+    {
+        std::unique_lock lock{mutex_};
+        return map_.insert_or_assign(key, value).second;
+    }
+};
+
+using Sharded = ConcurrentHashMap<Key, Value>;
+
+// One map per type shared by every thread and run - prefilled on first use
+template<typename Map>
+Map& shared_map()
+{
+    static Map map{};
+    static bool const filled{[] {
+        for (auto const key : keys()) { map.insert_or_assign(key, key); }
+        return true;
+    }()};
+    static_cast<void>(filled);
+    return map;
+}
+
+// range(0) - writes in percent of the operations
+template<typename Map>
+void BM_ReadMostly(benchmark::State& state)
+{
+    auto& map{shared_map<Map>()};
+    auto const& all_keys{keys()};
+    auto const write_percent{static_cast<std::uint64_t>(state.range(0))};
+    std::uint64_t rng{std::uint64_t{0x9e3779b97f4a7c15} * (static_cast<std::uint64_t>(state.thread_index()) + 1)};
+    std::size_t found{0};
+    for (auto _ : state) {
+        // xorshift64 - cheap enough not to dominate a lookup
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        auto const key{all_keys[rng % Key_Count]};
+        if ((rng >> 32) % 100 < write_percent) {
+            map.insert_or_assign(key, rng);
+        }
+        else {
+            found += map.find(key).has_value() ? std::size_t{1} : std::size_t{0};
+        }
+    }
+    benchmark::DoNotOptimize(found);
+    state.SetItemsProcessed(state.iterations());
+}
+
+void thread_args(benchmark::internal::Benchmark* b)
+{
+    b->Arg(0)->Arg(5)->ThreadRange(1, 32)->UseRealTime();
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_ReadMostly, Sharded)->Apply(thread_args);
+BENCHMARK_TEMPLATE(BM_ReadMostly, GlobalSharedMutex)->Apply(thread_args);
+BENCHMARK_TEMPLATE(BM_ReadMostly, GlobalMutex)->Apply(thread_args);
@@ -0,0 +1,157 @@
+#include <benchmark/benchmark.h>
+
+#include <hash_map/flat_hash_map.hpp>
+#include <hash_map/hash_map.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Chained HashMap vs open addressing FlatHashMap vs std::unordered_map, keyed by 64 bit integers.
+// Every container is reserved up front for the measured element count - the benchmarks compare
+// the probing and the memory layout, not the growth (see bm_hash_map_rehash.cpp).
+//
+//   ./HashMap_BM --benchmark_filter=FindMiss
+namespace
+{
+
+using Key = std::uint64_t;
+using Value = std::uint64_t;
+
+std::vector<Key> make_keys(std::size_t count, std::uint64_t seed)
+{
+    std::mt19937_64 gen{seed};
+    std::vector<Key> keys(count);
+    std::generate(keys.begin(), keys.end(), gen);
+    return keys;
+}
+
+template<typename Map>
+Map make_map(std::vector<Key> const& keys)
+{
+    Map map{};
+    map.reserve(keys.size());
+    for (auto const key : keys) {
+        map.insert({key, key});
+    }
+    return map;
+}
+
+template<typename Map>
+void BM_FindHit(benchmark::State& state)
+{
+    auto const count{static_cast<std::size_t>(state.range(0))};
+    auto const keys{make_keys(count, 1)};
+    auto map{make_map<Map>(keys)};
+    auto lookups{keys};
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937_64{2});
+    for (auto _ : state) {
+        for (auto const key : lookups) {
+            benchmark::DoNotOptimize(map.find(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(lookups.size()));
+}
+
+template<typename Map>
+void BM_FindMiss(benchmark::State& state)
+{
+    auto const count{static_cast<std::size_t>(state.range(0))};
+    auto map{make_map<Map>(make_keys(count, 1))};
+    auto const lookups{make_keys(count, 3)};
+    for (auto _ : state) {
+        for (auto const key : lookups) {
+            benchmark::DoNotOptimize(map.find(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(lookups.size()));
+}
+
+// Small integer keys - the cost of the range reduction is a large part of the lookup
+template<typename Map>
+void BM_FindSmallInt(benchmark::State& state)
+{
+    auto const count{static_cast<std::size_t>(state.range(0))};
+    std::vector<Key> keys(count);
+    std::iota(keys.begin(), keys.end(), Key{0});
+    auto map{make_map<Map>(keys)};
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64{2});
+    for (auto _ : state) {
+        for (auto const key : keys) {
+            benchmark::DoNotOptimize(map.find(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+template<typename Map>
+void BM_Insert(benchmark::State& state)
+{
+    auto const count{static_cast<std::size_t>(state.range(0))};
+    auto const keys{make_keys(count, 1)};
+    for (auto _ : state) {
+        // Includes the destruction of the map
+        Map map{};
+        map.reserve(count);
+        for (auto const key : keys) {
+            map.insert({key, key});
+        }
+        benchmark::DoNotOptimize(map);
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(keys.size()));
+}
+
+template<typename Map>
+void BM_Erase(benchmark::State& state)
+{
+    auto const count{static_cast<std::size_t>(state.range(0))};
+    auto const keys{make_keys(count, 1)};
+    auto const prototype{make_map<Map>(keys)};
+    auto erased{keys};
+    std::shuffle(erased.begin(), erased.end(), std::mt19937_64{2});
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto map{prototype};
+        state.ResumeTiming();
+        for (auto const key : erased) {
+            benchmark::DoNotOptimize(map.erase(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(erased.size()));
+}
+
+using Chained = HashMap<Key, Value>;
+using Flat = FlatHashMap<Key, Value>;
+using Std = std::unordered_map<Key, Value>;
+using ChainedPow2 = HashMap<Key, Value, std::hash<Key>, std::allocator<std::pair<Key const, Value>>, PowerOfTwoRange>;
+using ChainedFastRange = HashMap<Key, Value, MixingHash<Key>, std::allocator<std::pair<Key const, Value>>, FastRange>;
+
+constexpr std::int64_t Min_Size{1 << 10};
+constexpr std::int64_t Max_Size{1 << 18};
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_FindHit, Chained)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_FindHit, Flat)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_FindHit, Std)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+
+BENCHMARK_TEMPLATE(BM_FindMiss, Chained)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_FindMiss, Flat)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_FindMiss, Std)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+
+BENCHMARK_TEMPLATE(BM_FindSmallInt, Chained)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_FindSmallInt, ChainedPow2)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_FindSmallInt, ChainedFastRange)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_FindSmallInt, Flat)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_FindSmallInt, Std)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+
+BENCHMARK_TEMPLATE(BM_Insert, Chained)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_Insert, Flat)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_Insert, Std)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+
+BENCHMARK_TEMPLATE(BM_Erase, Chained)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_Erase, Flat)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
+BENCHMARK_TEMPLATE(BM_Erase, Std)->RangeMultiplier(16)->Range(Min_Size, Max_Size);
@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+
+#include <hash_map/hash_map.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Building a map from a vector of elements: "Insert" is a loop of single inserts growing the map
+// from the default bucket count, "ReserveInsert" the same loop after reserve() and "Bulk" the range
+// insert, which reserves, links the elements bucket by bucket and allocates their nodes in a single
+// block. BM_FindAfterBuild looks every key up in the map built each way - the bulk built nodes of
+// a bucket are adjacent in memory.
+//
+//   ./HashMapBuild_BM --benchmark_filter=BM_Build
+namespace
+{
+
+using Key = std::uint64_t;
+using Value = std::uint64_t;
+using Map = HashMap<Key, Value>;
+using Elements = std::vector<std::pair<Key const, Value>>;
+
+Elements make_elements(std::size_t count, std::uint64_t seed)
+{
+    std::mt19937_64 gen{seed};
+    Elements elements{};
+    elements.reserve(count);
+    for (std::size_t i{0}; i != count; ++i) {
+        auto const key{gen()};
+        elements.emplace_back(key, key);
+    }
+    return elements;
+}
+
+struct Insert {
+    static Map build(Elements const& elements)
+    {
+        Map map{};
+        for (auto const& element : elements) { map.insert(element); }
+        return map;
+    }
+};
+
+struct ReserveInsert {
+    static Map build(Elements const& elements)
+    {
+        Map map{};
+        map.reserve(elements.size());
+        for (auto const& element : elements) { map.insert(element); }
+        return map;
+    }
+};
+
+struct Bulk {
+    static Map build(Elements const& elements) { return Map{elements.cbegin(), elements.cend()}; }
+};
+
+struct Std {
+    static std::unordered_map<Key, Value> build(Elements const& elements)
+    {
+        return std::unordered_map<Key, Value>{elements.cbegin(), elements.cend()};
+    }
+};
+
+template<typename Builder>
+void BM_Build(benchmark::State& state)
+{
+    auto const elements{make_elements(static_cast<std::size_t>(state.range(0)), 1)};
+    for (auto _ : state) {
+        auto map{Builder::build(elements)};
+        benchmark::DoNotOptimize(map);
+        // Destroying the map is not part of the build
+        state.PauseTiming();
+        map = decltype(map){};
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename Builder>
+void BM_FindAfterBuild(benchmark::State& state)
+{
+    auto const elements{make_elements(static_cast<std::size_t>(state.range(0)), 1)};
+    auto const map{Builder::build(elements)};
+    std::vector<Key> lookups(elements.size());
+    std::transform(elements.cbegin(), elements.cend(), lookups.begin(), [](auto const& e) { return e.first; });
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937_64{2});
+    for (auto _ : state) {
+        for (auto const key : lookups) {
+            benchmark::DoNotOptimize(map.find(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(lookups.size()));
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Build, Insert)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Build, ReserveInsert)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Build, Bulk)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Build, Std)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_FindAfterBuild, Insert)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_FindAfterBuild, Bulk)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
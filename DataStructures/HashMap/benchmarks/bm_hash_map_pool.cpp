@@ -0,0 +1,87 @@
+#include <benchmark/benchmark.h>
+
+#include <hash_map/hash_map.hpp>
+#include <utils/node_pool.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Erase heavy churn: the map holds range(0) elements, every operation erases one of them and
+// inserts a new key in its place - each one frees a node and allocates another. Compares the
+// nodes allocated with std::allocator and with the PoolAllocator, followed by a lookup of every
+// live key (BM_FindAfterChurn) to show where the churned nodes ended up.
+//
+//   ./HashMapPool_BM
+namespace
+{
+
+using Key = std::uint64_t;
+using Value = std::uint64_t;
+
+template<typename Allocator>
+using Map = HashMap<Key, Value, std::hash<Key>, Allocator>;
+using StdAllocator = std::allocator<std::pair<Key const, Value>>;
+using NodePoolAllocator = PoolAllocator<std::pair<Key const, Value>>;
+
+template<typename Allocator>
+struct ChurnedMap {
+    Map<Allocator> map{};
+    std::vector<Key> live{};
+    std::mt19937_64 gen{1};
+
+    explicit ChurnedMap(std::size_t count)
+    {
+        map.reserve(count);
+        live.resize(count);
+        for (auto& key : live) {
+            key = gen();
+            map.insert({key, key});
+        }
+    }
+
+    void churn()
+    {
+        auto& slot{live[gen() % live.size()]};
+        map.erase(slot);
+        slot = gen();
+        map.insert({slot, slot});
+    }
+};
+
+template<typename Allocator>
+void BM_Churn(benchmark::State& state)
+{
+    ChurnedMap<Allocator> churned{static_cast<std::size_t>(state.range(0))};
+    for (auto _ : state) {
+        churned.churn();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template<typename Allocator>
+void BM_FindAfterChurn(benchmark::State& state)
+{
+    ChurnedMap<Allocator> churned{static_cast<std::size_t>(state.range(0))};
+    for (std::size_t i{0}; i != 4 * churned.live.size(); ++i) {
+        churned.churn();
+    }
+    auto lookups{churned.live};
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937_64{2});
+    for (auto _ : state) {
+        for (auto const key : lookups) {
+            benchmark::DoNotOptimize(churned.map.find(key));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(lookups.size()));
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Churn, StdAllocator)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Churn, NodePoolAllocator)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_FindAfterChurn, StdAllocator)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_FindAfterChurn, NodePoolAllocator)->Arg(1 << 20)->Unit(benchmark::kMillisecond);
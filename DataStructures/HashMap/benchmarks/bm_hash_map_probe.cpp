@@ -0,0 +1,159 @@
+#include <benchmark/benchmark.h>
+
+#include <hash_map/flat_hash_map.hpp>
+#include <hash_map/hash_map.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Probes (full key comparisons) per lookup with string keys. The chained HashMap matches the tags
+// of a whole bucket at once and compares the keys of the matching nodes only; "ChainedScan" is
+// the previous lookup - a walk over the bucket comparing every key.
+//
+// The group width is fixed at compile time, the target is built twice - for the x86-64 baseline
+// (SSE2, 16 tags per compare) and for AVX2 (32 tags per compare):
+//
+//   ./HashMapProbe_BM --benchmark_counters_tabular=true
+//   ./HashMapProbe_BM_AVX2 --benchmark_counters_tabular=true
+namespace
+{
+
+std::size_t key_comparisons{0};
+
+struct CountingKey {
+    std::string value{};
+};
+
+bool operator==(CountingKey const& lhs, CountingKey const& rhs) noexcept
+{
+    ++key_comparisons;
+    return lhs.value == rhs.value;
+}
+
+struct CountingKeyHash {
+    std::size_t operator()(CountingKey const& key) const noexcept { return std::hash<std::string>{}(key.value); }
+};
+
+using Value = std::uint64_t;
+
+std::vector<CountingKey> make_keys(std::size_t count, std::uint64_t seed)
+{
+    // Long common prefix - comparing the keys is expensive, as for request paths
+    std::mt19937_64 gen{seed};
+    std::vector<CountingKey> keys(count);
+    for (auto& key : keys) {
+        key.value = "/api/v1/resources/" + std::to_string(gen());
+    }
+    return keys;
+}
+
+template<typename Map>
+Map make_map(std::vector<CountingKey> const& keys, float load_factor)
+{
+    Map map{};
+    map.max_load_factor(load_factor);
+    map.reserve(keys.size());
+    for (std::size_t i{0}; i != keys.size(); ++i) {
+        map.insert({keys[i], Value{i}});
+    }
+    return map;
+}
+
+template<typename Map>
+struct Find {
+    static bool lookup(Map const& map, CountingKey const& key) noexcept { return map.find(key) != map.end(); }
+};
+
+using Chained = HashMap<CountingKey, Value, CountingKeyHash>;
+using Flat = FlatHashMap<CountingKey, Value, CountingKeyHash>;
+using Std = std::unordered_map<CountingKey, Value, CountingKeyHash>;
+
+struct ChainedScan {
+    static bool lookup(Chained const& map, CountingKey const& key) noexcept
+    {
+        auto const n{CountingKeyHash{}(key) % map.bucket_count()};
+        return std::find_if(map.cbegin(n), map.cend(n), [&key](auto const& e) { return e.first == key; })
+            != map.cend(n);
+    }
+};
+
+template<typename Map, typename Lookup>
+void run_lookups(benchmark::State& state, Map const& map, std::vector<CountingKey> const& lookups)
+{
+    std::size_t found{0};
+    key_comparisons = 0;
+    for (auto _ : state) {
+        for (auto const& key : lookups) {
+            found += Lookup::lookup(map, key) ? std::size_t{1} : std::size_t{0};
+        }
+    }
+    benchmark::DoNotOptimize(found);
+    auto const total{static_cast<double>(state.iterations()) * static_cast<double>(lookups.size())};
+    state.counters["probes/lookup"] = static_cast<double>(key_comparisons) / total;
+    state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(lookups.size()));
+    state.SetLabel("group width " + std::to_string(hash_map_detail::Group::width));
+}
+
+// range(0) - element count, range(1) - load factor in percent
+template<typename Map, typename Lookup = Find<Map>>
+void BM_ProbeHit(benchmark::State& state)
+{
+    auto const count{static_cast<std::size_t>(state.range(0))};
+    auto const load_factor{static_cast<float>(state.range(1)) / 100.0f};
+    auto const keys{make_keys(count, 1)};
+    auto const map{make_map<Map>(keys, load_factor)};
+    auto lookups{keys};
+    std::shuffle(lookups.begin(), lookups.end(), std::mt19937_64{2});
+    run_lookups<Map, Lookup>(state, map, lookups);
+}
+
+template<typename Map, typename Lookup = Find<Map>>
+void BM_ProbeMiss(benchmark::State& state)
+{
+    auto const count{static_cast<std::size_t>(state.range(0))};
+    auto const load_factor{static_cast<float>(state.range(1)) / 100.0f};
+    auto const map{make_map<Map>(make_keys(count, 1), load_factor)};
+    run_lookups<Map, Lookup>(state, map, make_keys(count, 3));
+}
+
+void probe_args(benchmark::internal::Benchmark* b)
+{
+    for (std::int64_t count : {1 << 10, 1 << 16}) {
+        for (std::int64_t load_factor : {50, 100, 400}) {
+            b->Args({count, load_factor});
+        }
+    }
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_ProbeHit, Chained)->Apply(probe_args);
+BENCHMARK_TEMPLATE(BM_ProbeHit, Chained, ChainedScan)->Apply(probe_args);
+BENCHMARK_TEMPLATE(BM_ProbeHit, Flat)->Apply(probe_args);
+BENCHMARK_TEMPLATE(BM_ProbeHit, Std)->Apply(probe_args);
+
+BENCHMARK_TEMPLATE(BM_ProbeMiss, Chained)->Apply(probe_args);
+BENCHMARK_TEMPLATE(BM_ProbeMiss, Chained, ChainedScan)->Apply(probe_args);
+BENCHMARK_TEMPLATE(BM_ProbeMiss, Flat)->Apply(probe_args);
+BENCHMARK_TEMPLATE(BM_ProbeMiss, Std)->Apply(probe_args);
+
+int main(int argc, char** argv)
+{
+#if defined(JAM_HASH_MAP_HAVE_AVX2) && (defined(__GNUC__) || defined(__clang__))
+    // Built with AVX2 enabled - refuse to run rather than die on an illegal instruction
+    if (!__builtin_cpu_supports("avx2")) {
+        std::fprintf(stderr, "%s: the CPU does not support AVX2, run the baseline build instead\n", argv[0]);
+        return 1;
+    }
+#endif
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) { return 1; }
+    benchmark::RunSpecifiedBenchmarks();
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+
+#include <hash_map/hash_map.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// Latency of single inserts into a map growing from the default bucket count - no reserve. The
+// immediate rehash moves every element within the insert crossing the load factor, the
+// incremental one spreads the move over the following inserts. Reported per insert, in ns:
+// p50, p99, p999, p9999 and max; the time of the benchmark is the time of all inserts.
+//
+//   ./HashMapRehash_BM --benchmark_counters_tabular=true
+namespace
+{
+
+using Key = std::uint64_t;
+using Value = std::uint64_t;
+using Clock = std::chrono::steady_clock;
+
+using Immediate = HashMap<Key, Value, std::hash<Key>, std::allocator<std::pair<Key const, Value>>,
+                          ModuloRange, ImmediateRehash>;
+using Incremental = HashMap<Key, Value, std::hash<Key>, std::allocator<std::pair<Key const, Value>>,
+                            ModuloRange, IncrementalRehash<>>;
+using Std = std::unordered_map<Key, Value>;
+
+std::vector<Key> make_keys(std::size_t count, std::uint64_t seed)
+{
+    std::mt19937_64 gen{seed};
+    std::vector<Key> keys(count);
+    std::generate(keys.begin(), keys.end(), gen);
+    return keys;
+}
+
+double percentile(std::vector<double> const& sorted, double p)
+{
+    auto const index{static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1))};
+    return sorted[index];
+}
+
+template<typename Map>
+void BM_InsertLatency(benchmark::State& state)
+{
+    auto const keys{make_keys(static_cast<std::size_t>(state.range(0)), 1)};
+    std::vector<double> latencies{};
+    latencies.reserve(keys.size() * 4);
+    for (auto _ : state) {
+        Map map{};
+        for (auto const key : keys) {
+            auto const start{Clock::now()};
+            map.insert({key, key});
+            auto const stop{Clock::now()};
+            latencies.push_back(std::chrono::duration<double, std::nano>(stop - start).count());
+        }
+        benchmark::DoNotOptimize(map);
+        state.PauseTiming();
+        // Destroying the map is not part of the growth. A large allocation afterwards lets the
+        // allocator coalesce the freed nodes now - otherwise the next allocation of a bucket array
+        // pays for it and shows up as the slowest insert of the following iteration
+        map = Map{};
+        benchmark::DoNotOptimize(std::vector<char>(1 << 16).data());
+        state.ResumeTiming();
+    }
+    std::sort(latencies.begin(), latencies.end());
+    state.counters["p50"] = percentile(latencies, 0.5);
+    state.counters["p99"] = percentile(latencies, 0.99);
+    state.counters["p999"] = percentile(latencies, 0.999);
+    state.counters["p9999"] = percentile(latencies, 0.9999);
+    state.counters["max"] = latencies.back();
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_InsertLatency, Immediate)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_InsertLatency, Incremental)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_InsertLatency, Std)->RangeMultiplier(16)->Range(1 << 12, 1 << 20)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,239 @@
+#ifndef DATA_STRUCTURES_CONCURRENT_HASH_MAP_HPP
+#define DATA_STRUCTURES_CONCURRENT_HASH_MAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include "ctrl_group.hpp"
+#include "hash_map.hpp"
+
+// HashMap split into independently locked shards (lock striping). A key belongs to the shard
+// selected by the top bits of its mixed hash, so the shards grow and rehash on their own and
+// lookups of different shards never touch the same lock. Readers take the shard lock shared,
+// writers exclusive; shards are cache line aligned so that locking one does not invalidate the
+// line of its neighbour.
+//
+// References into the map would outlive the lock, the API returns copies or runs a callback
+// under the lock instead:
+//
+//   find(key)                  - copy of the mapped value, std::nullopt if missing
+//   visit(key, f)              - f(value_type const&) under the shared lock, false if missing
+//   insert_or_assign(key, m)   - true if inserted, false if assigned
+//   try_emplace(key, args...)  - true if inserted, the mapped value is untouched otherwise
+//   erase(key)                 - number of elements erased
+//   erase_if(pred)             - erases the elements for which pred(value_type const&) holds,
+//                                one shard at a time
+//
+// size() and the other whole map observers lock the shards one after another - under concurrent
+// modification the result is a snapshot of each shard, not of the map.
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, T>>,
+          typename RangePolicy = ModuloRange,
+          typename RehashPolicy = IncrementalRehash<>>
+class ConcurrentHashMap {
+    using Map = HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>;
+
+    static constexpr std::size_t Cache_Line_Size{64};
+
+    struct alignas(Cache_Line_Size) Shard {
+        mutable std::shared_mutex mutex{};
+        Map map{};
+    };
+
+    Hash hash_;
+    std::size_t shard_count_;
+    int shard_shift_;
+    std::unique_ptr<Shard[]> shards_;
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = std::size_t;
+    using hasher = Hash;
+    using allocator_type = Allocator;
+
+    static constexpr size_type Default_Shard_Bucket_Count{17};
+
+    // Four shards per hardware thread keep two threads from meeting on the same lock most of
+    // the time
+    static size_type default_shard_count() noexcept
+    {
+        auto const threads{std::max(std::thread::hardware_concurrency(), 1u)};
+        return round_up_to_power_of_two(std::size_t{4} * threads);
+    }
+
+    ConcurrentHashMap() : ConcurrentHashMap(default_shard_count()) { }
+
+    explicit ConcurrentHashMap(size_type shard_count, size_type bucket_count = Default_Shard_Bucket_Count,
+                               Hash const& hash = Hash{}, Allocator const& alloc = Allocator{})
+        : hash_{hash},
+          shard_count_{round_up_to_power_of_two(shard_count)},
+          shard_shift_{Hash_Bits - log2(shard_count_)},
+          shards_{std::make_unique<Shard[]>(shard_count_)}
+    {
+        for (auto& shard : shards()) {
+            shard.map = Map{bucket_count, hash, alloc};
+        }
+    }
+
+    ConcurrentHashMap(ConcurrentHashMap const&) = delete;
+    ConcurrentHashMap& operator=(ConcurrentHashMap const&) = delete;
+    ~ConcurrentHashMap() noexcept = default;
+
+    // lookup
+    std::optional<mapped_type> find(Key const& key) const
+    {
+        auto const& shard{shard_of(key)};
+        std::shared_lock lock{shard.mutex};
+        auto const it{shard.map.find(key)};
+        if (it != shard.map.cend()) { return it->second; }
+        return std::nullopt;
+    }
+
+    template<typename F>
+    bool visit(Key const& key, F&& f) const
+    {
+        auto const& shard{shard_of(key)};
+        std::shared_lock lock{shard.mutex};
+        auto const it{shard.map.find(key)};
+        if (it == shard.map.cend()) { return false; }
+        std::invoke(std::forward<F>(f), *it);
+        return true;
+    }
+
+    bool contains(Key const& key) const
+    {
+        auto const& shard{shard_of(key)};
+        std::shared_lock lock{shard.mutex};
+        return shard.map.contains(key);
+    }
+
+    // modifiers
+    template<typename K, typename M, typename = std::enable_if_t<std::is_convertible_v<K&&, key_type>>>
+    bool insert_or_assign(K&& key, M&& value)
+    {
+        auto& shard{shard_of(key)};
+        std::unique_lock lock{shard.mutex};
+        return shard.map.insert_or_assign(std::forward<K>(key), std::forward<M>(value)).second;
+    }
+
+    template<typename K, typename... Args, typename = std::enable_if_t<std::is_convertible_v<K&&, key_type>>>
+    bool try_emplace(K&& key, Args&&... args)
+    {
+        auto& shard{shard_of(key)};
+        std::unique_lock lock{shard.mutex};
+        return shard.map.try_emplace(std::forward<K>(key), std::forward<Args>(args)...).second;
+    }
+
+    size_type erase(Key const& key)
+    {
+        auto& shard{shard_of(key)};
+        std::unique_lock lock{shard.mutex};
+        return shard.map.erase(key);
+    }
+
+    template<typename Predicate>
+    size_type erase_if(Predicate pred)
+    {
+        size_type erased{0};
+        for (auto& shard : shards()) {
+            std::unique_lock lock{shard.mutex};
+            for (auto it{shard.map.cbegin()}; it != shard.map.cend(); ) {
+                if (pred(*it)) {
+                    it = shard.map.erase(it);
+                    ++erased;
+                }
+                else {
+                    ++it;
+                }
+            }
+        }
+        return erased;
+    }
+
+    void clear()
+    {
+        for (auto& shard : shards()) {
+            std::unique_lock lock{shard.mutex};
+            shard.map.clear();
+        }
+    }
+
+    // Reserves room for `count` elements spread evenly over the shards
+    void reserve(size_type count)
+    {
+        auto const per_shard{(count + shard_count_ - 1) / shard_count_};
+        for (auto& shard : shards()) {
+            std::unique_lock lock{shard.mutex};
+            shard.map.reserve(per_shard);
+        }
+    }
+
+    // capacity
+    size_type size() const
+    {
+        size_type total{0};
+        for (auto const& shard : shards()) {
+            std::shared_lock lock{shard.mutex};
+            total += shard.map.size();
+        }
+        return total;
+    }
+
+    bool empty() const { return size() == 0; }
+
+    size_type shard_count() const noexcept { return shard_count_; }
+    hasher hash_function() const { return hash_; }
+
+private:
+    static constexpr int Hash_Bits{static_cast<int>(sizeof(std::size_t) * 8)};
+
+    template<typename S>
+    struct ShardRange {
+        S* first;
+        S* last;
+        S* begin() const noexcept { return first; }
+        S* end() const noexcept { return last; }
+    };
+
+    ShardRange<Shard> shards() noexcept { return {shards_.get(), shards_.get() + shard_count_}; }
+    ShardRange<Shard const> shards() const noexcept { return {shards_.get(), shards_.get() + shard_count_}; }
+
+    // The top bits of the mixed hash - the bucket of the key within the shard is taken from the
+    // plain hash, the two choices stay independent
+    size_type shard_index(Key const& key) const noexcept
+    {
+        if (shard_count_ == 1) { return 0; }
+        return hash_map_detail::mix(hash_(key)) >> shard_shift_;
+    }
+
+    Shard& shard_of(Key const& key) noexcept { return shards_[shard_index(key)]; }
+    Shard const& shard_of(Key const& key) const noexcept { return shards_[shard_index(key)]; }
+
+    static constexpr size_type round_up_to_power_of_two(size_type n) noexcept
+    {
+        size_type power{1};
+        while (power < n) { power <<= 1; }
+        return power;
+    }
+
+    static constexpr int log2(size_type power_of_two) noexcept
+    {
+        int bits{0};
+        while (power_of_two > 1) {
+            power_of_two >>= 1;
+            ++bits;
+        }
+        return bits;
+    }
+};
+
+#endif  // DATA_STRUCTURES_CONCURRENT_HASH_MAP_HPP
@@ -0,0 +1,271 @@
+#ifndef DATA_STRUCTURES_CTRL_GROUP_HPP
+#define DATA_STRUCTURES_CTRL_GROUP_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// The widest group implementation supported by the target is selected at compile time, define
+// JAM_HASH_MAP_NO_SIMD to force the portable one.
+#if !defined(JAM_HASH_MAP_NO_SIMD)
+#if defined(__AVX2__)
+#define JAM_HASH_MAP_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define JAM_HASH_MAP_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+#endif
+
+// Control bytes used by the open addressing tables. Every slot of a table has a single control
+// byte describing its state:
+//
+//   kEmpty    0b10000000  - the slot has never been used (terminates probing)
+//   kDeleted  0b11111110  - the slot held an element that was erased (tombstone)
+//   kSentinel 0b11111111  - marks the end of the control bytes, stops the iteration
+//   full      0b0xxxxxxx  - the slot holds an element, xxxxxxx are 7 bits of its hash (the tag)
+//
+// A Group is a window of `Group::width` consecutive control bytes that is matched against a tag
+// at once; the probing visits whole groups instead of single slots.
+namespace hash_map_detail {
+
+using ctrl_t = std::int8_t;
+using h2_t = std::uint8_t;
+
+inline constexpr ctrl_t kEmpty{-128};
+inline constexpr ctrl_t kDeleted{-2};
+inline constexpr ctrl_t kSentinel{-1};
+
+constexpr bool is_empty(ctrl_t c) noexcept { return c == kEmpty; }
+constexpr bool is_full(ctrl_t c) noexcept { return c >= 0; }
+constexpr bool is_deleted(ctrl_t c) noexcept { return c == kDeleted; }
+constexpr bool is_empty_or_deleted(ctrl_t c) noexcept { return c < kSentinel; }
+
+// Upper bits select the starting position of the probe, lower 7 bits are stored in the control
+// byte. The hash is mixed first so that identity hashes (std::hash<int>) spread over the table.
+constexpr std::size_t mix(std::size_t hash) noexcept
+{
+    if constexpr (sizeof(std::size_t) == 8) {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+    }
+    else {
+        hash ^= hash >> 16;
+        hash *= 0x85ebca6bU;
+        hash ^= hash >> 13;
+    }
+    return hash;
+}
+constexpr std::size_t h1(std::size_t hash) noexcept { return hash >> 7; }
+constexpr h2_t h2(std::size_t hash) noexcept { return static_cast<h2_t>(hash & 0x7f); }
+
+template<typename UInt>
+inline int count_trailing_zeros(UInt value) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+    if constexpr (sizeof(UInt) <= sizeof(unsigned)) {
+        return __builtin_ctz(static_cast<unsigned>(value));
+    }
+    else {
+        return __builtin_ctzll(static_cast<unsigned long long>(value));
+    }
+#else
+    int count{0};
+    while ((value & UInt{1}) == 0) {
+        value = static_cast<UInt>(value >> 1);
+        ++count;
+    }
+    return count;
+#endif
+}
+
+// Set of matching positions within a Group. Each position is represented by 2^Shift bits of the
+// mask, only the highest of which is set. Iterating yields the matching positions in order.
+template<typename UInt, int Shift>
+class BitMask {
+    UInt mask_;
+public:
+    explicit BitMask(UInt mask) noexcept : mask_{mask} { }
+
+    explicit operator bool() const noexcept { return mask_ != 0; }
+
+    int lowest_bit_set() const noexcept { return count_trailing_zeros(mask_) >> Shift; }
+
+    int operator*() const noexcept { return lowest_bit_set(); }
+
+    BitMask& operator++() noexcept
+    {
+        mask_ = static_cast<UInt>(mask_ & (mask_ - 1));
+        return *this;
+    }
+
+    BitMask begin() const noexcept { return *this; }
+    BitMask end() const noexcept { return BitMask{0}; }
+
+    friend BitMask operator|(BitMask const& lhs, BitMask const& rhs) noexcept
+    {
+        return BitMask{static_cast<UInt>(lhs.mask_ | rhs.mask_)};
+    }
+
+    friend bool operator==(BitMask const& lhs, BitMask const& rhs) noexcept { return lhs.mask_ == rhs.mask_; }
+    friend bool operator!=(BitMask const& lhs, BitMask const& rhs) noexcept { return lhs.mask_ != rhs.mask_; }
+};
+
+// Portable implementation working on 8 control bytes packed into a 64 bit word (SWAR).
+class GroupPortable {
+    static constexpr std::uint64_t lsbs{0x0101010101010101ULL};
+    static constexpr std::uint64_t msbs{0x8080808080808080ULL};
+
+    std::uint64_t ctrl_;
+public:
+    static constexpr std::size_t width{8};
+    using mask_type = BitMask<std::uint64_t, 3>;
+
+    explicit GroupPortable(ctrl_t const* pos) noexcept : ctrl_{load(pos)} { }
+
+    // May report false positives for a byte directly following a real match - the caller compares
+    // the keys anyway.
+    mask_type match(h2_t hash) const noexcept
+    {
+        auto const x{ctrl_ ^ (lsbs * hash)};
+        return mask_type{(x - lsbs) & ~x & msbs};
+    }
+
+    mask_type match_empty() const noexcept { return mask_type{(ctrl_ & (~ctrl_ << 6)) & msbs}; }
+
+    mask_type match_empty_or_deleted() const noexcept { return mask_type{(ctrl_ & (~ctrl_ << 7)) & msbs}; }
+
+private:
+    static std::uint64_t load(ctrl_t const* pos) noexcept
+    {
+        std::uint64_t value{0};
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        std::memcpy(&value, pos, sizeof(value));
+#else
+        // Byte i of the group has to end up in the bits [8i, 8i + 8)
+        for (std::size_t i{0}; i != width; ++i) {
+            value |= std::uint64_t{static_cast<std::uint8_t>(pos[i])} << (8 * i);
+        }
+#endif
+        return value;
+    }
+};
+
+#if defined(JAM_HASH_MAP_HAVE_SSE2)
+// 16 control bytes compared at once with SSE2, the mask holds one bit per control byte.
+class GroupSse2 {
+    __m128i ctrl_;
+public:
+    static constexpr std::size_t width{16};
+    using mask_type = BitMask<std::uint32_t, 0>;
+
+    explicit GroupSse2(ctrl_t const* pos) noexcept
+        : ctrl_{_mm_loadu_si128(reinterpret_cast<__m128i const*>(pos))}
+    {
+    }
+
+    mask_type match(h2_t hash) const noexcept
+    {
+        auto const tag{_mm_set1_epi8(static_cast<char>(hash))};
+        return mask_type{static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(tag, ctrl_)))};
+    }
+
+    mask_type match_empty() const noexcept
+    {
+        auto const empty{_mm_set1_epi8(kEmpty)};
+        return mask_type{static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(empty, ctrl_)))};
+    }
+
+    mask_type match_empty_or_deleted() const noexcept
+    {
+        auto const sentinel{_mm_set1_epi8(kSentinel)};
+        return mask_type{static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(sentinel, ctrl_)))};
+    }
+};
+#endif
+
+#if defined(JAM_HASH_MAP_HAVE_AVX2)
+// 32 control bytes compared at once with AVX2.
+class GroupAvx2 {
+    __m256i ctrl_;
+public:
+    static constexpr std::size_t width{32};
+    using mask_type = BitMask<std::uint32_t, 0>;
+
+    explicit GroupAvx2(ctrl_t const* pos) noexcept
+        : ctrl_{_mm256_loadu_si256(reinterpret_cast<__m256i const*>(pos))}
+    {
+    }
+
+    mask_type match(h2_t hash) const noexcept
+    {
+        auto const tag{_mm256_set1_epi8(static_cast<char>(hash))};
+        return mask_type{static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(tag, ctrl_)))};
+    }
+
+    mask_type match_empty() const noexcept
+    {
+        auto const empty{_mm256_set1_epi8(kEmpty)};
+        return mask_type{static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(empty, ctrl_)))};
+    }
+
+    mask_type match_empty_or_deleted() const noexcept
+    {
+        auto const sentinel{_mm256_set1_epi8(kSentinel)};
+        return mask_type{static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpgt_epi8(sentinel, ctrl_)))};
+    }
+};
+#endif
+
+#if defined(JAM_HASH_MAP_HAVE_AVX2)
+using Group = GroupAvx2;
+#elif defined(JAM_HASH_MAP_HAVE_SSE2)
+using Group = GroupSse2;
+#else
+using Group = GroupPortable;
+#endif
+
+// Control bytes of a table without any storage - every lookup ends in the first group, and the
+// first insertion allocates.
+inline constexpr std::size_t kEmptyGroupSize{32};
+static_assert(Group::width <= kEmptyGroupSize);
+
+constexpr std::array<ctrl_t, kEmptyGroupSize> make_empty_group() noexcept
+{
+    std::array<ctrl_t, kEmptyGroupSize> group{};
+    group[0] = kSentinel;
+    for (std::size_t i{1}; i != group.size(); ++i) {
+        group[i] = kEmpty;
+    }
+    return group;
+}
+alignas(kEmptyGroupSize) inline constexpr std::array<ctrl_t, kEmptyGroupSize> kEmptyGroup{make_empty_group()};
+
+inline ctrl_t* empty_group() noexcept { return const_cast<ctrl_t*>(kEmptyGroup.data()); }
+
+// Triangular probing over groups: visits every group exactly once when the number of groups is
+// a power of two.
+class ProbeSeq {
+    std::size_t mask_;
+    std::size_t offset_;
+    std::size_t index_{0};
+public:
+    ProbeSeq(std::size_t hash, std::size_t mask) noexcept : mask_{mask}, offset_{hash & mask} { }
+
+    std::size_t offset() const noexcept { return offset_; }
+    std::size_t offset(std::size_t i) const noexcept { return (offset_ + i) & mask_; }
+
+    void next() noexcept
+    {
+        index_ += Group::width;
+        offset_ += index_;
+        offset_ &= mask_;
+    }
+};
+
+}  // namespace hash_map_detail
+
+#endif  // DATA_STRUCTURES_CTRL_GROUP_HPP
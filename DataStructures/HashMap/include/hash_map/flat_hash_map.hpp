@@ -0,0 +1,745 @@
+#ifndef DATA_STRUCTURES_FLAT_HASH_MAP_HPP
+#define DATA_STRUCTURES_FLAT_HASH_MAP_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <utils/Assertion.h>
+#include <utils/traits.h>
+
+#include "ctrl_group.hpp"
+
+template <typename Value, typename Reference>
+class FlatHashMapIterator;
+
+// Open addressing counterpart of HashMap, storing the elements inline in a single slot array
+// (SwissTable layout). Next to the slots lives an array of control bytes - one per slot - holding
+// 7 bits of the element's hash, so that a lookup compares a whole group of tags at once and only
+// touches the slots whose tag matched.
+//
+// The number of slots (capacity) is always 2^k - 1, the control bytes array has `capacity + 1 +
+// Group::width - 1` entries: the slots, a sentinel and a copy of the first `Group::width - 1`
+// control bytes, so that a group starting anywhere in the table can be loaded without wrapping.
+//
+// The public interface mirrors HashMap, the differences being:
+//  - insertion may move the elements (and invalidates all iterators, references and pointers),
+//  - erasure invalidates only the iterators to the erased element,
+//  - a "bucket" is a single slot, bucket_size() being either 0 or 1.
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename Allocator = std::allocator<std::pair<const Key, T>>>
+class FlatHashMap {
+    using ValueType        = std::pair<const Key, T>;
+    using SlotAlloc        = typename std::allocator_traits<Allocator>::template rebind_alloc<ValueType>;
+    using SlotAllocTraits  = std::allocator_traits<SlotAlloc>;
+    using CtrlAlloc        = typename SlotAllocTraits::template rebind_alloc<hash_map_detail::ctrl_t>;
+    using CtrlAllocTraits  = std::allocator_traits<CtrlAlloc>;
+    using Group            = hash_map_detail::Group;
+    using ctrl_t           = hash_map_detail::ctrl_t;
+
+    static constexpr float Default_Max_Load_Factor{0.875f};
+
+    SlotAlloc alloc_{};
+    Hash hash_{};
+    ctrl_t* ctrl_{hash_map_detail::empty_group()};
+    ValueType* slots_{nullptr};
+    std::size_t capacity_{0};
+    std::size_t count_{0};
+    std::size_t growth_left_{0};
+    float max_load_factor_{Default_Max_Load_Factor};
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using value_type = std::pair<const Key, T>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using hasher = Hash;
+    using allocator_type = Allocator;
+    using reference = std::add_lvalue_reference_t<value_type>;
+    using const_reference = std::add_lvalue_reference_t<std::add_const_t<value_type>>;
+    using pointer = typename SlotAllocTraits::pointer;
+    using const_pointer = typename SlotAllocTraits::const_pointer;
+    using iterator = FlatHashMapIterator<value_type, reference>;
+    using const_iterator = FlatHashMapIterator<value_type, const_reference>;
+    using local_iterator = value_type*;
+    using const_local_iterator = value_type const*;
+
+    FlatHashMap() noexcept = default;
+
+    explicit FlatHashMap(size_type bucket_count, Hash const& hash = Hash{}, Allocator const& alloc = Allocator{})
+        : alloc_{SlotAlloc{alloc}}, hash_{hash}
+    {
+        if (bucket_count != 0) { resize(normalize_capacity(bucket_count)); }
+    }
+
+    explicit FlatHashMap(Allocator const& alloc) : alloc_{SlotAlloc{alloc}} { }
+
+    template<typename InputIt, typename = RequiresInputIterator<InputIt>>
+    explicit FlatHashMap(InputIt first, InputIt last, size_type bucket_count = 0,
+                         Hash const& hash = Hash{}, Allocator const& alloc = Allocator{})
+        : FlatHashMap{bucket_count, hash, alloc}
+    {
+        insert(first, last);
+    }
+
+    FlatHashMap(FlatHashMap const& other)
+        : FlatHashMap{other, SlotAllocTraits::select_on_container_copy_construction(other.alloc_)}
+    {
+    }
+
+    FlatHashMap(FlatHashMap const& other, Allocator const& alloc)
+        : alloc_{SlotAlloc{alloc}}, hash_{other.hash_}, max_load_factor_{other.max_load_factor_}
+    {
+        copy_elements(other);
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept
+        : alloc_{std::move(other.alloc_)},
+          hash_{std::move(other.hash_)},
+          ctrl_{std::exchange(other.ctrl_, hash_map_detail::empty_group())},
+          slots_{std::exchange(other.slots_, nullptr)},
+          capacity_{std::exchange(other.capacity_, 0)},
+          count_{std::exchange(other.count_, 0)},
+          growth_left_{std::exchange(other.growth_left_, 0)},
+          max_load_factor_{other.max_load_factor_}
+    {
+    }
+
+    FlatHashMap(FlatHashMap&& other, Allocator const& alloc)
+        : FlatHashMap{std::move(other)}
+    {
+        JAM_ENSURE(alloc_ == SlotAlloc{alloc}, "Move construction with incompatible allocator");
+    }
+
+    ~FlatHashMap() noexcept { free(); }
+
+    FlatHashMap& operator=(FlatHashMap const& other)
+    {
+        if (this != &other) {
+            free();
+            if (SlotAllocTraits::propagate_on_container_copy_assignment::value) {
+                alloc_ = other.alloc_;
+            }
+            hash_ = other.hash_;
+            max_load_factor_ = other.max_load_factor_;
+            copy_elements(other);
+        }
+        return *this;
+    }
+
+    FlatHashMap& operator=(FlatHashMap&& other) noexcept
+    {
+        if (this != &other) {
+            free();
+            if (SlotAllocTraits::propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(other.alloc_);
+            }
+            hash_ = std::move(other.hash_);
+            ctrl_ = std::exchange(other.ctrl_, hash_map_detail::empty_group());
+            slots_ = std::exchange(other.slots_, nullptr);
+            capacity_ = std::exchange(other.capacity_, 0);
+            count_ = std::exchange(other.count_, 0);
+            growth_left_ = std::exchange(other.growth_left_, 0);
+            max_load_factor_ = other.max_load_factor_;
+        }
+        return *this;
+    }
+
+    void swap(FlatHashMap& other) noexcept
+    {
+        using std::swap;
+        SwapAllocators<typename SlotAllocTraits::propagate_on_container_swap>{}(alloc_, other.alloc_);
+        swap(hash_, other.hash_);
+        swap(ctrl_, other.ctrl_);
+        swap(slots_, other.slots_);
+        swap(capacity_, other.capacity_);
+        swap(count_, other.count_);
+        swap(growth_left_, other.growth_left_);
+        swap(max_load_factor_, other.max_load_factor_);
+    }
+
+    // allocator access
+    allocator_type get_allocator() const noexcept { return alloc_; }
+
+    // iterators
+    iterator begin() noexcept { return iterator{ctrl_, slots_}; }
+    const_iterator begin() const noexcept { return const_iterator{ctrl_, slots_}; }
+    const_iterator cbegin() const noexcept { return const_iterator{ctrl_, slots_}; }
+
+    iterator end() noexcept { return iterator{ctrl_ + capacity_, slots_ + capacity_, {}}; }
+    const_iterator end() const noexcept { return const_iterator{ctrl_ + capacity_, slots_ + capacity_, {}}; }
+    const_iterator cend() const noexcept { return const_iterator{ctrl_ + capacity_, slots_ + capacity_, {}}; }
+
+    // capacity
+    bool empty() const noexcept { return count_ == 0; }
+    size_type size() const noexcept { return count_; }
+
+    // modifiers
+    void clear() noexcept;
+
+    std::pair<iterator, bool> insert(const value_type& value) { return emplace(value); }
+    std::pair<iterator, bool> insert(value_type&& value) { return emplace(std::move(value)); }
+    template<typename P, typename = std::enable_if_t<std::is_convertible_v<P, value_type>>>
+    std::pair<iterator, bool> insert(P&& value) { return emplace(std::forward<P>(value)); }
+    iterator insert(const_iterator, value_type const& value) { return insert(value).first; }
+    iterator insert(const_iterator, value_type&& value) { return insert(std::move(value)).first; }
+    template<typename InputIt, typename = RequiresInputIterator<InputIt>>
+    void insert(InputIt first, InputIt last);
+
+    template<typename M, typename = std::enable_if_t<std::is_convertible_v<M&&, mapped_type>>>
+    std::pair<iterator, bool> insert_or_assign(key_type const& key, M&& value)
+    {
+        return insert_or_assign_impl(key, std::forward<M>(value));
+    }
+    template<typename M, typename = std::enable_if_t<std::is_convertible_v<M&&, mapped_type>>>
+    std::pair<iterator, bool> insert_or_assign(key_type&& key, M&& value)
+    {
+        return insert_or_assign_impl(std::move(key), std::forward<M>(value));
+    }
+    template<typename M, typename = std::enable_if_t<std::is_convertible_v<M&&, mapped_type>>>
+    iterator insert_or_assign(const_iterator, key_type const& key, M&& value)
+    {
+        return insert_or_assign_impl(key, std::forward<M>(value)).first;
+    }
+    template<typename M, typename = std::enable_if_t<std::is_convertible_v<M&&, mapped_type>>>
+    iterator insert_or_assign(const_iterator, key_type&& key, M&& value)
+    {
+        return insert_or_assign_impl(std::move(key), std::forward<M>(value)).first;
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    template<typename... Args>
+    iterator emplace_hint(const_iterator, Args&&... args) { return emplace(std::forward<Args>(args)...).first; }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type const& key, Args&&... args)
+    {
+        return try_emplace_impl(key, std::forward<Args>(args)...);
+    }
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(key_type&& key, Args&&... args)
+    {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+    }
+    template<typename... Args>
+    iterator try_emplace(const_iterator, key_type const& key, Args&&... args)
+    {
+        return try_emplace_impl(key, std::forward<Args>(args)...).first;
+    }
+    template<typename... Args>
+    iterator try_emplace(const_iterator, key_type&& key, Args&&... args)
+    {
+        return try_emplace_impl(std::move(key), std::forward<Args>(args)...).first;
+    }
+
+    iterator erase(const_iterator pos);
+    iterator erase(const_iterator first, const_iterator last);
+    size_type erase(key_type const& key);
+
+    // lookup
+    reference at(Key const& key) { return at_impl(*this, key); }
+    const_reference at(Key const& key) const { return at_impl(*this, key); }
+    reference operator[](Key const& key) { return *try_emplace_impl(key).first; }
+    reference operator[](Key&& key) { return *try_emplace_impl(std::move(key)).first; }
+
+    size_type count(Key const& key) const noexcept { return contains(key) ? size_type{1} : size_type{0}; }
+    bool contains(Key const& key) const noexcept { return find_index(key) != npos; }
+
+    iterator find(Key const& key) noexcept
+    {
+        auto const index{find_index(key)};
+        return index != npos ? iterator_at(index) : end();
+    }
+    const_iterator find(Key const& key) const noexcept
+    {
+        auto const index{find_index(key)};
+        return index != npos ? iterator_at(index) : end();
+    }
+
+    std::pair<iterator, iterator> equal_range(Key const& key)
+    {
+        auto const it{find(key)};
+        return {it, it != end() ? std::next(it) : it};
+    }
+    std::pair<const_iterator, const_iterator> equal_range(Key const& key) const
+    {
+        auto const it{find(key)};
+        return {it, it != end() ? std::next(it) : it};
+    }
+
+    // bucket interface
+    local_iterator begin(size_type n) { return slots_ + n; }
+    const_local_iterator begin(size_type n) const { return slots_ + n; }
+    const_local_iterator cbegin(size_type n) const { return slots_ + n; }
+    local_iterator end(size_type n) { return slots_ + n + bucket_size(n); }
+    const_local_iterator end(size_type n) const { return slots_ + n + bucket_size(n); }
+    const_local_iterator cend(size_type n) const { return slots_ + n + bucket_size(n); }
+
+    size_type bucket_count() const noexcept { return capacity_; }
+    size_type bucket_size(size_type n) const { return hash_map_detail::is_full(ctrl_[n]) ? size_type{1} : size_type{0}; }
+    size_type bucket(Key const& k) const noexcept
+    {
+        auto const index{find_index(k)};
+        return index != npos ? index : hash_map_detail::h1(hash_of(k)) & capacity_;
+    }
+
+    // hash policy
+    float load_factor() const noexcept
+    {
+        return capacity_ == 0 ? 0.0f : static_cast<float>(count_) / static_cast<float>(capacity_);
+    }
+    float max_load_factor() const noexcept { return max_load_factor_; }
+    // Open addressing needs a free slot to terminate the probing - values above the default 7/8
+    // are clamped; takes effect at the next growth.
+    void max_load_factor(float ml) noexcept { max_load_factor_ = std::clamp(ml, 0.125f, Default_Max_Load_Factor); }
+    void rehash(size_type count);
+    void reserve(size_type count);
+
+    hasher hash_function() const { return hash_; }
+
+protected:
+    static constexpr size_type npos{static_cast<size_type>(-1)};
+
+    iterator iterator_at(size_type index) noexcept { return iterator{ctrl_ + index, slots_ + index, {}}; }
+    const_iterator iterator_at(size_type index) const noexcept
+    {
+        return const_iterator{ctrl_ + index, slots_ + index, {}};
+    }
+
+    std::size_t hash_of(key_type const& key) const noexcept { return hash_map_detail::mix(hash_(key)); }
+
+    hash_map_detail::ProbeSeq probe(std::size_t hash) const noexcept
+    {
+        return hash_map_detail::ProbeSeq{hash_map_detail::h1(hash), capacity_};
+    }
+
+    size_type find_index(key_type const& key) const noexcept;
+    size_type find_index(key_type const& key, std::size_t hash) const noexcept;
+    size_type find_first_non_full(std::size_t hash) const noexcept;
+    // Claims a slot for a new element with the given hash, growing the table if necessary. The
+    // slot is marked as full, but the element is not constructed.
+    size_type prepare_insert(std::size_t hash);
+
+    template<typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace_impl(K&& key, Args&&... args);
+    template<typename K, typename M>
+    std::pair<iterator, bool> insert_or_assign_impl(K&& key, M&& value);
+
+    template<typename... Args>
+    void construct_at(size_type index, Args&&... args)
+    {
+        try {
+            SlotAllocTraits::construct(alloc_, slots_ + index, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            set_ctrl(index, hash_map_detail::kDeleted);
+            --count_;
+            throw;
+        }
+    }
+
+    void set_ctrl(size_type index, ctrl_t value) noexcept
+    {
+        ctrl_[index] = value;
+        ctrl_[((index - (Group::width - 1)) & capacity_) + (Group::width - 1)] = value;
+    }
+
+    size_type growth(size_type capacity) const noexcept
+    {
+        auto const limit{static_cast<size_type>(static_cast<float>(capacity) * max_load_factor_)};
+        return std::min(limit, capacity - 1);
+    }
+
+    size_type normalize_capacity(size_type n) const noexcept
+    {
+        size_type capacity{Group::width - 1};
+        while (capacity < n) { capacity = capacity * 2 + 1; }
+        return capacity;
+    }
+
+    // Smallest capacity able to hold `elements` without exceeding max_load_factor
+    size_type capacity_for(size_type elements) const noexcept
+    {
+        size_type capacity{Group::width - 1};
+        while (growth(capacity) < elements) { capacity = capacity * 2 + 1; }
+        return capacity;
+    }
+
+    void grow();
+    void resize(size_type new_capacity);
+    void copy_elements(FlatHashMap const& other);
+    void destroy_elements() noexcept;
+
+    template<typename Object>
+    static auto at_impl(Object& o, key_type const& key) -> decltype(o.at(key));
+
+    void free() noexcept;
+};
+
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+auto FlatHashMap<Key, T, Hash, Allocator>::find_index(key_type const& key) const noexcept -> size_type
+{
+    return find_index(key, hash_of(key));
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+auto FlatHashMap<Key, T, Hash, Allocator>::find_index(key_type const& key, std::size_t hash) const noexcept
+    -> size_type
+{
+    auto seq{probe(hash)};
+    auto const tag{hash_map_detail::h2(hash)};
+    while (true) {
+        Group const group{ctrl_ + seq.offset()};
+        for (auto const i : group.match(tag)) {
+            auto const index{seq.offset(static_cast<size_type>(i))};
+            if (JAM_LIKELY(slots_[index].first == key)) { return index; }
+        }
+        if (JAM_LIKELY(group.match_empty())) { return npos; }
+        seq.next();
+    }
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+auto FlatHashMap<Key, T, Hash, Allocator>::find_first_non_full(std::size_t hash) const noexcept -> size_type
+{
+    auto seq{probe(hash)};
+    while (true) {
+        Group const group{ctrl_ + seq.offset()};
+        if (auto const mask{group.match_empty_or_deleted()}) {
+            return seq.offset(static_cast<size_type>(mask.lowest_bit_set()));
+        }
+        seq.next();
+    }
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+auto FlatHashMap<Key, T, Hash, Allocator>::prepare_insert(std::size_t hash) -> size_type
+{
+    auto target{find_first_non_full(hash)};
+    // Reusing a tombstone does not consume the growth budget
+    if (JAM_UNLIKELY(growth_left_ == 0 && !hash_map_detail::is_deleted(ctrl_[target]))) {
+        grow();
+        target = find_first_non_full(hash);
+    }
+    ++count_;
+    growth_left_ -= hash_map_detail::is_empty(ctrl_[target]) ? size_type{1} : size_type{0};
+    set_ctrl(target, static_cast<ctrl_t>(hash_map_detail::h2(hash)));
+    return target;
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+void FlatHashMap<Key, T, Hash, Allocator>::grow()
+{
+    if (capacity_ != 0 && count_ <= growth(capacity_) / 2) {
+        // Mostly tombstones - clean them up without growing
+        resize(capacity_);
+    }
+    else {
+        resize(std::max(capacity_ * 2 + 1, capacity_for(count_ + 1)));
+    }
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+void FlatHashMap<Key, T, Hash, Allocator>::resize(size_type new_capacity)
+{
+    JAM_EXPECT(new_capacity >= Group::width - 1 && ((new_capacity + 1) & new_capacity) == 0,
+               "FlatHashMap capacity has to be 2^k - 1");
+    CtrlAlloc ctrl_alloc{alloc_};
+    auto const ctrl_size{new_capacity + Group::width};
+    auto* new_slots{SlotAllocTraits::allocate(alloc_, new_capacity)};
+    ctrl_t* new_ctrl{nullptr};
+    try {
+        new_ctrl = CtrlAllocTraits::allocate(ctrl_alloc, ctrl_size);
+    }
+    catch (...) {
+        SlotAllocTraits::deallocate(alloc_, new_slots, new_capacity);
+        throw;
+    }
+    std::fill_n(new_ctrl, ctrl_size, hash_map_detail::kEmpty);
+    new_ctrl[new_capacity] = hash_map_detail::kSentinel;
+
+    auto* const old_ctrl{std::exchange(ctrl_, new_ctrl)};
+    auto* const old_slots{std::exchange(slots_, new_slots)};
+    auto const old_capacity{std::exchange(capacity_, new_capacity)};
+    growth_left_ = growth(new_capacity) - count_;
+
+    for (size_type i{0}; i != old_capacity; ++i) {
+        if (hash_map_detail::is_full(old_ctrl[i])) {
+            auto const h{hash_of(old_slots[i].first)};
+            auto const target{find_first_non_full(h)};
+            set_ctrl(target, static_cast<ctrl_t>(hash_map_detail::h2(h)));
+            // const key - the pair can only be copied or move constructed
+            SlotAllocTraits::construct(alloc_, slots_ + target, std::move_if_noexcept(old_slots[i]));
+            SlotAllocTraits::destroy(alloc_, old_slots + i);
+        }
+    }
+    if (old_capacity != 0) {
+        SlotAllocTraits::deallocate(alloc_, old_slots, old_capacity);
+        CtrlAllocTraits::deallocate(ctrl_alloc, old_ctrl, old_capacity + Group::width);
+    }
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+void FlatHashMap<Key, T, Hash, Allocator>::copy_elements(FlatHashMap const& other)
+{
+    if (other.count_ == 0) { return; }
+    resize(other.capacity_);
+    for (size_type i{0}; i != other.capacity_; ++i) {
+        if (hash_map_detail::is_full(other.ctrl_[i])) {
+            // Keys are unique, skip the lookup
+            auto const index{prepare_insert(hash_of(other.slots_[i].first))};
+            construct_at(index, other.slots_[i]);
+        }
+    }
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+void FlatHashMap<Key, T, Hash, Allocator>::destroy_elements() noexcept
+{
+    for (size_type i{0}; i != capacity_; ++i) {
+        if (hash_map_detail::is_full(ctrl_[i])) {
+            SlotAllocTraits::destroy(alloc_, slots_ + i);
+        }
+    }
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+void FlatHashMap<Key, T, Hash, Allocator>::free() noexcept
+{
+    if (capacity_ != 0) {
+        destroy_elements();
+        CtrlAlloc ctrl_alloc{alloc_};
+        SlotAllocTraits::deallocate(alloc_, slots_, capacity_);
+        CtrlAllocTraits::deallocate(ctrl_alloc, ctrl_, capacity_ + Group::width);
+    }
+    ctrl_ = hash_map_detail::empty_group();
+    slots_ = nullptr;
+    capacity_ = 0;
+    count_ = 0;
+    growth_left_ = 0;
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+void FlatHashMap<Key, T, Hash, Allocator>::clear() noexcept
+{
+    if (capacity_ == 0) { return; }
+    destroy_elements();
+    std::fill_n(ctrl_, capacity_ + Group::width, hash_map_detail::kEmpty);
+    ctrl_[capacity_] = hash_map_detail::kSentinel;
+    count_ = 0;
+    growth_left_ = growth(capacity_);
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+template<typename InputIt, typename>
+void FlatHashMap<Key, T, Hash, Allocator>::insert(InputIt first, InputIt last)
+{
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+                                    typename std::iterator_traits<InputIt>::iterator_category>) {
+        reserve(count_ + static_cast<size_type>(std::distance(first, last)));
+    }
+    for (; first != last; ++first) {
+        emplace(*first);
+    }
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+template<typename... Args>
+auto FlatHashMap<Key, T, Hash, Allocator>::emplace(Args&&... args) -> std::pair<iterator, bool>
+{
+    // The key is only known after the construction - build the element on the stack and move it in
+    value_type value(std::forward<Args>(args)...);
+    auto const h{hash_of(value.first)};
+    auto const found{find_index(value.first, h)};
+    if (found != npos) { return {iterator_at(found), false}; }
+    auto const index{prepare_insert(h)};
+    construct_at(index, std::move(value));
+    return {iterator_at(index), true};
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+template<typename K, typename... Args>
+auto FlatHashMap<Key, T, Hash, Allocator>::try_emplace_impl(K&& key, Args&&... args) -> std::pair<iterator, bool>
+{
+    auto const h{hash_of(key)};
+    auto const found{find_index(key, h)};
+    if (found != npos) { return {iterator_at(found), false}; }
+    auto const index{prepare_insert(h)};
+    construct_at(index, std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)),
+                 std::forward_as_tuple(std::forward<Args>(args)...));
+    return {iterator_at(index), true};
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+template<typename K, typename M>
+auto FlatHashMap<Key, T, Hash, Allocator>::insert_or_assign_impl(K&& key, M&& value) -> std::pair<iterator, bool>
+{
+    auto res{try_emplace_impl(std::forward<K>(key), std::forward<M>(value))};
+    if (!res.second) { res.first->second = std::forward<M>(value); }
+    return res;
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+auto FlatHashMap<Key, T, Hash, Allocator>::erase(const_iterator pos) -> iterator
+{
+    auto const index{static_cast<size_type>(pos.ctrl_ - ctrl_)};
+    JAM_EXPECT(index < capacity_ && hash_map_detail::is_full(ctrl_[index]), "Erasing an invalid iterator");
+    SlotAllocTraits::destroy(alloc_, slots_ + index);
+    // Leave a tombstone - probe sequences passing through this slot must continue
+    set_ctrl(index, hash_map_detail::kDeleted);
+    --count_;
+    return iterator{ctrl_ + index, slots_ + index};
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+auto FlatHashMap<Key, T, Hash, Allocator>::erase(const_iterator first, const_iterator last) -> iterator
+{
+    while (first != last) {
+        first = erase(first);
+    }
+    return iterator_at(static_cast<size_type>(last.ctrl_ - ctrl_));
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+auto FlatHashMap<Key, T, Hash, Allocator>::erase(key_type const& key) -> size_type
+{
+    auto const index{find_index(key)};
+    if (index == npos) { return 0; }
+    erase(iterator_at(index));
+    return 1;
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+template<typename Object>
+auto FlatHashMap<Key, T, Hash, Allocator>::at_impl(Object& self, Key const& key) -> decltype(self.at(key))
+{
+    auto const index{self.find_index(key)};
+    if (index != npos) { return self.slots_[index]; }
+    else { throw std::out_of_range{"FlatHashMap: key not found"}; }
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+void FlatHashMap<Key, T, Hash, Allocator>::rehash(size_type count)
+{
+    if (count == 0 && count_ == 0) {
+        free();
+        return;
+    }
+    auto const new_capacity{std::max(normalize_capacity(count), capacity_for(count_))};
+    // Rehashing to the current capacity still drops the tombstones
+    resize(new_capacity);
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator>
+void FlatHashMap<Key, T, Hash, Allocator>::reserve(size_type count)
+{
+    auto const capacity{capacity_for(count)};
+    if (capacity > capacity_) {
+        resize(capacity);
+    }
+}
+
+
+template <typename Value, typename Reference>
+class FlatHashMapIterator
+{
+    using CvValue = std::remove_reference_t<Reference>;
+    using ctrl_t = hash_map_detail::ctrl_t;
+    template<typename K, typename T, typename H, typename A> friend class FlatHashMap;
+    template<typename V, typename R> friend class FlatHashMapIterator;
+    using Self = FlatHashMapIterator;
+
+    ctrl_t const* ctrl_{nullptr};
+    CvValue* slot_{nullptr};
+
+    struct NoSkip {};
+
+    // Ctor for an iterator to an existing element (or end) - no skipping of empty slots
+    explicit FlatHashMapIterator(ctrl_t const* ctrl, CvValue* slot, NoSkip) noexcept
+        : ctrl_{ctrl}, slot_{slot}
+    {
+    }
+
+    explicit FlatHashMapIterator(ctrl_t const* ctrl, CvValue* slot) noexcept
+        : ctrl_{ctrl}, slot_{slot}
+    {
+        skip_empty_or_deleted();
+    }
+public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = std::remove_const_t<CvValue>;
+    using reference = Reference;
+    using pointer = std::add_pointer_t<CvValue>;
+    using difference_type = std::ptrdiff_t;
+    using const_iterator = FlatHashMapIterator<Value, std::add_lvalue_reference_t<std::add_const_t<value_type>>>;
+
+    FlatHashMapIterator() noexcept = default;
+
+    template<typename R2, typename = std::enable_if_t<std::conjunction_v<
+        std::is_const<CvValue>, std::negation<std::is_const<std::remove_reference_t<R2>>>>>
+    >
+    FlatHashMapIterator(FlatHashMapIterator<Value, R2> const& other) noexcept
+        : ctrl_{other.ctrl_}, slot_{other.slot_}
+    {
+    }
+
+    FlatHashMapIterator(FlatHashMapIterator const&) = default;
+    FlatHashMapIterator(FlatHashMapIterator&&) noexcept = default;
+    FlatHashMapIterator& operator=(FlatHashMapIterator const&) = default;
+    FlatHashMapIterator& operator=(FlatHashMapIterator&&) = default;
+
+    reference operator*() const noexcept { return *slot_; }
+    pointer operator->() const noexcept { return slot_; }
+
+    Self& operator++() noexcept
+    {
+        ++ctrl_;
+        ++slot_;
+        skip_empty_or_deleted();
+        return *this;
+    }
+
+    Self operator++(int) noexcept
+    {
+        auto result{*this};
+        this->operator++();
+        return result;
+    }
+
+    template<typename V1, typename R1, typename V2, typename R2>
+    friend bool operator==(FlatHashMapIterator<V1, R1> const& lhs, FlatHashMapIterator<V2, R2> const& rhs) noexcept;
+    template<typename V1, typename R1, typename V2, typename R2>
+    friend bool operator!=(FlatHashMapIterator<V1, R1> const& lhs, FlatHashMapIterator<V2, R2> const& rhs) noexcept;
+
+private:
+    void skip_empty_or_deleted() noexcept
+    {
+        // The sentinel at ctrl[capacity] stops the scan
+        while (hash_map_detail::is_empty_or_deleted(*ctrl_)) {
+            ++ctrl_;
+            ++slot_;
+        }
+    }
+};
+
+template<typename V1, typename R1, typename V2, typename R2>
+bool operator==(FlatHashMapIterator<V1, R1> const& lhs, FlatHashMapIterator<V2, R2> const& rhs) noexcept
+{
+    return lhs.ctrl_ == rhs.ctrl_;
+}
+
+template<typename V1, typename R1, typename V2, typename R2>
+bool operator!=(FlatHashMapIterator<V1, R1> const& lhs, FlatHashMapIterator<V2, R2> const& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+
+#endif  // DATA_STRUCTURES_FLAT_HASH_MAP_HPP
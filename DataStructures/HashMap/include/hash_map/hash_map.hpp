@@ -5,19 +5,28 @@
 #include <cstddef>
 #include <cstdint>
 #include <cmath>
+#include <functional>
 #include <iterator>
 #include <memory>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "hash_map_bucket.hpp"
+#include "range_policy.hpp"
+#include "rehash_policy.hpp"
 
 template <typename BucketType, typename Reference>
 class HashMapIterator;
 
 
+// RangePolicy maps the hash of a key onto a bucket and decides the bucket counts, see
+// range_policy.hpp. RehashPolicy decides whether growing moves all elements at once or spreads
+// the move over the following inserts, see rehash_policy.hpp.
 template <typename Key, typename T, typename Hash = std::hash<Key>,
-          typename Allocator = std::allocator<std::pair<const Key, T>>>
+          typename Allocator = std::allocator<std::pair<const Key, T>>,
+          typename RangePolicy = ModuloRange,
+          typename RehashPolicy = ImmediateRehash>
 class HashMap {
     using ValueType         = std::pair<const Key, T>;
     using ValueAlloc        = typename std::allocator_traits<Allocator>::template rebind_alloc<ValueType>;
@@ -25,17 +34,45 @@ class HashMap {
     using Bucket            = HashMapBucket<Key, T, Allocator>;
     using BucketAlloc       = typename ValueAllocTraits::template rebind_alloc<Bucket>;
     using BucketAllocTraits = std::allocator_traits<BucketAlloc>;
-    using self = HashMap<Key, T, Hash, Allocator>;
+    using Node              = typename Bucket::Node;
+    using NodeAlloc         = typename ValueAllocTraits::template rebind_alloc<Node>;
+    using NodeAllocTraits   = std::allocator_traits<NodeAlloc>;
+    using self = HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>;
 
     static constexpr std::size_t Default_Bucket_Count{17};
     static constexpr float Default_Max_Load_Factor{1.0f};
 
     BucketAlloc alloc_{};
     Hash hash_{};
-    std::size_t size_{Default_Bucket_Count};
+    std::size_t size_{RangePolicy::bucket_count(Default_Bucket_Count)};
+    RangePolicy range_{size_};
     Bucket* buckets_;
     std::size_t count_{0};
     float max_load_factor_{Default_Max_Load_Factor};
+
+    // Incremental rehash in progress. While building, `buckets` is the array replacing buckets_,
+    // its first `progress` buckets are constructed. While migrating, `buckets` is the previous
+    // array - its buckets [0, progress) have been moved into buckets_ and destroyed.
+    struct PendingRehash {
+        Bucket* buckets{nullptr};
+        std::size_t size{0};
+        std::size_t progress{0};
+        std::size_t step{0};
+        bool migrating{false};
+        RangePolicy range{RangePolicy::bucket_count(1)};
+    };
+    PendingRehash pending_{};
+
+    // Nodes built by insert(first, last) - allocated in one block, released to the block as the
+    // elements are erased and deallocated with the last of them. The other nodes are allocated one
+    // at a time by their bucket.
+    struct NodeSlab {
+        Node* nodes;
+        std::size_t capacity;
+        std::size_t live;
+    };
+    using SlabAlloc = typename ValueAllocTraits::template rebind_alloc<NodeSlab>;
+    std::vector<NodeSlab, SlabAlloc> slabs_{};
 public:
     using key_type = Key;
     using mapped_type = T;
@@ -56,7 +93,8 @@ public:
     HashMap() : HashMap(Default_Bucket_Count) { }
 
     explicit HashMap(size_type bucket_count, Hash const& hash = Hash{}, Allocator const& alloc = Allocator{})
-        : alloc_{BucketAlloc{alloc}}, hash_{hash}, size_{bucket_count}, buckets_{make_buckets(bucket_count)}
+        : alloc_{BucketAlloc{alloc}}, hash_{hash}, size_{RangePolicy::bucket_count(bucket_count)},
+          buckets_{make_buckets(size_)}
     {
     }
 
@@ -70,14 +108,15 @@ public:
                      Hash const& hash = Hash{}, Allocator const& alloc = Allocator{})
         : HashMap{bucket_count, hash, alloc}
     {
-        count_ = safe_fill_buckets(first, last);
+        insert(first, last);
     }
 
     HashMap(HashMap const& other)
         : alloc_{BucketAllocTraits::select_on_container_copy_construction(other.alloc_)},
           hash_{other.hash_},
           size_{other.size_},
-          buckets_{make_buckets(size_)}
+          buckets_{make_buckets(size_)},
+          max_load_factor_{other.max_load_factor_}
     {
         count_ = fill_buckets(other.cbegin(), other.cend());
         JAM_ENSURE(count_ == other.count_, "Copy construction - failed to copy all elements");
@@ -97,7 +136,10 @@ public:
           hash_{std::move(other.hash_)},
           size_{other.size_},
           buckets_{std::exchange(other.buckets_, nullptr)},
-          count_{std::exchange(other.count_, 0)}
+          count_{std::exchange(other.count_, 0)},
+          max_load_factor_{other.max_load_factor_},
+          pending_{std::exchange(other.pending_, PendingRehash{})},
+          slabs_{std::exchange(other.slabs_, {})}
     {
     }
 
@@ -106,7 +148,10 @@ public:
           hash_{std::move(other.hash_)},
           size_{other.size_},
           buckets_{std::exchange(other.buckets_, nullptr)},
-          count_{std::exchange(other.count_, 0)}
+          count_{std::exchange(other.count_, 0)},
+          max_load_factor_{other.max_load_factor_},
+          pending_{std::exchange(other.pending_, PendingRehash{})},
+          slabs_{std::exchange(other.slabs_, {})}
     {
         JAM_ENSURE(alloc_ == other.alloc_, "Move construction with incompatible allocator");
     }
@@ -122,7 +167,9 @@ public:
             }
             hash_ = other.hash_;
             size_ = other.size_;
+            range_ = other.range_;
             buckets_ = make_buckets(size_);
+            max_load_factor_ = other.max_load_factor_;
             count_ = fill_buckets(other.cbegin(), other.cend());
         }
         return *this;
@@ -137,8 +184,12 @@ public:
             }
             hash_ = std::move(other.hash_);
             size_ = other.size_;
+            range_ = other.range_;
             buckets_ = std::exchange(other.buckets_, nullptr);
             count_ = std::exchange(other.count_, 0);
+            max_load_factor_ = other.max_load_factor_;
+            pending_ = std::exchange(other.pending_, PendingRehash{});
+            slabs_ = std::exchange(other.slabs_, {});
         }
         return *this;
     }
@@ -146,22 +197,27 @@ public:
     void swap(HashMap& other) noexcept
     {
         using std::swap;
-        if (BucketAllocTraits::propagate_on_container_swap) {
+        if (BucketAllocTraits::propagate_on_container_swap::value) {
             swap(alloc_, other.alloc_);
         }
         swap(hash_, other.hash_);
         swap(size_, other.size_);
+        swap(range_, other.range_);
         swap(buckets_, other.buckets_);
         swap(count_, other.count_);
+        swap(max_load_factor_, other.max_load_factor_);
+        swap(pending_, other.pending_);
+        swap(slabs_, other.slabs_);
     }
 
     // allocator access
     allocator_type get_allocator() const noexcept { return alloc_; }
 
-    // iterators
-    iterator begin() noexcept { return iterator{buckets_, buckets_ + size_}; }
-    const_iterator begin() const noexcept { return const_iterator{buckets_, buckets_ + size_}; }
-    const_iterator cbegin() const noexcept { return const_iterator{buckets_, buckets_ + size_}; }
+    // iterators - while an incremental rehash migrates, the buckets not yet migrated are visited
+    // first, then the new array
+    iterator begin() noexcept { return make_begin<iterator>(); }
+    const_iterator begin() const noexcept { return make_begin<const_iterator>(); }
+    const_iterator cbegin() const noexcept { return make_begin<const_iterator>(); }
 
     iterator end() noexcept { return iterator{buckets_ + size_}; }
     const_iterator end() const noexcept { return const_iterator{buckets_ + size_}; }
@@ -172,7 +228,7 @@ public:
     size_type size() const noexcept { return count_; }
 
     // modifiers
-    void clear() noexcept { free(); }
+    void clear() noexcept;
 
     std::pair<iterator, bool> insert(const value_type& value);
     std::pair<iterator, bool> insert(value_type&& value);
@@ -181,6 +237,11 @@ public:
     // TODO: implement the hint'ed operations
     iterator insert(const_iterator hint, value_type const& value);
     iterator insert(const_iterator hint, value_type&& value);
+    // Bulk load - a forward range reserves room for all of its elements up front, is hashed once
+    // and linked bucket by bucket with the nodes allocated in a single block. The first of equal
+    // keys is inserted, like a loop of insert() would.
+    template<typename InputIt, typename = RequiresInputIterator<InputIt>>
+    void insert(InputIt first, InputIt last);
 
     template<typename M, typename = std::enable_if_t<std::is_convertible_v<M&&, mapped_type>>>
     std::pair<iterator, bool> insert_or_assign(key_type const&, M&& value);
@@ -213,22 +274,52 @@ public:
     iterator erase(const_iterator pos);
     iterator erase(const_iterator first, const_iterator last);
     size_type erase(key_type const& key);
+    template<typename K, typename H = Hash, typename = RequiresTransparent<H>>
+    size_type erase(K const& key);
 
-    // lookup
+    // lookup - the overloads templated on K take any key comparable to key_type with operator==,
+    // without constructing a key_type, if Hash is transparent and hashes K equal to the
+    // corresponding key_type
     reference at(Key const&);
     const_reference at(Key const&) const;
+    template<typename K, typename H = Hash, typename = RequiresTransparent<H>>
+    reference at(K const&);
+    template<typename K, typename H = Hash, typename = RequiresTransparent<H>>
+    const_reference at(K const&) const;
     reference operator[](Key const&);
     reference operator[](Key&&);
 
-    size_type count(Key const&) const noexcept { return count_; }
+    size_type count(Key const& key) const noexcept { return contains(key) ? size_type{1} : size_type{0}; }
+    template<typename K, typename H = Hash, typename = RequiresTransparent<H>>
+    size_type count(K const& key) const noexcept { return contains(key) ? size_type{1} : size_type{0}; }
 
-    iterator find(Key const&) noexcept;
-    const_iterator find(Key const&) const noexcept;
+    bool contains(Key const& key) const noexcept { return contains_impl(key); }
+    template<typename K, typename H = Hash, typename = RequiresTransparent<H>>
+    bool contains(K const& key) const noexcept { return contains_impl(key); }
 
-    std::pair<iterator, iterator> equal_range(Key const&);
-    std::pair<const_iterator, const_iterator> equal_range(Key const&) const;
+    iterator find(Key const& key) noexcept { return find_impl<iterator>(*this, key); }
+    const_iterator find(Key const& key) const noexcept { return find_impl<const_iterator>(*this, key); }
+    template<typename K, typename H = Hash, typename = RequiresTransparent<H>>
+    iterator find(K const& key) noexcept { return find_impl<iterator>(*this, key); }
+    template<typename K, typename H = Hash, typename = RequiresTransparent<H>>
+    const_iterator find(K const& key) const noexcept { return find_impl<const_iterator>(*this, key); }
 
-    // bucket interface
+    // Keys are unique - the range holds at most one element
+    std::pair<iterator, iterator> equal_range(Key const& key) { return equal_range_impl<iterator>(*this, key); }
+    std::pair<const_iterator, const_iterator> equal_range(Key const& key) const
+    {
+        return equal_range_impl<const_iterator>(*this, key);
+    }
+    template<typename K, typename H = Hash, typename = RequiresTransparent<H>>
+    std::pair<iterator, iterator> equal_range(K const& key) { return equal_range_impl<iterator>(*this, key); }
+    template<typename K, typename H = Hash, typename = RequiresTransparent<H>>
+    std::pair<const_iterator, const_iterator> equal_range(K const& key) const
+    {
+        return equal_range_impl<const_iterator>(*this, key);
+    }
+
+    // bucket interface - while an incremental rehash is in progress it describes the array new
+    // elements are inserted into, bucket_count() included; buckets not yet migrated are not visible
     local_iterator begin(size_type n) { return buckets_[n].begin(); }
     const_local_iterator begin(size_type n) const { return buckets_[n].begin(); }
     const_local_iterator cbegin(size_type n) const { return buckets_[n].cbegin(); }
@@ -238,10 +329,7 @@ public:
 
     size_type bucket_count() const noexcept { return size_; }
     size_type bucket_size(size_type n) const { return buckets_[n].size(); }
-    size_type bucket(Key const& k) const noexcept {
-        auto bucket{get_bucket(k)};
-        return bucket->size();
-    }
+    size_type bucket(Key const& k) const noexcept { return bucket_index(k); }
 
     // hash policy
     float load_factor() const noexcept;
@@ -249,6 +337,7 @@ public:
     void max_load_factor(float ml) noexcept;
     void rehash(size_type count);
     void reserve(size_type count);
+    bool rehashing() const noexcept { return pending_.buckets != nullptr; }
 
 protected:
     using buckets_iterator = Bucket*;
@@ -272,121 +361,349 @@ protected:
     {
         size_type count{0};
         while (first != last) {
-            auto bucket{get_bucket(first->first)};
-            bucket->push_front(*first);
+            auto const [bucket, tag]{locate(first->first)};
+            bucket->push_front(tag, *first);
             ++first;
             ++count;
         }
         return count;
     }
 
+    // Skips the duplicate keys of the range
     template<typename InputIt>
-    size_type safe_fill_buckets(InputIt first, InputIt last)
+    void safe_fill_buckets(InputIt first, InputIt last)
     {
-        size_type count{0};
         while (first != last) {
-            auto bucket{get_bucket(first->first)};
-            bucket->insert_unique(*first);
+            grow_if_needed();
+            auto const [bucket, tag]{locate(first->first)};
+            if (bucket->insert_unique(tag, *first).second) { ++count_; }
             ++first;
-            ++count;
         }
-        return count;
     }
 
+    // Bucket of the key and the tag identifying the key within the bucket - hashes the key once
+    template<typename K>
+    std::pair<buckets_iterator, BucketTag> locate(K const& key) noexcept
+    {
+        auto const hash{hash_(key)};
+        return {home_bucket(hash), make_bucket_tag(hash)};
+    }
+
+    template<typename K>
+    std::pair<const_buckets_iterator, BucketTag> locate(K const& key) const noexcept
+    {
+        auto const hash{hash_(key)};
+        return {home_bucket(hash), make_bucket_tag(hash)};
+    }
+
+    // A bucket not yet migrated by an incremental rehash still holds its elements
+    buckets_iterator home_bucket(std::size_t hash) const noexcept
+    {
+        if constexpr (RehashPolicy::incremental) {
+            if (JAM_UNLIKELY(pending_.migrating)) {
+                auto const index{pending_.range(hash)};
+                if (index >= pending_.progress) { return pending_.buckets + index; }
+            }
+        }
+        return buckets_ + range_(hash);
+    }
+
+    bool in_pending(const_buckets_iterator bucket) const noexcept
+    {
+        return pending_.migrating && !std::less<const_buckets_iterator>{}(bucket, pending_.buckets)
+            && std::less<const_buckets_iterator>{}(bucket, pending_.buckets + pending_.size);
+    }
+
+    // Iterator over the rest of the map, starting at `node` of `bucket`
+    template<typename Iterator, typename Node>
+    Iterator make_iterator(const_buckets_iterator bucket, Node node) const noexcept
+    {
+        auto* const b{const_cast<Bucket*>(bucket)};
+        if (in_pending(bucket)) {
+            return Iterator{b, pending_.buckets + pending_.size, buckets_, buckets_ + size_, node};
+        }
+        return Iterator{b, buckets_ + size_, node};
+    }
+
+    template<typename Iterator>
+    Iterator make_begin() const noexcept
+    {
+        if (pending_.migrating) {
+            return Iterator{pending_.buckets + pending_.progress, pending_.buckets + pending_.size,
+                            buckets_, buckets_ + size_};
+        }
+        return Iterator{buckets_, buckets_ + size_};
+    }
+
+    // Called by every insert before the key is located
+    void grow_if_needed();
+    void grow_to(size_type count);
+    void rehash_step(size_type buckets);
+    void finish_rehash();
+
     template<typename K, typename... Args> inline
     std::enable_if_t<std::is_convertible_v<K&&, key_type>, buckets_iterator> get_bucket(K&& key, Args&&...)
     {
-        auto bucket{bbegin()};
-        std::advance(bucket, bucket_index(key));
-        return bucket;
+        return bbegin() + bucket_index(key);
     }
 
     constexpr inline size_type bucket_index(key_type const& key) const noexcept
     {
-        return hash_(key) % size_;
+        return range_(hash_(key));
     }
 
     inline buckets_iterator get_bucket(key_type const& key) noexcept
     {
-        auto bucket{bbegin()};
-        std::advance(bucket, bucket_index(key));
-        return bucket;
+        return bbegin() + bucket_index(key);
     }
 
     inline const_buckets_iterator get_bucket(key_type const& key) const noexcept
     {
-        auto bucket{bbegin()};
-        std::advance(bucket, bucket_index(key));
-        return bucket;
+        return bcbegin() + bucket_index(key);
     }
 
-    template<typename Object>
-    static auto at_impl(Object& o, key_type const& key) -> decltype(o.at(key));
+    template<typename Object, typename K>
+    static auto at_impl(Object& o, K const& key) -> decltype(o.at(std::declval<key_type const&>()));
+
+    template<typename K>
+    bool contains_impl(K const& key) const noexcept
+    {
+        auto const [bucket, tag]{locate(key)};
+        return bucket->find(tag, key) != bucket->cend();
+    }
+
+    template<typename Iterator, typename Object, typename K>
+    static Iterator find_impl(Object& self, K const& key) noexcept
+    {
+        auto const [bucket, tag]{self.locate(key)};
+        auto const bucket_it{bucket->find(tag, key)};
+        if (bucket_it != bucket->end()) { return self.template make_iterator<Iterator>(bucket, bucket_it); }
+        else { return self.end(); }
+    }
+
+    template<typename Iterator, typename Object, typename K>
+    static std::pair<Iterator, Iterator> equal_range_impl(Object& self, K const& key) noexcept
+    {
+        auto const first{find_impl<Iterator>(self, key)};
+        if (first == self.end()) { return {first, first}; }
+        return {first, std::next(first)};
+    }
+
+    template<typename K>
+    size_type erase_impl(K const& key)
+    {
+        auto const [bucket, tag]{locate(key)};
+        auto erased_count{bucket->erase(tag, key, node_release())};
+        count_ -= erased_count;
+        return erased_count;
+    }
+
+    void destroy_buckets(Bucket* first, Bucket* last) noexcept
+    {
+        while (last != first) {
+            --last;
+            if (!slabs_.empty()) { last->clear(node_release()); }
+            BucketAllocTraits::destroy(alloc_, last);
+        }
+    }
+
+    template<typename ForwardIt>
+    void bulk_insert(ForwardIt first, ForwardIt last);
+
+    // Takes back the nodes of the slabs - the bucket frees the node if this returns false
+    bool release_node(Node* node) noexcept
+    {
+        for (auto slab{slabs_.begin()}; slab != slabs_.end(); ++slab) {
+            if (!std::less<Node*>{}(node, slab->nodes) && std::less<Node*>{}(node, slab->nodes + slab->capacity)) {
+                NodeAlloc node_alloc{alloc_};
+                NodeAllocTraits::destroy(node_alloc, node);
+                if (--slab->live == 0) {
+                    NodeAllocTraits::deallocate(node_alloc, slab->nodes, slab->capacity);
+                    slabs_.erase(slab);
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    auto node_release() noexcept
+    {
+        return [this](Node* node) noexcept { return release_node(node); };
+    }
+
+    void free_pending() noexcept
+    {
+        if (pending_.buckets) {
+            if (pending_.migrating) {
+                destroy_buckets(pending_.buckets + pending_.progress, pending_.buckets + pending_.size);
+            }
+            else {
+                destroy_buckets(pending_.buckets, pending_.buckets + pending_.progress);
+            }
+            BucketAllocTraits::deallocate(alloc_, pending_.buckets, pending_.size);
+            pending_ = PendingRehash{};
+        }
+    }
 
     void free() noexcept
     {
+        free_pending();
         if (buckets_)
         {
-            for (auto* p{buckets_ + size_}; p != buckets_; ) {
-                BucketAllocTraits::destroy(alloc_, --p);
-            }
+            destroy_buckets(buckets_, buckets_ + size_);
             BucketAllocTraits::deallocate(alloc_, buckets_, size_);
         }
     }
 };
 
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::insert(value_type const& value) -> std::pair<iterator, bool>
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+void HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::clear() noexcept
 {
-    auto bucket{get_bucket(value.first)};
-    auto res{bucket->insert_unique(value)};
+    free_pending();
+    for (auto b{bbegin()}; b != bend(); ++b) {
+        b->clear(node_release());
+    }
+    count_ = 0;
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::insert(value_type const& value) -> std::pair<iterator, bool>
+{
+    grow_if_needed();
+    auto const [bucket, tag]{locate(value.first)};
+    auto res{bucket->insert_unique(tag, value)};
     if (res.second) { ++count_; }
-    return {iterator{bucket, bend(), res.first}, res.second};
+    return {make_iterator<iterator>(bucket, res.first), res.second};
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::insert(value_type&& value) -> std::pair<iterator, bool>
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::insert(value_type&& value) -> std::pair<iterator, bool>
 {
-    auto bucket{get_bucket(value.first)};
-    auto res{bucket->insert_unique(std::move(value))};
+    grow_if_needed();
+    auto const [bucket, tag]{locate(value.first)};
+    auto res{bucket->insert_unique(tag, std::move(value))};
     if (res.second) { ++count_; }
-    return {iterator{bucket, bend(), res.first}, res.second};
+    return {make_iterator<iterator>(bucket, res.first), res.second};
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
 template<typename P, typename>
-auto HashMap<Key, T, Hash, Allocator>::insert(P&& value) -> std::pair<iterator, bool>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::insert(P&& value) -> std::pair<iterator, bool>
 {
-    auto bucket{get_bucket(value.first)};
-    auto res{bucket->insert_unique(std::forward<P>(value))};
+    grow_if_needed();
+    auto const [bucket, tag]{locate(value.first)};
+    auto res{bucket->insert_unique(tag, std::forward<P>(value))};
     if (res.second) { ++count_; }
-    return {iterator{bucket, bend(), res.first}, res.second};
+    return {make_iterator<iterator>(bucket, res.first), res.second};
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+template<typename InputIt, typename>
+void HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::insert(InputIt first, InputIt last)
+{
+    if constexpr (std::is_convertible_v<typename std::iterator_traits<InputIt>::iterator_category,
+                                        std::forward_iterator_tag>) {
+        bulk_insert(first, last);
+    }
+    else {
+        safe_fill_buckets(first, last);
+    }
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+template<typename ForwardIt>
+void HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::bulk_insert(ForwardIt first, ForwardIt last)
+{
+    auto const count{static_cast<size_type>(std::distance(first, last))};
+    if (count == 0) { return; }
+    // The elements go straight to their final buckets
+    finish_rehash();
+    if (static_cast<float>(count_ + count) > static_cast<float>(size_) * max_load_factor_) {
+        reserve(count_ + count);
+    }
+
+    // Hash every key once, then order the elements by bucket (counting sort, stable) - the buckets
+    // are visited in order and the nodes of a bucket end up next to each other in the slab
+    struct Entry {
+        ForwardIt element;
+        std::size_t hash;
+    };
+    std::vector<Entry> entries{};
+    entries.reserve(count);
+    std::vector<size_type> offsets(size_ + 1, 0);
+    for (auto it{first}; it != last; ++it) {
+        auto const hash{hash_(it->first)};
+        entries.push_back(Entry{it, hash});
+        ++offsets[range_(hash) + 1];
+    }
+    for (size_type b{1}; b != offsets.size(); ++b) {
+        offsets[b] += offsets[b - 1];
+    }
+    std::vector<Entry> by_bucket(count, entries.front());
+    for (auto const& entry : entries) {
+        by_bucket[offsets[range_(entry.hash)]++] = entry;
+    }
+    entries = std::vector<Entry>{};
+
+    slabs_.reserve(slabs_.size() + 1);
+    NodeAlloc node_alloc{alloc_};
+    slabs_.push_back(NodeSlab{NodeAllocTraits::allocate(node_alloc, count), count, 0});
+    auto& slab{slabs_.back()};
+    try {
+        for (auto const& entry : by_bucket) {
+            auto& bucket{buckets_[range_(entry.hash)]};
+            auto const tag{make_bucket_tag(entry.hash)};
+            if (bucket.find(tag, entry.element->first) != bucket.end()) { continue; }
+            Node* const node{slab.nodes + slab.live};
+            NodeAllocTraits::construct(node_alloc, node, *entry.element);
+            bucket.link_front(tag, node);
+            ++slab.live;
+        }
+    }
+    catch (...) {
+        // The nodes linked so far stay in the map
+        count_ += slab.live;
+        if (slab.live == 0) {
+            NodeAllocTraits::deallocate(node_alloc, slab.nodes, slab.capacity);
+            slabs_.pop_back();
+        }
+        throw;
+    }
+    count_ += slab.live;
+    // Every key was already in the map
+    if (slab.live == 0) {
+        NodeAllocTraits::deallocate(node_alloc, slab.nodes, slab.capacity);
+        slabs_.pop_back();
+    }
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
 template<typename M, typename>
-auto HashMap<Key, T, Hash, Allocator>::insert_or_assign(key_type const& key, M&& value) -> std::pair<iterator, bool>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::insert_or_assign(key_type const& key, M&& value) -> std::pair<iterator, bool>
 {
-    auto bucket{get_bucket(key)};
-    auto res{bucket->insert_or_assign(key, std::forward<M>(value))};
+    grow_if_needed();
+    auto const [bucket, tag]{locate(key)};
+    auto res{bucket->insert_or_assign(tag, key, std::forward<M>(value))};
     if (res.second) { ++count_; }
-    return {iterator{bucket, bend(), res.first}, res.second};
+    return {make_iterator<iterator>(bucket, res.first), res.second};
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
 template<typename M, typename>
-auto HashMap<Key, T, Hash, Allocator>::insert_or_assign(key_type&& key, M&& value) -> std::pair<iterator, bool>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::insert_or_assign(key_type&& key, M&& value) -> std::pair<iterator, bool>
 {
-    auto bucket{get_bucket(key)};
-    auto res{bucket->insert_or_assign(std::move(key), std::forward<M>(value))};
+    grow_if_needed();
+    auto const [bucket, tag]{locate(key)};
+    auto res{bucket->insert_or_assign(tag, std::move(key), std::forward<M>(value))};
     if (res.second) { ++count_; }
-    return {iterator{bucket, bend(), res.first}, res.second};
+    return {make_iterator<iterator>(bucket, res.first), res.second};
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
 template<typename... Args>
-auto HashMap<Key, T, Hash, Allocator>::emplace(Args&&... args) -> std::pair<iterator, bool>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::emplace(Args&&... args) -> std::pair<iterator, bool>
 {
     auto bucket{get_bucket(args...)};
     auto res{bucket->emplace_unique(std::forward<Args>(args)...)};
@@ -394,58 +711,61 @@ auto HashMap<Key, T, Hash, Allocator>::emplace(Args&&... args) -> std::pair<iter
     return {iterator{bucket, bend(), res.first}, res.second};
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
 template<typename... Args, typename>
-auto HashMap<Key, T, Hash, Allocator>::try_emplace(key_type const& key, Args&&... args) -> std::pair<iterator, bool>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::try_emplace(key_type const& key, Args&&... args) -> std::pair<iterator, bool>
 {
-    auto bucket{get_bucket(key)};
-    auto res{bucket->try_emplace(key, std::forward<Args>(args)...)};
+    grow_if_needed();
+    auto const [bucket, tag]{locate(key)};
+    auto res{bucket->try_emplace(tag, key, std::forward<Args>(args)...)};
     if (res.second) { ++count_; }
-    return {iterator{bucket, bend(), res.first}, res.second};
+    return {make_iterator<iterator>(bucket, res.first), res.second};
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
 template<typename... Args, typename>
-auto HashMap<Key, T, Hash, Allocator>::try_emplace(key_type&& key, Args&&... args) -> std::pair<iterator, bool>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::try_emplace(key_type&& key, Args&&... args) -> std::pair<iterator, bool>
 {
-    auto bucket{get_bucket(key)};
-    auto res{bucket->try_emplace(std::move(key), std::forward<Args>(args)...)};
+    grow_if_needed();
+    auto const [bucket, tag]{locate(key)};
+    auto res{bucket->try_emplace(tag, std::move(key), std::forward<Args>(args)...)};
     if (res.second) { ++count_; }
-    return {iterator{bucket, bend(), res.first}, res.second};
+    return {make_iterator<iterator>(bucket, res.first), res.second};
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::erase(const_iterator pos) -> iterator
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::erase(const_iterator pos) -> iterator
 {
-    auto bucket{pos.bucket_};
-    auto const end{pos.end_bucket_};
-    auto res{bucket->erase(pos.node_)};
+    auto res{pos.bucket_->erase(pos.node_, node_release())};
     --count_;
-    return iterator{bucket, end, res};
+    return iterator::following(pos.bucket_, pos.end_bucket_, pos.next_bucket_, pos.next_end_, res);
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::erase(const_iterator first, const_iterator last) -> iterator
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::erase(const_iterator first, const_iterator last) -> iterator
 {
     while (first != last) {
-        erase(first);
-        ++first;
-        --count_;
+        first = erase(first);
     }
-    return iterator{last.bucket_, last.end_bucket_, last.node_};
+    return iterator::following(last.bucket_, last.end_bucket_, last.next_bucket_, last.next_end_,
+                               local_iterator{last.node_});
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::erase(key_type const& key) -> size_type
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::erase(key_type const& key) -> size_type
 {
-    auto bucket{get_bucket(key)};
-    auto erased_count{bucket->erase(key)};
-    count_ -= erased_count;
-    return erased_count;
+    return erase_impl(key);
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::at(Key const& key) -> reference
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+template<typename K, typename H, typename>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::erase(K const& key) -> size_type
+{
+    return erase_impl(key);
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::at(Key const& key) -> reference
 {
     // auto bucket{get_bucket(key)};
     // auto it{std::find_if(bucket->begin(), bucket->end(),
@@ -456,8 +776,8 @@ auto HashMap<Key, T, Hash, Allocator>::at(Key const& key) -> reference
     return at_impl(*this, key);
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::at(Key const& key) const -> const_reference
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::at(Key const& key) const -> const_reference
 {
     // auto bucket{get_bucket(key)};
     // auto it{std::find_if(bucket->begin(), bucket->end(),
@@ -468,131 +788,181 @@ auto HashMap<Key, T, Hash, Allocator>::at(Key const& key) const -> const_referen
     return at_impl(*this, key);
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-template<typename Object>
-auto HashMap<Key, T, Hash, Allocator>::at_impl(Object& self, Key const& key) -> decltype(self.at(key))
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+template<typename K, typename H, typename>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::at(K const& key) -> reference
 {
-    auto bucket{self.get_bucket(key)};
-    auto it{std::find_if(bucket->begin(), bucket->end(),
-        [&key](auto const& e){return e.first == key;})
-    };
+    return at_impl(*this, key);
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+template<typename K, typename H, typename>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::at(K const& key) const -> const_reference
+{
+    return at_impl(*this, key);
+}
+
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+template<typename Object, typename K>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::at_impl(Object& self, K const& key)
+    -> decltype(self.at(std::declval<key_type const&>()))
+{
+    auto const [bucket, tag]{self.locate(key)};
+    auto it{bucket->find(tag, key)};
     if (it != bucket->end()) { return *it; }
     else { throw std::out_of_range{"HashMap: key not found"}; }
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::operator[](Key const& key) -> reference
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::operator[](Key const& key) -> reference
 {
-    auto bucket{get_bucket(key)};
-    auto it{std::find_if(bucket->begin(), bucket->end(),
-        [&key](auto const& e)noexcept{return e.first == key;})
-    };
+    grow_if_needed();
+    auto const [bucket, tag]{locate(key)};
+    auto it{bucket->find(tag, key)};
     if (it != bucket->end()) { return *it; }
     else {
-        bucket->push_front({key, mapped_type{}});
+        bucket->push_front(tag, {key, mapped_type{}});
+        ++count_;
         return *bucket->begin();
     };
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::operator[](Key&& key) -> reference
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+auto HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::operator[](Key&& key) -> reference
 {
-    auto bucket{get_bucket(key)};
-    auto it{std::find_if(bucket->begin(), bucket->end(),
-        [&key](auto const& e)noexcept{return e.first == key;})
-    };
+    grow_if_needed();
+    auto const [bucket, tag]{locate(key)};
+    auto it{bucket->find(tag, key)};
     if (it != bucket->end()) { return *it; }
     else {
-        bucket->emplace_front(std::move(key), mapped_type{});
+        bucket->emplace_front(tag, std::move(key), mapped_type{});
+        ++count_;
         return *bucket->begin();
     };
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::find(Key const& key) noexcept -> iterator
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+float HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::load_factor() const noexcept
 {
-    auto bucket{get_bucket(key)};
-    auto const bucket_it{bucket->find(key)};
-    if (bucket_it != bucket->end()) { return iterator{bucket, bend(), bucket_it}; }
-    else { return end(); }
+    return static_cast<float>(count_) / static_cast<float>(size_);
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::find(Key const& key) const noexcept -> const_iterator
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+float HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::max_load_factor() const noexcept
 {
-    auto bucket{get_bucket(key)};
-    auto const bucket_it{bucket->find(key)};
-    if (bucket_it != bucket->cend()) { return iterator{bucket, bcend(), bucket_it}; }
-    else { return cend(); }
+    return max_load_factor_;
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::equal_range(Key const& key) -> std::pair<iterator, iterator>
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+void HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::max_load_factor(float ml) noexcept
 {
-    auto bucket{get_bucket(key)};
-    auto const bucket_it{bucket->find(key)};
-    if (bucket_it != bucket->end()) {
-        auto range_end = bucket_it;
-        while (range_end != bucket->end() && range_end->first == key) { ++range_end; }
-        return {iterator{bucket, bend(), bucket_it}, iterator{bucket, bend(), range_end}};
-    }
-    else { return {end(), end()}; }
+    max_load_factor_ = ml;
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-auto HashMap<Key, T, Hash, Allocator>::equal_range(Key const& key) const -> std::pair<const_iterator, const_iterator>
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+void HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::rehash(size_type count)
 {
-    auto bucket{get_bucket(key)};
-    auto const bucket_it{bucket->find(key)};
-    if (bucket_it != bucket->cend()) {
-        auto range_end = bucket_it;
-        while (range_end != bucket->end() && range_end->first == key) { ++range_end; }
-        return {iterator{bucket, bcend(), bucket_it}, iterator{bucket, bcend(), range_end}};
+    finish_rehash();
+    count = RangePolicy::bucket_count(count);
+    RangePolicy const new_range{count};
+    Bucket* const new_buckets{make_buckets(count)};
+    // Relink the nodes - no element is copied or moved
+    for (auto b{bbegin()}; b != bend(); ++b) {
+        while (!b->empty()) {
+            auto const hash{hash_(b->begin()->first)};
+            new_buckets[new_range(hash)].splice_front(make_bucket_tag(hash), *b);
+        }
     }
-    else { return {cend(), cend()}; }
+    free();
+    buckets_ = new_buckets;
+    size_ = count;
+    range_ = new_range;
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-float HashMap<Key, T, Hash, Allocator>::load_factor() const noexcept
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+void HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::reserve(size_type count)
 {
-    size_type total{0};
-    for (auto b{bcbegin()}; b != bcend(); ++b) {
-        total += b->size();
-    }
-    return static_cast<float>(total) / static_cast<float>(size_);
+    rehash(static_cast<size_type>(std::ceil(static_cast<float>(count) / max_load_factor())));
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-float HashMap<Key, T, Hash, Allocator>::max_load_factor() const noexcept
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+void HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::grow_if_needed()
 {
-    return max_load_factor_;
+    if constexpr (RehashPolicy::incremental) {
+        if (rehashing()) {
+            rehash_step(pending_.step);
+            // The map keeps growing into the pending array, the load factor is checked again
+            // once it has been populated
+            if (rehashing()) { return; }
+        }
+    }
+    if (JAM_UNLIKELY(static_cast<float>(count_ + 1) > static_cast<float>(size_) * max_load_factor_)) {
+        grow_to(size_ * 2);
+    }
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-void HashMap<Key, T, Hash, Allocator>::max_load_factor(float ml) noexcept
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+void HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::grow_to(size_type count)
 {
-    max_load_factor_ = ml;
+    if constexpr (RehashPolicy::incremental) {
+        count = RangePolicy::bucket_count(count);
+        pending_.buckets = BucketAllocTraits::allocate(alloc_, count);
+        pending_.size = count;
+        pending_.progress = 0;
+        // The inserts until the next growth have to complete the rehash - the new array is built
+        // 2 * step buckets at a time, so a low max load factor takes larger steps
+        pending_.step = std::max(RehashPolicy::buckets_per_step,
+                                 static_cast<size_type>(2.0f / max_load_factor_) + 1);
+        pending_.migrating = false;
+        pending_.range = RangePolicy{count};
+        rehash_step(pending_.step);
+    }
+    else {
+        rehash(count);
+    }
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-void HashMap<Key, T, Hash, Allocator>::rehash(size_type count)
+// Constructs 2 * `buckets` buckets of the pending array or migrates the elements of `buckets` old
+// buckets into the new one
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+void HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::rehash_step(size_type buckets)
 {
-    auto const new_bucket_index = [this, count](key_type const& key) noexcept { return hash_(key) % count; };
-    std::unique_ptr<Bucket> new_buckets{make_buckets(count)};
-    using std::swap;
-    for (auto b{begin()}; b != end(); ++b) {
-        auto const i{new_bucket_index(b->first)};
-        new_buckets.get()[i].push_front(std::move(*b));
+    if (!pending_.migrating) {
+        auto const n{std::min(pending_.size - pending_.progress, 2 * buckets)};
+        for (auto* p{pending_.buckets + pending_.progress}; p != pending_.buckets + pending_.progress + n; ++p) {
+            BucketAllocTraits::construct(alloc_, p);
+        }
+        pending_.progress += n;
+        if (pending_.progress == pending_.size) {
+            // Swap the roles - new elements go to the new array, lookups fall back to the old
+            // one for the buckets not migrated yet
+            pending_ = PendingRehash{std::exchange(buckets_, pending_.buckets),
+                                     std::exchange(size_, pending_.size), 0, pending_.step, true,
+                                     std::exchange(range_, pending_.range)};
+        }
+        return;
+    }
+    auto const last{std::min(pending_.size, pending_.progress + buckets)};
+    for (; pending_.progress != last; ++pending_.progress) {
+        auto* const b{pending_.buckets + pending_.progress};
+        while (!b->empty()) {
+            auto const hash{hash_(b->begin()->first)};
+            buckets_[range_(hash)].splice_front(make_bucket_tag(hash), *b);
+        }
+        BucketAllocTraits::destroy(alloc_, b);
+    }
+    if (pending_.progress == pending_.size) {
+        BucketAllocTraits::deallocate(alloc_, pending_.buckets, pending_.size);
+        pending_ = PendingRehash{};
     }
-    free();
-    buckets_ = new_buckets.release();
-    size_ = count;
 }
 
-template <typename Key, typename T, typename Hash, typename Allocator>
-void HashMap<Key, T, Hash, Allocator>::reserve(size_type count)
+template <typename Key, typename T, typename Hash, typename Allocator, typename RangePolicy, typename RehashPolicy>
+void HashMap<Key, T, Hash, Allocator, RangePolicy, RehashPolicy>::finish_rehash()
 {
-    rehash(std::ceil(count / max_load_factor()));
+    while (rehashing()) {
+        rehash_step(pending_.size);
+    }
 }
 
 template <typename BucketType, typename Reference>
@@ -602,12 +972,17 @@ class HashMapIterator
     using CvValue = std::remove_reference_t<Reference>;
     using BucketIterator = std::conditional_t<
                             std::is_const_v<CvValue>, typename Bucket::const_iterator, typename Bucket::iterator>;
-    template<typename K, typename T, typename H, typename A> friend class HashMap;
+    template<typename K, typename T, typename H, typename A, typename R, typename P> friend class HashMap;
+    template<typename B, typename R> friend class HashMapIterator;
     using Self = HashMapIterator;
 
+    // An incremental rehash splits the map into two bucket ranges, the iterator moves on to
+    // [next_bucket_, next_end_) once it reaches end_bucket_
     Bucket* bucket_;
     Bucket* end_bucket_;
-    BucketIterator node_{bucket_->begin()};
+    Bucket* next_bucket_{nullptr};
+    Bucket* next_end_{nullptr};
+    BucketIterator node_{};
 public:
     using iterator_category = std::forward_iterator_tag;
     using value_type = std::remove_const_t<CvValue>;
@@ -625,24 +1000,38 @@ public:
     explicit HashMapIterator(Bucket* first, Bucket* last) noexcept
         : bucket_{first}, end_bucket_{last}
     {
-        if (node_ == bucket_->end()) {
-            next_node();
-        }
+        next_node();
     }
 
     explicit HashMapIterator(Bucket* first, Bucket* last, BucketIterator node) noexcept
         : bucket_{first}, end_bucket_{last}, node_{node}
     {
-        if (node_ == bucket_->end()) {
-            next_node();
+        if (node_ == BucketIterator{}) {
+            skip_bucket();
+        }
+    }
+
+    explicit HashMapIterator(Bucket* first, Bucket* last, Bucket* next_first, Bucket* next_last,
+                             BucketIterator node = {}) noexcept
+        : bucket_{first}, end_bucket_{last}, next_bucket_{next_first}, next_end_{next_last}, node_{node}
+    {
+        if (node_ == BucketIterator{}) {
+            // No node - either the first node of the range or the one following this bucket
+            if (bucket_ != end_bucket_ && bucket_->begin() != BucketIterator{}) {
+                node_ = bucket_->begin();
+            }
+            else {
+                skip_bucket();
+            }
         }
     }
 
     template<typename R2, typename = std::enable_if_t<std::conjunction_v<
-        std::negation<std::is_const<CvValue>>, std::is_const<std::remove_reference_t<R2>>>>
+        std::is_const<CvValue>, std::negation<std::is_const<std::remove_reference_t<R2>>>>>
     >
     HashMapIterator(HashMapIterator<BucketType, R2> const& other) noexcept
-        : bucket_{other.bucket_}, end_bucket_{other.end_bucket_}, node_{other.node_}
+        : bucket_{other.bucket_}, end_bucket_{other.end_bucket_},
+          next_bucket_{other.next_bucket_}, next_end_{other.next_end_}, node_{other.node_}
     {
     }
 
@@ -657,7 +1046,9 @@ public:
     Self& operator++() noexcept
     {
         ++node_;
-        next_node();
+        if (node_ == BucketIterator{}) {
+            skip_bucket();
+        }
         return *this;
     }
 
@@ -674,11 +1065,43 @@ public:
     friend bool operator!=(HashMapIterator<B1, R1> const& lhs, HashMapIterator<B2, R2> const& rhs) noexcept;
 
 private:
-    void next_node() noexcept
+    // Iterator at `node` of `bucket` - no node, as left by erasing the last node of the bucket,
+    // means the first node after the bucket, never the first one of it
+    static Self following(Bucket* bucket, Bucket* last, Bucket* next_first, Bucket* next_last,
+                          BucketIterator node) noexcept
+    {
+        Self it{last};
+        it.bucket_ = bucket;
+        it.next_bucket_ = next_first;
+        it.next_end_ = next_last;
+        it.node_ = node;
+        if (it.node_ == BucketIterator{}) {
+            it.skip_bucket();
+        }
+        return it;
+    }
+
+    void skip_bucket() noexcept
     {
-        while (node_ == bucket_->end() && bucket_ != end_bucket_) {
+        if (bucket_ != end_bucket_) {
             ++bucket_;
-            node_ = bucket_->begin();
+        }
+        next_node();
+    }
+
+    // First node at or after bucket_ - the end iterator rests on end_bucket_ of the last range
+    // and never dereferences it
+    void next_node() noexcept
+    {
+        for (;;) {
+            for (; bucket_ != end_bucket_; ++bucket_) {
+                node_ = bucket_->begin();
+                if (node_ != BucketIterator{}) { return; }
+            }
+            node_ = BucketIterator{};
+            if (next_bucket_ == nullptr) { return; }
+            bucket_ = std::exchange(next_bucket_, nullptr);
+            end_bucket_ = std::exchange(next_end_, nullptr);
         }
     }
 };
@@ -2,10 +2,12 @@
 #define DATA_STRUCTURES_HASH_MAP_BUCKET_HPP
 
 #include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <tuple>
 #include <type_traits>
 #include <utility>
 
@@ -14,6 +16,25 @@
 #include "utils/Assertion.h"
 #include "utils/traits.h"
 
+#include "ctrl_group.hpp"
+
+namespace hash_map_detail {
+
+// Tag of a node inserted without a hash - matches every lookup
+inline constexpr ctrl_t kUntagged{kDeleted};
+
+}  // namespace hash_map_detail
+
+// 7 bits of the element's hash identifying it within a bucket, computed by the owning HashMap.
+struct BucketTag {
+    hash_map_detail::h2_t value;
+};
+
+constexpr BucketTag make_bucket_tag(std::size_t hash) noexcept
+{
+    return BucketTag{hash_map_detail::h2(hash_map_detail::mix(hash))};
+}
+
 // template<typename Derived>
 struct BucketNodeBase {
     mutable BucketNodeBase* next{nullptr};
@@ -62,6 +83,11 @@ struct BucketNode : public BucketNodeBase
 template<typename NodeType, typename Reference>
 class HashMapBucketIterator;
 
+// Singly linked list of the elements sharing a bucket. Next to the list head the bucket keeps a
+// block of `Group::width` control bytes mirroring the tags of the first nodes of the chain (kEmpty
+// past its end), so that a tagged lookup matches the whole block at once and compares the keys of
+// the matching nodes only. Nodes inserted through the untagged interface are marked kUntagged and
+// are compared by every tagged lookup; chains longer than the block fall back to comparing keys.
 template<typename Key, typename T, typename Allocator = std::allocator<BucketNode<Key, T>>>
 class HashMapBucket {
 public:
@@ -72,9 +98,20 @@ private:
     using Alloc         = typename AllocatorTraits::template rebind_alloc<Node>;
     using AllocTraits   = std::allocator_traits<Alloc>;
     using Self          = HashMapBucket;
+    using Group         = hash_map_detail::Group;
+    using ctrl_t        = hash_map_detail::ctrl_t;
+    using Tags          = std::array<ctrl_t, Group::width>;
+
+    static constexpr Tags make_empty_tags() noexcept
+    {
+        Tags tags{};
+        for (auto& t : tags) { t = hash_map_detail::kEmpty; }
+        return tags;
+    }
 
     Alloc alloc_{};
     NodeBase head_{};
+    Tags tags_{make_empty_tags()};
 public:
     using value_type        = typename Node::value_type;
     using key_type          = typename Node::key_type;
@@ -96,6 +133,7 @@ public:
         if (first != last) {
             auto nodes{make_range(first, last)};
             head_.next = nodes.first;
+            reset_tags();
         }
     }
 
@@ -105,11 +143,14 @@ public:
         if (!other.empty()) {
             auto nodes{make_range(other.cbegin(), other.cend())};
             head_.next = nodes.first;
+            // The copy preserves the order of the nodes
+            tags_ = other.tags_;
         }
     }
 
     HashMapBucket(HashMapBucket&& other) noexcept
-        : alloc_{std::move(other.alloc_)}, head_{std::move(other.head_)} { }
+        : alloc_{std::move(other.alloc_)}, head_{std::move(other.head_)},
+          tags_{std::exchange(other.tags_, make_empty_tags())} { }
 
     // HashMapBucket& operator=(HashMapBucket const&);
 
@@ -119,6 +160,7 @@ public:
             alloc_ = std::move(other.alloc_);
         }
         head_ = std::move(other.head_);
+        tags_ = std::exchange(other.tags_, make_empty_tags());
         return *this;
     }
 
@@ -147,7 +189,23 @@ public:
         return count;
     }
 
-    void clear() noexcept { free(); }
+    void clear() noexcept
+    {
+        free();
+        head_.next = nullptr;
+        tags_ = make_empty_tags();
+    }
+
+    // The overloads taking `release` offer every node they unlink to release(Node*) first - the
+    // bucket destroys and deallocates the node itself only if release returns false. Lets the
+    // owner of the bucket keep nodes it allocated in bulk, see HashMap::insert(first, last).
+    template<typename Release>
+    void clear(Release&& release) noexcept
+    {
+        free(release);
+        head_.next = nullptr;
+        tags_ = make_empty_tags();
+    }
 
     void push_front(value_type const& value)
     {
@@ -161,6 +219,18 @@ public:
         insert_front(nn);
     }
 
+    void push_front(BucketTag tag, value_type const& value)
+    {
+        Node* nn{make_node(value)};
+        insert_front(nn, tag);
+    }
+
+    void push_front(BucketTag tag, value_type&& value)
+    {
+        Node* nn{make_node(std::move(value))};
+        insert_front(nn, tag);
+    }
+
     template<typename P, typename = std::enable_if_t<std::is_convertible_v<P&&, value_type>>>
     std::pair<iterator, bool> insert_unique(P&& value)
     {
@@ -174,6 +244,17 @@ public:
         }
     }
 
+    template<typename P, typename = std::enable_if_t<std::is_convertible_v<P&&, value_type>>>
+    std::pair<iterator, bool> insert_unique(BucketTag tag, P&& value)
+    {
+        auto const pred{find_before(tag, value.first)};
+        if (pred != nullptr) { return {iterator{static_cast<Node*>(pred->next)}, false}; }
+        else {
+            push_front(tag, std::forward<P>(value));
+            return {begin(), true};
+        }
+    }
+
     iterator find(key_type const& key) noexcept
     {
         return std::find_if(begin(), end(), [&key](auto const& v)noexcept { return v.first == key; });
@@ -184,6 +265,21 @@ public:
         return std::find_if(cbegin(), cend(), [&key](auto const& v)noexcept { return v.first == key; });
     }
 
+    // K is key_type or a type comparable to it with operator== (heterogeneous lookup)
+    template<typename K>
+    iterator find(BucketTag tag, K const& key) noexcept
+    {
+        auto const pred{find_before(tag, key)};
+        return pred != nullptr ? iterator{static_cast<Node*>(pred->next)} : end();
+    }
+
+    template<typename K>
+    const_iterator find(BucketTag tag, K const& key) const noexcept
+    {
+        auto const pred{find_before(tag, key)};
+        return pred != nullptr ? const_iterator{static_cast<Node const*>(pred->next)} : cend();
+    }
+
     template<typename K, typename... Args>
     iterator find_iter(K&& key, Args&&... args) const noexcept
     {
@@ -263,6 +359,64 @@ public:
         }
     }
 
+    template<typename M, typename = std::enable_if_t<std::is_convertible_v<M&&, mapped_type>>>
+    std::pair<iterator, bool> insert_or_assign(BucketTag tag, key_type const& key, M&& value)
+    {
+        auto const pred{find_before(tag, key)};
+        if (pred != nullptr) {
+            auto const it{iterator{static_cast<Node*>(pred->next)}};
+            it->second = std::forward<M>(value);
+            return {it, false};
+        }
+        else {
+            emplace_front(tag, key, std::forward<M>(value));
+            return {begin(), true};
+        }
+    }
+
+    template<typename M, typename = std::enable_if_t<std::is_convertible_v<M&&, mapped_type>>>
+    std::pair<iterator, bool> insert_or_assign(BucketTag tag, key_type&& key, M&& value)
+    {
+        auto const pred{find_before(tag, key)};
+        if (pred != nullptr) {
+            auto const it{iterator{static_cast<Node*>(pred->next)}};
+            it->second = std::forward<M>(value);
+            return {it, false};
+        }
+        else {
+            emplace_front(tag, std::move(key), std::forward<M>(value));
+            return {begin(), true};
+        }
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(BucketTag tag, key_type const& key, Args&&... args)
+    {
+        auto const pred{find_before(tag, key)};
+        if (pred != nullptr) {
+            return {iterator{static_cast<Node*>(pred->next)}, false};
+        }
+        else {
+            emplace_front(tag, std::piecewise_construct, std::forward_as_tuple(key),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+            return {begin(), true};
+        }
+    }
+
+    template<typename... Args>
+    std::pair<iterator, bool> try_emplace(BucketTag tag, key_type&& key, Args&&... args)
+    {
+        auto const pred{find_before(tag, key)};
+        if (pred != nullptr) {
+            return {iterator{static_cast<Node*>(pred->next)}, false};
+        }
+        else {
+            emplace_front(tag, std::piecewise_construct, std::forward_as_tuple(std::move(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+            return {begin(), true};
+        }
+    }
+
     template<typename... Args>
     void emplace_front(Args&&... args)
     {
@@ -270,6 +424,13 @@ public:
         insert_front(nn);
     }
 
+    template<typename... Args>
+    void emplace_front(BucketTag tag, Args&&... args)
+    {
+        Node* nn{make_node(std::forward<Args>(args)...)};
+        insert_front(nn, tag);
+    }
+
     iterator insert_after(const_iterator pos, value_type const& value)
     {
         Node* nn{make_node(value)};
@@ -314,6 +475,22 @@ public:
         return count;
     }
 
+    // Keys inserted through the tagged interface are unique within the bucket
+    template<typename K>
+    size_type erase(BucketTag tag, K const& key) noexcept
+    {
+        return erase(tag, key, [](Node*) noexcept { return false; });
+    }
+
+    template<typename K, typename Release>
+    size_type erase(BucketTag tag, K const& key, Release&& release) noexcept
+    {
+        auto const pred{find_before(tag, key)};
+        if (pred == nullptr) { return 0; }
+        erase_after(pred, release);
+        return 1;
+    }
+
     iterator erase_after(const_iterator pos) noexcept
     {
         erase_after(pos->node_);
@@ -321,6 +498,12 @@ public:
     }
 
     iterator erase(const_iterator pos) noexcept
+    {
+        return erase(pos, [](Node*) noexcept { return false; });
+    }
+
+    template<typename Release>
+    iterator erase(const_iterator pos, Release&& release) noexcept
     {
         auto pred{before_begin()};
         auto it{begin()};
@@ -329,10 +512,28 @@ public:
             ++it;
         }
         JAM_ENSURE(it == pos, "Invalid erase position");
-        erase_after(pred.node_);
+        erase_after(pred.node_, release);
         return iterator{++pred};
     }
 
+    // Links a node constructed by the owner of the bucket - released through the `release`
+    // overloads of erase and clear
+    void link_front(BucketTag tag, Node* node) noexcept
+    {
+        insert_front(node, tag);
+    }
+
+    // Moves the first node of `other` to the front of this bucket - the node is relinked, not
+    // reallocated, so the allocators of both buckets must compare equal
+    void splice_front(BucketTag tag, Self& other) noexcept
+    {
+        JAM_EXPECT(!other.empty(), "Splice from an empty bucket");
+        NodeBase* node{other.head_.next};
+        other.head_.next = node->next;
+        other.erase_tag(0, &other.head_);
+        insert_front(node, tag);
+    }
+
 protected:
     template<typename... Args>
     Node* make_node(Args&&... args)
@@ -370,25 +571,103 @@ protected:
         return {front, nn};
     }
 
+    void insert_front(NodeBase* node, BucketTag tag) noexcept
+    {
+        node->next = head_.next;
+        head_.next = node;
+        insert_tag(0, static_cast<ctrl_t>(tag.value));
+    }
+
     void insert_front(NodeBase* node) noexcept
     {
         node->next = head_.next;
         head_.next = node;
+        insert_tag(0, hash_map_detail::kUntagged);
     }
 
-    static iterator insert_after(const NodeBase* pos, NodeBase* node) noexcept
+    iterator insert_after(const NodeBase* pos, NodeBase* node) noexcept
     {
+        insert_tag(index_after(pos), hash_map_detail::kUntagged);
         node->next = pos->next;
         pos->next = node;
         return iterator{static_cast<Node*>(node)};
     }
 
     void erase_after(NodeBase* node) noexcept
+    {
+        erase_after(node, [](Node*) noexcept { return false; });
+    }
+
+    template<typename Release>
+    void erase_after(NodeBase* node, Release&& release) noexcept
     {
         JAM_EXPECT(node != nullptr, "nullptr node");
+        auto const index{index_after(node)};
         Node* to_free{static_cast<Node*>(node->next)};
         node->next = to_free->next;
-        free(to_free);
+        if (!release(to_free)) { free(to_free); }
+        erase_tag(index, node);
+    }
+
+    // Node preceding the one holding `key`, nullptr if the key is not in the bucket
+    template<typename K>
+    NodeBase* find_before(BucketTag tag, K const& key) const noexcept
+    {
+        Group const group{tags_.data()};
+        auto const candidates{group.match(tag.value) |
+                              group.match(static_cast<hash_map_detail::h2_t>(hash_map_detail::kUntagged))};
+        NodeBase* pred{const_cast<NodeBase*>(&head_)};
+        size_type index{0};
+        for (auto const i : candidates) {
+            for (; index != static_cast<size_type>(i); ++index) { pred = pred->next; }
+            if (static_cast<Node*>(pred->next)->data.first == key) { return pred; }
+        }
+        if (JAM_LIKELY(group.match_empty())) { return nullptr; }
+        // The chain is longer than the tags block - compare the remaining keys one by one
+        for (; index != tags_.size(); ++index) { pred = pred->next; }
+        for (; pred->next != nullptr; pred = pred->next) {
+            if (static_cast<Node*>(pred->next)->data.first == key) { return pred; }
+        }
+        return nullptr;
+    }
+
+    // Position in the chain of the node following `pos`, saturated at the size of the tags block
+    size_type index_after(NodeBase const* pos) const noexcept
+    {
+        size_type index{0};
+        for (NodeBase const* n{&head_}; n != pos && index != tags_.size(); n = n->next) { ++index; }
+        return index;
+    }
+
+    void insert_tag(size_type index, ctrl_t tag) noexcept
+    {
+        if (index < tags_.size()) {
+            std::copy_backward(tags_.begin() + index, tags_.end() - 1, tags_.end());
+            tags_[index] = tag;
+        }
+    }
+
+    // The node at `index` has been unlinked, `pred` is the node now preceding that position
+    void erase_tag(size_type index, NodeBase const* pred) noexcept
+    {
+        if (index >= tags_.size()) { return; }
+        bool const block_full{tags_.back() != hash_map_detail::kEmpty};
+        std::copy(tags_.begin() + index + 1, tags_.end(), tags_.begin() + index);
+        tags_.back() = hash_map_detail::kEmpty;
+        if (block_full) {
+            // A node past the block moves into its last position, its tag is not known
+            for (auto i{index}; pred != nullptr && i != tags_.size(); ++i) { pred = pred->next; }
+            if (pred != nullptr) { tags_.back() = hash_map_detail::kUntagged; }
+        }
+    }
+
+    void reset_tags() noexcept
+    {
+        tags_ = make_empty_tags();
+        size_type index{0};
+        for (NodeBase const* n{head_.next}; n != nullptr && index != tags_.size(); n = n->next) {
+            tags_[index++] = hash_map_detail::kUntagged;
+        }
     }
 
     void free(Node* node) noexcept
@@ -406,6 +685,17 @@ protected:
             free(temp);
         }
     }
+
+    template<typename Release>
+    void free(Release&& release) noexcept
+    {
+        Node* node{static_cast<Node*>(head_.next)};
+        while (node != nullptr) {
+            Node* temp{node};
+            node = static_cast<Node*>(node->next);
+            if (!release(temp)) { free(temp); }
+        }
+    }
 };
 
 
@@ -0,0 +1,122 @@
+#ifndef DATA_STRUCTURES_RANGE_POLICY_HPP
+#define DATA_STRUCTURES_RANGE_POLICY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <utility>
+
+#include "ctrl_group.hpp"
+
+// Range reduction policies of HashMap - map a hash onto a bucket index in [0, bucket_count).
+// A policy decides which bucket counts it supports:
+//
+//   static size_type bucket_count(size_type requested)   - bucket count used for a request
+//   explicit Policy(size_type bucket_count)               - bucket count already normalized
+//   size_type operator()(std::size_t hash) const          - index of the bucket
+//
+// ModuloRange      - any bucket count, one division per lookup (the default)
+// PowerOfTwoRange  - power of two bucket counts, multiplicative (Fibonacci) hashing: the hash is
+//                    multiplied by 2^64 / phi and the top bits select the bucket, so weak hashes
+//                    (std::hash of integers is the identity) still spread over the buckets
+// FastRange        - any bucket count, Lemire's multiply-shift reduction; the top bits of the
+//                    hash select the bucket, pair it with MixingHash for identity hashes
+
+class ModuloRange {
+    std::size_t bucket_count_;
+public:
+    static constexpr std::size_t bucket_count(std::size_t requested) noexcept
+    {
+        return std::max(requested, std::size_t{1});
+    }
+
+    explicit constexpr ModuloRange(std::size_t bucket_count) noexcept : bucket_count_{bucket_count} { }
+
+    constexpr std::size_t operator()(std::size_t hash) const noexcept { return hash % bucket_count_; }
+};
+
+class PowerOfTwoRange {
+    static constexpr int Hash_Bits{static_cast<int>(sizeof(std::size_t) * 8)};
+
+    int shift_;
+public:
+    // At least two buckets - the shift of a single bucket would be the whole width of the hash
+    static constexpr std::size_t bucket_count(std::size_t requested) noexcept
+    {
+        std::size_t count{2};
+        while (count < requested) { count <<= 1; }
+        return count;
+    }
+
+    explicit constexpr PowerOfTwoRange(std::size_t bucket_count) noexcept
+        : shift_{Hash_Bits - log2(bucket_count)}
+    {
+    }
+
+    constexpr std::size_t operator()(std::size_t hash) const noexcept
+    {
+        if constexpr (sizeof(std::size_t) == 8) {
+            return static_cast<std::size_t>(hash * 0x9e3779b97f4a7c15ULL) >> shift_;
+        }
+        else {
+            return static_cast<std::size_t>(hash * 0x9e3779b9U) >> shift_;
+        }
+    }
+
+private:
+    static constexpr int log2(std::size_t power_of_two) noexcept
+    {
+        int bits{0};
+        while (power_of_two > 1) {
+            power_of_two >>= 1;
+            ++bits;
+        }
+        return bits;
+    }
+};
+
+class FastRange {
+    std::size_t bucket_count_;
+public:
+    static constexpr std::size_t bucket_count(std::size_t requested) noexcept
+    {
+        return std::max(requested, std::size_t{1});
+    }
+
+    explicit constexpr FastRange(std::size_t bucket_count) noexcept : bucket_count_{bucket_count} { }
+
+    // The high half of hash * bucket_count - the hash is treated as a fraction of 2^64
+    constexpr std::size_t operator()(std::size_t hash) const noexcept
+    {
+#if defined(__SIZEOF_INT128__)
+        if constexpr (sizeof(std::size_t) == 8) {
+            __extension__ using uint128_t = unsigned __int128;
+            return static_cast<std::size_t>((uint128_t{hash} * bucket_count_) >> 64);
+        }
+        else
+#endif
+        if constexpr (sizeof(std::size_t) == 4) {
+            return static_cast<std::size_t>((std::uint64_t{hash} * bucket_count_) >> 32);
+        }
+        else {
+            return hash % bucket_count_;
+        }
+    }
+};
+
+// Applies a mixing step to the result of another hasher - for hashers with weak high bits (the
+// identity std::hash of the integral types) combined with FastRange.
+template<typename Key, typename Hash = std::hash<Key>>
+class MixingHash : private Hash {
+public:
+    MixingHash() = default;
+    explicit MixingHash(Hash const& hash) : Hash{hash} { }
+
+    std::size_t operator()(Key const& key) const noexcept(noexcept(std::declval<Hash const&>()(key)))
+    {
+        return hash_map_detail::mix(Hash::operator()(key));
+    }
+};
+
+#endif  // DATA_STRUCTURES_RANGE_POLICY_HPP
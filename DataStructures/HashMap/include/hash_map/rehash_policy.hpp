@@ -0,0 +1,34 @@
+#ifndef DATA_STRUCTURES_REHASH_POLICY_HPP
+#define DATA_STRUCTURES_REHASH_POLICY_HPP
+
+#include <cstddef>
+
+// Rehash policies of HashMap - decide how the elements move to a larger bucket array once an
+// insert would exceed max_load_factor:
+//
+//   static constexpr bool incremental                 - the old and the new array may coexist
+//   static constexpr std::size_t buckets_per_step     - minimum old buckets migrated by an insert
+//
+// ImmediateRehash       - the insert crossing the load factor moves every element (the default)
+// IncrementalRehash<N>  - the insert crossing the load factor only allocates the new array; every
+//                         following insert constructs 2 * N of its buckets and then moves the
+//                         elements of N old buckets, until the old array is empty - N is raised
+//                         when a low max_load_factor leaves too few inserts until the next
+//                         growth to complete the rehash at that pace. Lookups check
+//                         the old array for buckets not yet migrated, so the latency of a single
+//                         insert stays bounded while the map grows.
+
+struct ImmediateRehash {
+    static constexpr bool incremental{false};
+    static constexpr std::size_t buckets_per_step{0};
+};
+
+template<std::size_t BucketsPerStep = 8>
+struct IncrementalRehash {
+    static_assert(BucketsPerStep > 0, "An incremental rehash has to make progress");
+
+    static constexpr bool incremental{true};
+    static constexpr std::size_t buckets_per_step{BucketsPerStep};
+};
+
+#endif  // DATA_STRUCTURES_REHASH_POLICY_HPP
@@ -0,0 +1,20 @@
+#ifndef DATA_STRUCTURES_STRING_HASH_HPP
+#define DATA_STRUCTURES_STRING_HASH_HPP
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+// Transparent hash of std::string keys - std::string, std::string_view and string literals hash
+// alike, so HashMap<std::string, T, StringHash> is searched by any of them without building a
+// std::string:
+//
+//   HashMap<std::string, int, StringHash> map{};
+//   map.find(std::string_view{"key"});
+struct StringHash {
+    using is_transparent = void;
+
+    std::size_t operator()(std::string_view str) const noexcept { return std::hash<std::string_view>{}(str); }
+};
+
+#endif  // DATA_STRUCTURES_STRING_HASH_HPP
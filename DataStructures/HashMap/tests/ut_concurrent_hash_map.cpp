@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <hash_map/concurrent_hash_map.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+TEST(ConcurrentHashMapTest, shard_count_is_rounded_up_to_a_power_of_two)
+{
+    ConcurrentHashMap<int, int> sut{5};
+    ASSERT_EQ(sut.shard_count(), 8u);
+    ASSERT_TRUE(sut.empty());
+    ASSERT_GE((ConcurrentHashMap<int, int>{}.shard_count()), 1u);
+}
+
+TEST(ConcurrentHashMapTest, find_returns_a_copy_of_the_mapped_value)
+{
+    ConcurrentHashMap<int, std::string> sut{4};
+    ASSERT_TRUE(sut.insert_or_assign(1, "one"));
+    ASSERT_EQ(sut.find(1), std::optional<std::string>{"one"});
+    ASSERT_EQ(sut.find(2), std::nullopt);
+    ASSERT_TRUE(sut.contains(1));
+    ASSERT_FALSE(sut.contains(2));
+}
+
+TEST(ConcurrentHashMapTest, insert_or_assign_and_try_emplace_report_insertion)
+{
+    ConcurrentHashMap<int, std::string> sut{4};
+    ASSERT_TRUE(sut.try_emplace(1, 3u, 'a'));
+    ASSERT_FALSE(sut.try_emplace(1, "b"));
+    ASSERT_EQ(sut.find(1), std::optional<std::string>{"aaa"});
+    ASSERT_FALSE(sut.insert_or_assign(1, "c"));
+    ASSERT_EQ(sut.find(1), std::optional<std::string>{"c"});
+    ASSERT_EQ(sut.size(), 1u);
+}
+
+TEST(ConcurrentHashMapTest, visit_runs_the_callback_for_existing_keys_only)
+{
+    ConcurrentHashMap<int, int> sut{4};
+    sut.insert_or_assign(7, 70);
+    int seen{0};
+    ASSERT_TRUE(sut.visit(7, [&seen](auto const& e) { seen = e.second; }));
+    ASSERT_EQ(seen, 70);
+    ASSERT_FALSE(sut.visit(8, [&seen](auto const&) { seen = -1; }));
+    ASSERT_EQ(seen, 70);
+}
+
+TEST(ConcurrentHashMapTest, erase_and_erase_if_remove_matching_elements)
+{
+    ConcurrentHashMap<int, int> sut{8};
+    for (int i{0}; i != 1000; ++i) {
+        sut.insert_or_assign(i, i * 2);
+    }
+    ASSERT_EQ(sut.erase(0), 1u);
+    ASSERT_EQ(sut.erase(0), 0u);
+    ASSERT_EQ(sut.erase_if([](auto const& e) { return e.first % 2 == 1; }), 500u);
+    ASSERT_EQ(sut.size(), 499u);
+    for (int i{1}; i != 1000; ++i) {
+        ASSERT_EQ(sut.contains(i), i % 2 == 0) << "key: " << i;
+    }
+    sut.clear();
+    ASSERT_TRUE(sut.empty());
+}
+
+TEST(ConcurrentHashMapTest, erase_if_visits_colliding_elements_exactly_once)
+{
+    // Every key lands in the same bucket of the same shard, the predicate holds for both ends of
+    // the chain
+    struct CollidingHash {
+        std::size_t operator()(int) const noexcept { return 0; }
+    };
+    constexpr int element_count{16};
+    ConcurrentHashMap<int, int, CollidingHash> sut{4};
+    for (int i{0}; i != element_count; ++i) {
+        sut.insert_or_assign(i, i);
+    }
+    std::vector<int> calls(element_count, 0);
+    auto const erased{sut.erase_if([&calls](auto const& e) {
+        ++calls[static_cast<std::size_t>(e.first)];
+        return e.first % 3 != 1;
+    })};
+    ASSERT_EQ(erased, static_cast<std::size_t>(element_count - element_count / 3));
+    for (int i{0}; i != element_count; ++i) {
+        ASSERT_EQ(calls[static_cast<std::size_t>(i)], 1) << "key: " << i;
+        ASSERT_EQ(sut.contains(i), i % 3 == 1) << "key: " << i;
+    }
+}
+
+TEST(ConcurrentHashMapConcurrencyTest, concurrent_writers_of_disjoint_keys_lose_no_element)
+{
+    constexpr int thread_count{8};
+    constexpr int per_thread{5000};
+    ConcurrentHashMap<int, int> sut{16};
+    std::vector<std::thread> threads{};
+    for (int t{0}; t != thread_count; ++t) {
+        threads.emplace_back([&sut, t] {
+            for (int i{0}; i != per_thread; ++i) {
+                auto const key{t * per_thread + i};
+                sut.try_emplace(key, -key);
+            }
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+    ASSERT_EQ(sut.size(), static_cast<std::size_t>(thread_count * per_thread));
+    for (int key{0}; key != thread_count * per_thread; ++key) {
+        ASSERT_EQ(sut.find(key), std::optional<int>{-key});
+    }
+}
+
+TEST(ConcurrentHashMapConcurrencyTest, readers_observe_consistent_values_while_writers_update)
+{
+    // Every value written is a multiple of its key - a torn or stale read of a node breaks it
+    constexpr int key_count{512};
+    ConcurrentHashMap<int, long> sut{8};
+    for (int key{1}; key <= key_count; ++key) {
+        sut.insert_or_assign(key, long{key});
+    }
+    std::atomic<bool> done{false};
+    std::atomic<int> bad_reads{0};
+    std::vector<std::thread> threads{};
+    for (int t{0}; t != 4; ++t) {
+        threads.emplace_back([&] {
+            while (!done.load(std::memory_order_relaxed)) {
+                for (int key{1}; key <= key_count; ++key) {
+                    auto const value{sut.find(key)};
+                    if (!value || *value % key != 0) { bad_reads.fetch_add(1); }
+                }
+            }
+        });
+    }
+    for (int t{0}; t != 2; ++t) {
+        threads.emplace_back([&sut, t] {
+            for (long round{1}; round != 50; ++round) {
+                for (int key{1}; key <= key_count; ++key) {
+                    sut.insert_or_assign(key, key * (round + t));
+                    // Growing and shrinking shards while the readers run
+                    sut.insert_or_assign(key_count + key * (t + 1) + static_cast<int>(round) * 4096, 0L);
+                }
+                sut.erase_if([](auto const& e) { return e.first > key_count; });
+            }
+        });
+    }
+    threads[4].join();
+    threads[5].join();
+    done = true;
+    for (int t{0}; t != 4; ++t) { threads[static_cast<std::size_t>(t)].join(); }
+    ASSERT_EQ(bad_reads.load(), 0);
+    ASSERT_EQ(sut.size(), static_cast<std::size_t>(key_count));
+}
+
+}  // namespace
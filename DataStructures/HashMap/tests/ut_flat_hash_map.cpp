@@ -0,0 +1,311 @@
+#include <gtest/gtest.h>
+
+#include <hash_map/flat_hash_map.hpp>
+
+#include <array>
+#include <algorithm>
+#include <string>
+#include <utility>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+
+constexpr auto same_element = [](auto const& lhs, auto const& rhs) noexcept {
+    return lhs.first == rhs.first && lhs.second == rhs.second;
+};
+
+TEST(FlatHashMapTest, constructor)
+{
+    FlatHashMap<int, double> sut{};
+    ASSERT_TRUE(sut.empty());
+    ASSERT_EQ(sut.begin(), sut.end());
+    ASSERT_EQ(sut.find(1), sut.end());
+}
+
+TEST(FlatHashMapTest, constructor_custom_bucket_count)
+{
+    FlatHashMap<int, double> sut{100};
+    ASSERT_TRUE(sut.empty());
+    ASSERT_GE(sut.bucket_count(), 100);
+}
+
+TEST(FlatHashMapTest, constructor_from_range)
+{
+    constexpr std::array<std::pair<int, double>, 5> init{{{2, 2.2}, {3, 3.3}, {1, 1.1}, {5, 5.5}, {4, 4.4}}};
+    FlatHashMap<int, double> sut{init.cbegin(), init.cend()};
+    ASSERT_EQ(init.size(), sut.size());
+    ASSERT_TRUE(std::is_permutation(init.cbegin(), init.cend(), sut.cbegin(), sut.cend(), same_element));
+}
+
+class FlatHashMapCopyMoveTests : public ::testing::Test {
+public:
+    static constexpr std::array<std::pair<int, double>, 5> init{{{2, 2.2}, {3, 3.3}, {1, 1.1}, {5, 5.5}, {4, 4.4}}};
+
+protected:
+    FlatHashMap<int, double> sut{init.cbegin(), init.cend()};
+};
+
+TEST_F(FlatHashMapCopyMoveTests, copy_constructor)
+{
+    FlatHashMap<int, double> sut_copy{sut};
+    ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), sut_copy.cbegin(), sut_copy.cend()));
+}
+
+TEST_F(FlatHashMapCopyMoveTests, move_constructor)
+{
+    FlatHashMap<int, double> sut_copy{sut};
+    FlatHashMap<int, double> sut_moved{std::move(sut_copy)};
+    ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), sut_moved.cbegin(), sut_moved.cend()));
+    ASSERT_TRUE(sut_copy.empty());
+    ASSERT_EQ(sut_copy.find(init[0].first), sut_copy.end());
+}
+
+TEST_F(FlatHashMapCopyMoveTests, copy_assignment)
+{
+    static constexpr std::array<std::pair<int, double>, 2> vals{{{9, 9.9}, {11, 11.11}}};
+    FlatHashMap<int, double> assigned{vals.cbegin(), vals.cend()};
+    assigned = sut;
+    ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), assigned.cbegin(), assigned.cend()));
+}
+
+TEST_F(FlatHashMapCopyMoveTests, move_assignment)
+{
+    static constexpr std::array<std::pair<int, double>, 2> vals{{{9, 9.9}, {11, 11.11}}};
+    FlatHashMap<int, double> assigned{vals.cbegin(), vals.cend()};
+    FlatHashMap<int, double> sut_copy{sut};
+    assigned = std::move(sut_copy);
+    ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), assigned.cbegin(), assigned.cend()));
+    ASSERT_TRUE(sut_copy.empty());
+}
+
+TEST_F(FlatHashMapCopyMoveTests, swap_exchanges_contents)
+{
+    FlatHashMap<int, double> other{};
+    other.swap(sut);
+    ASSERT_TRUE(sut.empty());
+    ASSERT_TRUE(std::is_permutation(init.cbegin(), init.cend(), other.cbegin(), other.cend(), same_element));
+}
+
+class FlatHashMapInsertingTests : public ::testing::Test {
+public:
+    static constexpr std::array<std::pair<int, double>, 5> init{{{2, 2.2}, {3, 3.3}, {1, 1.1}, {5, 5.5}, {4, 4.4}}};
+
+protected:
+    FlatHashMap<int, double> sut{init.cbegin(), init.cend()};
+
+    FlatHashMapInsertingTests()
+    {
+        EXPECT_EQ(sut.size(), init.size());
+    }
+};
+
+TEST_F(FlatHashMapInsertingTests, insert_is_noop_if_key_already_exists)
+{
+    auto const existing_element{init[0]};
+    auto res = sut.insert(existing_element);
+    ASSERT_FALSE(res.second);
+    ASSERT_EQ(res.first->first, existing_element.first);
+    ASSERT_EQ(res.first->second, existing_element.second);
+    ASSERT_EQ(sut.size(), init.size());
+}
+
+TEST_F(FlatHashMapInsertingTests, insert_adds_element_if_doesnt_exist)
+{
+    std::pair<const int, double> const new_element{42, 42.42};
+    auto res = sut.insert(new_element);
+    ASSERT_TRUE(res.second);
+    ASSERT_EQ(res.first->first, new_element.first);
+    ASSERT_EQ(res.first->second, new_element.second);
+    ASSERT_EQ(sut.size(), init.size() + 1);
+}
+
+TEST_F(FlatHashMapInsertingTests, insert_or_assign_assigns_value_if_element_exists)
+{
+    auto res = sut.insert_or_assign(init[0].first, 42.42);
+    ASSERT_FALSE(res.second);
+    ASSERT_EQ(res.first->first, init[0].first);
+    ASSERT_EQ(res.first->second, 42.42);
+}
+
+TEST_F(FlatHashMapInsertingTests, insert_or_assign_adds_element_if_doesnt_exist)
+{
+    auto res = sut.insert_or_assign(42, 42.42);
+    ASSERT_TRUE(res.second);
+    ASSERT_EQ(res.first->first, 42);
+    ASSERT_EQ(res.first->second, 42.42);
+}
+
+TEST_F(FlatHashMapInsertingTests, try_emplace_is_noop_if_element_exists)
+{
+    auto res = sut.try_emplace(init[0].first, 42.42);
+    ASSERT_FALSE(res.second);
+    ASSERT_EQ(res.first->second, init[0].second);
+}
+
+TEST_F(FlatHashMapInsertingTests, emplace_constructs_element_in_place)
+{
+    auto res = sut.emplace(42, 42.42);
+    ASSERT_TRUE(res.second);
+    ASSERT_EQ(res.first->first, 42);
+    res = sut.emplace(42, 1.0);
+    ASSERT_FALSE(res.second);
+    ASSERT_EQ(res.first->second, 42.42);
+}
+
+TEST_F(FlatHashMapInsertingTests, insert_grows_the_table_and_keeps_elements)
+{
+    std::unordered_map<int, double> reference(init.cbegin(), init.cend());
+    for (int i{100}; i != 10'000; ++i) {
+        sut.insert({i, i * 0.5});
+        reference.insert({i, i * 0.5});
+    }
+    ASSERT_EQ(sut.size(), reference.size());
+    ASSERT_LE(sut.load_factor(), sut.max_load_factor());
+    ASSERT_EQ(static_cast<std::size_t>(std::distance(sut.cbegin(), sut.cend())), reference.size());
+    for (auto const& e : sut) {
+        ASSERT_EQ(reference.at(e.first), e.second);
+    }
+    for (auto const& e : reference) {
+        ASSERT_EQ(sut.at(e.first).second, e.second);
+    }
+}
+
+class FlatHashMapLookupTests : public ::testing::Test {
+public:
+    static constexpr std::array<std::pair<int, double>, 5> init{{{2, 2.2}, {3, 3.3}, {1, 1.1}, {5, 5.5}, {4, 4.4}}};
+
+protected:
+    FlatHashMap<int, double> sut{init.cbegin(), init.cend()};
+};
+
+TEST_F(FlatHashMapLookupTests, at_throws_if_key_doesnt_exist)
+{
+    ASSERT_THROW(sut.at(42), std::out_of_range);
+    auto const& csut{sut};
+    ASSERT_THROW(csut.at(42), std::out_of_range);
+}
+
+TEST_F(FlatHashMapLookupTests, index_operator_inserts_value_initialized_element)
+{
+    ASSERT_EQ(sut[init[0].first].second, init[0].second);
+    ASSERT_EQ(sut[42].second, double{});
+    ASSERT_EQ(sut.size(), init.size() + 1);
+}
+
+TEST_F(FlatHashMapLookupTests, find_count_contains)
+{
+    for (auto const& e : init) {
+        auto it = sut.find(e.first);
+        ASSERT_NE(it, sut.end());
+        ASSERT_EQ(it->second, e.second);
+        ASSERT_EQ(sut.count(e.first), 1);
+        ASSERT_TRUE(sut.contains(e.first));
+    }
+    ASSERT_EQ(sut.find(42), sut.end());
+    ASSERT_EQ(sut.count(42), 0);
+    ASSERT_FALSE(sut.contains(42));
+}
+
+TEST_F(FlatHashMapLookupTests, equal_range_returns_single_element_range)
+{
+    auto res = sut.equal_range(init[0].first);
+    ASSERT_EQ(std::distance(res.first, res.second), 1);
+    ASSERT_EQ(res.first->first, init[0].first);
+    auto missing = sut.equal_range(42);
+    ASSERT_EQ(missing.first, missing.second);
+}
+
+TEST_F(FlatHashMapLookupTests, bucket_interface_covers_all_elements)
+{
+    std::size_t total{0};
+    for (std::size_t n{0}; n != sut.bucket_count(); ++n) {
+        ASSERT_LE(sut.bucket_size(n), 1);
+        total += static_cast<std::size_t>(std::distance(sut.begin(n), sut.end(n)));
+    }
+    ASSERT_EQ(total, sut.size());
+    auto const b{sut.bucket(init[0].first)};
+    ASSERT_EQ(sut.begin(b)->first, init[0].first);
+}
+
+class FlatHashMapModifyingTests : public ::testing::Test {
+public:
+    static constexpr std::array<std::pair<int, double>, 5> init{{{2, 2.2}, {3, 3.3}, {1, 1.1}, {5, 5.5}, {4, 4.4}}};
+
+protected:
+    FlatHashMap<int, double> sut{init.cbegin(), init.cend()};
+};
+
+TEST_F(FlatHashMapModifyingTests, erase_removes_element_with_equal_key)
+{
+    ASSERT_EQ(sut.erase(init[0].first), 1);
+    ASSERT_EQ(sut.erase(init[0].first), 0);
+    ASSERT_EQ(sut.size(), init.size() - 1);
+    ASSERT_TRUE(std::is_permutation(init.cbegin() + 1, init.cend(), sut.cbegin(), sut.cend(), same_element));
+}
+
+TEST_F(FlatHashMapModifyingTests, erase_at_position_returns_next_element)
+{
+    auto it = sut.find(init[2].first);
+    auto const expected_next{std::next(it)};
+    auto res = sut.erase(it);
+    ASSERT_EQ(res, expected_next);
+    ASSERT_EQ(sut.size(), init.size() - 1);
+    ASSERT_FALSE(sut.contains(init[2].first));
+}
+
+TEST_F(FlatHashMapModifyingTests, erase_range_removes_all_elements)
+{
+    auto res = sut.erase(sut.cbegin(), sut.cend());
+    ASSERT_EQ(res, sut.end());
+    ASSERT_TRUE(sut.empty());
+    ASSERT_EQ(sut.begin(), sut.end());
+}
+
+TEST_F(FlatHashMapModifyingTests, clear_keeps_the_table_usable)
+{
+    sut.clear();
+    ASSERT_TRUE(sut.empty());
+    ASSERT_EQ(sut.begin(), sut.end());
+    sut.insert({42, 42.42});
+    ASSERT_EQ(sut.size(), 1);
+    ASSERT_EQ(sut.at(42).second, 42.42);
+}
+
+TEST_F(FlatHashMapModifyingTests, rehash_changes_capacity_and_load_factor_keeps_elements)
+{
+    auto const init_load_factor{sut.load_factor()};
+    sut.rehash(97);
+    ASSERT_GE(sut.bucket_count(), 97);
+    ASSERT_LT(sut.load_factor(), init_load_factor);
+    ASSERT_TRUE(std::is_permutation(sut.cbegin(), sut.cend(), init.cbegin(), init.cend(), same_element));
+}
+
+TEST(FlatHashMapChurnTest, repeated_insert_erase_matches_reference)
+{
+    // Exercises tombstone reuse and the in-place cleanup of tombstones
+    FlatHashMap<std::string, int> sut{};
+    std::unordered_map<std::string, int> reference{};
+    for (int round{0}; round != 20; ++round) {
+        for (int i{0}; i != 500; ++i) {
+            auto key{std::to_string(round * 250 + i)};
+            sut.insert_or_assign(key, i);
+            reference.insert_or_assign(key, i);
+        }
+        for (int i{0}; i != 500; i += 2) {
+            auto key{std::to_string(round * 250 + i)};
+            ASSERT_EQ(sut.erase(key), reference.erase(key));
+        }
+        ASSERT_EQ(sut.size(), reference.size());
+    }
+    ASSERT_EQ(static_cast<std::size_t>(std::distance(sut.cbegin(), sut.cend())), reference.size());
+    for (auto const& e : sut) {
+        ASSERT_EQ(reference.at(e.first), e.second);
+    }
+    for (auto const& e : reference) {
+        ASSERT_EQ(sut.at(e.first).second, e.second);
+    }
+}
+
+} // namespace
@@ -1,12 +1,18 @@
 #include <gtest/gtest.h>
 
 #include <hash_map/hash_map.hpp>
+#include <hash_map/string_hash.hpp>
+#include <utils/node_pool.h>
 
 #include <array>
 #include <algorithm>
 #include <utility>
 #include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <vector>
 
 namespace
 {
@@ -229,6 +235,39 @@ TEST_F(HashMapLookupTests, find_returns_end_iterator_if_key_doesnt_exist)
     ASSERT_EQ(res, sut.end());
 }
 
+TEST_F(HashMapLookupTests, contains_and_count_report_existing_keys_only)
+{
+    for (auto const& elem : init) {
+        ASSERT_TRUE(sut.contains(elem.first));
+        ASSERT_EQ(sut.count(elem.first), 1);
+    }
+    ASSERT_FALSE(sut.contains(42));
+    ASSERT_EQ(sut.count(42), 0);
+}
+
+TEST(HashMapLongChainTest, lookups_in_chains_longer_than_the_tags_block)
+{
+    // Every element lands in the single bucket, the chain overflows the tags block
+    constexpr int element_count{100};
+    HashMap<int, int> sut{1};
+    sut.max_load_factor(static_cast<float>(element_count));
+    for (int i{0}; i != element_count; ++i) {
+        ASSERT_TRUE(sut.insert({i, i * 10}).second);
+    }
+    for (int i{0}; i != element_count; ++i) {
+        auto const it{sut.find(i)};
+        ASSERT_NE(it, sut.end());
+        ASSERT_EQ(it->second, i * 10);
+    }
+    for (int i{0}; i < element_count; i += 2) {
+        ASSERT_EQ(sut.erase(i), 1);
+    }
+    for (int i{0}; i != element_count; ++i) {
+        ASSERT_EQ(sut.contains(i), i % 2 == 1) << "key: " << i;
+    }
+    ASSERT_FALSE(sut.contains(element_count));
+}
+
 TEST(HashMapEqualRangeTest, equal_range_returns_single_element_range)
 {
     constexpr std::array<std::pair<int, double>, 6> init{
@@ -292,6 +331,81 @@ TEST_F(HashMapModifyingTests, erase_removes_element_at_position)
     [](auto const& lhs, auto const& rhs)noexcept{ return lhs.first == rhs.first && lhs.second == rhs.second; }));
 }
 
+TEST(HashMapEraseTest, erase_of_the_last_node_of_a_bucket_returns_the_next_element)
+{
+    // A few crowded buckets - erasing any node, the last one of its bucket included, has to
+    // return the node which followed it
+    constexpr int element_count{16};
+    auto const make_map = [] {
+        HashMap<int, int> map{4};
+        map.max_load_factor(static_cast<float>(element_count));
+        for (int i{0}; i != element_count; ++i) {
+            map.insert({i, i});
+        }
+        return map;
+    };
+    auto const reference{make_map()};
+    ASSERT_EQ(reference.bucket_count(), 4u);
+    for (auto it{reference.cbegin()}; it != reference.cend(); ++it) {
+        auto sut{make_map()};
+        auto const res{sut.erase(sut.find(it->first))};
+        auto const expected{std::next(it)};
+        if (expected == reference.cend()) {
+            ASSERT_EQ(res, sut.end());
+        }
+        else {
+            ASSERT_NE(res, sut.end());
+            ASSERT_EQ(res->first, expected->first) << "erased key: " << it->first;
+        }
+        ASSERT_EQ(sut.size(), static_cast<std::size_t>(element_count - 1));
+    }
+}
+
+TEST(HashMapEraseRangeTest, range_erase_in_one_bucket_removes_the_range_only)
+{
+    HashMap<int, int> sut{1};
+    sut.max_load_factor(4.0f);
+    for (int i{0}; i != 4; ++i) {
+        ASSERT_TRUE(sut.insert({i, i}).second);
+    }
+    ASSERT_EQ(sut.bucket_count(), 1u);
+    auto const first{std::next(sut.cbegin(), 2)};
+    std::vector<int> kept{};
+    for (auto it{sut.cbegin()}; it != first; ++it) {
+        kept.push_back(it->first);
+    }
+    auto const res{sut.erase(first, sut.cend())};
+    ASSERT_EQ(res, sut.end());
+    ASSERT_EQ(sut.size(), 2u);
+    for (auto const key : kept) {
+        ASSERT_TRUE(sut.contains(key)) << "key: " << key;
+    }
+}
+
+TEST(HashMapEraseRangeTest, range_erase_ending_mid_table_keeps_the_rest)
+{
+    constexpr int element_count{64};
+    HashMap<int, int> sut{16};
+    for (int i{0}; i != element_count; ++i) {
+        ASSERT_TRUE(sut.insert({i, i}).second);
+    }
+    std::vector<int> keys{};
+    for (auto const& elem : sut) {
+        keys.push_back(elem.first);
+    }
+    auto const first{std::next(sut.cbegin(), element_count / 4)};
+    auto const last{std::next(sut.cbegin(), element_count / 2)};
+    auto const last_key{last->first};
+    auto const res{sut.erase(first, last)};
+    ASSERT_NE(res, sut.end());
+    ASSERT_EQ(res->first, last_key);
+    ASSERT_EQ(sut.size(), static_cast<std::size_t>(element_count - element_count / 4));
+    for (std::size_t i{0}; i != keys.size(); ++i) {
+        auto const erased{i >= keys.size() / 4 && i < keys.size() / 2};
+        ASSERT_EQ(sut.contains(keys[i]), !erased) << "key: " << keys[i];
+    }
+}
+
 TEST_F(HashMapModifyingTests, rehash_changes_capacity_and_load_factor_keeps_elements)
 {
     std::size_t constexpr new_capacity{97};
@@ -304,4 +418,372 @@ TEST_F(HashMapModifyingTests, rehash_changes_capacity_and_load_factor_keeps_elem
     );
 }
 
+
+template<typename Policy>
+class HashMapRangePolicyTest : public ::testing::Test {
+protected:
+    using Map = HashMap<int, int, MixingHash<int>, std::allocator<std::pair<int const, int>>, Policy>;
+};
+
+using RangePolicies = ::testing::Types<ModuloRange, PowerOfTwoRange, FastRange>;
+TYPED_TEST_SUITE(HashMapRangePolicyTest, RangePolicies);
+
+TYPED_TEST(HashMapRangePolicyTest, bucket_count_is_normalized_by_the_policy)
+{
+    typename TestFixture::Map sut{100};
+    ASSERT_EQ(sut.bucket_count(), TypeParam::bucket_count(100));
+    ASSERT_GE(sut.bucket_count(), 100);
+    sut.rehash(1000);
+    ASSERT_EQ(sut.bucket_count(), TypeParam::bucket_count(1000));
+}
+
+TYPED_TEST(HashMapRangePolicyTest, elements_are_found_in_their_buckets_after_rehash)
+{
+    constexpr int element_count{1000};
+    typename TestFixture::Map sut{};
+    for (int i{0}; i != element_count; ++i) {
+        ASSERT_TRUE(sut.insert({i, -i}).second);
+    }
+    sut.reserve(element_count);
+    for (int i{0}; i != element_count; ++i) {
+        auto const n{sut.bucket(i)};
+        ASSERT_LT(n, sut.bucket_count());
+        ASSERT_NE(std::find_if(sut.cbegin(n), sut.cend(n), [i](auto const& e) { return e.first == i; }),
+                  sut.cend(n));
+        ASSERT_EQ(sut.at(i).second, -i);
+    }
+}
+
+TYPED_TEST(HashMapRangePolicyTest, sequential_keys_spread_over_the_buckets)
+{
+    constexpr int element_count{4096};
+    typename TestFixture::Map sut(element_count);
+    for (int i{0}; i != element_count; ++i) {
+        sut.insert({i, i});
+    }
+    std::size_t longest_chain{0};
+    for (std::size_t n{0}; n != sut.bucket_count(); ++n) {
+        longest_chain = std::max(longest_chain, sut.bucket_size(n));
+    }
+    ASSERT_LE(longest_chain, 16);
+}
+
+TEST(HashMapRangePolicyTest, power_of_two_range_spreads_identity_hashes)
+{
+    HashMap<int, int, std::hash<int>, std::allocator<std::pair<int const, int>>, PowerOfTwoRange> sut(1024);
+    for (int i{0}; i != 1024; ++i) {
+        sut.insert({i * 1024, i});
+    }
+    std::size_t longest_chain{0};
+    for (std::size_t n{0}; n != sut.bucket_count(); ++n) {
+        longest_chain = std::max(longest_chain, sut.bucket_size(n));
+    }
+    ASSERT_LE(longest_chain, 16);
+}
+
+template<typename Policy>
+class HashMapRehashPolicyTest : public ::testing::Test {
+protected:
+    using Map = HashMap<int, int, std::hash<int>, std::allocator<std::pair<int const, int>>, ModuloRange, Policy>;
+
+    static void expect_contents(Map const& sut, int first, int last)
+    {
+        ASSERT_EQ(sut.size(), static_cast<std::size_t>(last - first));
+        for (int i{first}; i != last; ++i) {
+            auto const it{sut.find(i)};
+            ASSERT_NE(it, sut.cend()) << "key: " << i;
+            ASSERT_EQ(it->second, -i);
+        }
+        std::vector<int> keys{};
+        for (auto const& e : sut) { keys.push_back(e.first); }
+        std::sort(keys.begin(), keys.end());
+        ASSERT_EQ(keys.size(), sut.size());
+        for (std::size_t i{0}; i != keys.size(); ++i) {
+            ASSERT_EQ(keys[i], first + static_cast<int>(i));
+        }
+    }
+};
+using RehashPolicies = ::testing::Types<ImmediateRehash, IncrementalRehash<1>, IncrementalRehash<>>;
+TYPED_TEST_SUITE(HashMapRehashPolicyTest, RehashPolicies);
+
+TYPED_TEST(HashMapRehashPolicyTest, inserts_grow_the_map_past_max_load_factor)
+{
+    typename TestFixture::Map sut{};
+    auto const initial_bucket_count{sut.bucket_count()};
+    constexpr int element_count{10000};
+    for (int i{0}; i != element_count; ++i) {
+        ASSERT_TRUE(sut.insert({i, -i}).second);
+    }
+    ASSERT_GT(sut.bucket_count(), initial_bucket_count);
+    // The old array keeps taking inserts while the new one is being built
+    ASSERT_LE(sut.load_factor(), sut.max_load_factor() * (TypeParam::incremental ? 2.0f : 1.0f));
+    this->expect_contents(sut, 0, element_count);
+}
+
+TYPED_TEST(HashMapRehashPolicyTest, every_element_is_reachable_while_the_map_grows)
+{
+    typename TestFixture::Map sut{};
+    constexpr int element_count{700};
+    for (int i{0}; i != element_count; ++i) {
+        sut.try_emplace(i, -i);
+        this->expect_contents(sut, 0, i + 1);
+    }
+}
+
+TYPED_TEST(HashMapRehashPolicyTest, erase_and_clear_while_the_map_grows)
+{
+    typename TestFixture::Map sut{};
+    constexpr int element_count{2000};
+    int first{0};
+    for (int i{0}; i != element_count; ++i) {
+        sut[i].second = -i;
+        if (i % 3 == 0) {
+            ASSERT_EQ(sut.erase(first), 1u);
+            ++first;
+        }
+    }
+    this->expect_contents(sut, first, element_count);
+
+    sut.clear();
+    ASSERT_TRUE(sut.empty());
+    ASSERT_FALSE(sut.rehashing());
+    ASSERT_EQ(sut.begin(), sut.end());
+    for (int i{0}; i != element_count; ++i) {
+        sut.insert_or_assign(i, -i);
+    }
+    this->expect_contents(sut, 0, element_count);
+}
+
+TYPED_TEST(HashMapRehashPolicyTest, copy_and_move_while_the_map_grows)
+{
+    typename TestFixture::Map sut{};
+    int element_count{0};
+    do {
+        sut.insert({element_count, -element_count});
+        ++element_count;
+    } while (element_count != 100 && (!TypeParam::incremental || !sut.rehashing()));
+
+    typename TestFixture::Map const copy{sut};
+    this->expect_contents(copy, 0, element_count);
+    typename TestFixture::Map moved{std::move(sut)};
+    this->expect_contents(moved, 0, element_count);
+    for (int i{element_count}; i != 1000; ++i) {
+        moved.insert({i, -i});
+    }
+    this->expect_contents(moved, 0, 1000);
+}
+
+TEST(HashMapRehashPolicyTest, incremental_rehash_spreads_the_migration_over_inserts)
+{
+    HashMap<int, int, std::hash<int>, std::allocator<std::pair<int const, int>>, ModuloRange,
+            IncrementalRehash<1>> sut{};
+    auto const initial_bucket_count{sut.bucket_count()};
+    int i{0};
+    while (!sut.rehashing()) {
+        sut.insert({i, -i});
+        ++i;
+    }
+    // The migration completes over the following inserts, not within the one which started it
+    ASSERT_EQ(static_cast<std::size_t>(i), initial_bucket_count + 1);
+    while (sut.rehashing()) {
+        sut.insert({i, -i});
+        ++i;
+    }
+    ASSERT_GT(i, static_cast<int>(initial_bucket_count) + 2);
+    ASSERT_EQ(sut.bucket_count(), initial_bucket_count * 2);
+    sut.rehash(sut.bucket_count() * 2);
+    ASSERT_FALSE(sut.rehashing());
+    for (int k{0}; k != i; ++k) {
+        ASSERT_TRUE(sut.contains(k));
+    }
+}
+
+TEST(HashMapBulkInsertTest, range_insert_keeps_the_first_of_equal_keys)
+{
+    HashMap<int, int> sut{};
+    sut.insert({0, -1});
+    std::vector<std::pair<int, int>> elements{};
+    for (int i{0}; i != 5000; ++i) {
+        elements.emplace_back(i % 4000, i);
+    }
+    sut.insert(elements.cbegin(), elements.cend());
+    ASSERT_EQ(sut.size(), 4000u);
+    ASSERT_LE(sut.load_factor(), sut.max_load_factor());
+    ASSERT_EQ(sut.at(0).second, -1);
+    for (int i{1}; i != 4000; ++i) {
+        ASSERT_EQ(sut.at(i).second, i);
+    }
+    ASSERT_EQ(static_cast<std::size_t>(std::distance(sut.cbegin(), sut.cend())), sut.size());
+}
+
+TEST(HashMapBulkInsertTest, bulk_built_elements_can_be_erased_and_reinserted)
+{
+    std::vector<std::pair<int, int>> elements{};
+    for (int i{0}; i != 1000; ++i) {
+        elements.emplace_back(i, i);
+    }
+    HashMap<int, int> sut{elements.cbegin(), elements.cend()};
+    for (int i{0}; i != 1000; i += 2) {
+        ASSERT_EQ(sut.erase(i), 1u);
+    }
+    for (auto it{sut.cbegin()}; it != sut.cend(); ) {
+        it = it->first % 3 == 0 ? sut.erase(it) : std::next(it);
+    }
+    for (int i{0}; i != 1000; ++i) {
+        ASSERT_EQ(sut.contains(i), i % 2 == 1 && i % 3 != 0) << "key: " << i;
+    }
+    // The slab of the first build is released with its last element
+    sut.insert(elements.cbegin(), elements.cend());
+    ASSERT_EQ(sut.size(), 1000u);
+    sut.clear();
+    ASSERT_TRUE(sut.empty());
+    sut.insert(elements.cbegin(), elements.cbegin() + 10);
+    ASSERT_EQ(sut.size(), 10u);
+}
+
+TEST(HashMapBulkInsertTest, copy_move_and_swap_bulk_built_maps)
+{
+    std::vector<std::pair<int, int>> elements{};
+    for (int i{0}; i != 300; ++i) {
+        elements.emplace_back(i, -i);
+    }
+    HashMap<int, int> source{elements.cbegin(), elements.cend()};
+    HashMap<int, int> copy{source};
+    HashMap<int, int> moved{std::move(source)};
+    HashMap<int, int> other{elements.cbegin(), elements.cbegin() + 3};
+    moved.swap(other);
+    ASSERT_EQ(copy.size(), 300u);
+    ASSERT_EQ(other.size(), 300u);
+    ASSERT_EQ(moved.size(), 3u);
+    for (int i{0}; i != 300; ++i) {
+        ASSERT_EQ(other.at(i).second, -i);
+        ASSERT_EQ(copy.erase(i), 1u);
+    }
+    moved = std::move(other);
+    ASSERT_EQ(moved.size(), 300u);
+}
+
+TEST(HashMapBulkInsertTest, range_insert_completes_a_pending_incremental_rehash)
+{
+    HashMap<int, int, std::hash<int>, std::allocator<std::pair<int const, int>>, ModuloRange,
+            IncrementalRehash<1>> sut{};
+    int key{0};
+    while (!sut.rehashing()) {
+        sut.insert({key, key});
+        ++key;
+    }
+    std::vector<std::pair<int, int>> elements{};
+    for (int i{0}; i != 2000; ++i) {
+        elements.emplace_back(i, i);
+    }
+    sut.insert(elements.cbegin(), elements.cend());
+    ASSERT_FALSE(sut.rehashing());
+    ASSERT_EQ(sut.size(), 2000u);
+    for (int i{0}; i != 2000; ++i) {
+        ASSERT_TRUE(sut.contains(i));
+    }
+}
+
+struct ThrowingCopy {
+    static inline int copies_left{0};
+    int value{0};
+
+    ThrowingCopy(int v) : value{v} { }
+    ThrowingCopy(ThrowingCopy const& other) : value{other.value}
+    {
+        if (copies_left-- == 0) { throw std::runtime_error{"copy"}; }
+    }
+    ThrowingCopy& operator=(ThrowingCopy const&) = default;
+};
+
+TEST(HashMapBulkInsertTest, throwing_element_leaves_the_elements_linked_so_far)
+{
+    ThrowingCopy::copies_left = 1 << 20;
+    std::vector<std::pair<int, ThrowingCopy>> elements{};
+    elements.reserve(100);
+    for (int i{0}; i != 100; ++i) {
+        elements.emplace_back(i, ThrowingCopy{i});
+    }
+    HashMap<int, ThrowingCopy> sut{};
+    ThrowingCopy::copies_left = 40;
+    ASSERT_THROW(sut.insert(elements.cbegin(), elements.cend()), std::runtime_error);
+    ASSERT_EQ(sut.size(), 40u);
+    ASSERT_EQ(static_cast<std::size_t>(std::distance(sut.cbegin(), sut.cend())), 40u);
+    ThrowingCopy::copies_left = 0;
+    ASSERT_THROW(sut.insert(elements.cbegin() + 99, elements.cend()), std::runtime_error);
+    ThrowingCopy::copies_left = 1000;
+    sut.insert(elements.cbegin(), elements.cend());
+    ASSERT_EQ(sut.size(), 100u);
+}
+
+TEST(HashMapPoolAllocatorTest, nodes_come_from_the_node_pool)
+{
+    using Map = HashMap<int, std::string, std::hash<int>, PoolAllocator<std::pair<int const, std::string>>>;
+    std::vector<std::pair<int, std::string>> elements{};
+    for (int i{0}; i != 500; ++i) {
+        elements.emplace_back(i, std::to_string(i));
+    }
+    Map sut{elements.cbegin(), elements.cend()};
+    for (int i{500}; i != 2000; ++i) {
+        sut.try_emplace(i, std::to_string(i));
+    }
+    for (int i{0}; i != 2000; i += 2) {
+        ASSERT_EQ(sut.erase(i), 1u);
+    }
+    Map copy{sut};
+    ASSERT_EQ(copy.size(), 1000u);
+    for (int i{1}; i < 2000; i += 2) {
+        ASSERT_EQ(copy.at(i).second, std::to_string(i));
+    }
+    sut.clear();
+    ASSERT_TRUE(sut.empty());
+}
+
+class HashMapTransparentLookupTest : public ::testing::Test {
+protected:
+    // std::string is not implicitly constructible from std::string_view - the lookups below only
+    // compile through the heterogeneous overloads
+    HashMap<std::string, int, StringHash> sut{};
+
+    void SetUp() override
+    {
+        sut.insert({"one", 1});
+        sut.insert({"two", 2});
+        sut.insert({"three", 3});
+    }
+};
+
+TEST_F(HashMapTransparentLookupTest, find_contains_and_count_take_a_string_view)
+{
+    auto const it{sut.find(std::string_view{"two"})};
+    ASSERT_NE(it, sut.end());
+    ASSERT_EQ(it->second, 2);
+    ASSERT_EQ(std::as_const(sut).find(std::string_view{"four"}), sut.cend());
+    ASSERT_TRUE(sut.contains(std::string_view{"one"}));
+    ASSERT_FALSE(sut.contains(std::string_view{"on"}));
+    ASSERT_EQ(sut.count(std::string_view{"three"}), 1u);
+    ASSERT_EQ(sut.count("four"), 0u);
+}
+
+TEST_F(HashMapTransparentLookupTest, at_and_equal_range_take_a_string_view)
+{
+    ASSERT_EQ(sut.at(std::string_view{"three"}).second, 3);
+    ASSERT_EQ(std::as_const(sut).at(std::string_view{"one"}).second, 1);
+    ASSERT_THROW(sut.at(std::string_view{"four"}), std::out_of_range);
+    auto const [first, last]{sut.equal_range(std::string_view{"one"})};
+    ASSERT_EQ(std::distance(first, last), 1);
+    ASSERT_EQ(first->first, "one");
+    auto const [missing_first, missing_last]{std::as_const(sut).equal_range(std::string_view{"four"})};
+    ASSERT_EQ(missing_first, missing_last);
+}
+
+TEST_F(HashMapTransparentLookupTest, erase_takes_a_string_view)
+{
+    ASSERT_EQ(sut.erase(std::string_view{"two"}), 1u);
+    ASSERT_EQ(sut.erase(std::string_view{"two"}), 0u);
+    ASSERT_EQ(sut.size(), 2u);
+    ASSERT_FALSE(sut.contains(std::string_view{"two"}));
+    ASSERT_EQ(sut.at(std::string("one")).second, 1);
+}
+
 } // namespace
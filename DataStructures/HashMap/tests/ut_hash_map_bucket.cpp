@@ -83,6 +83,39 @@ TEST_F(HashMapBucketInsertingModifiers, insert_after_range_adds_range_size_nodes
 }
 
 
+TEST(HashMapBucketTaggedTest, tagged_find_matches_tagged_and_untagged_nodes)
+{
+    HashMapBucket<int, double> sut{};
+    auto const tag_of = [](int key) noexcept { return make_bucket_tag(std::hash<int>{}(key)); };
+    sut.push_front(tag_of(1), {1, 1.1});
+    sut.push_front({2, 2.2});
+    sut.insert_after(sut.before_cbegin(), {3, 3.3});
+    ASSERT_TRUE(sut.insert_unique(tag_of(4), std::pair<int, double>{4, 4.4}).second);
+    ASSERT_FALSE(sut.insert_unique(tag_of(1), std::pair<int, double>{1, 11.11}).second);
+    for (int key : {1, 2, 3, 4}) {
+        auto const it{sut.find(tag_of(key), key)};
+        ASSERT_NE(it, sut.end()) << "key: " << key;
+        ASSERT_EQ(it->first, key);
+    }
+    ASSERT_EQ(sut.find(tag_of(5), 5), sut.end());
+}
+
+TEST(HashMapBucketTaggedTest, tagged_erase_keeps_remaining_nodes_reachable)
+{
+    constexpr int element_count{70};
+    HashMapBucket<int, double> sut{};
+    auto const tag_of = [](int key) noexcept { return make_bucket_tag(std::hash<int>{}(key)); };
+    for (int i{0}; i != element_count; ++i) {
+        sut.push_front(tag_of(i), {i, static_cast<double>(i)});
+    }
+    for (int i{0}; i < element_count; i += 3) {
+        ASSERT_EQ(sut.erase(tag_of(i), i), 1);
+    }
+    for (int i{0}; i != element_count; ++i) {
+        ASSERT_EQ(sut.find(tag_of(i), i) != sut.end(), i % 3 != 0) << "key: " << i;
+    }
+}
+
 class HashMapBucketErasingModifiers : public ::testing::Test {
 public:
     static constexpr std::array<std::pair<int, double>, 5> init_{{{2, 2.2}, {5, 5.5}, {3, 3.3}, {1, 1.1}, {4, 4.4}}};
@@ -0,0 +1,57 @@
+#include <benchmark/benchmark.h>
+
+#include <single_linked_list/single_linked_list.hpp>
+#include <utils/node_pool.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Node churn across many lists: every operation pops the front node of one list and pushes a new
+// one onto another, so the live nodes of a list end up scattered over the heap. The lists hold
+// range(0) nodes in total. Compares std::allocator with the PoolAllocator.
+//
+//   ./SingleLinkedListPool_BM
+namespace
+{
+
+using Value = std::uint64_t;
+
+constexpr std::size_t List_Count{256};
+
+template<typename Allocator>
+void BM_Churn(benchmark::State& state)
+{
+    using List = SingleLinkedList<Value, Allocator>;
+    auto const node_count{static_cast<std::size_t>(state.range(0))};
+    std::vector<List> lists(List_Count);
+    for (std::size_t i{0}; i != node_count; ++i) {
+        lists[i % List_Count].push_front(i);
+    }
+    std::uint64_t rng{0x9e3779b97f4a7c15};
+    for (auto _ : state) {
+        // xorshift64
+        rng ^= rng << 13;
+        rng ^= rng >> 7;
+        rng ^= rng << 17;
+        auto& from{lists[rng % List_Count]};
+        auto& to{lists[(rng >> 32) % List_Count]};
+        if (from.empty()) { continue; }
+        auto const value{from.front()};
+        from.pop_front();
+        to.push_front(value + 1);
+        benchmark::DoNotOptimize(to.front());
+    }
+    // Walk every list - the traversal pays for the scattered nodes
+    std::uint64_t sum{0};
+    for (auto const& list : lists) {
+        for (auto const v : list) { sum += v; }
+    }
+    benchmark::DoNotOptimize(sum);
+    state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Churn, std::allocator<Value>)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Churn, PoolAllocator<Value>)->RangeMultiplier(16)->Range(1 << 12, 1 << 20);
@@ -0,0 +1,167 @@
+#include <benchmark/benchmark.h>
+
+#include <single_linked_list/single_linked_list.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <forward_list>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// List operations on range(0) elements in random order, compared with std::forward_list:
+//  - Sort, with the merge sort and the buffered sort of SingleLinkedList. The keys are integers,
+//    24 character strings (one more pointer to chase per comparison) and 64 byte records.
+//  - Merge of two sorted lists of range(0) / 2 elements each.
+//  - Unique on a sorted list holding every key four times, RemoveIf of every other element.
+// The lists are rebuilt outside of the timing, every node is allocated in the list order.
+//
+//   ./SingleLinkedListSort_BM
+namespace
+{
+
+struct Record {
+    std::uint64_t key;
+    std::uint64_t payload[7];
+
+    bool operator<(Record const& other) const noexcept { return key < other.key; }
+    bool operator==(Record const& other) const noexcept { return key == other.key; }
+};
+
+template<typename Value>
+Value make_value(std::uint64_t key)
+{
+    if constexpr (std::is_same_v<Value, std::string>) {
+        auto text{std::to_string(key)};
+        return std::string(24 - text.size(), '0') + text;
+    }
+    else if constexpr (std::is_same_v<Value, Record>) {
+        return Record{key, {}};
+    }
+    else {
+        return key;
+    }
+}
+
+template<typename Value>
+std::vector<Value> random_values(std::size_t count)
+{
+    std::mt19937_64 gen{42};
+    std::vector<Value> values{};
+    values.reserve(count);
+    for (std::size_t i{0}; i != count; ++i) { values.push_back(make_value<Value>(gen() % (count * 4))); }
+    return values;
+}
+
+struct MergeSort {};
+struct BufferedSort {};
+
+template<typename List, typename Strategy>
+void sort(List& list, Strategy)
+{
+    if constexpr (std::is_same_v<Strategy, BufferedSort>) { list.sort(SLL_Sort_Buffered); }
+    else { list.sort(); }
+}
+
+template<typename List, typename Strategy = MergeSort>
+void BM_Sort(benchmark::State& state)
+{
+    using Value = typename List::value_type;
+    auto const values{random_values<Value>(static_cast<std::size_t>(state.range(0)))};
+    for (auto _ : state) {
+        state.PauseTiming();
+        List list(values.cbegin(), values.cend());
+        state.ResumeTiming();
+        sort(list, Strategy{});
+        benchmark::DoNotOptimize(list.front());
+        state.PauseTiming();
+        list.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename List>
+void BM_Merge(benchmark::State& state)
+{
+    auto values{random_values<std::uint64_t>(static_cast<std::size_t>(state.range(0)))};
+    auto const half{values.begin() + state.range(0) / 2};
+    std::sort(values.begin(), half);
+    std::sort(half, values.end());
+    for (auto _ : state) {
+        state.PauseTiming();
+        List list(values.begin(), half);
+        List other(half, values.end());
+        state.ResumeTiming();
+        list.merge(other);
+        benchmark::DoNotOptimize(list.front());
+        state.PauseTiming();
+        list.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename List>
+void BM_Unique(benchmark::State& state)
+{
+    std::vector<std::uint64_t> values(static_cast<std::size_t>(state.range(0)));
+    for (std::size_t i{0}; i != values.size(); ++i) { values[i] = i / 4; }
+    for (auto _ : state) {
+        state.PauseTiming();
+        List list(values.cbegin(), values.cend());
+        state.ResumeTiming();
+        list.unique();
+        benchmark::DoNotOptimize(list.front());
+        state.PauseTiming();
+        list.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename List>
+void BM_RemoveIf(benchmark::State& state)
+{
+    auto const values{random_values<std::uint64_t>(static_cast<std::size_t>(state.range(0)))};
+    for (auto _ : state) {
+        state.PauseTiming();
+        List list(values.cbegin(), values.cend());
+        state.ResumeTiming();
+        list.remove_if([](std::uint64_t value) noexcept { return value % 2 == 0; });
+        benchmark::DoNotOptimize(list.empty());
+        state.PauseTiming();
+        list.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+using SllInt = SingleLinkedList<std::uint64_t>;
+using FwdInt = std::forward_list<std::uint64_t>;
+using SllString = SingleLinkedList<std::string>;
+using FwdString = std::forward_list<std::string>;
+using SllRecord = SingleLinkedList<Record>;
+using FwdRecord = std::forward_list<Record>;
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Sort, SllInt)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Sort, SllInt, BufferedSort)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Sort, FwdInt)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Sort, SllString)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Sort, SllString, BufferedSort)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Sort, FwdString)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Sort, SllRecord)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Sort, SllRecord, BufferedSort)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_Sort, FwdRecord)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_TEMPLATE(BM_Merge, SllInt)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Merge, FwdInt)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_TEMPLATE(BM_Unique, SllInt)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Unique, FwdInt)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_TEMPLATE(BM_RemoveIf, SllInt)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_RemoveIf, FwdInt)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
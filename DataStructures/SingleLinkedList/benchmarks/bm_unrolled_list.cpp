@@ -0,0 +1,128 @@
+#include <benchmark/benchmark.h>
+
+#include <single_linked_list/single_linked_list.hpp>
+#include <single_linked_list/unrolled_list.hpp>
+
+#include <cstdint>
+#include <forward_list>
+#include <memory>
+#include <vector>
+
+// Lists of range(0) small elements: SingleLinkedList and std::forward_list allocate a node per
+// element, UnrolledList keeps 64, 128 (default) or 256 bytes of elements per node.
+//  - Iterate sums a list built by push_front on a fresh heap, its nodes are close to each other.
+//  - IterateInterleaved sums a list built in turns with 63 other lists, consecutive nodes are far
+//    apart as in long lived lists.
+//  - PushFront builds and destroys a list, AppendAfter builds it in order through insert_after
+//    with the returned iterator.
+//  - InsertEveryOther inserts an element after each element of a list - the unrolled list splits
+//    every node.
+//
+//   ./UnrolledList_BM
+namespace
+{
+
+using Value = std::uint64_t;
+
+using Sll = SingleLinkedList<Value>;
+using ForwardList = std::forward_list<Value>;
+using Unrolled64 = UnrolledList<Value, std::allocator<Value>, 64>;
+using Unrolled = UnrolledList<Value>;
+using Unrolled256 = UnrolledList<Value, std::allocator<Value>, 256>;
+
+constexpr std::size_t Interleaved_Lists{64};
+
+template<typename List>
+void BM_Iterate(benchmark::State& state)
+{
+    List list{};
+    for (std::int64_t i{0}; i != state.range(0); ++i) { list.push_front(static_cast<Value>(i)); }
+    for (auto _ : state) {
+        Value sum{0};
+        for (auto const v : list) { sum += v; }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename List>
+void BM_IterateInterleaved(benchmark::State& state)
+{
+    std::vector<List> lists(Interleaved_Lists);
+    for (std::int64_t i{0}; i != state.range(0); ++i) {
+        for (auto& list : lists) { list.push_front(static_cast<Value>(i)); }
+    }
+    auto const& list{lists[Interleaved_Lists / 2]};
+    for (auto _ : state) {
+        Value sum{0};
+        for (auto const v : list) { sum += v; }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename List>
+void BM_PushFront(benchmark::State& state)
+{
+    for (auto _ : state) {
+        List list{};
+        for (std::int64_t i{0}; i != state.range(0); ++i) { list.push_front(static_cast<Value>(i)); }
+        benchmark::DoNotOptimize(list.front());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename List>
+void BM_AppendAfter(benchmark::State& state)
+{
+    for (auto _ : state) {
+        List list{};
+        auto it{list.before_begin()};
+        for (std::int64_t i{0}; i != state.range(0); ++i) { it = list.insert_after(it, static_cast<Value>(i)); }
+        benchmark::DoNotOptimize(list.front());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template<typename List>
+void BM_InsertEveryOther(benchmark::State& state)
+{
+    for (auto _ : state) {
+        state.PauseTiming();
+        List list{};
+        for (std::int64_t i{0}; i != state.range(0); ++i) { list.push_front(static_cast<Value>(i)); }
+        state.ResumeTiming();
+        for (auto it{list.begin()}; it != list.end(); ++it) { it = list.insert_after(it, *it); }
+        benchmark::DoNotOptimize(list.front());
+        state.PauseTiming();
+        list.clear();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Iterate, Sll)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Iterate, ForwardList)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Iterate, Unrolled64)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Iterate, Unrolled)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+BENCHMARK_TEMPLATE(BM_Iterate, Unrolled256)->RangeMultiplier(16)->Range(1 << 10, 1 << 22);
+
+BENCHMARK_TEMPLATE(BM_IterateInterleaved, Sll)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_IterateInterleaved, ForwardList)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_IterateInterleaved, Unrolled64)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_IterateInterleaved, Unrolled)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+BENCHMARK_TEMPLATE(BM_IterateInterleaved, Unrolled256)->RangeMultiplier(16)->Range(1 << 8, 1 << 16);
+
+BENCHMARK_TEMPLATE(BM_PushFront, Sll)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_PushFront, ForwardList)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_PushFront, Unrolled)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_TEMPLATE(BM_AppendAfter, Sll)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_AppendAfter, ForwardList)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+BENCHMARK_TEMPLATE(BM_AppendAfter, Unrolled)->RangeMultiplier(16)->Range(1 << 10, 1 << 20);
+
+BENCHMARK_TEMPLATE(BM_InsertEveryOther, Sll)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_InsertEveryOther, ForwardList)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_InsertEveryOther, Unrolled)->RangeMultiplier(16)->Range(1 << 10, 1 << 18);
@@ -4,14 +4,18 @@
 #include <utils/Assertion.h>
 #include <utils/traits.h>
 
+#include <algorithm>
+#include <array>
 #include <cstddef>
 #include <cstdint>
 #include <forward_list>
 #include <initializer_list>
 #include <iterator>
 #include <memory>
+#include <new>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 template<typename T, bool IsConst> class SLL_IteratorImpl;
 template<typename T> using SLL_Iterator = SLL_IteratorImpl<T, false>;
@@ -37,6 +41,9 @@ struct SLL_Node {
     SLL_Node& operator=(SLL_Node&& other) noexcept(std::is_nothrow_move_constructible_v<T>) = default;
 };
 
+// Selects the sort that copies the node pointers into a temporary array - see SingleLinkedList::sort
+struct SLL_Sort_Buffered_Tag {};
+inline constexpr SLL_Sort_Buffered_Tag SLL_Sort_Buffered{};
 
 template <class T, class Allocator = std::allocator<T>>
 class SingleLinkedList {
@@ -46,7 +53,7 @@ private:
     using alloc_traits = std::allocator_traits<Allocator>;
     using Nalloc = typename alloc_traits::template rebind_alloc<Node>;
     using nalloc_traits = std::allocator_traits<Nalloc>;
-    using SwapAllocators = SwapAllocators<typename nalloc_traits::propagate_on_container_swap>;
+    using SwapAllocators = ::SwapAllocators<typename nalloc_traits::propagate_on_container_swap>;
 
     Nalloc nalloc_{};
     Node head_{};
@@ -157,10 +164,44 @@ public:
     size_type unique();
     template<typename BinaryPredicate> size_type unique(BinaryPredicate pred);
 
+    // Stable bottom-up merge sort of the nodes, without allocating and without recursion. The
+    // ascending runs of the list are merged as a binary counter: bin i holds a sorted run of about
+    // 2^i runs and is merged with the next run of that size right after the run was built, while its
+    // nodes are still in the cache. Sorted input takes a single pass.
+    //
+    // The buffered sort copies the node pointers into a temporary array, sorts it with
+    // std::stable_sort and relinks the nodes - it is faster on long lists of cheap to compare
+    // elements, and falls back to the merge sort if the array can't be allocated. It leaves the list
+    // unchanged if the comparison throws, the merge sort leaves the elements in unspecified order.
     void sort();
     template<typename Compare> void sort(Compare cmp);
+    void sort(SLL_Sort_Buffered_Tag);
+    template<typename Compare> void sort(Compare cmp, SLL_Sort_Buffered_Tag);
 
 private:
+    // Sorts up to 2^Sort_Bins ascending runs
+    static constexpr std::size_t Sort_Bins{64};
+
+    // Merges the sorted nodes of rhs into lhs, the nodes of lhs go first among equal elements. If
+    // the comparison throws, lhs holds all nodes in unspecified order.
+    template<typename Compare>
+    static void merge_nodes(Node*& lhs, Node* rhs, Compare& cmp);
+
+    static Node* last_node(Node* node) noexcept
+    {
+        while (node->next != nullptr) { node = node->next; }
+        return node;
+    }
+
+    inline void free_nodes(Node* node) noexcept
+    {
+        while (node != nullptr) {
+            Node* const next{node->next};
+            free(node);
+            node = next;
+        }
+    }
+
     template<typename... Args>
     Node* make_node(Args&&... args)
     {
@@ -496,24 +537,37 @@ template<typename Compare> void SingleLinkedList<T, Allocator>::merge(SingleLink
 template<typename T, typename Allocator>
 template<typename Compare> void SingleLinkedList<T, Allocator>::merge(SingleLinkedList&& other, Compare cmp)
 {
-    auto lbb{&head_};
-    auto lb{head_.next};
-    auto rbb{&other.head_};
-    auto rb{other.head_.next};
-    while (rb != nullptr) {
-        while (lb != nullptr && !cmp(rb->data, lb->data)) {
-            lbb = lb;
-            lb = lb->next;
-        }
-        auto rend{rb->next};
-        while (rend != nullptr && (lb == nullptr || !cmp(lb->data, rend->data))) {
-            rend = rend->next;
+    if (&other == this) { return; }
+    merge_nodes(head_.next, std::exchange(other.head_.next, nullptr), cmp);
+}
+
+template<typename T, typename Allocator>
+template<typename Compare>
+void SingleLinkedList<T, Allocator>::merge_nodes(Node*& lhs, Node* rhs, Compare& cmp)
+{
+    Node* merged{nullptr};
+    Node** tail{&merged};
+    Node* left{lhs};
+    try {
+        while (left != nullptr && rhs != nullptr) {
+            if (cmp(rhs->data, left->data)) {
+                *tail = rhs;
+                tail = &rhs->next;
+                rhs = rhs->next;
+            } else {
+                *tail = left;
+                tail = &left->next;
+                left = left->next;
+            }
         }
-        lbb->next = rb;
-        rbb->next = rend;
-        rb->next = lb;
-        rb = rend;
+    } catch (...) {
+        *tail = left != nullptr ? left : rhs;
+        if (left != nullptr && rhs != nullptr) { last_node(left)->next = rhs; }
+        lhs = merged;
+        throw;
     }
+    *tail = left != nullptr ? left : rhs;
+    lhs = merged;
 }
 
 template<typename T, typename Allocator>
@@ -525,20 +579,27 @@ template<typename T, typename Allocator>
 template<typename UnaryPredicate>
 auto SingleLinkedList<T, Allocator>::remove_if(UnaryPredicate pred) -> size_type
 {
-    Node* bbegin{&head_};
-    Node* begin{head_.next};
+    // The removed nodes are freed at the end - the predicate may refer to one of their elements,
+    // as remove(front()) does
+    Node* removed{nullptr};
+    Node* prev{&head_};
     size_type count{0};
-    while (begin != nullptr) {
-        if (pred(begin->data)) {
-            bbegin->next = begin->next;
-            free(begin);
-            begin = bbegin->next;
-            ++count;
-        } else {
-            bbegin = begin;
-            begin = begin->next;
+    try {
+        while (Node* const node{prev->next}) {
+            if (pred(node->data)) {
+                prev->next = node->next;
+                node->next = removed;
+                removed = node;
+                ++count;
+            } else {
+                prev = node;
+            }
         }
+    } catch (...) {
+        free_nodes(removed);
+        throw;
     }
+    free_nodes(removed);
     return count;
 }
 
@@ -567,18 +628,26 @@ template<typename T, typename Allocator>
 template<typename BinaryPredicate>
 auto SingleLinkedList<T, Allocator>::unique(BinaryPredicate pred) -> size_type
 {
-    auto begin{head_.next};
+    Node* removed{nullptr};
+    Node* kept{head_.next};
     size_type count{0};
-    while (begin != nullptr && begin->next != nullptr) {
-        auto next = begin->next;
-        while (next != nullptr && pred(begin->data, next->data)) {
-            begin->next = next->next;
-            free(next);
-            next = begin->next;
-            ++count;
+    try {
+        while (kept != nullptr && kept->next != nullptr) {
+            Node* const next{kept->next};
+            if (pred(kept->data, next->data)) {
+                kept->next = next->next;
+                next->next = removed;
+                removed = next;
+                ++count;
+            } else {
+                kept = next;
+            }
         }
-        begin = next;
+    } catch (...) {
+        free_nodes(removed);
+        throw;
     }
+    free_nodes(removed);
     return count;
 }
 
@@ -591,29 +660,75 @@ template<typename T, typename Allocator>
 template<typename Compare>
 void SingleLinkedList<T, Allocator>::sort(Compare cmp)
 {
-    auto const swap_nodes = [](Node* blhs, Node* lhs, Node* rhs) noexcept {
-        blhs->next = rhs;
-        lhs->next = rhs->next;
-        rhs->next = lhs;
-    };
-
-    if (head_.next == nullptr) return;
-
-    bool sorted{false};
-    while (!sorted) {
-        sorted = true;
-        Node* blhs{&head_};
-        Node* lhs{head_.next};
-        while (lhs->next != nullptr) {
-            if (cmp(lhs->next->data, lhs->data)) {
-                swap_nodes(blhs, lhs, lhs->next);
-                sorted = false;
-            } else {
-                lhs = lhs->next;
+    // bins[i] holds a sorted run or nothing, the higher the bin the earlier its elements
+    std::array<Node*, Sort_Bins> bins{};
+    std::size_t used{0};
+    Node* rest{std::exchange(head_.next, nullptr)};
+    Node* run{nullptr};
+    try {
+        while (rest != nullptr) {
+            Node* last{rest};
+            while (last->next != nullptr && !cmp(last->next->data, last->data)) { last = last->next; }
+            run = std::exchange(rest, last->next);
+            last->next = nullptr;
+
+            std::size_t bin{0};
+            for (; bin != used && bins[bin] != nullptr; ++bin) {
+                merge_nodes(bins[bin], std::exchange(run, nullptr), cmp);
+                run = std::exchange(bins[bin], nullptr);
+            }
+            if (bin == used) {
+                JAM_EXPECT(used != Sort_Bins, "Too many runs to sort");
+                ++used;
             }
-            blhs = blhs->next;
+            bins[bin] = std::exchange(run, nullptr);
+        }
+        for (std::size_t bin{0}; bin != used; ++bin) {
+            if (bins[bin] == nullptr) { continue; }
+            merge_nodes(bins[bin], std::exchange(run, nullptr), cmp);
+            run = std::exchange(bins[bin], nullptr);
+        }
+    } catch (...) {
+        // Relink the nodes of all runs
+        for (Node* const nodes : bins) {
+            if (nodes != nullptr) { last_node(nodes)->next = std::exchange(run, nodes); }
         }
+        if (rest != nullptr) { last_node(rest)->next = std::exchange(run, rest); }
+        head_.next = run;
+        throw;
+    }
+    head_.next = run;
+}
+
+template<typename T, typename Allocator>
+void SingleLinkedList<T, Allocator>::sort(SLL_Sort_Buffered_Tag)
+{
+    sort([](auto const& lhs, auto const& rhs)noexcept { return lhs < rhs; }, SLL_Sort_Buffered);
+}
+template<typename T, typename Allocator>
+template<typename Compare>
+void SingleLinkedList<T, Allocator>::sort(Compare cmp, SLL_Sort_Buffered_Tag)
+{
+    using Palloc = typename alloc_traits::template rebind_alloc<Node*>;
+    std::vector<Node*, Palloc> nodes{Palloc{nalloc_}};
+    try {
+        size_type count{0};
+        for (Node* node{head_.next}; node != nullptr; node = node->next) { ++count; }
+        nodes.reserve(count);
+    } catch (std::bad_alloc const&) {
+        sort(cmp);
+        return;
+    }
+    for (Node* node{head_.next}; node != nullptr; node = node->next) { nodes.push_back(node); }
+    std::stable_sort(nodes.begin(), nodes.end(), [&cmp](Node const* lhs, Node const* rhs) {
+        return cmp(lhs->data, rhs->data);
+    });
+    Node* prev{&head_};
+    for (Node* const node : nodes) {
+        prev->next = node;
+        prev = node;
     }
+    prev->next = nullptr;
 }
 
 // Iterators
@@ -0,0 +1,650 @@
+#ifndef DATA_STRUCTURES_UNROLLED_LIST_HPP
+#define DATA_STRUCTURES_UNROLLED_LIST_HPP
+
+#include <utils/Assertion.h>
+#include <utils/traits.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+template<typename T, std::size_t Capacity, bool IsConst> class ULL_IteratorImpl;
+template<typename T, std::size_t Capacity> using ULL_Iterator = ULL_IteratorImpl<T, Capacity, false>;
+template<typename T, std::size_t Capacity> using ULL_ConstIterator = ULL_IteratorImpl<T, Capacity, true>;
+
+// The head of the list is a node without slots
+struct ULL_NodeBase {
+    ULL_NodeBase* next{nullptr};
+    // the elements sit in the slots [first, last)
+    std::uint16_t first{0};
+    std::uint16_t last{0};
+};
+
+// The slots outside [first, last) hold no objects
+template<typename T, std::size_t Capacity>
+struct ULL_Node : ULL_NodeBase {
+    alignas(T) std::byte storage[Capacity * sizeof(T)];
+
+    ULL_Node() noexcept = default;
+    ULL_Node(ULL_Node const&) = delete;
+    ULL_Node& operator=(ULL_Node const&) = delete;
+
+    T* slots() noexcept { return reinterpret_cast<T*>(storage); }
+    T const* slots() const noexcept { return reinterpret_cast<T const*>(storage); }
+};
+
+// Singly linked list keeping up to Node_Capacity elements in every node - as many as NodeBytes
+// holds. Iteration reads the elements of a node from adjacent slots and follows one pointer per
+// node instead of one per element, and the list allocates one node per Node_Capacity elements.
+//
+// push_front fills a node from its back and appending after the last element of a node fills it
+// from the front, neither moves an element. Inserting in the middle of a node moves the elements
+// behind the insertion point one slot back, a full node is split in two at the insertion point.
+//
+// The interface is the part of SingleLinkedList's which the nodes are about: construction and
+// assignment, front, empty, the iterators, insert_after, emplace_after, erase_after, push_front,
+// emplace_front, pop_front, resize, swap and clear - plus splice_after. There is no assign, merge,
+// remove, remove_if, reverse, unique or sort.
+// As elements move between the slots the iterator invalidation rules are weaker, an invalidated
+// iterator also invalidates the pointers and references to its element:
+//  - insert_after and emplace_after invalidate the elements following pos in the node of pos,
+//  - push_front and emplace_front invalidate nothing,
+//  - erase_after and pop_front invalidate the erased elements and the elements following them in
+//    their node. When a node drops below a quarter of Node_Capacity the elements of the next node
+//    may be moved into it and are invalidated too,
+//  - splice_after invalidates the elements following pos in its node and, in other, the spliced
+//    elements and the elements of the node of last. Splicing requires &other != this and equal
+//    allocators.
+// T must be nothrow move constructible, elements are relocated by move construction.
+template <class T, class Allocator = std::allocator<T>, std::size_t NodeBytes = 128>
+class UnrolledList {
+    static constexpr std::size_t Header{(sizeof(ULL_NodeBase) + alignof(T) - 1) / alignof(T) * alignof(T)};
+public:
+    static constexpr std::size_t Node_Capacity{std::max<std::size_t>(
+        NodeBytes > Header ? (NodeBytes - Header) / sizeof(T) : 0, 2)};
+private:
+    static_assert(Node_Capacity <= std::numeric_limits<std::uint16_t>::max(), "NodeBytes too large");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "Elements are relocated by move construction");
+
+    // A node falling below that many elements takes in the elements of the next node if they fit
+    static constexpr std::size_t Merge_Threshold{Node_Capacity / 4};
+
+    using NodeBase = ULL_NodeBase;
+    using Node = ULL_Node<T, Node_Capacity>;
+    using alloc_traits = std::allocator_traits<Allocator>;
+    using Nalloc = typename alloc_traits::template rebind_alloc<Node>;
+    using nalloc_traits = std::allocator_traits<Nalloc>;
+    using SwapAllocators = ::SwapAllocators<typename nalloc_traits::propagate_on_container_swap>;
+
+    Nalloc nalloc_{};
+    NodeBase head_{};
+public:
+    using value_type = T;
+    using allocator_type = Allocator;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = std::add_lvalue_reference_t<value_type>;
+    using const_reference = std::add_lvalue_reference_t<const value_type>;
+    using pointer = typename alloc_traits::pointer;
+    using const_pointer = typename alloc_traits::const_pointer;
+    using iterator = ULL_Iterator<T, Node_Capacity>;
+    using const_iterator = ULL_ConstIterator<T, Node_Capacity>;
+
+    UnrolledList() noexcept = default;
+    explicit UnrolledList(Allocator const& alloc) noexcept : nalloc_{Nalloc{alloc}} { }
+    explicit UnrolledList(size_type count, value_type const& value, Allocator const& alloc = Allocator{});
+    explicit UnrolledList(size_type count, Allocator const& alloc = Allocator{});
+    template <typename InputIt, typename = RequiresInputIterator<InputIt>>
+    UnrolledList(InputIt first, InputIt last, Allocator const& alloc = Allocator{});
+    UnrolledList(std::initializer_list<value_type> il, Allocator const& alloc = Allocator{});
+    UnrolledList(UnrolledList const& other);
+    UnrolledList(UnrolledList&& other) noexcept;
+    ~UnrolledList() noexcept { free(); }
+
+    UnrolledList& operator=(UnrolledList const& other);
+    UnrolledList& operator=(UnrolledList&& other) noexcept;
+
+    // allocator access
+    allocator_type get_allocator() const noexcept { return allocator_type{nalloc_}; }
+
+    // element access
+    reference front() noexcept
+    {
+        JAM_EXPECT(head_.next != nullptr, "front() called on an empty UnrolledList");
+        return *begin();
+    }
+    const_reference front() const noexcept
+    {
+        JAM_EXPECT(head_.next != nullptr, "front() called on an empty UnrolledList");
+        return *begin();
+    }
+
+    // capacity
+    bool empty() const noexcept { return head_.next == nullptr; }
+
+    // iterators
+    iterator before_begin() noexcept { return iterator{&head_, 0}; }
+    const_iterator before_begin() const noexcept { return before_cbegin(); }
+    const_iterator before_cbegin() const noexcept { return const_iterator{const_cast<NodeBase*>(&head_), 0}; }
+
+    iterator begin() noexcept { return node_begin(head_.next); }
+    const_iterator begin() const noexcept { return cbegin(); }
+    const_iterator cbegin() const noexcept { return node_begin(head_.next); }
+
+    iterator end() noexcept { return iterator{}; }
+    const_iterator end() const noexcept { return const_iterator{}; }
+    const_iterator cend() const noexcept { return const_iterator{}; }
+
+    // modifiers
+    void clear() noexcept { free(); }
+    iterator insert_after(const_iterator pos, T const& value) { return emplace_after(pos, value); }
+    iterator insert_after(const_iterator pos, T&& value) { return emplace_after(pos, std::move(value)); }
+    iterator insert_after(const_iterator pos, size_type count, T const& value);
+    template <class InputIt, typename = RequiresInputIterator<InputIt>>
+    iterator insert_after(const_iterator pos, InputIt first, InputIt last);
+
+    template <typename... Args>
+    iterator emplace_after(const_iterator pos, Args&&... args);
+
+    iterator erase_after(const_iterator pos);
+    iterator erase_after(const_iterator first, const_iterator last);
+
+    void push_front(T const& value) { emplace_before_first(&head_, Node_Capacity - 1, value); }
+    void push_front(T&& value) { emplace_before_first(&head_, Node_Capacity - 1, std::move(value)); }
+
+    template <typename... Args>
+    reference emplace_front(Args&&... args)
+    {
+        return *emplace_before_first(&head_, Node_Capacity - 1, std::forward<Args>(args)...);
+    }
+
+    void pop_front() { erase_after(before_cbegin()); }
+
+    void resize(size_type count);
+    void resize(size_type count, T const& value);
+
+    void swap(UnrolledList& other) noexcept;
+
+    template<typename U, typename Alloc, std::size_t Bytes>
+    friend void swap(UnrolledList<U, Alloc, Bytes>& lhs, UnrolledList<U, Alloc, Bytes>& rhs) noexcept;
+
+    // operations
+    void splice_after(const_iterator pos, UnrolledList& other);
+    void splice_after(const_iterator pos, UnrolledList&& other);
+    void splice_after(const_iterator pos, UnrolledList& other, const_iterator it);
+    void splice_after(const_iterator pos, UnrolledList& other, const_iterator first, const_iterator last);
+
+private:
+    static Node* as_node(NodeBase* node) noexcept { return static_cast<Node*>(node); }
+
+    static iterator node_begin(NodeBase* node) noexcept
+    {
+        return node != nullptr ? iterator{node, node->first} : iterator{};
+    }
+
+    Node* make_node()
+    {
+        return ::new (static_cast<void*>(nalloc_traits::allocate(nalloc_, 1))) Node;
+    }
+
+    // The node holds no objects any more
+    void release(Node* node) noexcept
+    {
+        node->~Node();
+        nalloc_traits::deallocate(nalloc_, node, 1);
+    }
+
+    void destroy(Node* node, std::size_t first, std::size_t last) noexcept
+    {
+        for (T* slot{node->slots() + first}; slot != node->slots() + last; ++slot) {
+            nalloc_traits::destroy(nalloc_, slot);
+        }
+    }
+
+    // Moves count elements into the slots starting at `to`, the ranges may overlap
+    void move_slots(T* to, T* from, std::size_t count) noexcept
+    {
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            if (count != 0) { std::memmove(static_cast<void*>(to), static_cast<void const*>(from), count * sizeof(T)); }
+        }
+        else if (to < from) {
+            for (std::size_t i{0}; i != count; ++i) { relocate(to + i, from + i); }
+        }
+        else {
+            for (std::size_t i{count}; i != 0; --i) { relocate(to + i - 1, from + i - 1); }
+        }
+    }
+
+    void relocate(T* to, T* from) noexcept
+    {
+        nalloc_traits::construct(nalloc_, to, std::move(*from));
+        nalloc_traits::destroy(nalloc_, from);
+    }
+
+    // Moves the elements from slot k on to the back of a new node following node
+    Node* split(Node* node, std::size_t k)
+    {
+        Node* const next{make_node()};
+        std::size_t const moved{node->last - k};
+        move_slots(next->slots() + Node_Capacity - moved, node->slots() + k, moved);
+        next->first = static_cast<std::uint16_t>(Node_Capacity - moved);
+        next->last = static_cast<std::uint16_t>(Node_Capacity);
+        node->last = static_cast<std::uint16_t>(k);
+        next->next = node->next;
+        node->next = next;
+        return next;
+    }
+
+    // Emplaces the element in front of the first element of the node following prev. Without a free
+    // slot there, it goes to `slot` of a new node following prev.
+    template<typename... Args>
+    iterator emplace_before_first(NodeBase* prev, std::size_t slot, Args&&... args);
+
+    void merge_next(Node* node) noexcept;
+
+    template<typename InputIt>
+    void append(InputIt first, InputIt last);
+
+    void free() noexcept
+    {
+        while (head_.next != nullptr) {
+            Node* const node{as_node(head_.next)};
+            head_.next = node->next;
+            destroy(node, node->first, node->last);
+            release(node);
+        }
+    }
+};
+
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+UnrolledList<T, Allocator, NodeBytes>::UnrolledList(size_type count, value_type const& value, Allocator const& alloc)
+    : UnrolledList{alloc}
+{
+    insert_after(before_cbegin(), count, value);
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+UnrolledList<T, Allocator, NodeBytes>::UnrolledList(size_type count, Allocator const& alloc)
+    : UnrolledList{alloc}
+{
+    resize(count);
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+template <typename InputIt, typename>
+UnrolledList<T, Allocator, NodeBytes>::UnrolledList(InputIt first, InputIt last, Allocator const& alloc)
+    : UnrolledList{alloc}
+{
+    append(first, last);
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+UnrolledList<T, Allocator, NodeBytes>::UnrolledList(std::initializer_list<value_type> il, Allocator const& alloc)
+    : UnrolledList{alloc}
+{
+    append(il.begin(), il.end());
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+UnrolledList<T, Allocator, NodeBytes>::UnrolledList(UnrolledList const& other)
+    : UnrolledList{Allocator{nalloc_traits::select_on_container_copy_construction(other.nalloc_)}}
+{
+    append(other.cbegin(), other.cend());
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+UnrolledList<T, Allocator, NodeBytes>::UnrolledList(UnrolledList&& other) noexcept
+    : nalloc_{std::move(other.nalloc_)}
+{
+    head_.next = std::exchange(other.head_.next, nullptr);
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+auto UnrolledList<T, Allocator, NodeBytes>::operator=(UnrolledList const& other) -> UnrolledList&
+{
+    if (this != &other) {
+        free();
+        append(other.cbegin(), other.cend());
+    }
+    return *this;
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+auto UnrolledList<T, Allocator, NodeBytes>::operator=(UnrolledList&& other) noexcept -> UnrolledList&
+{
+    if (this != &other) {
+        free();
+        if constexpr (nalloc_traits::propagate_on_container_move_assignment::value) {
+            nalloc_ = std::move(other.nalloc_);
+        }
+        head_.next = std::exchange(other.head_.next, nullptr);
+    }
+    return *this;
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+void UnrolledList<T, Allocator, NodeBytes>::swap(UnrolledList& other) noexcept
+{
+    using std::swap;
+    swap(head_.next, other.head_.next);
+    // if nalloc_traits::propagate_on_container_swap is false and the allocators don't compare
+    // equal, swapping is UB
+    SwapAllocators{}(nalloc_, other.nalloc_);
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+void swap(UnrolledList<T, Allocator, NodeBytes>& lhs, UnrolledList<T, Allocator, NodeBytes>& rhs) noexcept
+{
+    lhs.swap(rhs);
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+auto UnrolledList<T, Allocator, NodeBytes>::insert_after(const_iterator pos, size_type count, T const& value) -> iterator
+{
+    JAM_EXPECT(pos != cend(), "Can't insert after end iterator");
+    iterator it{pos.node_, pos.index_};
+    while (count-- != 0) { it = emplace_after(it, value); }
+    return it;
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+template <class InputIt, typename>
+auto UnrolledList<T, Allocator, NodeBytes>::insert_after(const_iterator pos, InputIt first, InputIt last) -> iterator
+{
+    JAM_EXPECT(pos != cend(), "Can't insert after end iterator");
+    iterator it{pos.node_, pos.index_};
+    for (; first != last; ++first) { it = emplace_after(it, *first); }
+    return it;
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+template <typename... Args>
+auto UnrolledList<T, Allocator, NodeBytes>::emplace_after(const_iterator pos, Args&&... args) -> iterator
+{
+    JAM_EXPECT(pos != cend(), "Can't insert after end iterator");
+    if (pos.node_ == &head_) { return emplace_before_first(&head_, Node_Capacity - 1, std::forward<Args>(args)...); }
+
+    Node* const node{as_node(pos.node_)};
+    std::size_t const k{pos.index_ + 1};
+    if (k == node->last) {
+        if (k != Node_Capacity) {
+            nalloc_traits::construct(nalloc_, node->slots() + k, std::forward<Args>(args)...);
+            ++node->last;
+            return iterator{node, k};
+        }
+        return emplace_before_first(node, 0, std::forward<Args>(args)...);
+    }
+
+    // The arguments may refer to one of the elements moved below
+    T value(std::forward<Args>(args)...);
+    if (node->last == Node_Capacity) { split(node, k); }
+    else { move_slots(node->slots() + k + 1, node->slots() + k, node->last - k); }
+    nalloc_traits::construct(nalloc_, node->slots() + k, std::move(value));
+    ++node->last;
+    return iterator{node, k};
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+template <typename... Args>
+auto UnrolledList<T, Allocator, NodeBytes>::emplace_before_first(NodeBase* prev, std::size_t slot, Args&&... args) -> iterator
+{
+    if (NodeBase* const next{prev->next}; next != nullptr && next->first != 0) {
+        nalloc_traits::construct(nalloc_, as_node(next)->slots() + next->first - 1, std::forward<Args>(args)...);
+        --next->first;
+        return iterator{next, next->first};
+    }
+    Node* const node{make_node()};
+    try {
+        nalloc_traits::construct(nalloc_, node->slots() + slot, std::forward<Args>(args)...);
+    }
+    catch (...) {
+        release(node);
+        throw;
+    }
+    node->first = static_cast<std::uint16_t>(slot);
+    node->last = static_cast<std::uint16_t>(slot + 1);
+    node->next = prev->next;
+    prev->next = node;
+    return iterator{node, slot};
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+auto UnrolledList<T, Allocator, NodeBytes>::erase_after(const_iterator pos) -> iterator
+{
+    if (pos == cend()) { return end(); }
+    NodeBase* const prev{pos.node_};
+    NodeBase* erased{prev};
+    std::size_t k{pos.index_ + 1};
+    if (prev == &head_ || k == prev->last) {
+        erased = prev->next;
+        if (erased == nullptr) { return end(); }
+        k = erased->first;
+    }
+
+    Node* const node{as_node(erased)};
+    nalloc_traits::destroy(nalloc_, node->slots() + k);
+    if (k == node->first) {
+        // The first element of its node - pos is the last element of the previous node
+        if (++node->first == node->last) {
+            prev->next = node->next;
+            release(node);
+            return node_begin(prev->next);
+        }
+        ++k;
+    }
+    else {
+        move_slots(node->slots() + k, node->slots() + k + 1, node->last - k - 1);
+        --node->last;
+    }
+    merge_next(node);
+    return k != node->last ? iterator{node, k} : node_begin(node->next);
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+auto UnrolledList<T, Allocator, NodeBytes>::erase_after(const_iterator first, const_iterator last) -> iterator
+{
+    NodeBase* const from_node{first.node_};
+    NodeBase* const to_node{last.node_};
+    std::size_t const from{first.index_ + 1};
+    std::size_t const to{last.index_};
+
+    if (from_node == to_node) {
+        if (from >= to) { return iterator{to_node, to}; }
+        Node* const node{as_node(from_node)};
+        destroy(node, from, to);
+        move_slots(node->slots() + from, node->slots() + to, node->last - to);
+        node->last = static_cast<std::uint16_t>(node->last - (to - from));
+        merge_next(node);
+        return from != node->last ? iterator{node, from} : node_begin(node->next);
+    }
+
+    // The tail of the first node, the nodes in between and the front of the last node
+    if (from_node != &head_) {
+        destroy(as_node(from_node), from, from_node->last);
+        from_node->last = static_cast<std::uint16_t>(from);
+    }
+    for (NodeBase* node{from_node->next}; node != to_node;) {
+        Node* const erased{as_node(node)};
+        node = node->next;
+        destroy(erased, erased->first, erased->last);
+        release(erased);
+    }
+    from_node->next = to_node;
+    if (to_node == nullptr) { return end(); }
+    destroy(as_node(to_node), to_node->first, to);
+    to_node->first = static_cast<std::uint16_t>(to);
+    return iterator{to_node, to};
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+void UnrolledList<T, Allocator, NodeBytes>::merge_next(Node* node) noexcept
+{
+    NodeBase* const next{node->next};
+    if (next == nullptr || static_cast<std::size_t>(node->last - node->first) >= Merge_Threshold) { return; }
+    std::size_t const count{static_cast<std::size_t>(next->last - next->first)};
+    if (count > Node_Capacity - node->last) { return; }
+    move_slots(node->slots() + node->last, as_node(next)->slots() + next->first, count);
+    node->last = static_cast<std::uint16_t>(node->last + count);
+    node->next = next->next;
+    release(as_node(next));
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+void UnrolledList<T, Allocator, NodeBytes>::resize(size_type count)
+{
+    auto before_it{before_begin()};
+    while (count != 0 && std::next(before_it) != end()) {
+        ++before_it;
+        --count;
+    }
+    if (count == 0) { erase_after(before_it, cend()); }
+    else {
+        while (count-- != 0) { before_it = emplace_after(before_it); }
+    }
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+void UnrolledList<T, Allocator, NodeBytes>::resize(size_type count, T const& value)
+{
+    auto before_it{before_begin()};
+    while (count != 0 && std::next(before_it) != end()) {
+        ++before_it;
+        --count;
+    }
+    if (count == 0) { erase_after(before_it, cend()); }
+    else { insert_after(before_it, count, value); }
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+void UnrolledList<T, Allocator, NodeBytes>::splice_after(const_iterator pos, UnrolledList& other)
+{
+    splice_after(pos, other, other.before_cbegin(), other.cend());
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+void UnrolledList<T, Allocator, NodeBytes>::splice_after(const_iterator pos, UnrolledList&& other)
+{
+    splice_after(pos, other, other.before_cbegin(), other.cend());
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+void UnrolledList<T, Allocator, NodeBytes>::splice_after(const_iterator pos, UnrolledList& other, const_iterator it)
+{
+    JAM_EXPECT(&other != this, "Can't splice from the list itself");
+    auto const spliced{std::next(it)};
+    JAM_EXPECT(spliced != other.cend(), "Can't splice the element after the last element");
+    // A single element is moved rather than cut out of its node
+    emplace_after(pos, std::move(*iterator{spliced.node_, spliced.index_}));
+    other.erase_after(it);
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+void UnrolledList<T, Allocator, NodeBytes>::splice_after(const_iterator pos, UnrolledList& other,
+                                                         const_iterator first, const_iterator last)
+{
+    JAM_EXPECT(&other != this, "Can't splice from the list itself");
+    JAM_EXPECT(nalloc_ == other.nalloc_, "Can't splice between lists with different allocators");
+    if (first == last || std::next(first) == last) { return; }
+
+    // Splitting the nodes at the ends of the range turns it into a chain of whole nodes, the
+    // elements stay in their lists until all the allocations succeeded
+    NodeBase* const from_node{first.node_};
+    NodeBase* to_node{last.node_};
+    std::size_t to{last.index_};
+    if (from_node != &other.head_ && first.index_ + 1 != from_node->last) {
+        Node* const tail{other.split(as_node(from_node), first.index_ + 1)};
+        if (to_node == from_node) {
+            to = to - (first.index_ + 1) + tail->first;
+            to_node = tail;
+        }
+    }
+    NodeBase* chain_last{nullptr};
+    if (to_node != nullptr && to != to_node->first) {
+        other.split(as_node(to_node), to);
+        chain_last = to_node;
+        to_node = to_node->next;
+    }
+    else {
+        chain_last = from_node->next;
+        while (chain_last->next != to_node) { chain_last = chain_last->next; }
+    }
+    if (pos.node_ != &head_ && pos.index_ + 1 != pos.node_->last) { split(as_node(pos.node_), pos.index_ + 1); }
+
+    NodeBase* const chain_first{from_node->next};
+    from_node->next = to_node;
+    chain_last->next = pos.node_->next;
+    pos.node_->next = chain_first;
+}
+
+template<typename T, typename Allocator, std::size_t NodeBytes>
+template<typename InputIt>
+void UnrolledList<T, Allocator, NodeBytes>::append(InputIt first, InputIt last)
+{
+    JAM_EXPECT(empty(), "Appends to an empty list only");
+    iterator it{before_begin()};
+    for (; first != last; ++first) { it = emplace_after(it, *first); }
+}
+
+// Iterators
+template<typename T, std::size_t Capacity, bool IsConst> class ULL_IteratorImpl
+{
+    template<typename, typename, std::size_t> friend class UnrolledList;
+    friend class ULL_IteratorImpl<T, Capacity, !IsConst>;
+    using Node = ULL_Node<T, Capacity>;
+    using self = ULL_IteratorImpl<T, Capacity, IsConst>;
+
+    ULL_NodeBase* node_{nullptr};
+    std::size_t index_{0};
+
+    explicit ULL_IteratorImpl(ULL_NodeBase* node, std::size_t index) noexcept
+        : node_{node}, index_{index} {}
+public:
+    using value_type = std::conditional_t<IsConst, const T, T>;
+    using reference = value_type&;
+    using pointer = value_type*;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+    using const_iterator = ULL_IteratorImpl<T, Capacity, true>;
+
+    ULL_IteratorImpl() noexcept = default;
+
+    pointer operator->() const noexcept { return static_cast<Node*>(node_)->slots() + index_; }
+
+    reference operator*() const noexcept { return static_cast<Node*>(node_)->slots()[index_]; }
+
+    self& operator++() noexcept
+    {
+        // The head has no slots - before_begin() moves on to the first node too
+        if (++index_ >= node_->last) {
+            node_ = node_->next;
+            index_ = node_ != nullptr ? node_->first : 0;
+        }
+        return *this;
+    }
+
+    self operator++(int) noexcept
+    {
+        auto result{*this};
+        ++*this;
+        return result;
+    }
+
+    operator const_iterator() const noexcept { return const_iterator{node_, index_}; }
+
+    friend bool operator==(self const& lhs, self const& rhs) noexcept
+    {
+        return lhs.node_ == rhs.node_ && lhs.index_ == rhs.index_;
+    }
+    friend bool operator!=(self const& lhs, self const& rhs) noexcept { return !(lhs == rhs); }
+};
+
+#endif  // DATA_STRUCTURES_UNROLLED_LIST_HPP
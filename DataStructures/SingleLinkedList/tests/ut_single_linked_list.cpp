@@ -1,8 +1,12 @@
 #include <gtest/gtest.h>
 
 #include <single_linked_list/single_linked_list.hpp>
+#include <utils/node_pool.h>
 
+#include <functional>
 #include <iostream>
+#include <numeric>
+#include <stdexcept>
 #include <forward_list>
 #include <algorithm>
 #include <array>
@@ -683,4 +687,122 @@ TEST(SingleLinkedListSortTest, sort_orders_elements_according_to_predicate_singl
     ASSERT_EQ(init_size, after_sort_pred_size);
 }
 
+// Sorts by the key only - the tag tells equal keys apart
+struct Keyed {
+    int key;
+    int tag;
+
+    bool operator==(Keyed const& other) const noexcept { return key == other.key && tag == other.tag; }
+};
+
+std::vector<Keyed> keyed_elements(std::size_t count, int keys, unsigned seed)
+{
+    std::mt19937 gen{seed};
+    std::uniform_int_distribution<int> key{0, keys - 1};
+    std::vector<Keyed> result{};
+    for (std::size_t i{0}; i != count; ++i) { result.push_back({key(gen), static_cast<int>(i)}); }
+    return result;
+}
+
+auto const by_key{[](Keyed const& lhs, Keyed const& rhs) noexcept { return lhs.key < rhs.key; }};
+
+class SingleLinkedListStableSortTest : public ::testing::TestWithParam<std::size_t>
+{
+};
+
+TEST_P(SingleLinkedListStableSortTest, sort_is_stable)
+{
+    for (int const keys : {2, 100, 1 << 20}) {
+        auto expected{keyed_elements(GetParam(), keys, 42)};
+        SingleLinkedList<Keyed> sut{expected.cbegin(), expected.cend()};
+        SingleLinkedList<Keyed> buffered{sut};
+        std::stable_sort(expected.begin(), expected.end(), by_key);
+
+        sut.sort(by_key);
+        ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), expected.cbegin(), expected.cend())) << keys;
+        buffered.sort(by_key, SLL_Sort_Buffered);
+        ASSERT_TRUE(std::equal(buffered.cbegin(), buffered.cend(), expected.cbegin(), expected.cend())) << keys;
+    }
+}
+
+TEST_P(SingleLinkedListStableSortTest, sort_takes_sorted_and_reversed_input)
+{
+    std::vector<int> expected(GetParam());
+    std::iota(expected.begin(), expected.end(), 0);
+    SingleLinkedList<int> sorted{expected.cbegin(), expected.cend()};
+    SingleLinkedList<int> reversed{expected.crbegin(), expected.crend()};
+
+    sorted.sort();
+    ASSERT_TRUE(std::equal(sorted.cbegin(), sorted.cend(), expected.cbegin(), expected.cend()));
+    reversed.sort();
+    ASSERT_TRUE(std::equal(reversed.cbegin(), reversed.cend(), expected.cbegin(), expected.cend()));
+    reversed.sort(std::greater<>{}, SLL_Sort_Buffered);
+    ASSERT_TRUE(std::equal(reversed.cbegin(), reversed.cend(), expected.crbegin(), expected.crend()));
+}
+
+INSTANTIATE_TEST_CASE_P(StableSortTest, SingleLinkedListStableSortTest,
+    ::testing::Values(1, 2, 3, 63, 64, 65, 1000, 100000)
+);
+
+TEST(SingleLinkedListSortTest, throwing_comparison_keeps_all_elements)
+{
+    auto const elements{keyed_elements(1000, 1000, 7)};
+    for (int const throw_at : {0, 10, 900, 5000}) {
+        SingleLinkedList<Keyed> sut{elements.cbegin(), elements.cend()};
+        int calls{0};
+        auto const throwing{[&calls, throw_at](Keyed const& lhs, Keyed const& rhs) {
+            if (calls++ == throw_at) { throw std::runtime_error{"compare"}; }
+            return lhs.key < rhs.key;
+        }};
+        ASSERT_THROW(sut.sort(throwing), std::runtime_error);
+
+        std::vector<int> tags{};
+        for (auto const& element : sut) { tags.push_back(element.tag); }
+        std::sort(tags.begin(), tags.end());
+        std::vector<int> expected(elements.size());
+        std::iota(expected.begin(), expected.end(), 0);
+        ASSERT_EQ(tags, expected) << throw_at;
+    }
+}
+
+TEST(SingleLinkedListMergeTest, merge_is_stable)
+{
+    std::vector<Keyed> const lhs{{0, 0}, {1, 1}, {1, 2}, {3, 3}};
+    std::vector<Keyed> const rhs{{1, 10}, {1, 11}, {2, 12}, {3, 13}};
+    SingleLinkedList<Keyed> sut{lhs.cbegin(), lhs.cend()};
+    SingleLinkedList<Keyed> other{rhs.cbegin(), rhs.cend()};
+
+    sut.merge(other, by_key);
+    std::vector<Keyed> const expected{{0, 0}, {1, 1}, {1, 2}, {1, 10}, {1, 11}, {2, 12}, {3, 3}, {3, 13}};
+    ASSERT_TRUE(other.empty());
+    ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), expected.cbegin(), expected.cend()));
+
+    sut.merge(sut, by_key);
+    ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), expected.cbegin(), expected.cend()));
+}
+
+TEST(SingleLinkedListRemoveTest, remove_takes_an_element_of_the_list)
+{
+    std::array<std::string, 5> const elements{"a", "b", "a", "c", "a"};
+    SingleLinkedList<std::string> sut{elements.cbegin(), elements.cend()};
+    ASSERT_EQ(sut.remove(sut.front()), 3u);
+    std::array<std::string, 2> const expected{"b", "c"};
+    ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), expected.cbegin(), expected.cend()));
+}
+
+TEST(SingleLinkedListPoolAllocatorTest, nodes_come_from_the_node_pool)
+{
+    SingleLinkedList<std::string, PoolAllocator<std::string>> sut{};
+    for (int round{0}; round != 3; ++round) {
+        for (int i{0}; i != 1000; ++i) {
+            sut.push_front(std::to_string(i));
+        }
+        ASSERT_EQ(sut.front(), "999");
+        auto copy{sut};
+        while (!sut.empty()) { sut.pop_front(); }
+        ASSERT_EQ(copy.front(), "999");
+    }
+    ASSERT_TRUE(sut.empty());
+}
+
 } // namespace
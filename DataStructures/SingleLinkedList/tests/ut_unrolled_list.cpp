@@ -0,0 +1,349 @@
+#include <gtest/gtest.h>
+
+#include <single_linked_list/unrolled_list.hpp>
+#include <utils/node_pool.h>
+
+#include <cstdint>
+#include <forward_list>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// Eight ints per node - a few dozen elements span several nodes
+template<typename T>
+using SmallUnrolledList = UnrolledList<T, std::allocator<T>, 48>;
+
+template<typename List>
+std::vector<typename List::value_type> elements(List const& list)
+{
+    return {list.cbegin(), list.cend()};
+}
+
+std::vector<int> iota(int first, int last)
+{
+    std::vector<int> result{};
+    for (int i{first}; i != last; ++i) { result.push_back(i); }
+    return result;
+}
+
+SmallUnrolledList<int> iota_list(int first, int last)
+{
+    auto const values{iota(first, last)};
+    return SmallUnrolledList<int>{values.cbegin(), values.cend()};
+}
+
+TEST(UnrolledListTest, default_constructed_list_is_empty)
+{
+    UnrolledList<int> sut{};
+    ASSERT_TRUE(sut.empty());
+    ASSERT_EQ(sut.cbegin(), sut.cend());
+    ASSERT_EQ(std::next(sut.before_cbegin()), sut.cend());
+}
+
+TEST(UnrolledListTest, nodes_fit_in_node_bytes)
+{
+    using Sut = UnrolledList<std::uint64_t>;
+    ASSERT_EQ(Sut::Node_Capacity, 14u);
+    ASSERT_EQ(sizeof(ULL_Node<std::uint64_t, Sut::Node_Capacity>), 128u);
+    ASSERT_EQ(SmallUnrolledList<int>::Node_Capacity, 8u);
+    ASSERT_EQ(SmallUnrolledList<std::string>::Node_Capacity, 2u);
+}
+
+TEST(UnrolledListTest, constructors_hold_the_elements_in_order)
+{
+    std::vector<int> const expected{iota(0, 50)};
+    SmallUnrolledList<int> const range{expected.cbegin(), expected.cend()};
+    ASSERT_EQ(elements(range), expected);
+
+    SmallUnrolledList<int> const il{1, 2, 3};
+    ASSERT_EQ(elements(il), (std::vector<int>{1, 2, 3}));
+
+    SmallUnrolledList<int> const count(20, 7);
+    ASSERT_EQ(elements(count), std::vector<int>(20, 7));
+
+    SmallUnrolledList<int> const defaulted(17);
+    ASSERT_EQ(elements(defaulted), std::vector<int>(17, 0));
+}
+
+TEST(UnrolledListTest, copies_moves_and_swaps_carry_the_elements)
+{
+    std::vector<int> const expected{iota(0, 30)};
+    SmallUnrolledList<int> sut{expected.cbegin(), expected.cend()};
+
+    SmallUnrolledList<int> copy{sut};
+    ASSERT_EQ(elements(copy), expected);
+
+    SmallUnrolledList<int> moved{std::move(copy)};
+    ASSERT_EQ(elements(moved), expected);
+    ASSERT_TRUE(copy.empty());
+
+    SmallUnrolledList<int> other{100};
+    other.swap(moved);
+    ASSERT_EQ(elements(other), expected);
+    ASSERT_EQ(elements(moved), std::vector<int>{100});
+
+    moved = other;
+    ASSERT_EQ(elements(moved), expected);
+    other.clear();
+    ASSERT_TRUE(other.empty());
+    other = std::move(moved);
+    ASSERT_EQ(elements(other), expected);
+}
+
+TEST(UnrolledListInsertTest, push_front_moves_no_element)
+{
+    SmallUnrolledList<std::string> sut{};
+    std::vector<std::string const*> addresses{};
+    for (int i{0}; i != 20; ++i) {
+        sut.push_front(std::to_string(i));
+        addresses.push_back(&sut.front());
+    }
+    sut.emplace_front("front");
+
+    int i{19};
+    for (auto it{std::next(sut.cbegin())}; it != sut.cend(); ++it, --i) {
+        ASSERT_EQ(*it, std::to_string(i));
+        ASSERT_EQ(&*it, addresses[static_cast<std::size_t>(i)]);
+    }
+}
+
+TEST(UnrolledListInsertTest, insert_after_keeps_pos_and_the_elements_before_it)
+{
+    SmallUnrolledList<int> sut{0, 1, 2, 3, 4, 5, 6, 7};
+    std::vector<int const*> addresses{};
+    for (auto const& value : sut) { addresses.push_back(&value); }
+
+    // The node is full - the elements after pos move to a new node
+    auto const pos{std::next(sut.cbegin(), 3)};
+    auto const it{sut.insert_after(pos, 42)};
+    ASSERT_EQ(*it, 42);
+    ASSERT_EQ(&*pos, addresses[3]);
+    auto element{sut.cbegin()};
+    for (std::size_t i{0}; i != 4; ++i, ++element) { ASSERT_EQ(&*element, addresses[i]); }
+    ASSERT_EQ(elements(sut), (std::vector<int>{0, 1, 2, 3, 42, 4, 5, 6, 7}));
+
+    // Now the node has room - the elements after pos move one slot back
+    auto const it2{sut.insert_after(pos, 41)};
+    ASSERT_EQ(*it2, 41);
+    ASSERT_EQ(&*pos, addresses[3]);
+    ASSERT_EQ(elements(sut), (std::vector<int>{0, 1, 2, 3, 41, 42, 4, 5, 6, 7}));
+}
+
+TEST(UnrolledListInsertTest, insert_after_the_last_element_appends)
+{
+    SmallUnrolledList<int> sut{};
+    auto it{sut.before_begin()};
+    for (int i{0}; i != 40; ++i) {
+        it = sut.insert_after(it, i);
+        ASSERT_EQ(*it, i);
+    }
+    ASSERT_EQ(elements(sut), iota(0, 40));
+}
+
+TEST(UnrolledListInsertTest, insert_after_count_and_range_return_the_last_inserted_element)
+{
+    SmallUnrolledList<int> sut{1, 2};
+    auto const it{sut.insert_after(sut.cbegin(), 10, 9)};
+    ASSERT_EQ(std::next(it), std::next(sut.cbegin(), 11));
+    ASSERT_EQ(sut.insert_after(it, 0, 5), it);
+
+    std::vector<int> const range{20, 21, 22};
+    auto const it2{sut.insert_after(it, range.cbegin(), range.cend())};
+    ASSERT_EQ(*it2, 22);
+    ASSERT_EQ(*std::next(it2), 2);
+    ASSERT_EQ(std::distance(sut.cbegin(), sut.cend()), 15);
+}
+
+TEST(UnrolledListInsertTest, emplace_after_may_take_an_element_of_the_list)
+{
+    SmallUnrolledList<std::string> sut{"a", "b", "c", "d"};
+    auto const pos{sut.cbegin()};
+    sut.emplace_after(pos, *std::next(pos));
+    ASSERT_EQ(elements(sut), (std::vector<std::string>{"a", "b", "b", "c", "d"}));
+}
+
+class UnrolledListEraseTest : public ::testing::Test
+{
+protected:
+    SmallUnrolledList<int> sut_{iota_list(0, 40)};
+};
+
+TEST_F(UnrolledListEraseTest, erase_after_returns_the_next_element)
+{
+    // Every other element, across all nodes
+    for (auto it{sut_.cbegin()}; it != sut_.cend();) {
+        auto const next{sut_.erase_after(it)};
+        if (next == sut_.end()) { break; }
+        ASSERT_EQ(*next, *it + 2);
+        it = next;
+    }
+    std::vector<int> expected{};
+    for (int i{0}; i < 40; i += 2) { expected.push_back(i); }
+    ASSERT_EQ(elements(sut_), expected);
+
+    ASSERT_EQ(sut_.erase_after(sut_.cend()), sut_.end());
+    ASSERT_EQ(sut_.erase_after(std::next(sut_.cbegin(), 19)), sut_.end());
+}
+
+TEST_F(UnrolledListEraseTest, pop_front_erases_all_elements)
+{
+    for (int i{0}; i != 40; ++i) {
+        ASSERT_EQ(sut_.front(), i);
+        sut_.pop_front();
+    }
+    ASSERT_TRUE(sut_.empty());
+    sut_.pop_front();
+    ASSERT_TRUE(sut_.empty());
+}
+
+TEST_F(UnrolledListEraseTest, erase_after_range_within_a_node)
+{
+    auto const next{sut_.erase_after(std::next(sut_.cbegin()), std::next(sut_.cbegin(), 5))};
+    ASSERT_EQ(*next, 5);
+    auto expected{iota(0, 40)};
+    expected.erase(expected.begin() + 2, expected.begin() + 5);
+    ASSERT_EQ(elements(sut_), expected);
+
+    auto const same{std::next(sut_.cbegin(), 3)};
+    ASSERT_EQ(sut_.erase_after(same, std::next(same)), std::next(same));
+}
+
+TEST_F(UnrolledListEraseTest, erase_after_range_across_nodes)
+{
+    auto const last{std::next(sut_.cbegin(), 30)};
+    auto const next{sut_.erase_after(std::next(sut_.cbegin(), 4), last)};
+    ASSERT_EQ(next, last);
+    ASSERT_EQ(*next, 30);
+    auto expected{iota(0, 40)};
+    expected.erase(expected.begin() + 5, expected.begin() + 30);
+    ASSERT_EQ(elements(sut_), expected);
+
+    ASSERT_EQ(sut_.erase_after(sut_.before_cbegin(), sut_.cend()), sut_.end());
+    ASSERT_TRUE(sut_.empty());
+}
+
+TEST_F(UnrolledListEraseTest, resize_erases_or_appends_elements)
+{
+    sut_.resize(10);
+    ASSERT_EQ(elements(sut_), iota(0, 10));
+    sut_.resize(12, 5);
+    auto expected{iota(0, 10)};
+    expected.insert(expected.end(), {5, 5});
+    ASSERT_EQ(elements(sut_), expected);
+    sut_.resize(0);
+    ASSERT_TRUE(sut_.empty());
+}
+
+TEST(UnrolledListSpliceTest, splice_after_moves_the_whole_list)
+{
+    SmallUnrolledList<int> sut{iota_list(0, 20)};
+    SmallUnrolledList<int> other{iota_list(100, 130)};
+
+    sut.splice_after(std::next(sut.cbegin(), 9), other);
+    ASSERT_TRUE(other.empty());
+    auto expected{iota(0, 20)};
+    auto const spliced{iota(100, 130)};
+    expected.insert(expected.begin() + 10, spliced.cbegin(), spliced.cend());
+    ASSERT_EQ(elements(sut), expected);
+
+    sut.splice_after(sut.before_cbegin(), SmallUnrolledList<int>{-2, -1});
+    ASSERT_EQ(sut.front(), -2);
+}
+
+TEST(UnrolledListSpliceTest, splice_after_moves_one_element)
+{
+    SmallUnrolledList<int> sut{1, 2, 3};
+    SmallUnrolledList<int> other{10, 20, 30};
+    sut.splice_after(sut.cbegin(), other, other.cbegin());
+    ASSERT_EQ(elements(sut), (std::vector<int>{1, 20, 2, 3}));
+    ASSERT_EQ(elements(other), (std::vector<int>{10, 30}));
+}
+
+TEST(UnrolledListSpliceTest, splice_after_moves_a_range)
+{
+    for (int first{-1}; first != 40; ++first) {
+        for (int last{first + 1}; last <= 40; ++last) {
+            SmallUnrolledList<int> sut{iota_list(0, 10)};
+            SmallUnrolledList<int> other{iota_list(100, 140)};
+            auto const range_first{std::next(other.before_cbegin(), first + 1)};
+            auto const range_last{std::next(other.before_cbegin(), last + 1)};
+            sut.splice_after(std::next(sut.cbegin(), 4), other, range_first, range_last);
+
+            auto expected{iota(0, 10)};
+            auto expected_other{iota(100, 140)};
+            expected.insert(expected.begin() + 5, expected_other.begin() + first + 1, expected_other.begin() + last);
+            expected_other.erase(expected_other.begin() + first + 1, expected_other.begin() + last);
+            ASSERT_EQ(elements(sut), expected) << first << ' ' << last;
+            ASSERT_EQ(elements(other), expected_other) << first << ' ' << last;
+        }
+    }
+}
+
+// Random modifications against std::forward_list - splits, merges and empty nodes at any position
+TEST(UnrolledListRandomTest, random_modifications_match_std_forward_list)
+{
+    SmallUnrolledList<int> sut{};
+    std::forward_list<int> expected{};
+    std::size_t size{0};
+    std::mt19937 gen{42};
+
+    for (int round{0}; round != 20000; ++round) {
+        std::size_t const offset{size != 0 ? gen() % (size + 1) : 0};
+        auto const pos{std::next(sut.before_cbegin(), static_cast<std::ptrdiff_t>(offset))};
+        auto const expected_pos{std::next(expected.cbefore_begin(), static_cast<std::ptrdiff_t>(offset))};
+        switch (gen() % 6) {
+        case 0:
+        case 1: {
+            auto const it{sut.insert_after(pos, round)};
+            expected.insert_after(expected_pos, round);
+            ASSERT_EQ(*it, round);
+            ++size;
+            break;
+        }
+        case 2:
+            sut.push_front(round);
+            expected.push_front(round);
+            ++size;
+            break;
+        case 3:
+            if (offset != size) {
+                auto const next{sut.erase_after(pos)};
+                auto const expected_next{expected.erase_after(expected_pos)};
+                ASSERT_EQ(next == sut.end(), expected_next == expected.end());
+                if (next != sut.end()) { ASSERT_EQ(*next, *expected_next); }
+                --size;
+            }
+            break;
+        case 4: {
+            std::size_t const count{std::min<std::size_t>(gen() % 20, size - offset)};
+            auto const distance{static_cast<std::ptrdiff_t>(count) + 1};
+            sut.erase_after(pos, std::next(pos, distance));
+            expected.erase_after(expected_pos, std::next(expected_pos, distance));
+            size -= count;
+            break;
+        }
+        default:
+            sut.pop_front();
+            if (!expected.empty()) {
+                expected.pop_front();
+                --size;
+            }
+            break;
+        }
+        ASSERT_TRUE(std::equal(sut.cbegin(), sut.cend(), expected.cbegin(), expected.cend())) << round;
+    }
+}
+
+TEST(UnrolledListPoolAllocatorTest, nodes_come_from_the_node_pool)
+{
+    UnrolledList<int, PoolAllocator<int>> sut{};
+    for (int i{0}; i != 1000; ++i) { sut.push_front(i); }
+    sut.erase_after(std::next(sut.cbegin(), 10), sut.cend());
+    ASSERT_EQ(std::distance(sut.cbegin(), sut.cend()), 11);
+}
+
+} // namespace
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include <utils/node_pool.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct alignas(32) Aligned {
+    char data[40];
+};
+
+TEST(NodePoolTest, blocks_are_large_enough_and_aligned)
+{
+    static_assert(NodePool<1, 1>::Block_Size == sizeof(void*));
+    static_assert(NodePool<sizeof(Aligned), alignof(Aligned)>::Block_Size == 64);
+    PoolAllocator<Aligned> alloc{};
+    std::vector<Aligned*> blocks{};
+    for (int i{0}; i != 1000; ++i) {
+        auto* const p{alloc.allocate(1)};
+        ASSERT_EQ(reinterpret_cast<std::uintptr_t>(p) % alignof(Aligned), 0u);
+        blocks.push_back(p);
+    }
+    std::sort(blocks.begin(), blocks.end());
+    ASSERT_EQ(std::adjacent_find(blocks.begin(), blocks.end()), blocks.end());
+    for (auto* const p : blocks) { alloc.deallocate(p, 1); }
+}
+
+TEST(NodePoolTest, freed_blocks_are_reused)
+{
+    using Pool = NodePool<24, 8>;
+    auto& pool{Pool::instance()};
+    std::vector<void*> blocks(Pool::Blocks_Per_Chunk);
+    for (auto& p : blocks) { p = pool.allocate(); }
+    auto const chunks{pool.chunk_count()};
+    std::set<void*> const first_round(blocks.cbegin(), blocks.cend());
+    for (int round{0}; round != 10; ++round) {
+        for (auto* const p : blocks) { pool.deallocate(p); }
+        for (auto& p : blocks) {
+            p = pool.allocate();
+            ASSERT_EQ(first_round.count(p), 1u);
+        }
+    }
+    ASSERT_EQ(pool.chunk_count(), chunks);
+    for (auto* const p : blocks) { pool.deallocate(p); }
+}
+
+TEST(NodePoolTest, blocks_freed_by_other_threads_and_exiting_threads_are_reused)
+{
+    using Pool = NodePool<48, 16>;
+    auto& pool{Pool::instance()};
+    std::vector<void*> blocks(4 * Pool::Blocks_Per_Chunk);
+    for (auto& p : blocks) { p = pool.allocate(); }
+    auto const chunks{pool.chunk_count()};
+    // Freed in one thread, the cache flushed to the shared list as it exits
+    std::thread{[&pool, &blocks] {
+        for (auto* const p : blocks) { pool.deallocate(p); }
+    }}.join();
+    std::vector<std::thread> threads{};
+    for (int t{0}; t != 4; ++t) {
+        threads.emplace_back([&pool] {
+            std::vector<void*> local(Pool::Blocks_Per_Chunk / 2);
+            for (auto& p : local) { p = pool.allocate(); }
+            for (auto* const p : local) { pool.deallocate(p); }
+        });
+    }
+    for (auto& thread : threads) { thread.join(); }
+    ASSERT_EQ(pool.chunk_count(), chunks);
+}
+
+TEST(NodePoolTest, arrays_bypass_the_pool)
+{
+    PoolAllocator<std::uint64_t> alloc{};
+    auto* const array{alloc.allocate(100)};
+    std::fill_n(array, 100, std::uint64_t{42});
+    alloc.deallocate(array, 100);
+    ASSERT_EQ(PoolAllocator<int>{}, PoolAllocator<double>{});
+}
+
+}  // namespace
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+#include "Assertion.h"
+
+// Fixed size block pool for the nodes of the node based containers. Blocks are carved out of 64KiB
+// chunks and recycled through free lists, they are never returned to the system - a container
+// churning through inserts and erases reuses the same blocks instead of fragmenting the heap.
+//
+// Every thread keeps a cache of free blocks and exchanges them with the shared free list in
+// batches, so allocations and deallocations only lock the pool once every Batch_Size calls. A
+// block may be freed by another thread than the one that allocated it.
+//
+// There is one pool per block size and alignment, it lives until the program exits - nodes of
+// containers with static storage duration are deallocated safely during the shutdown.
+template<std::size_t Size, std::size_t Align>
+class NodePool {
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    static constexpr std::size_t Alignment{std::max(Align, alignof(FreeBlock))};
+    static constexpr std::size_t Chunk_Size{std::size_t{1} << 16};
+    static constexpr std::size_t Batch_Size{64};
+
+public:
+    static constexpr std::size_t Block_Size{(std::max(Size, sizeof(FreeBlock)) + Alignment - 1) / Alignment * Alignment};
+    static constexpr std::size_t Blocks_Per_Chunk{std::max(Chunk_Size / Block_Size, std::size_t{1})};
+
+    static NodePool& instance()
+    {
+        // Never destroyed - see above
+        static NodePool* const pool{new NodePool{}};
+        return *pool;
+    }
+
+    NodePool(NodePool const&) = delete;
+    NodePool& operator=(NodePool const&) = delete;
+
+    void* allocate()
+    {
+        auto& cache{thread_cache()};
+        if (JAM_UNLIKELY(cache.exited)) { return allocate_shared(); }
+        if (cache.head == nullptr) { refill(cache); }
+        FreeBlock* const block{cache.head};
+        cache.head = block->next;
+        --cache.count;
+        return block;
+    }
+
+    void deallocate(void* p) noexcept
+    {
+        auto& cache{thread_cache()};
+        auto* const block{static_cast<FreeBlock*>(p)};
+        if (JAM_UNLIKELY(cache.exited)) {
+            std::lock_guard lock{mutex_};
+            block->next = free_;
+            free_ = block;
+            return;
+        }
+        block->next = cache.head;
+        cache.head = block;
+        if (++cache.count >= 2 * Batch_Size) { flush(cache, Batch_Size); }
+    }
+
+    // Chunks allocated so far - the pool never shrinks
+    std::size_t chunk_count() const
+    {
+        std::lock_guard lock{mutex_};
+        return chunk_count_;
+    }
+
+private:
+    struct Chunk {
+        Chunk* next;
+    };
+
+    // Trivially destructible - stays usable after the owner has flushed it at the thread exit, the
+    // containers destroyed after that bypass the cache
+    struct Cache {
+        FreeBlock* head;
+        std::size_t count;
+        bool exited;
+    };
+
+    // The blocks of an exiting thread go back to the shared free list
+    struct CacheOwner {
+        Cache& cache;
+
+        ~CacheOwner() noexcept
+        {
+            NodePool::instance().flush(cache, cache.count);
+            cache.exited = true;
+        }
+    };
+
+    NodePool() noexcept = default;
+    ~NodePool() noexcept = default;
+
+    static Cache& thread_cache() noexcept
+    {
+        thread_local Cache cache{nullptr, 0, false};
+        thread_local CacheOwner const owner{cache};
+        return cache;
+    }
+
+    void* allocate_shared()
+    {
+        Cache single{nullptr, 0, false};
+        refill(single);
+        FreeBlock* const block{single.head};
+        single.head = block->next;
+        --single.count;
+        flush(single, single.count);
+        return block;
+    }
+
+    // Moves a batch of free blocks into the cache, carving them from a new chunk if the shared
+    // free list runs out
+    void refill(Cache& cache)
+    {
+        std::lock_guard lock{mutex_};
+        while (free_ != nullptr && cache.count != Batch_Size) {
+            FreeBlock* const block{free_};
+            free_ = block->next;
+            block->next = cache.head;
+            cache.head = block;
+            ++cache.count;
+        }
+        if (cache.count != 0) { return; }
+        if (bump_ == bump_end_) { new_chunk(); }
+        auto const blocks{std::min(Batch_Size, static_cast<std::size_t>(bump_end_ - bump_) / Block_Size)};
+        for (std::size_t i{0}; i != blocks; ++i) {
+            auto* const block{reinterpret_cast<FreeBlock*>(bump_)};
+            bump_ += Block_Size;
+            block->next = cache.head;
+            cache.head = block;
+        }
+        cache.count = blocks;
+    }
+
+    void flush(Cache& cache, std::size_t count) noexcept
+    {
+        if (count == 0) { return; }
+        // Detach `count` blocks from the front of the cache, then splice them under the lock
+        FreeBlock* const first{cache.head};
+        FreeBlock* last{first};
+        for (std::size_t i{1}; i != count; ++i) { last = last->next; }
+        cache.head = last->next;
+        cache.count -= count;
+        std::lock_guard lock{mutex_};
+        last->next = free_;
+        free_ = first;
+    }
+
+    void new_chunk()
+    {
+        // The chunk header takes the first block, the block size keeps the blocks aligned
+        constexpr std::size_t header{(sizeof(Chunk) + Alignment - 1) / Alignment * Alignment};
+        auto* const memory{static_cast<std::byte*>(
+            ::operator new(header + Blocks_Per_Chunk * Block_Size, std::align_val_t{Alignment}))};
+        chunks_ = new (memory) Chunk{chunks_};
+        ++chunk_count_;
+        bump_ = memory + header;
+        bump_end_ = bump_ + Blocks_Per_Chunk * Block_Size;
+    }
+
+    mutable std::mutex mutex_{};
+    FreeBlock* free_{nullptr};
+    Chunk* chunks_{nullptr};
+    std::size_t chunk_count_{0};
+    std::byte* bump_{nullptr};
+    std::byte* bump_end_{nullptr};
+};
+
+// Stateless allocator drawing single objects from the NodePool of their size - node based
+// containers allocate one node at a time and take it through their Allocator parameter:
+//
+//   SingleLinkedList<int, PoolAllocator<int>> list{};
+//   HashMap<Key, T, Hash, PoolAllocator<std::pair<Key const, T>>> map{};
+//
+// Allocations of more than one object (e.g. the bucket array of a HashMap) go to operator new.
+template<typename T>
+class PoolAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::true_type;
+
+    constexpr PoolAllocator() noexcept = default;
+    template<typename U>
+    constexpr PoolAllocator(PoolAllocator<U> const&) noexcept { }
+
+    T* allocate(std::size_t n)
+    {
+        if (n == 1) { return static_cast<T*>(Pool::instance().allocate()); }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept
+    {
+        if (n == 1) { Pool::instance().deallocate(p); }
+        else { ::operator delete(p, std::align_val_t{alignof(T)}); }
+    }
+
+private:
+    using Pool = NodePool<sizeof(T), alignof(T)>;
+};
+
+template<typename T, typename U>
+constexpr bool operator==(PoolAllocator<T> const&, PoolAllocator<U> const&) noexcept { return true; }
+
+template<typename T, typename U>
+constexpr bool operator!=(PoolAllocator<T> const&, PoolAllocator<U> const&) noexcept { return false; }
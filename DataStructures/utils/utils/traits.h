@@ -3,10 +3,21 @@
 #include <utility>
 #include <type_traits>
 
+#include "is_detected.h"
+
 template<typename InputIt>
 using RequiresInputIterator = std::enable_if_t<
         std::is_convertible_v<typename std::iterator_traits<InputIt>::iterator_category, std::input_iterator_tag>>;
 
+// Hash and comparison function objects declaring `is_transparent` accept any key type comparable to
+// the container's key_type - the heterogeneous lookup overloads of the containers require it
+template<typename Fn>
+using TransparentTag = typename Fn::is_transparent;
+template<typename Fn>
+constexpr inline bool is_transparent_v{is_detected_v<TransparentTag, Fn>};
+template<typename Fn>
+using RequiresTransparent = std::enable_if_t<is_transparent_v<Fn>>;
+
 template<typename PropagateOnSwap> struct SwapAllocators;
 template<> struct SwapAllocators<std::true_type> {
     template<typename Alloc>
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "net_common.h"
+
+
+namespace olc
+{
+namespace net
+{
+
+// Recycled message bodies. A connection takes the body of every message it receives from its
+// pool, and server_interface::update() gives the bodies of the handled messages back - a steady
+// stream of messages then reuses the same handful of buffers instead of allocating one each.
+// Taken on the thread of the connection and given back on the thread calling update().
+class buffer_pool
+{
+public:
+    using buffer = std::vector<std::uint8_t>;
+
+    // bodies beyond these are freed rather than kept - a read of a burst of small messages may
+    // take a thousand bodies before update() gives the first one back
+    static constexpr std::size_t Max_Buffers{1024};
+    static constexpr std::size_t Max_Capacity{64 * 1024};
+    static constexpr std::size_t Max_Pooled_Bytes{256 * 1024};
+
+    buffer take()
+    {
+        std::lock_guard lk{mutex_};
+        if (buffers_.empty())
+        {
+            return {};
+        }
+        auto buf{std::move(buffers_.back())};
+        buffers_.pop_back();
+        pooled_bytes_ -= buf.capacity();
+        return buf;
+    }
+
+    void give(buffer&& buf)
+    {
+        if (buf.capacity() == 0 || buf.capacity() > Max_Capacity)
+        {
+            return;
+        }
+        buf.clear();
+        std::lock_guard lk{mutex_};
+        if (buffers_.size() != Max_Buffers && pooled_bytes_ + buf.capacity() <= Max_Pooled_Bytes)
+        {
+            pooled_bytes_ += buf.capacity();
+            buffers_.push_back(std::move(buf));
+        }
+    }
+
+    std::size_t size() const
+    {
+        std::lock_guard lk{mutex_};
+        return buffers_.size();
+    }
+
+private:
+    mutable std::mutex mutex_{};
+    std::vector<buffer> buffers_{};
+    std::size_t pooled_bytes_{0};
+};
+
+} // namespace net
+} // namespace olc
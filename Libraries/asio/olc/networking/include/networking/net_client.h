@@ -64,6 +64,14 @@ public:
         }
     }
 
+    void send(shared_message<T> const& msg)
+    {
+        if (is_connected())
+        {
+            connection_->send(msg);
+        }
+    }
+
     bool is_connected() const noexcept
     {
         if (connection_) {
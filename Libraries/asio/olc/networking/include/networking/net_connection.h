@@ -1,5 +1,6 @@
 #pragma once
 
+#include "net_buffer_pool.h"
 #include "net_common.h"
 #include "net_message.h"
 #include "net_tsqueue.h"
@@ -12,10 +13,26 @@ namespace net
 // forward declaration
 template<typename T> class server_interface;
 
+// Caps of one gathered write of a connection - at least one message is written, however large.
+struct write_limits
+{
+    std::size_t max_messages{64};
+    std::size_t max_bytes{64 * 1024};
+
+    // whether a write gathered so far from `messages` messages of `bytes` bytes takes one more -
+    // the first one always, so that zero caps write one message at a time instead of nothing
+    bool takes(std::size_t messages, std::size_t bytes) const noexcept
+    {
+        return messages == 0 || (messages < max_messages && bytes < max_bytes);
+    }
+};
+
 template<typename T>
 class connection : public std::enable_shared_from_this<connection<T>>
 {
 public:
+    static constexpr std::size_t Read_Buffer_Size{16 * 1024};
+
     enum class owner
     {
         server,
@@ -26,11 +43,13 @@ public:
         owner parent,
         asio::io_context& context,
         asio::ip::tcp::socket socket,
-        tsqueue<owned_message<T>>& queue_in)
+        tsqueue<owned_message<T>>& queue_in,
+        write_limits limits = {})
         : socket_{std::move(socket)},
           context_{context},
           queue_in_{queue_in},
-          owner_type_{parent}
+          owner_type_{parent},
+          write_limits_{limits}
     {
         if (owner_type_ == owner::server)
         {
@@ -52,6 +71,12 @@ public:
 
     std::uint32_t get_id() const noexcept { return id_; }
 
+    // hands the body of a handled message back for the messages still to be received
+    void recycle(std::vector<std::uint8_t>&& body)
+    {
+        body_pool_.give(std::move(body));
+    }
+
 
     void connect_to_client(olc::net::server_interface<T>* server, std::uint32_t id)
     {
@@ -62,7 +87,7 @@ public:
             if (socket_.is_open())
             {
                 id_ = id;
-                // read_header();
+                // read_messages();
 
                 // a client has attempted to connect to the server - we want to validate it
                 // send out the handshare data first
@@ -89,7 +114,7 @@ public:
                 {
                     if (!ec)
                     {
-                        // read_header();
+                        // read_messages();
 
                         // the server validates the client
                         // read the validation data
@@ -120,117 +145,172 @@ public:
     }
 
     void send(message<T> const& msg)
+    {
+        send(shared_message<T>{msg});
+    }
+
+    void send(message<T>&& msg)
+    {
+        send(shared_message<T>{std::move(msg)});
+    }
+
+    // the body is shared, not copied - the same message may be sent to any number of connections
+    void send(shared_message<T> msg)
     {
         // Here the asio::io_context_ is already running and waiting to read a header
         // We can post additional tasks at any time using asio::post
         asio::post(context_,
-            [this, msg]()
+            [this, msg = std::move(msg)]() mutable
             {
                 // we need to check if the context is already busy writing messages
-                // and trigger write_header only if it isn't
-                const bool writing_messages{!queue_out_.empty()};
-                queue_out_.push_back(msg);
-                if (!writing_messages)
+                // and trigger write_messages only if it isn't - otherwise the message goes
+                // with the next gathered write
+                queue_out_.push_back(std::move(msg));
+                if (writing_.empty())
                 {
-                    write_header();
+                    write_messages();
                 }
             }
         );
     }
 
 protected:
-    // async - prime context ready to read a message header
-    void read_header()
+    // async - read as many bytes as the socket has into the read buffer, then parse every
+    // complete message in it - a burst of small messages costs one read, not two per message
+    void read_messages()
     {
-        asio::async_read(socket_, asio::buffer(&msg_temp_in_.header, sizeof(message_header<T>)),
-            [this](asio::error_code ec, std::size_t /* length */)
+        // move the part of a message left over from the last read to the front
+        if (read_begin_ != 0)
+        {
+            std::copy(read_buffer_.begin() + static_cast<std::ptrdiff_t>(read_begin_),
+                      read_buffer_.begin() + static_cast<std::ptrdiff_t>(read_end_), read_buffer_.begin());
+            read_end_ -= read_begin_;
+            read_begin_ = 0;
+        }
+        socket_.async_read_some(asio::buffer(read_buffer_.data() + read_end_, read_buffer_.size() - read_end_),
+            [this](asio::error_code ec, std::size_t length)
             {
                 if (!ec)
                 {
-                    if (msg_temp_in_.header.size > 0)
-                    {
-                        msg_temp_in_.body.resize(msg_temp_in_.header.size);
-                        read_body();
-                    }
-                    else
+                    read_end_ += length;
+                    if (parse_messages())
                     {
-                        add_to_incomming_message_queue();
+                        read_messages();
                     }
                 }
                 else
                 {
-                    std::cerr << "[" << id_ << "] Read Header Failed\n";
+                    std::cerr << "[" << id_ << "] Read Failed\n";
                     socket_.close();
                 }
             }
         );
     }
 
-    // async - prime context ready to read a message body
-    void read_body()
+    // queues the complete messages of the read buffer, with one lock - returns false when it
+    // started to read a message too large for the read buffer straight into its body
+    bool parse_messages()
     {
-        asio::async_read(socket_, asio::buffer(msg_temp_in_.body.data(), msg_temp_in_.body.size()),
-            [this](asio::error_code ec, std::size_t /* length */)
+        bool read_more{true};
+        while (read_end_ - read_begin_ >= sizeof(message_header<T>))
+        {
+            message_header<T> header{};
+            std::memcpy(&header, read_buffer_.data() + read_begin_, sizeof(header));
+            auto const body_begin{read_begin_ + sizeof(header)};
+            auto const available{read_end_ - body_begin};
+            if (available < header.size)
             {
-                if (!ec)
-                {
-                    add_to_incomming_message_queue();
-                }
-                else
+                if (sizeof(header) + header.size > read_buffer_.size())
                 {
-                    std::cerr << "[" << id_ << "] Read Body Failed\n";
-                    socket_.close();
+                    read_large_body(header, body_begin, available);
+                    read_more = false;
                 }
+                break;
             }
-        );
+            parsed_.push_back({owner_type_ == owner::server ? this->shared_from_this() : nullptr,
+                               make_message(header, body_begin, header.size)});
+            read_begin_ = body_begin + header.size;
+        }
+        if (read_begin_ == read_end_)
+        {
+            read_begin_ = read_end_ = 0;
+        }
+        queue_in_.push_back_bulk(parsed_);
+        return read_more;
     }
 
-    // async - prime context ready to write a message header
-    void write_header()
+    // async - the body beyond the read buffer goes straight into the message
+    void read_large_body(message_header<T> const& header, std::size_t body_begin, std::size_t available)
     {
-        msg_temp_out_ = queue_out_.pop_front();
-        asio::async_write(socket_, asio::buffer(&msg_temp_out_.header, sizeof(msg_temp_out_.header)),
+        msg_temp_in_ = make_message(header, body_begin, available);
+        msg_temp_in_.body.resize(header.size);
+        read_begin_ = read_end_ = 0;
+        asio::async_read(socket_, asio::buffer(msg_temp_in_.body.data() + available, header.size - available),
             [this](asio::error_code ec, std::size_t /* length */)
             {
                 if (!ec)
                 {
-                    if (msg_temp_out_.body.size() != 0)
-                    {
-                        write_body();
-                    }
-                    else
-                    {
-                        if (!queue_out_.empty())
-                        {
-                            write_header();
-                        }
-                    }
+                    add_to_incomming_message_queue();
                 }
                 else
                 {
-                    std::cerr << "[" << id_ << "] Write Header Failed\n";
+                    std::cerr << "[" << id_ << "] Read Body Failed\n";
                     socket_.close();
                 }
             }
         );
     }
 
-    // async - prime context ready to write a message body
-    void write_body()
+    // the body is a recycled buffer, if the pool has one
+    message<T> make_message(message_header<T> const& header, std::size_t body_begin, std::size_t size)
+    {
+        message<T> msg{};
+        msg.header = header;
+        if (header.size != 0)
+        {
+            msg.body = body_pool_.take();
+            auto const first{read_buffer_.cbegin() + static_cast<std::ptrdiff_t>(body_begin)};
+            msg.body.assign(first, first + static_cast<std::ptrdiff_t>(size));
+        }
+        return msg;
+    }
+
+    // async - write the waiting messages, headers and bodies, with one scatter-gather write
+    // of up to write_limits_ - instead of a write, a system call and a handler for every
+    // header and every body
+    void write_messages()
     {
-        asio::async_write(socket_, asio::buffer(msg_temp_out_.body.data(), msg_temp_out_.body.size()),
+        std::size_t bytes{0};
+        while (!queue_out_.empty() && write_limits_.takes(writing_.size(), bytes))
+        {
+            writing_.push_back(queue_out_.pop_front());
+            bytes += sizeof(message_header<T>) + writing_.back().size();
+        }
+        // the buffers point into writing_, which does not change until the write completed
+        for (auto const& msg : writing_)
+        {
+            write_buffers_.push_back(asio::buffer(&msg.header(), sizeof(message_header<T>)));
+            if (msg.size() != 0)
+            {
+                write_buffers_.push_back(asio::buffer(msg.body_data(), msg.size()));
+            }
+        }
+
+        asio::async_write(socket_, write_buffers_,
             [this](asio::error_code ec, std::size_t /* length */)
             {
+                writing_.clear();
+                write_buffers_.clear();
                 if (!ec)
                 {
                     if (!queue_out_.empty())
                     {
-                        write_header();
+                        write_messages();
                     }
                 }
                 else
                 {
-                    std::cerr << "[" << id_ << "] Write Body Failed\n";
+                    std::cerr << "[" << id_ << "] Write Failed\n";
                     socket_.close();
                 }
             }
@@ -241,14 +321,15 @@ protected:
     {
         if (owner_type_ == owner::server)
         {
-            queue_in_.push_back({this->shared_from_this(), msg_temp_in_});
+            queue_in_.push_back({this->shared_from_this(), std::move(msg_temp_in_)});
         }
         else
         {
-            queue_in_.push_back({nullptr, msg_temp_in_});
+            queue_in_.push_back({nullptr, std::move(msg_temp_in_)});
         }
+        msg_temp_in_ = {};
 
-        read_header();
+        read_messages();
     }
 
     // ASYNC - used by both client and server to write validation packet
@@ -262,7 +343,7 @@ protected:
                     // validation data sent - clients start attempting to read data now
                     if (owner_type_ == owner::client)
                     {
-                        read_header();
+                        read_messages();
                     }
                 }
                 else
@@ -292,7 +373,7 @@ protected:
                             server->on_client_validated(this->shared_from_this());
 
                             // move on to reading the data
-                            read_header();
+                            read_messages();
                         }
                         else
                         {
@@ -333,18 +414,31 @@ protected:
     asio::ip::tcp::socket socket_{};
     // the context is shared with the whole asio interface
     asio::io_context& context_;
-    // queue contains all messages outgoing to the remote side of this connection
-    tsqueue<message<T>> queue_out_{};
+    // queue contains all messages outgoing to the remote side of this connection,
+    // their bodies may be shared with the queues of other connections
+    tsqueue<shared_message<T>> queue_out_{};
     // this queue holds all messages that have been received from the remote side
     // of this connection. Note that it's a reference - owner of this connection
     // is expected to provide a queue
     tsqueue<owned_message<T>>& queue_in_;
     // owner type decides how some of the connection behaves
     owner owner_type_{owner::server};
+    write_limits write_limits_{};
     std::uint32_t id_{0};
 
+    // the bytes read and not yet parsed are [read_begin_, read_end_)
+    std::vector<std::uint8_t> read_buffer_ = std::vector<std::uint8_t>(Read_Buffer_Size);
+    std::size_t read_begin_{0};
+    std::size_t read_end_{0};
+    // the messages parsed from one read, queued together
+    std::vector<owned_message<T>> parsed_{};
+    // a message larger than the read buffer, being read
     message<T> msg_temp_in_{};
-    message<T> msg_temp_out_{};
+    // bodies for the received messages, given back by the server once handled
+    buffer_pool body_pool_{};
+    // the messages of the write in flight, and the buffers of their headers and bodies
+    std::vector<shared_message<T>> writing_{};
+    std::vector<asio::const_buffer> write_buffers_{};
 
     std::uint64_t handshake_out_{0};
     std::uint64_t handshake_in_{0};
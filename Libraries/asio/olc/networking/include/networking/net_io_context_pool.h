@@ -0,0 +1,87 @@
+#pragma once
+
+#include "net_common.h"
+
+
+namespace olc
+{
+namespace net
+{
+
+// A pool of io_contexts, each run by a thread of its own. Every socket belongs to one of the
+// contexts, so the handlers of a connection never run concurrently - no strand is needed - while
+// the connections as a whole spread over the threads. next() hands out the contexts round-robin.
+class io_context_pool
+{
+public:
+    explicit io_context_pool(std::size_t size = 1)
+    {
+        size = std::max<std::size_t>(size, 1);
+        contexts_.reserve(size);
+        for (std::size_t i{0}; i != size; ++i)
+        {
+            contexts_.push_back(std::make_unique<asio::io_context>(1));
+        }
+    }
+
+    io_context_pool(io_context_pool const&) = delete;
+    io_context_pool& operator=(io_context_pool const&) = delete;
+
+    ~io_context_pool()
+    {
+        stop();
+    }
+
+    // the contexts keep running without work until stop()
+    void run()
+    {
+        for (auto& context : contexts_)
+        {
+            guards_.push_back(asio::make_work_guard(*context));
+        }
+        for (auto& context : contexts_)
+        {
+            threads_.emplace_back([&context]() { context->run(); });
+        }
+    }
+
+    void stop()
+    {
+        for (auto& context : contexts_)
+        {
+            context->stop();
+        }
+        for (auto& thread : threads_)
+        {
+            thread.join();
+        }
+        threads_.clear();
+        guards_.clear();
+    }
+
+    asio::io_context& context(std::size_t index) noexcept
+    {
+        return *contexts_[index];
+    }
+
+    asio::io_context& next() noexcept
+    {
+        auto& context{*contexts_[next_]};
+        next_ = (next_ + 1) % contexts_.size();
+        return context;
+    }
+
+    std::size_t size() const noexcept
+    {
+        return contexts_.size();
+    }
+
+private:
+    std::vector<std::unique_ptr<asio::io_context>> contexts_{};
+    std::vector<asio::executor_work_guard<asio::io_context::executor_type>> guards_{};
+    std::vector<std::thread> threads_{};
+    std::size_t next_{0};
+};
+
+} // namespace net
+} // namespace olc
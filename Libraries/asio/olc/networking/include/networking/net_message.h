@@ -39,14 +39,9 @@ struct message
     {
         static_assert(IsTrivialAndStandardLayout<DataType>, "message can operate only on PoD types");
 
-        // cache the current buffer size - this will be the point we insert data at
-        auto const cur_size{msg.body.size()};
-        // resize the vector by the size of the data being pushed
-        msg.body.resize(cur_size + sizeof(DataType));
-        std::memcpy(msg.body.data() + cur_size, &data, sizeof(DataType));
-        // std::copy(static_cast<std::uint8_t const*>(&data), static_cast<std::uint8_t const*>(++&data),
-        //           std::next(std::begin(msg.body), static_cast<std::ptrdiff_t>(cur_size))
-        //           );
+        // append the bytes of the data - unlike resize, insert does not zero the new bytes first
+        auto const* const bytes{reinterpret_cast<std::uint8_t const*>(&data)};
+        msg.body.insert(msg.body.end(), bytes, bytes + sizeof(DataType));
         msg.header.size = static_cast<std::uint32_t>(msg.size());
         return msg;
     }
@@ -68,6 +63,89 @@ struct message
 };
 
 
+// An immutable message with a reference-counted body, in the spirit of SharedConstBuffer in
+// server_client/tcp_server_shared_buffer.cpp. A broadcast serializes the message once, and the
+// outgoing queue of every recipient holds a reference to the same bytes instead of a copy.
+template<typename T>
+class shared_message
+{
+public:
+    shared_message() = default;
+
+    // takes over the body, no bytes are copied
+    explicit shared_message(message<T>&& msg)
+        : header_{msg.header},
+          body_{msg.body.empty() ? nullptr : std::make_shared<std::vector<std::uint8_t> const>(std::move(msg.body))}
+    {
+    }
+
+    // copies the body once
+    explicit shared_message(message<T> const& msg)
+        : shared_message{message<T>{msg}}
+    {
+    }
+
+    message_header<T> const& header() const noexcept { return header_; }
+
+    std::uint8_t const* body_data() const noexcept { return body_ ? body_->data() : nullptr; }
+
+    std::size_t size() const noexcept { return body_ ? body_->size() : 0; }
+
+    // number of messages sharing the body, 0 without a body
+    long use_count() const noexcept { return body_.use_count(); }
+
+private:
+    message_header<T> header_{};
+    std::shared_ptr<std::vector<std::uint8_t> const> body_{};
+};
+
+
+// Composes a message with the body reserved up front, so that appending the fields copies their
+// bytes and nothing else. build() hands out the message, share() a shared_message for broadcasts.
+template<typename T>
+class message_builder
+{
+public:
+    explicit message_builder(T id, std::size_t reserve_bytes = 0)
+    {
+        msg_.header.id = id;
+        msg_.body.reserve(reserve_bytes);
+    }
+
+    template<typename DataType>
+    message_builder& operator<<(DataType const& data)
+    {
+        static_assert(IsTrivialAndStandardLayout<DataType>, "message can operate only on PoD types");
+        return append(&data, sizeof(DataType));
+    }
+
+    message_builder& append(void const* data, std::size_t size)
+    {
+        auto const* const bytes{static_cast<std::uint8_t const*>(data)};
+        msg_.body.insert(msg_.body.end(), bytes, bytes + size);
+        return *this;
+    }
+
+    void reserve(std::size_t bytes) { msg_.body.reserve(bytes); }
+
+    std::size_t size() const noexcept { return msg_.body.size(); }
+
+    message<T> build() &&
+    {
+        msg_.header.size = static_cast<std::uint32_t>(msg_.size());
+        return std::move(msg_);
+    }
+
+    shared_message<T> share() &&
+    {
+        return shared_message<T>{std::move(*this).build()};
+    }
+
+private:
+    message<T> msg_{};
+};
+
+
 template<typename T>
 struct connection;
 
@@ -3,21 +3,28 @@
 #include <limits>
 
 #include "net_common.h"
+#include "net_io_context_pool.h"
 #include "net_tsqueue.h"
 #include "net_message.h"
 #include "net_connection.h"
+#include "net_slot_map.h"
 
 namespace olc
 {
 namespace net
 {
 
+// The socket work - accepting, validating, reading and writing - runs on a pool of threads,
+// each with an io_context of its own; a new connection goes to the next context round-robin.
+// The callbacks of the connections, on_client_validated() among them, may therefore run on any
+// of the threads. on_message() runs on the thread calling update().
 template<typename T>
 class server_interface
 {
 public:
-    server_interface(std::uint16_t port)
-        : acceptor_{context_, asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port)}
+    server_interface(std::uint16_t port, std::size_t threads = 1)
+        : pool_{threads},
+          acceptor_{pool_.context(0), asio::ip::tcp::endpoint(asio::ip::tcp::v4(), port)}
     {
 
     }
@@ -31,7 +38,7 @@ public:
     {
         try {
             wait_for_client_connection();
-            context_thread_ = std::thread{[this](){ context_.run(); }};
+            pool_.run();
         }
         catch (std::exception const& e) {
             // something prohibited the server from listening
@@ -45,34 +52,51 @@ public:
 
     void stop()
     {
-        context_.stop();
-        if (context_thread_.joinable()) { context_thread_.join(); }
+        pool_.stop();
         std::cerr << "[SERVER] Stopped\n";
     }
 
     // async - instruct asio to wait for connection
     void wait_for_client_connection()
     {
-        acceptor_.async_accept(
-            [this](std::error_code ec, asio::ip::tcp::socket socket)
+        // the socket is accepted onto the context the connection is going to run on
+        auto& context{pool_.next()};
+        acceptor_.async_accept(context,
+            [this, &context](std::error_code ec, asio::ip::tcp::socket socket)
             {
                 if (!ec) {
                     std::cerr << "[SERVER] New Connection: " << socket.remote_endpoint() << "\n";
                     auto newconn = std::make_shared<connection<T>>(
                                         connection<T>::owner::server,
-                                        context_,
+                                        context,
                                         std::move(socket),
-                                        queue_in_);
+                                        queue_in_,
+                                        write_limits_);
 
                     // give the user server an opportunity to deny this connection
                     if (on_client_connect(newconn))
                     {
-                        // connection allowed, so add to container of new connections
-                        connections_.push_back(std::move(newconn));
-                        // assign ID to the connection
-                        auto&& con{connections_.back()};
-                        con->connect_to_client(this, id_counter_++);
-                        std::cout << "[" << con->get_id() << "] Connection Approved" << std::endl;
+                        // connection allowed, so add to container of new connections - the key of
+                        // its slot is the ID of the connection
+                        std::optional<std::uint32_t> id{};
+                        {
+                            std::lock_guard lk{connections_mutex_};
+                            if (connections_.size() != connections_.max_size())
+                            {
+                                id = connections_.insert(newconn);
+                            }
+                        }
+                        if (id)
+                        {
+                            asio::post(context,
+                                [this, con = std::move(newconn), id = *id]() { con->connect_to_client(this, id); }
+                            );
+                            std::cout << "[" << *id << "] Connection Approved" << std::endl;
+                        }
+                        else
+                        {
+                            std::cout << "[------] Connection Denied - too many connections\n";
+                        }
                     }
                     else
                     {
@@ -88,49 +112,88 @@ public:
             });
     }
 
+    // caps of the gathered writes of the connections - to be set before start(); every write
+    // takes at least one message, so zero caps send the messages one by one
+    void set_write_limits(write_limits limits) noexcept
+    {
+        write_limits_ = limits;
+    }
+
+    // the client with the ID, or nullptr when it has disconnected
+    std::shared_ptr<connection<T>> find_client(std::uint32_t id) const
+    {
+        std::lock_guard lk{connections_mutex_};
+        auto const* const con{connections_.find(id)};
+        return con ? *con : nullptr;
+    }
+
+    std::size_t client_count() const
+    {
+        std::lock_guard lk{connections_mutex_};
+        return connections_.size();
+    }
+
     // send a message to a specific client
     void message_client(std::shared_ptr<connection<T>> client, message<T> const& msg)
+    {
+        message_client(std::move(client), shared_message<T>{msg});
+    }
+
+    void message_client(std::shared_ptr<connection<T>> client, shared_message<T> const& msg)
     {
         if (client && client->is_connected())
         {
             client->send(msg);
         }
-        else
+        else if (client)
         {
             // if fail to communicate with the client assume the client has disconnected
             on_client_disconnect(client);
-            client.reset();
-            connections_.erase(
-                std::remove(connections_.begin(), connections_.end(), client), connections_.end()
-            );
+            remove_client(client);
         }
     }
 
-    // send message to all clients
+    // send a message to the client with the ID
+    void message_client(std::uint32_t id, message<T> const& msg)
+    {
+        message_client(find_client(id), shared_message<T>{msg});
+    }
+
+    void message_client(std::uint32_t id, shared_message<T> const& msg)
+    {
+        message_client(find_client(id), msg);
+    }
+
+    // send message to all clients - the body is copied once and shared by all of them
     void message_all_clients(message<T> const& msg, std::shared_ptr<connection<T>> ignored_client)
     {
-        bool invalid_client_exists{false};
-        for (auto& client : connections_)
+        message_all_clients(shared_message<T>{msg}, std::move(ignored_client));
+    }
+
+    void message_all_clients(shared_message<T> const& msg, std::shared_ptr<connection<T>> ignored_client)
+    {
+        // the clients which failed to communicate are taken out of the registry in the same pass,
+        // and the user server told about them once the registry is unlocked
+        std::vector<std::shared_ptr<connection<T>>> disconnected{};
         {
-            if (client && client->is_connected())
+            std::lock_guard lk{connections_mutex_};
+            connections_.erase_if([&msg, &ignored_client, &disconnected](auto& client)
             {
-                if (client != ignored_client) {
-                    client->send(msg);
+                if (client->is_connected())
+                {
+                    if (client != ignored_client) {
+                        client->send(msg);
+                    }
+                    return false;
                 }
-            }
-            else
-            {
-                // we failed to communicate with the client, so assume it has disconnected
-                on_client_disconnect(client);
-                client.reset();
-                invalid_client_exists = true;
-            }
+                disconnected.push_back(std::move(client));
+                return true;
+            });
         }
-        if (invalid_client_exists)
+        for (auto& client : disconnected)
         {
-            connections_.erase(
-                std::remove(connections_.begin(), connections_.end(), nullptr), connections_.end()
-            );
+            // we failed to communicate with the client, so assume it has disconnected
+            on_client_disconnect(std::move(client));
         }
     }
 
@@ -140,12 +203,20 @@ public:
     {
         if (wait) { queue_in_.wait_for_data(); }
 
-        for (std::size_t msg_count{0}; msg_count != max_messages && !queue_in_.empty(); ++msg_count)
+        // take the messages in batches, one lock each, and handle them outside of the queue
+        for (std::size_t msg_count{0}; msg_count != max_messages; )
         {
-            // get the front message
-            auto msg{queue_in_.pop_front()};
-            // pass to message handler
-            on_message(msg.remote, msg.msg);
+            auto const count{queue_in_.try_pop_bulk(batch_in_, max_messages - msg_count)};
+            if (count == 0) { break; }
+            for (auto& msg : batch_in_)
+            {
+                // pass to message handler
+                on_message(msg.remote, msg.msg);
+                // the connection reuses the body, unless the handler kept it
+                if (msg.remote) { msg.remote->recycle(std::move(msg.msg.body)); }
+            }
+            batch_in_.clear();
+            msg_count += count;
         }
     }
 
@@ -168,6 +239,17 @@ protected:
 
     }
 
+    // takes the client out of the registry - its ID may already belong to another client
+    void remove_client(std::shared_ptr<connection<T>> const& client)
+    {
+        std::lock_guard lk{connections_mutex_};
+        auto const* const con{connections_.find(client->get_id())};
+        if (con && *con == client)
+        {
+            connections_.erase(client->get_id());
+        }
+    }
+
     // called when a message arrives
     virtual void on_message(std::shared_ptr<connection<T>> /* client */, message<T>& /* msg */)
     {
@@ -175,19 +257,23 @@ protected:
     }
 
 // --- member data
+    // declared first - the sockets of the connections below must be destroyed before its contexts
+    io_context_pool pool_;
+
     // threadsafe queue for incomming messages
     tsqueue<owned_message<T>> queue_in_{};
+    // messages taken out of queue_in_ by update(), kept to reuse its storage
+    std::deque<owned_message<T>> batch_in_{};
 
-    // container of active validated objects
-    std::deque<std::shared_ptr<connection<T>>> connections_{};
+    // container of active validated objects, keyed by their IDs - filled by the thread accepting
+    // the connections, emptied by the thread messaging them
+    slot_map<std::shared_ptr<connection<T>>> connections_{};
+    mutable std::mutex connections_mutex_{};
 
-    asio::io_context context_{};
-    std::thread context_thread_{};
 
     asio::ip::tcp::acceptor acceptor_{};
 
-    // clients will be identified in the system via ID
-    std::uint32_t id_counter_{10000};
+    write_limits write_limits_{};
 };
 
 } // namespace net
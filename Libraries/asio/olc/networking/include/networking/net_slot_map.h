@@ -0,0 +1,202 @@
+#pragma once
+
+#include "net_common.h"
+
+
+namespace olc
+{
+namespace net
+{
+
+// Values kept densely in a vector and addressed by keys which stay valid while the values move.
+// A key packs the index of a slot with the generation of that slot; the slot points at the value.
+// Erasing moves the last value into the hole and bumps the generation of the slot, so the key of
+// an erased value finds nothing - even after its slot has been reused for another value.
+// Insert, erase and find are O(1); iterating walks the values, back to back.
+//
+// The free slots are reused first in, first out: a slot comes back only after all the others
+// freed before it, which keeps the 12 bit generation from wrapping around under churn.
+template<typename V>
+class slot_map
+{
+public:
+    using key_type = std::uint32_t;
+    using value_type = V;
+    using iterator = typename std::vector<V>::iterator;
+    using const_iterator = typename std::vector<V>::const_iterator;
+
+    static constexpr std::uint32_t Index_Bits{20};
+    static constexpr std::uint32_t Generation_Bits{32 - Index_Bits};
+
+    static constexpr std::size_t max_size() noexcept
+    {
+        return std::size_t{1} << Index_Bits;
+    }
+
+    key_type insert(V value)
+    {
+        std::uint32_t index{};
+        if (free_head_ != None)
+        {
+            index = free_head_;
+            free_head_ = slots_[index].position;
+            if (free_head_ == None) { free_tail_ = None; }
+        }
+        else
+        {
+            if (slots_.size() == max_size())
+            {
+                throw std::length_error{"slot_map is full"};
+            }
+            index = static_cast<std::uint32_t>(slots_.size());
+            slots_.push_back({});
+        }
+
+        values_.push_back(std::move(value));
+        indices_.push_back(index);
+        slots_[index].position = static_cast<std::uint32_t>(values_.size() - 1);
+        return make_key(index, slots_[index].generation);
+    }
+
+    bool erase(key_type key)
+    {
+        auto const position{position_of(key)};
+        if (position == None)
+        {
+            return false;
+        }
+        erase_at(position);
+        return true;
+    }
+
+    // erases the values the predicate holds for - in one pass, each value is visited once
+    template<typename Predicate>
+    std::size_t erase_if(Predicate pred)
+    {
+        std::size_t erased{0};
+        for (std::size_t position{0}; position != values_.size(); )
+        {
+            if (pred(values_[position]))
+            {
+                // the last value moves into position and is visited next
+                erase_at(static_cast<std::uint32_t>(position));
+                ++erased;
+            }
+            else
+            {
+                ++position;
+            }
+        }
+        return erased;
+    }
+
+    V* find(key_type key) noexcept
+    {
+        auto const position{position_of(key)};
+        return position == None ? nullptr : &values_[position];
+    }
+
+    V const* find(key_type key) const noexcept
+    {
+        auto const position{position_of(key)};
+        return position == None ? nullptr : &values_[position];
+    }
+
+    bool contains(key_type key) const noexcept
+    {
+        return position_of(key) != None;
+    }
+
+    void clear() noexcept
+    {
+        while (!values_.empty())
+        {
+            erase_at(static_cast<std::uint32_t>(values_.size() - 1));
+        }
+    }
+
+    void reserve(std::size_t size)
+    {
+        values_.reserve(size);
+        indices_.reserve(size);
+        slots_.reserve(size);
+    }
+
+    std::size_t size() const noexcept { return values_.size(); }
+    bool empty() const noexcept { return values_.empty(); }
+
+    iterator begin() noexcept { return values_.begin(); }
+    iterator end() noexcept { return values_.end(); }
+    const_iterator begin() const noexcept { return values_.cbegin(); }
+    const_iterator end() const noexcept { return values_.cend(); }
+
+private:
+    static constexpr std::uint32_t None{std::numeric_limits<std::uint32_t>::max()};
+    static constexpr std::uint32_t Index_Mask{(std::uint32_t{1} << Index_Bits) - 1};
+    static constexpr std::uint32_t Generation_Mask{(std::uint32_t{1} << Generation_Bits) - 1};
+
+    // position is the index of the value while the slot is in use, the next free slot otherwise
+    struct slot
+    {
+        std::uint32_t position{None};
+        std::uint32_t generation{0};
+    };
+
+    static key_type make_key(std::uint32_t index, std::uint32_t generation) noexcept
+    {
+        return (generation << Index_Bits) | index;
+    }
+
+    std::uint32_t position_of(key_type key) const noexcept
+    {
+        auto const index{key & Index_Mask};
+        if (index >= slots_.size())
+        {
+            return None;
+        }
+        auto const& s{slots_[index]};
+        // a free slot points at no value which points back at it
+        if (s.generation != key >> Index_Bits || s.position >= values_.size() || indices_[s.position] != index)
+        {
+            return None;
+        }
+        return s.position;
+    }
+
+    void erase_at(std::uint32_t position)
+    {
+        auto const index{indices_[position]};
+        auto const last{static_cast<std::uint32_t>(values_.size() - 1)};
+        if (position != last)
+        {
+            values_[position] = std::move(values_[last]);
+            indices_[position] = indices_[last];
+            slots_[indices_[position]].position = position;
+        }
+        values_.pop_back();
+        indices_.pop_back();
+
+        auto& s{slots_[index]};
+        s.generation = (s.generation + 1) & Generation_Mask;
+        s.position = None;
+        if (free_tail_ == None)
+        {
+            free_head_ = index;
+        }
+        else
+        {
+            slots_[free_tail_].position = index;
+        }
+        free_tail_ = index;
+    }
+
+    std::vector<V> values_{};
+    // the slot of every value, to fix up the slot of the value moved by an erase
+    std::vector<std::uint32_t> indices_{};
+    std::vector<slot> slots_{};
+    std::uint32_t free_head_{None};
+    std::uint32_t free_tail_{None};
+};
+
+} // namespace net
+} // namespace olc
@@ -3,6 +3,7 @@
 #include "net_common.h"
 
 #include <condition_variable>
+#include <limits>
 
 
 namespace olc
@@ -10,10 +11,23 @@ namespace olc
 namespace net
 {
 
+// what a push does when a bounded tsqueue is full:
+// block waits for room, drop_oldest discards the element at the front, reject returns false
+enum class overflow_policy { block, drop_oldest, reject };
+
+// Unbounded unless constructed with a capacity. try_pop_bulk and wait_pop_bulk take up to max
+// elements under one lock - when the batch is an empty std::deque and max does not limit it,
+// by swapping the containers.
 template<typename T>
 class tsqueue {
 public:
+    static constexpr std::size_t Unbounded{std::numeric_limits<std::size_t>::max()};
+
     tsqueue() = default;
+    explicit tsqueue(std::size_t capacity, overflow_policy policy = overflow_policy::block)
+        : capacity_{capacity}, policy_{policy}
+    {
+    }
     tsqueue& operator=(tsqueue&&) = delete;
 
     ~tsqueue() noexcept
@@ -24,18 +38,20 @@ public:
     T pop_front()
     {
         // expects !data_.empty();
-        std::lock_guard lk{mutex_};
+        std::unique_lock lk{mutex_};
         auto val{std::move(data_.front())};
         data_.pop_front();
+        notify_not_full(lk, 1);
         return val;
     }
 
     T pop_back()
     {
         // expects !data_.empty();
-        std::lock_guard lk{mutex_};
+        std::unique_lock lk{mutex_};
         auto val{std::move(data_.back())};
         data_.pop_back();
+        notify_not_full(lk, 1);
         return val;
     }
 
@@ -46,6 +62,7 @@ public:
         auto lk{do_wait_for_data()};
         auto val{std::move(data_.front())};
         data_.pop_front();
+        notify_not_full(lk, 1);
         return val;
     }
 
@@ -56,36 +73,86 @@ public:
         auto lk{do_wait_for_data()};
         auto val{std::move(data_.back())};
         data_.pop_back();
+        notify_not_full(lk, 1);
         return val;
     }
 
-    void push_front(T const& val)
+    // appends up to max elements to batch, returns how many
+    template<typename Container>
+    std::size_t try_pop_bulk(Container& batch, std::size_t max = Unbounded)
     {
-        std::lock_guard lk{mutex_};
+        std::unique_lock lk{mutex_};
+        auto const count{take(batch, max)};
+        notify_not_full(lk, count);
+        return count;
+    }
+
+    // waits for at least one element, then appends up to max elements to batch
+    template<typename Container>
+    std::size_t wait_pop_bulk(Container& batch, std::size_t max = Unbounded)
+    {
+        auto lk{do_wait_for_data()};
+        auto const count{take(batch, max)};
+        notify_not_full(lk, count);
+        return count;
+    }
+
+    bool push_front(T const& val)
+    {
+        std::unique_lock lk{mutex_};
+        if (!make_room(lk)) { return false; }
         data_.push_front(val);
         cv_.notify_one();
+        return true;
     }
 
-    void push_front(T&& val)
+    bool push_front(T&& val)
     {
-        std::lock_guard lk{mutex_};
+        std::unique_lock lk{mutex_};
+        if (!make_room(lk)) { return false; }
         data_.push_front(std::move(val));
         cv_.notify_one();
+        return true;
     }
 
-    void push_back(T const& val)
+    bool push_back(T const& val)
     {
-        std::lock_guard lk{mutex_};
+        std::unique_lock lk{mutex_};
+        if (!make_room(lk)) { return false; }
         data_.push_back(val);
         cv_.notify_one();
+        return true;
     }
 
 
-    void push_back(T&& val)
+    bool push_back(T&& val)
     {
-        std::lock_guard lk{mutex_};
+        std::unique_lock lk{mutex_};
+        if (!make_room(lk)) { return false; }
         data_.push_back(std::move(val));
         cv_.notify_one();
+        return true;
+    }
+
+    // moves the elements of batch to the back under one lock and empties batch, returns how
+    // many the queue took - a full queue with the reject policy turns the rest down
+    template<typename Container>
+    std::size_t push_back_bulk(Container& batch)
+    {
+        if (batch.empty()) { return 0; }
+        std::size_t count{0};
+        {
+            std::unique_lock lk{mutex_};
+            for (auto& val : batch)
+            {
+                if (!make_room(lk)) { break; }
+                data_.push_back(std::move(val));
+                ++count;
+            }
+            cv_.notify_all();
+        }
+        batch.clear();
+        return count;
     }
 
     std::size_t count() const noexcept
@@ -102,8 +169,15 @@ public:
 
     void clear()
     {
-        std::lock_guard lk{mutex_};
+        std::unique_lock lk{mutex_};
+        auto const count{data_.size()};
         data_.clear();
+        notify_not_full(lk, count);
+    }
+
+    std::size_t capacity() const noexcept
+    {
+        return capacity_;
     }
 
     void wait_for_data()
@@ -119,9 +193,56 @@ private:
         return lk;
     }
 
+    bool make_room(std::unique_lock<std::mutex>& lk)
+    {
+        if (data_.size() < capacity_) { return true; }
+        switch (policy_) {
+        case overflow_policy::block:
+            ++waiting_producers_;
+            not_full_.wait(lk, [this]()noexcept{ return data_.size() < capacity_; });
+            --waiting_producers_;
+            return true;
+        case overflow_policy::drop_oldest:
+            data_.pop_front();
+            return true;
+        case overflow_policy::reject:
+            break;
+        }
+        return false;
+    }
+
+    template<typename Container>
+    std::size_t take(Container& batch, std::size_t max)
+    {
+        if constexpr (std::is_same_v<Container, std::deque<T>>) {
+            if (batch.empty() && data_.size() <= max) {
+                batch.swap(data_);
+                return batch.size();
+            }
+        }
+        std::size_t count{0};
+        for (; count != max && !data_.empty(); ++count) {
+            batch.push_back(std::move(data_.front()));
+            data_.pop_front();
+        }
+        return count;
+    }
+
+    // blocked pushes are woken once the queue drained to half its capacity, not on every pop
+    void notify_not_full(std::unique_lock<std::mutex>& lk, std::size_t count)
+    {
+        auto const wake{count != 0 && waiting_producers_ != 0 && data_.size() <= capacity_ / 2};
+        lk.unlock();
+        if (wake) { not_full_.notify_all(); }
+    }
+
     mutable std::mutex mutex_{};
     mutable std::condition_variable cv_{};
+    std::condition_variable not_full_{};
     std::deque<T> data_{};
+    std::size_t capacity_{Unbounded};
+    overflow_policy policy_{overflow_policy::block};
+    std::size_t waiting_producers_{0}; // blocked in a push
 };
 
 } // namespace net
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "networking/net_common.h"
+#include "networking/net_buffer_pool.h"
 #include "networking/net_message.h"
+#include "networking/net_io_context_pool.h"
+#include "networking/net_slot_map.h"
 #include "networking/net_connection.h"
 #include "networking/net_tsqueue.h"
 #include "networking/net_client.h"
@@ -0,0 +1,239 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#include <olc_net.h>
+
+
+// Fan-out of a broadcast to many local clients: the server sends every message to all of them,
+// timed until the last client has received the last byte.
+//  - copy:   one message_client() per client - every client's queue gets a copy of the body,
+//            what message_all_clients() used to do
+//  - shared: one message_all_clients() with a shared_message - the body is serialized once and
+//            every client's queue references it
+//
+//   ./olc_networking_broadcast_bm [clients] [messages] [body bytes]
+namespace
+{
+
+enum class BenchMsgTypes : std::uint32_t
+{
+    Payload
+};
+
+using Clock = std::chrono::steady_clock;
+using Message = olc::net::message<BenchMsgTypes>;
+
+// below the ephemeral ports, which thousands of clients use up on loopback
+constexpr std::uint16_t Port{30100};
+
+// the handshake answer of a client is the protected scramble() of the connection
+struct handshake : olc::net::connection<BenchMsgTypes>
+{
+    using olc::net::connection<BenchMsgTypes>::scramble;
+};
+
+class BroadcastServer : public olc::net::server_interface<BenchMsgTypes>
+{
+public:
+    BroadcastServer() : olc::net::server_interface<BenchMsgTypes>{Port}
+    {
+    }
+
+    void on_client_validated(std::shared_ptr<olc::net::connection<BenchMsgTypes>> /* client */) override
+    {
+        validated_.fetch_add(1, std::memory_order_release);
+    }
+
+    int validated() const noexcept { return validated_.load(std::memory_order_acquire); }
+
+    void broadcast_copies(Message const& msg)
+    {
+        // message_client() removes clients which disconnected
+        std::vector<std::shared_ptr<olc::net::connection<BenchMsgTypes>>> clients{};
+        {
+            std::lock_guard lk{connections_mutex_};
+            clients.assign(connections_.begin(), connections_.end());
+        }
+        for (auto const& client : clients)
+        {
+            message_client(client, msg);
+        }
+    }
+
+    void broadcast_shared(olc::net::shared_message<BenchMsgTypes> const& msg)
+    {
+        message_all_clients(msg, nullptr);
+    }
+
+protected:
+    bool on_client_connect(std::shared_ptr<olc::net::connection<BenchMsgTypes>> const& /* client */) override
+    {
+        return true;
+    }
+
+private:
+    std::atomic<int> validated_{0};
+};
+
+// a raw socket which answers the handshake and then counts the bytes it receives
+class BenchClient
+{
+public:
+    BenchClient(asio::io_context& context, std::atomic<std::size_t>& received)
+        : socket_{context}, received_{received}
+    {
+    }
+
+    void connect(asio::ip::tcp::endpoint const& endpoint)
+    {
+        socket_.connect(endpoint);
+        asio::async_read(socket_, asio::buffer(&handshake_, sizeof(handshake_)),
+            [this](asio::error_code ec, std::size_t /* length */)
+            {
+                if (ec) { return; }
+                handshake_ = handshake::scramble(handshake_);
+                asio::async_write(socket_, asio::buffer(&handshake_, sizeof(handshake_)),
+                    [this](asio::error_code write_ec, std::size_t /* length */)
+                    {
+                        if (!write_ec) { read(); }
+                    });
+            });
+    }
+
+    void close()
+    {
+        asio::error_code ec;
+        socket_.close(ec);
+    }
+
+private:
+    void read()
+    {
+        socket_.async_read_some(asio::buffer(buffer_),
+            [this](asio::error_code ec, std::size_t length)
+            {
+                if (ec) { return; }
+                received_.fetch_add(length, std::memory_order_relaxed);
+                read();
+            });
+    }
+
+    asio::ip::tcp::socket socket_;
+    std::atomic<std::size_t>& received_;
+    std::uint64_t handshake_{0};
+    std::array<std::uint8_t, 16 * 1024> buffer_{};
+};
+
+// the server reports every connection, from any of its threads - not of interest here
+class Silence
+{
+public:
+    Silence() : out_{std::cout.rdbuf(&sink_)}, err_{std::cerr.rdbuf(&sink_)}
+    {
+    }
+    Silence(Silence const&) = delete;
+    Silence& operator=(Silence const&) = delete;
+    ~Silence()
+    {
+        std::cout.rdbuf(out_);
+        std::cerr.rdbuf(err_);
+    }
+
+private:
+    // discards the characters without keeping any state, so the threads may share it
+    struct null_buffer : std::streambuf
+    {
+        int overflow(int c) override { return traits_type::not_eof(c); }
+    };
+
+    null_buffer sink_{};
+    std::streambuf* out_;
+    std::streambuf* err_;
+};
+
+template<typename Broadcast>
+void run(char const* name, int clients, int messages, std::size_t body_size, Broadcast broadcast)
+{
+    std::atomic<std::size_t> received{0};
+    auto const expected{static_cast<std::size_t>(clients) * static_cast<std::size_t>(messages) *
+                        (sizeof(olc::net::message_header<BenchMsgTypes>) + body_size)};
+    double elapsed{0.0};
+    {
+        Silence silence{};
+        asio::io_context context{};
+        std::vector<std::unique_ptr<BenchClient>> bench_clients{};
+        BroadcastServer server{};
+        server.start();
+        auto guard{asio::make_work_guard(context)};
+        std::thread client_thread{[&context]() { context.run(); }};
+
+        asio::ip::tcp::endpoint const endpoint{asio::ip::make_address("127.0.0.1"), Port};
+        for (int i{0}; i != clients; ++i)
+        {
+            bench_clients.push_back(std::make_unique<BenchClient>(context, received));
+            bench_clients.back()->connect(endpoint);
+        }
+        while (server.validated() != clients)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
+        auto const start{Clock::now()};
+        for (int m{0}; m != messages; ++m)
+        {
+            broadcast(server, body_size);
+        }
+        while (received.load(std::memory_order_relaxed) != expected)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds{100});
+        }
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        asio::post(context, [&bench_clients]() { for (auto& c : bench_clients) { c->close(); } });
+        guard.reset();
+        client_thread.join();
+        server.stop();
+    }
+
+    auto const deliveries{static_cast<double>(clients) * messages};
+    std::cout << std::left << std::setw(10) << name << std::right << std::setw(6) << clients << " clients"
+              << std::setw(7) << body_size << " B" << std::setw(10) << std::fixed << std::setprecision(2)
+              << deliveries / elapsed / 1e6 << " M deliveries/s" << std::setw(10)
+              << static_cast<double>(expected) / elapsed / 1e6 << " MB/s" << std::endl;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    int const clients{argc > 1 ? std::atoi(argv[1]) : 1000};
+    int const messages{argc > 2 ? std::atoi(argv[2]) : 100};
+    std::size_t const body_size{argc > 3 ? static_cast<std::size_t>(std::atoll(argv[3])) : 1024};
+
+    run("copy", clients, messages, body_size, [](BroadcastServer& server, std::size_t size)
+    {
+        Message msg{};
+        msg.header.id = BenchMsgTypes::Payload;
+        msg.body.assign(size, std::uint8_t{0x5A});
+        msg.header.size = static_cast<std::uint32_t>(msg.size());
+        server.broadcast_copies(msg);
+    });
+    run("shared", clients, messages, body_size, [](BroadcastServer& server, std::size_t size)
+    {
+        olc::net::message_builder<BenchMsgTypes> builder{BenchMsgTypes::Payload, size};
+        for (std::size_t i{0}; i != size; ++i)
+        {
+            builder << std::uint8_t{0x5A};
+        }
+        server.broadcast_shared(std::move(builder).share());
+    });
+}
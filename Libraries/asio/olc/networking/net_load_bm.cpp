@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#include <olc_net.h>
+
+
+// Load generator for server_interface: thousands of loopback clients each send a ping, wait for
+// the server to bounce it back and send the next one. Reported are the round trips per second
+// and their latency percentiles, for a growing number of server threads.
+// The clients run on io_contexts of their own, in this process.
+//
+//   ./olc_networking_load_bm [clients] [seconds] [max server threads] [client threads]
+namespace
+{
+
+enum class LoadMsgTypes : std::uint32_t
+{
+    Ping
+};
+
+using Clock = std::chrono::steady_clock;
+using Header = olc::net::message_header<LoadMsgTypes>;
+
+// below the ephemeral ports, which thousands of clients use up on loopback
+constexpr std::uint16_t Port{30200};
+
+// the handshake answer of a client is the protected scramble() of the connection
+struct handshake : olc::net::connection<LoadMsgTypes>
+{
+    using olc::net::connection<LoadMsgTypes>::scramble;
+};
+
+class EchoServer : public olc::net::server_interface<LoadMsgTypes>
+{
+public:
+    explicit EchoServer(std::size_t threads) : olc::net::server_interface<LoadMsgTypes>{Port, threads}
+    {
+    }
+
+    void on_client_validated(std::shared_ptr<olc::net::connection<LoadMsgTypes>> /* client */) override
+    {
+        validated_.fetch_add(1, std::memory_order_release);
+    }
+
+    int validated() const noexcept { return validated_.load(std::memory_order_acquire); }
+
+    // returns from an update() waiting for messages
+    void wake()
+    {
+        queue_in_.push_back({nullptr, {}});
+    }
+
+protected:
+    bool on_client_connect(std::shared_ptr<olc::net::connection<LoadMsgTypes>> const& /* client */) override
+    {
+        return true;
+    }
+
+    void on_message(std::shared_ptr<olc::net::connection<LoadMsgTypes>> client,
+                    olc::net::message<LoadMsgTypes>& msg) override
+    {
+        if (client) { client->send(std::move(msg)); }
+    }
+
+private:
+    std::atomic<int> validated_{0};
+};
+
+// a raw socket which answers the handshake, then pings the server in a closed loop and
+// records the round trip times while recording is on
+class LoadClient
+{
+public:
+    LoadClient(asio::io_context& context, std::atomic<bool>& recording)
+        : socket_{context}, recording_{recording}
+    {
+    }
+
+    void connect(asio::ip::tcp::endpoint const& endpoint)
+    {
+        socket_.connect(endpoint);
+        asio::async_read(socket_, asio::buffer(&handshake_, sizeof(handshake_)),
+            [this](asio::error_code ec, std::size_t /* length */)
+            {
+                if (ec) { return; }
+                handshake_ = handshake::scramble(handshake_);
+                asio::async_write(socket_, asio::buffer(&handshake_, sizeof(handshake_)),
+                    [this](asio::error_code write_ec, std::size_t /* length */)
+                    {
+                        if (!write_ec) { ping(); }
+                    });
+            });
+    }
+
+    std::vector<std::uint32_t> const& latencies() const noexcept { return latencies_; }
+
+private:
+    void ping()
+    {
+        header_out_ = Header{LoadMsgTypes::Ping, sizeof(sent_)};
+        sent_ = Clock::now();
+        std::array<asio::const_buffer, 2> const buffers{
+            asio::buffer(&header_out_, sizeof(header_out_)), asio::buffer(&sent_, sizeof(sent_))};
+        asio::async_write(socket_, buffers,
+            [this](asio::error_code ec, std::size_t /* length */)
+            {
+                if (!ec) { read_echo(); }
+            });
+    }
+
+    void read_echo()
+    {
+        std::array<asio::mutable_buffer, 2> const buffers{
+            asio::buffer(&header_in_, sizeof(header_in_)), asio::buffer(&echoed_, sizeof(echoed_))};
+        asio::async_read(socket_, buffers,
+            [this](asio::error_code ec, std::size_t /* length */)
+            {
+                if (ec) { return; }
+                if (recording_.load(std::memory_order_relaxed))
+                {
+                    auto const rtt{std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - echoed_)};
+                    latencies_.push_back(static_cast<std::uint32_t>(std::min<std::chrono::nanoseconds::rep>(
+                        rtt.count(), std::numeric_limits<std::uint32_t>::max())));
+                }
+                ping();
+            });
+    }
+
+    asio::ip::tcp::socket socket_;
+    std::atomic<bool>& recording_;
+    std::uint64_t handshake_{0};
+    Header header_out_{};
+    Header header_in_{};
+    Clock::time_point sent_{};
+    Clock::time_point echoed_{};
+    std::vector<std::uint32_t> latencies_{};
+};
+
+// the server reports every connection, from any of its threads - not of interest here
+class Silence
+{
+public:
+    Silence() : out_{std::cout.rdbuf(&sink_)}, err_{std::cerr.rdbuf(&sink_)}
+    {
+    }
+    Silence(Silence const&) = delete;
+    Silence& operator=(Silence const&) = delete;
+    ~Silence()
+    {
+        std::cout.rdbuf(out_);
+        std::cerr.rdbuf(err_);
+    }
+
+private:
+    // discards the characters without keeping any state, so the threads may share it
+    struct null_buffer : std::streambuf
+    {
+        int overflow(int c) override { return traits_type::not_eof(c); }
+    };
+
+    null_buffer sink_{};
+    std::streambuf* out_;
+    std::streambuf* err_;
+};
+
+double percentile(std::vector<std::uint32_t> const& sorted, double p)
+{
+    if (sorted.empty()) { return 0.0; }
+    auto const index{static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1))};
+    return sorted[index] / 1e3;
+}
+
+void run(int clients, double seconds, std::size_t server_threads, std::size_t client_threads)
+{
+    std::atomic<bool> recording{false};
+    std::vector<std::uint32_t> latencies{};
+    double elapsed{0.0};
+    {
+        Silence silence{};
+        EchoServer server{server_threads};
+        server.start();
+        std::atomic<bool> serving{true};
+        std::thread update_thread{[&server, &serving]()
+        {
+            while (serving.load(std::memory_order_relaxed))
+            {
+                server.update(std::numeric_limits<std::size_t>::max(), true);
+            }
+        }};
+
+        olc::net::io_context_pool client_pool{client_threads};
+        client_pool.run();
+        std::vector<std::unique_ptr<LoadClient>> load_clients{};
+        asio::ip::tcp::endpoint const endpoint{asio::ip::make_address("127.0.0.1"), Port};
+        for (int i{0}; i != clients; ++i)
+        {
+            load_clients.push_back(std::make_unique<LoadClient>(client_pool.next(), recording));
+            load_clients.back()->connect(endpoint);
+        }
+        while (server.validated() != clients)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
+        // warm up, then record
+        std::this_thread::sleep_for(std::chrono::milliseconds{200});
+        recording.store(true);
+        auto const start{Clock::now()};
+        std::this_thread::sleep_for(std::chrono::duration<double>{seconds});
+        recording.store(false);
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        // the sockets close with the clients, before the pool destroys their contexts
+        client_pool.stop();
+        serving.store(false);
+        server.wake();
+        update_thread.join();
+        server.stop();
+
+        for (auto const& client : load_clients)
+        {
+            latencies.insert(latencies.end(), client->latencies().cbegin(), client->latencies().cend());
+        }
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    std::cout << std::setw(3) << server_threads << " server threads" << std::setw(7) << clients << " clients"
+              << std::fixed << std::setprecision(1) << std::setw(12)
+              << static_cast<double>(latencies.size()) / elapsed / 1e3 << " k msg/s"
+              << "   latency us p50 " << std::setw(8) << percentile(latencies, 0.50)
+              << " p90 " << std::setw(8) << percentile(latencies, 0.90)
+              << " p99 " << std::setw(8) << percentile(latencies, 0.99)
+              << " max " << std::setw(9) << percentile(latencies, 1.0) << std::endl;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    int const clients{argc > 1 ? std::atoi(argv[1]) : 2000};
+    double const seconds{argc > 2 ? std::atof(argv[2]) : 2.0};
+    std::size_t const max_threads{argc > 3 ? static_cast<std::size_t>(std::atoi(argv[3]))
+                                           : std::max(std::thread::hardware_concurrency(), 1u)};
+    std::size_t const client_threads{argc > 4 ? static_cast<std::size_t>(std::atoi(argv[4])) : 2};
+
+    std::cout << std::thread::hardware_concurrency() << " hardware threads, " << client_threads
+              << " client threads\n";
+    for (std::size_t threads{1}; threads <= max_threads; threads *= 2)
+    {
+        run(clients, seconds, threads, client_threads);
+    }
+}
@@ -0,0 +1,232 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <new>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+#include <olc_net.h>
+
+
+// Receive path of server_interface: loopback clients send bursts of tiny messages - a burst is
+// one write of many framed messages - and the server handles them in update(). Timed until the
+// server has handled every message; the allocations are counted over the same span.
+//
+//   ./olc_networking_receive_bm [clients] [messages per client] [burst] [body bytes]
+namespace
+{
+
+std::atomic<std::size_t> allocations{0};
+
+} // namespace
+
+// counts every allocation - the pragma silences the check that malloc and free are not paired
+// with new and delete, which they are not meant to be here
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (auto* const p{std::malloc(size == 0 ? 1 : size)}) { return p; }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t /* size */) noexcept { std::free(p); }
+#pragma GCC diagnostic pop
+
+
+namespace
+{
+
+enum class ReceiveMsgTypes : std::uint32_t
+{
+    Data
+};
+
+using Clock = std::chrono::steady_clock;
+using Header = olc::net::message_header<ReceiveMsgTypes>;
+
+// below the ephemeral ports, which thousands of clients use up on loopback
+constexpr std::uint16_t Port{30300};
+
+// the handshake answer of a client is the protected scramble() of the connection
+struct handshake : olc::net::connection<ReceiveMsgTypes>
+{
+    using olc::net::connection<ReceiveMsgTypes>::scramble;
+};
+
+class CountingServer : public olc::net::server_interface<ReceiveMsgTypes>
+{
+public:
+    CountingServer() : olc::net::server_interface<ReceiveMsgTypes>{Port}
+    {
+    }
+
+    void on_client_validated(std::shared_ptr<olc::net::connection<ReceiveMsgTypes>> /* client */) override
+    {
+        validated_.fetch_add(1, std::memory_order_release);
+    }
+
+    int validated() const noexcept { return validated_.load(std::memory_order_acquire); }
+
+    std::size_t handled() const noexcept { return handled_; }
+
+protected:
+    bool on_client_connect(std::shared_ptr<olc::net::connection<ReceiveMsgTypes>> const& /* client */) override
+    {
+        return true;
+    }
+
+    void on_message(std::shared_ptr<olc::net::connection<ReceiveMsgTypes>> /* client */,
+                    olc::net::message<ReceiveMsgTypes>& /* msg */) override
+    {
+        ++handled_;
+    }
+
+private:
+    std::atomic<int> validated_{0};
+    std::size_t handled_{0};  // only touched by the thread calling update()
+};
+
+// a raw socket which answers the handshake, then writes its messages burst by burst
+class BurstClient
+{
+public:
+    BurstClient(asio::io_context& context, std::vector<std::uint8_t> const& burst, int bursts)
+        : socket_{context}, burst_{burst}, bursts_{bursts}
+    {
+    }
+
+    void connect(asio::ip::tcp::endpoint const& endpoint)
+    {
+        socket_.connect(endpoint);
+        asio::async_read(socket_, asio::buffer(&handshake_, sizeof(handshake_)),
+            [this](asio::error_code ec, std::size_t /* length */)
+            {
+                if (ec) { return; }
+                handshake_ = handshake::scramble(handshake_);
+                asio::async_write(socket_, asio::buffer(&handshake_, sizeof(handshake_)),
+                    [](asio::error_code /* ec */, std::size_t /* length */) {});
+            });
+    }
+
+    void start()
+    {
+        write_burst();
+    }
+
+private:
+    void write_burst()
+    {
+        if (bursts_-- == 0) { return; }
+        asio::async_write(socket_, asio::buffer(burst_),
+            [this](asio::error_code ec, std::size_t /* length */)
+            {
+                if (!ec) { write_burst(); }
+            });
+    }
+
+    asio::ip::tcp::socket socket_;
+    std::vector<std::uint8_t> const& burst_;
+    int bursts_;
+    std::uint64_t handshake_{0};
+};
+
+// the server reports every connection, from any of its threads - not of interest here
+class Silence
+{
+public:
+    Silence() : out_{std::cout.rdbuf(&sink_)}, err_{std::cerr.rdbuf(&sink_)}
+    {
+    }
+    Silence(Silence const&) = delete;
+    Silence& operator=(Silence const&) = delete;
+    ~Silence()
+    {
+        std::cout.rdbuf(out_);
+        std::cerr.rdbuf(err_);
+    }
+
+private:
+    // discards the characters without keeping any state, so the threads may share it
+    struct null_buffer : std::streambuf
+    {
+        int overflow(int c) override { return traits_type::not_eof(c); }
+    };
+
+    null_buffer sink_{};
+    std::streambuf* out_;
+    std::streambuf* err_;
+};
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    int const clients{argc > 1 ? std::atoi(argv[1]) : 100};
+    int const messages{argc > 2 ? std::atoi(argv[2]) : 10000};
+    int const burst{argc > 3 ? std::atoi(argv[3]) : 100};
+    std::size_t const body_size{argc > 4 ? static_cast<std::size_t>(std::atoi(argv[4])) : 8};
+
+    // one burst - the frames of burst messages, back to back
+    std::vector<std::uint8_t> frames{};
+    Header const header{ReceiveMsgTypes::Data, static_cast<std::uint32_t>(body_size)};
+    for (int i{0}; i != burst; ++i)
+    {
+        auto const* const bytes{reinterpret_cast<std::uint8_t const*>(&header)};
+        frames.insert(frames.end(), bytes, bytes + sizeof(header));
+        frames.insert(frames.end(), body_size, std::uint8_t{0x5A});
+    }
+
+    auto const total{static_cast<std::size_t>(clients) * static_cast<std::size_t>(messages / burst * burst)};
+    double elapsed{0.0};
+    std::size_t allocated{0};
+    {
+        Silence silence{};
+        CountingServer server{};
+        server.start();
+        asio::io_context context{};
+        auto guard{asio::make_work_guard(context)};
+        std::thread client_thread{[&context]() { context.run(); }};
+        std::vector<std::unique_ptr<BurstClient>> burst_clients{};
+        asio::ip::tcp::endpoint const endpoint{asio::ip::make_address("127.0.0.1"), Port};
+        for (int i{0}; i != clients; ++i)
+        {
+            burst_clients.push_back(std::make_unique<BurstClient>(context, frames, messages / burst));
+            burst_clients.back()->connect(endpoint);
+        }
+        while (server.validated() != clients)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+        }
+
+        auto const allocations_before{allocations.load()};
+        auto const start{Clock::now()};
+        asio::post(context, [&burst_clients]() { for (auto& c : burst_clients) { c->start(); } });
+        while (server.handled() != total)
+        {
+            server.update(std::numeric_limits<std::size_t>::max(), true);
+        }
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        allocated = allocations.load() - allocations_before;
+
+        guard.reset();
+        context.stop();
+        client_thread.join();
+        server.stop();
+    }
+
+    std::cout << clients << " clients, bursts of " << burst << " messages of " << body_size << " bytes: "
+              << std::fixed << std::setprecision(2) << static_cast<double>(total) / elapsed / 1e6
+              << " M msg/s, " << static_cast<double>(allocated) / static_cast<double>(total)
+              << " allocations/msg" << std::endl;
+}
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <olc_net.h>
+
+
+// The connection registry of server_interface under churn: every round a broadcast walks all the
+// connections, a number of clients is looked up by ID, and as many disconnect and are replaced by
+// new ones - without sockets, the connections are stand-ins which count what they were sent.
+//  - deque:    the former registry, a deque of shared_ptr - lookup by a scan, disconnect by
+//              std::remove
+//  - slot_map: the registry of server_interface now, keyed by the connection IDs
+//
+//   ./olc_networking_registry_bm [connections] [rounds] [churn per round]
+namespace
+{
+
+using Clock = std::chrono::steady_clock;
+
+struct stand_in
+{
+    std::uint32_t id{0};
+    bool connected{true};
+    std::uint64_t sent{0};
+};
+
+using Connection = std::shared_ptr<stand_in>;
+
+class DequeRegistry
+{
+public:
+    std::uint32_t add(Connection con)
+    {
+        con->id = id_counter_++;
+        connections_.push_back(std::move(con));
+        return connections_.back()->id;
+    }
+
+    Connection find(std::uint32_t id) const
+    {
+        auto const it{std::find_if(connections_.cbegin(), connections_.cend(),
+            [id](Connection const& con) { return con->id == id; })};
+        return it == connections_.cend() ? nullptr : *it;
+    }
+
+    void remove(Connection const& con)
+    {
+        connections_.erase(std::remove(connections_.begin(), connections_.end(), con), connections_.end());
+    }
+
+    void broadcast()
+    {
+        for (auto& con : connections_)
+        {
+            if (con->connected) { ++con->sent; }
+        }
+    }
+
+private:
+    std::deque<Connection> connections_{};
+    std::uint32_t id_counter_{10000};
+};
+
+class SlotMapRegistry
+{
+public:
+    std::uint32_t add(Connection con)
+    {
+        auto* const raw{con.get()};
+        raw->id = connections_.insert(std::move(con));
+        return raw->id;
+    }
+
+    Connection find(std::uint32_t id) const
+    {
+        auto const* const con{connections_.find(id)};
+        return con ? *con : nullptr;
+    }
+
+    void remove(Connection const& con)
+    {
+        connections_.erase(con->id);
+    }
+
+    void broadcast()
+    {
+        for (auto& con : connections_)
+        {
+            if (con->connected) { ++con->sent; }
+        }
+    }
+
+private:
+    olc::net::slot_map<Connection> connections_{};
+};
+
+template<typename Registry>
+void run(char const* name, int connections, int rounds, int churn)
+{
+    std::mt19937 rng{42};
+    Registry registry{};
+    std::vector<std::uint32_t> ids{};
+    for (int i{0}; i != connections; ++i)
+    {
+        ids.push_back(registry.add(std::make_shared<stand_in>()));
+    }
+
+    double broadcast_s{0.0};
+    double lookup_s{0.0};
+    double churn_s{0.0};
+    std::uint64_t found{0};
+    for (int r{0}; r != rounds; ++r)
+    {
+        auto t0{Clock::now()};
+        registry.broadcast();
+        auto t1{Clock::now()};
+        broadcast_s += std::chrono::duration<double>(t1 - t0).count();
+
+        std::vector<std::size_t> picks{};
+        for (int c{0}; c != churn; ++c)
+        {
+            picks.push_back(std::uniform_int_distribution<std::size_t>{0, ids.size() - 1}(rng));
+        }
+
+        t0 = Clock::now();
+        for (auto const pick : picks)
+        {
+            if (registry.find(ids[pick])) { ++found; }
+        }
+        t1 = Clock::now();
+        lookup_s += std::chrono::duration<double>(t1 - t0).count();
+
+        // the picked clients disconnect, new ones take their places
+        t0 = Clock::now();
+        for (auto const pick : picks)
+        {
+            if (auto con{registry.find(ids[pick])})
+            {
+                registry.remove(con);
+            }
+            ids[pick] = registry.add(std::make_shared<stand_in>());
+        }
+        t1 = Clock::now();
+        churn_s += std::chrono::duration<double>(t1 - t0).count();
+    }
+
+    auto const operations{std::max(static_cast<double>(rounds) * churn, 1.0)};
+    std::cout << std::left << std::setw(10) << name << std::right << std::setw(8) << connections << " connections"
+              << std::fixed << std::setprecision(1)
+              << "   broadcast " << std::setw(9) << broadcast_s / rounds * 1e6 << " us"
+              << "   lookup " << std::setw(9) << lookup_s / operations * 1e9 << " ns"
+              << "   disconnect+connect " << std::setw(9) << churn_s / operations * 1e9 << " ns"
+              << "   (" << found << " found)" << std::endl;
+}
+
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    int const connections{argc > 1 ? std::atoi(argv[1]) : 100000};
+    int const rounds{argc > 2 ? std::atoi(argv[2]) : 20};
+    int const churn{argc > 3 ? std::atoi(argv[3]) : 1000};
+
+    run<DequeRegistry>("deque", connections, rounds, churn);
+    run<SlotMapRegistry>("slot_map", connections, rounds, churn);
+}
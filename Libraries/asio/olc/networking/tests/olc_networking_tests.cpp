@@ -1,7 +1,145 @@
-#include <networking/net_common.h>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <olc_net.h>
+
+
+// Checks without a test framework: every failed check is reported and fails the run.
+namespace
+{
+
+enum class TestMsgTypes : std::uint32_t
+{
+    Counter
+};
+
+using Clock = std::chrono::steady_clock;
+
+// below the ephemeral ports, next to the ones of the benchmarks
+constexpr std::uint16_t Port{30300};
+
+int failures{0};
+
+void check(bool condition, char const* what)
+{
+    if (!condition)
+    {
+        std::cerr << "FAILED: " << what << "\n";
+        ++failures;
+    }
+}
+
+class CounterServer : public olc::net::server_interface<TestMsgTypes>
+{
+public:
+    CounterServer() : olc::net::server_interface<TestMsgTypes>{Port}
+    {
+    }
+
+    void on_client_validated(std::shared_ptr<olc::net::connection<TestMsgTypes>> client) override
+    {
+        client_id_ = client->get_id();
+        validated_.store(true, std::memory_order_release);
+    }
+
+    bool validated() const noexcept { return validated_.load(std::memory_order_acquire); }
+    // valid once validated() holds
+    std::uint32_t client_id() const noexcept { return client_id_; }
+
+protected:
+    bool on_client_connect(std::shared_ptr<olc::net::connection<TestMsgTypes>> const& /* client */) override
+    {
+        return true;
+    }
+
+private:
+    std::uint32_t client_id_{0};
+    std::atomic<bool> validated_{false};
+};
+
+void takes_at_least_one_message()
+{
+    check(olc::net::write_limits{0, 0}.takes(0, 0), "zero caps take the first message");
+    check(!olc::net::write_limits{0, 0}.takes(1, 100), "zero caps take no second message");
+    check(olc::net::write_limits{1, 1}.takes(0, 0), "a cap of one takes the first message");
+    check(!olc::net::write_limits{1, 1 << 20}.takes(1, 100), "the message cap ends the write");
+    check(!olc::net::write_limits{64, 100}.takes(1, 100), "the byte cap ends the write");
+    check(olc::net::write_limits{}.takes(1, 100), "the default caps take more messages");
+}
+
+// the server sends a burst of messages, which queue up behind the first write - all of them
+// have to reach the client in order, whatever the caps of the gathered writes
+void delivers_burst(olc::net::write_limits limits, char const* what)
+{
+    constexpr std::uint32_t Burst{1000};
+
+    CounterServer server{};
+    server.set_write_limits(limits);
+    server.start();
+    olc::net::client_interface<TestMsgTypes> client{};
+    client.connect("127.0.0.1", Port);
+
+    auto const deadline{Clock::now() + std::chrono::seconds{5}};
+    while (!server.validated() && Clock::now() < deadline)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+    check(server.validated(), what);
+
+    for (std::uint32_t i{0}; i != Burst; ++i)
+    {
+        olc::net::message<TestMsgTypes> msg{};
+        msg.header.id = TestMsgTypes::Counter;
+        msg << i;
+        server.message_client(server.client_id(), msg);
+    }
+
+    std::uint32_t received{0};
+    bool in_order{true};
+    std::vector<olc::net::owned_message<TestMsgTypes>> batch{};
+    while (received != Burst && Clock::now() < deadline)
+    {
+        batch.clear();
+        if (client.incomming().try_pop_bulk(batch) == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds{1});
+            continue;
+        }
+        for (auto& owned : batch)
+        {
+            std::uint32_t value{};
+            owned.msg >> value;
+            in_order = in_order && value == received;
+            ++received;
+        }
+    }
+    check(received == Burst && in_order, what);
+
+    client.disconnect();
+    server.stop();
+}
+
+} // namespace
 
 
 int main()
 {
-    
+    takes_at_least_one_message();
+    delivers_burst({}, "burst with the default caps");
+    delivers_burst({1, 1}, "burst with a cap of one message");
+    delivers_burst({0, 0}, "burst with zero caps");
+    delivers_burst({16, 256}, "burst with a byte cap");
+
+    if (failures != 0)
+    {
+        std::cerr << failures << " check(s) failed\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "all checks passed\n";
+    return EXIT_SUCCESS;
 }
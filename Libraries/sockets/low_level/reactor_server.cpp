@@ -0,0 +1,291 @@
+// reactor_server.cpp -- the telnet chat server of poll_server.cpp on an edge-triggered epoll reactor
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <string>
+#include <system_error>
+#include <unordered_map>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+
+#include <reactor/reactor.h>
+
+namespace {
+constexpr const char* Port{"9034"};  // Port we're listening on
+constexpr auto Idle_Timeout{std::chrono::minutes{10}};  // clients silent for longer are dropped
+constexpr auto Idle_Check{std::chrono::seconds{30}};
+constexpr std::size_t Max_Outbox{64 * 1024};  // clients which fall further behind are dropped
+}  // namespace
+
+// get sockaddr, IPv4, IPv6
+void* get_in_addr(sockaddr* sa)
+{
+    if (sa->sa_family == AF_INET) {
+        return &(reinterpret_cast<sockaddr_in*>(sa)->sin_addr);
+    }
+    else {
+        return &(reinterpret_cast<sockaddr_in6*>(sa)->sin6_addr);
+    }
+}
+
+// get a listening socket
+int get_listener_socket() noexcept
+{
+    int yes{1};  // For setsockopt SO_REUSEADDR
+
+    addrinfo hints{};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+    addrinfo* ai;
+    if (auto const sc{getaddrinfo(nullptr, Port, &hints, &ai)}; sc != 0)
+    {
+        fmt::print(stderr, "[reactor server] getaddrinfo: {}\n", gai_strerror(sc));
+        std::exit(1);
+    }
+
+    int listener;
+    addrinfo* p;
+    for (p = ai; p != nullptr; p = p->ai_next)
+    {
+        listener = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (listener < 0) { continue; }
+
+        // reuse sockets
+        setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+        if (bind(listener, p->ai_addr, p->ai_addrlen) < 0)
+        {
+            close(listener);
+            continue;
+        }
+
+        break;
+    }
+
+    freeaddrinfo(ai);
+
+    if (p == nullptr)
+    {
+        fmt::print("[reactor server] failed to bind address\n");
+        return -1;
+    }
+
+    if (listen(listener, SOMAXCONN) == -1)
+    {
+        return -1;
+    }
+
+    return listener;
+}
+
+// The sockets are non-blocking: what a client cannot take right away waits in its outbox and is
+// sent once the socket becomes writable again. The outbox is capped, so a client which stops
+// reading cannot make the server buffer without bound.
+class ChatServer
+{
+public:
+    explicit ChatServer(int listener) : listener_{listener}
+    {
+        reactor_.add(listener_, EPOLLIN, [this](std::uint32_t) { accept_clients(); });
+        reactor_.add_timer(Idle_Check, [this]() { drop_idle_clients(); }, Idle_Check);
+    }
+
+    void run()
+    {
+        reactor_.run();
+    }
+
+private:
+    struct client
+    {
+        std::string outbox{};
+        jam::net::reactor::clock::time_point last_heard{};
+    };
+
+    void accept_clients()
+    {
+        // edge-triggered - take every pending connection
+        for (;;)
+        {
+            sockaddr_storage remoteaddr; // Client address
+            socklen_t addrlen{sizeof(remoteaddr)};
+            const int newfd = accept(listener_, reinterpret_cast<sockaddr*>(&remoteaddr), &addrlen);
+            if (newfd == -1)
+            {
+                // interrupted, or a connection reset while it waited - the others are still pending
+                if (errno == EINTR || errno == ECONNABORTED)
+                {
+                    continue;
+                }
+                // out of descriptors or memory - the connections left pending are taken with the
+                // next one, the listener does not signal them again
+                if (errno != EAGAIN)
+                {
+                    fmt::print(stderr, "[reactor server] accept error: {}\n", std::strerror(errno));
+                }
+                return;
+            }
+
+            // watched first - a client the reactor cannot take is turned away, not recorded
+            try
+            {
+                reactor_.add(newfd, EPOLLIN | EPOLLOUT | EPOLLRDHUP,
+                    [this, newfd](std::uint32_t events) { on_client_events(newfd, events); });
+            }
+            catch (std::system_error const& e)
+            {
+                fmt::print(stderr, "[reactor server] socket {} refused: {}\n", newfd, e.what());
+                close(newfd);
+                continue;
+            }
+            clients_[newfd].last_heard = jam::net::reactor::clock::now();
+            char remote_ip[INET6_ADDRSTRLEN];
+            fmt::print("[reactor server]: new connection from {} on socket {}\n",
+                inet_ntop(remoteaddr.ss_family,
+                    get_in_addr(reinterpret_cast<sockaddr*>(&remoteaddr)), remote_ip, INET6_ADDRSTRLEN),
+                newfd);
+        }
+    }
+
+    void on_client_events(int fd, std::uint32_t events)
+    {
+        if (events & EPOLLOUT)
+        {
+            flush(fd);
+        }
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))
+        {
+            receive(fd);
+        }
+    }
+
+    void receive(int fd)
+    {
+        char buf[256];
+        // edge-triggered - read until the socket is drained
+        for (;;)
+        {
+            const ssize_t nbytes = recv(fd, buf, sizeof(buf), 0);
+            if (nbytes > 0)
+            {
+                clients_[fd].last_heard = jam::net::reactor::clock::now();
+                broadcast(fd, buf, static_cast<std::size_t>(nbytes));
+                continue;
+            }
+
+            if (nbytes == 0)
+            {
+                // connection closed
+                fmt::print("[reactor server] socket {} hung up\n", fd);
+            }
+            else if (errno == EAGAIN)
+            {
+                return;
+            }
+            else
+            {
+                fmt::print(stderr, "[reactor server] recv error {}\n", std::strerror(errno));
+            }
+            disconnect(fd);  // bye!
+            return;
+        }
+    }
+
+    // send to everyone except ourselves - a client which does not read keeps what it was sent in
+    // its outbox, and is dropped before the outbox exceeds Max_Outbox
+    void broadcast(int sender_fd, char const* buf, std::size_t len)
+    {
+        std::vector<int> too_slow{};
+        for (auto& [dest_fd, dest] : clients_)
+        {
+            if (dest_fd == sender_fd)
+            {
+                continue;
+            }
+            if (dest.outbox.size() + len > Max_Outbox)
+            {
+                too_slow.push_back(dest_fd);
+                continue;
+            }
+            dest.outbox.append(buf, len);
+            flush(dest_fd);
+        }
+        // not while iterating clients_, which disconnect() erases from
+        for (auto const fd : too_slow)
+        {
+            fmt::print("[reactor server] socket {} too slow, dropped\n", fd);
+            disconnect(fd);
+        }
+    }
+
+    void flush(int fd)
+    {
+        auto& outbox{clients_[fd].outbox};
+        std::size_t sent{0};
+        while (sent != outbox.size())
+        {
+            const auto n = send(fd, outbox.data() + sent, outbox.size() - sent, MSG_NOSIGNAL);
+            if (n == -1)
+            {
+                if (errno != EAGAIN)
+                {
+                    fmt::print(stderr, "[reactor server] send error {}\n", std::strerror(errno));
+                }
+                break;
+            }
+            sent += static_cast<std::size_t>(n);
+        }
+        outbox.erase(0, sent);
+    }
+
+    void drop_idle_clients()
+    {
+        auto const now{jam::net::reactor::clock::now()};
+        for (auto it{clients_.begin()}; it != clients_.end(); )
+        {
+            auto const fd{it->first};
+            ++it;
+            if (now - clients_[fd].last_heard > Idle_Timeout)
+            {
+                fmt::print("[reactor server] socket {} idle, dropped\n", fd);
+                disconnect(fd);
+            }
+        }
+    }
+
+    void disconnect(int fd)
+    {
+        reactor_.remove(fd);
+        close(fd);
+        clients_.erase(fd);
+    }
+
+    jam::net::reactor reactor_{};
+    int listener_;
+    std::unordered_map<int, client> clients_{};
+};
+
+int main()
+{
+    const int listener = get_listener_socket();
+    if (listener == -1)
+    {
+        fmt::print(stderr, "[reactor server] error getting listening socket\n");
+        std::exit(1);
+    }
+
+    ChatServer server{listener};
+    server.run();
+}
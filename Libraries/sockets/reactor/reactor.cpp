@@ -0,0 +1,306 @@
+#include "reactor/reactor.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+
+namespace jam::net
+{
+
+namespace
+{
+constexpr std::size_t Max_Events{256};  // events taken per epoll_wait()
+constexpr std::uint64_t Wake_Key{std::numeric_limits<std::uint64_t>::max()};
+constexpr std::size_t Min_Compacted_Deadlines{64};  // fewer cancelled deadlines are left in the queue
+
+std::uint64_t make_key(int fd, std::uint32_t generation) noexcept
+{
+    return (std::uint64_t{generation} << 32) | static_cast<std::uint32_t>(fd);
+}
+
+[[noreturn]] void throw_errno(char const* what)
+{
+    throw std::system_error{errno, std::generic_category(), what};
+}
+} // namespace
+
+
+reactor::reactor() : events_(Max_Events)
+{
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ == -1)
+    {
+        throw_errno("epoll_create1");
+    }
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ == -1)
+    {
+        auto const error{errno};
+        close(epoll_fd_);
+        throw std::system_error{error, std::generic_category(), "eventfd"};
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.u64 = Wake_Key;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev) == -1)
+    {
+        auto const error{errno};
+        close(wake_fd_);
+        close(epoll_fd_);
+        throw std::system_error{error, std::generic_category(), "epoll_ctl"};
+    }
+}
+
+reactor::~reactor()
+{
+    close(wake_fd_);
+    close(epoll_fd_);
+}
+
+void reactor::add(int fd, std::uint32_t events, handler on_events)
+{
+    if (fd < 0)
+    {
+        throw std::system_error{EBADF, std::generic_category(), "reactor::add"};
+    }
+    if (!set_non_blocking(fd))
+    {
+        throw_errno("fcntl");
+    }
+
+    auto const index{static_cast<std::size_t>(fd)};
+    if (index >= entries_.size())
+    {
+        entries_.resize(index + 1);
+    }
+    auto& e{entries_[index]};
+    if (e.on_events)
+    {
+        throw std::system_error{EEXIST, std::generic_category(), "reactor::add"};
+    }
+
+    epoll_event ev{};
+    ev.events = events | EPOLLET;
+    ev.data.u64 = make_key(fd, ++e.generation);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) == -1)
+    {
+        throw_errno("epoll_ctl");
+    }
+    e.on_events = std::make_shared<handler>(std::move(on_events));
+    ++size_;
+}
+
+void reactor::modify(int fd, std::uint32_t events)
+{
+    if (!contains(fd))
+    {
+        throw std::system_error{ENOENT, std::generic_category(), "reactor::modify"};
+    }
+
+    epoll_event ev{};
+    ev.events = events | EPOLLET;
+    ev.data.u64 = make_key(fd, entries_[static_cast<std::size_t>(fd)].generation);
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &ev) == -1)
+    {
+        throw_errno("epoll_ctl");
+    }
+}
+
+void reactor::remove(int fd) noexcept
+{
+    if (!contains(fd))
+    {
+        return;
+    }
+
+    // fails only if the descriptor was closed already, which took it out of the set as well
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    auto& e{entries_[static_cast<std::size_t>(fd)]};
+    e.on_events.reset();
+    // events of this wakeup which are still to be handled carry the old generation
+    ++e.generation;
+    --size_;
+}
+
+reactor::timer_id reactor::add_timer(clock::duration delay, timer_handler on_timer, clock::duration period)
+{
+    auto const id{next_timer_id_++};
+    timers_.emplace(id, timer{std::move(on_timer), period});
+    deadlines_.push({clock::now() + delay, id});
+    return id;
+}
+
+bool reactor::cancel_timer(timer_id id) noexcept
+{
+    if (timers_.erase(id) == 0)
+    {
+        return false;
+    }
+
+    // the deadline cannot be taken out of the middle of the heap - it stays queued and is skipped
+    // once it is due, unless it is the earliest one, which would cut the next wait short
+    while (!deadlines_.empty() && timers_.count(deadlines_.top().id) == 0)
+    {
+        deadlines_.pop();
+    }
+    // timers cancelled long before they are due would pile up - the queue is rebuilt once they
+    // are most of it, which keeps the cost per cancelled timer constant
+    if (deadlines_.size() > Min_Compacted_Deadlines && deadlines_.size() > 2 * timers_.size())
+    {
+        compact_deadlines();
+    }
+    return true;
+}
+
+std::size_t reactor::run_once(int timeout_ms)
+{
+    auto const count{epoll_wait(epoll_fd_, events_.data(), static_cast<int>(events_.size()),
+                                wait_timeout(timeout_ms))};
+    if (count == -1)
+    {
+        if (errno == EINTR)
+        {
+            return run_timers();
+        }
+        throw_errno("epoll_wait");
+    }
+
+    std::size_t handled{0};
+    for (std::size_t i{0}; i != static_cast<std::size_t>(count); ++i)
+    {
+        auto const key{events_[i].data.u64};
+        if (key == Wake_Key)
+        {
+            std::uint64_t value{};
+            [[maybe_unused]] auto const n{read(wake_fd_, &value, sizeof(value))};
+            continue;
+        }
+
+        auto const fd{static_cast<std::size_t>(key & 0xFFFF'FFFFu)};
+        auto const generation{static_cast<std::uint32_t>(key >> 32)};
+        if (fd >= entries_.size() || entries_[fd].generation != generation || !entries_[fd].on_events)
+        {
+            continue;
+        }
+        // keeps the handler alive even if it removes its own descriptor
+        auto const on_events{entries_[fd].on_events};
+        (*on_events)(events_[i].events);
+        ++handled;
+    }
+
+    // a full buffer means more events are waiting - take more of them next time
+    if (static_cast<std::size_t>(count) == events_.size())
+    {
+        events_.resize(events_.size() * 2);
+    }
+
+    return handled + run_timers();
+}
+
+void reactor::run()
+{
+    while (!stopped_.load(std::memory_order_acquire))
+    {
+        run_once();
+    }
+    stopped_.store(false, std::memory_order_relaxed);
+}
+
+void reactor::stop() noexcept
+{
+    stopped_.store(true, std::memory_order_release);
+    std::uint64_t const one{1};
+    [[maybe_unused]] auto const n{write(wake_fd_, &one, sizeof(one))};
+}
+
+bool reactor::set_non_blocking(int fd) noexcept
+{
+    auto const flags{fcntl(fd, F_GETFL, 0)};
+    return flags != -1 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+}
+
+std::size_t reactor::run_timers()
+{
+    std::size_t handled{0};
+    auto const now{clock::now()};
+    while (!deadlines_.empty() && deadlines_.top().when <= now)
+    {
+        auto const due{deadlines_.top()};
+        deadlines_.pop();
+        auto const it{timers_.find(due.id)};
+        if (it == timers_.end())
+        {
+            continue;   // cancelled
+        }
+
+        // the handler is moved out first - it may cancel its own timer or add others
+        auto on_timer{std::move(it->second.on_timer)};
+        auto const period{it->second.period};
+        if (period == clock::duration::zero())
+        {
+            timers_.erase(it);
+            on_timer();
+        }
+        else
+        {
+            on_timer();
+            if (auto const again{timers_.find(due.id)}; again != timers_.end())
+            {
+                again->second.on_timer = std::move(on_timer);
+                deadlines_.push({due.when + period, due.id});
+            }
+        }
+        ++handled;
+    }
+    return handled;
+}
+
+void reactor::compact_deadlines() noexcept
+{
+    std::vector<deadline> pending{};
+    try
+    {
+        pending.reserve(timers_.size());
+    }
+    catch (std::bad_alloc const&)
+    {
+        return;     // the cancelled deadlines are skipped once due, as before
+    }
+
+    // every timer has at most one deadline queued, so the reserved room is enough
+    while (!deadlines_.empty())
+    {
+        if (timers_.count(deadlines_.top().id) != 0)
+        {
+            pending.push_back(deadlines_.top());
+        }
+        deadlines_.pop();
+    }
+    deadlines_ = decltype(deadlines_){std::greater<>{}, std::move(pending)};
+}
+
+int reactor::wait_timeout(int timeout_ms) const noexcept
+{
+    if (deadlines_.empty())
+    {
+        return timeout_ms;
+    }
+
+    // rounded up - waking up before the timer is due would only spin
+    auto const until{deadlines_.top().when - clock::now()};
+    auto const ms{std::chrono::ceil<std::chrono::milliseconds>(until).count()};
+    auto const timer_ms{static_cast<int>(std::clamp<decltype(ms)>(ms, 0, std::numeric_limits<int>::max()))};
+    return timeout_ms < 0 ? timer_ms : std::min(timeout_ms, timer_ms);
+}
+
+} // namespace jam::net
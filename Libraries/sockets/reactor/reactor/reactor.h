@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+
+
+namespace jam::net
+{
+
+// An event loop over epoll in edge-triggered mode.
+//
+// Unlike select() and poll() the set of descriptors lives in the kernel: adding and removing a
+// descriptor is one epoll_ctl() and a wakeup returns only the descriptors which are ready, so the
+// cost of a wakeup does not grow with the number of idle connections.
+//
+// Edge-triggered - a handler is called once when a descriptor becomes ready, not as long as it is
+// ready. The handler therefore has to read (or write) until the call fails with EAGAIN, which is
+// why add() switches the descriptor to non-blocking mode.
+//
+// The handlers are kept in a vector indexed by the descriptor. Every add() bumps a generation which
+// is carried in the epoll event, so an event for a descriptor removed - and maybe reused - earlier
+// in the same wakeup is dropped. A handler may add and remove descriptors, itself included.
+//
+// Timers run on the same thread, between the wakeups; the wait is cut short by the earliest one.
+// Everything but stop() must be called on the thread running the loop.
+class reactor
+{
+public:
+    using clock = std::chrono::steady_clock;
+    // called with the ready events - EPOLLIN, EPOLLOUT, EPOLLRDHUP, EPOLLHUP, EPOLLERR
+    using handler = std::function<void(std::uint32_t events)>;
+    using timer_handler = std::function<void()>;
+    using timer_id = std::uint64_t;
+
+    reactor();
+    ~reactor();
+
+    reactor(reactor const&) = delete;
+    reactor& operator=(reactor const&) = delete;
+
+    // watches the descriptor for the events, EPOLLET is implied; throws std::system_error
+    void add(int fd, std::uint32_t events, handler on_events);
+    void modify(int fd, std::uint32_t events);
+    // stops watching the descriptor - closing it is up to the caller, after this call
+    void remove(int fd) noexcept;
+    bool contains(int fd) const noexcept
+    {
+        return fd >= 0 && static_cast<std::size_t>(fd) < entries_.size() &&
+               entries_[static_cast<std::size_t>(fd)].on_events != nullptr;
+    }
+    // number of descriptors watched
+    std::size_t size() const noexcept { return size_; }
+
+    // calls the handler after the delay, and then every period if one is given
+    timer_id add_timer(clock::duration delay, timer_handler on_timer,
+                       clock::duration period = clock::duration::zero());
+    // the timer is not called any more; its deadline may stay queued until it is due, but the
+    // queue is compacted once such deadlines make up most of it
+    bool cancel_timer(timer_id id) noexcept;
+    // number of deadlines queued, those of cancelled timers not dropped yet included
+    std::size_t queued_deadlines() const noexcept { return deadlines_.size(); }
+
+    // waits up to timeout_ms (-1 waits for ever) for events or the next timer and handles them;
+    // returns the number of handlers called
+    std::size_t run_once(int timeout_ms = -1);
+    // handles events until stop()
+    void run();
+    // ends run() - may be called from any thread
+    void stop() noexcept;
+
+    static bool set_non_blocking(int fd) noexcept;
+
+private:
+    struct entry
+    {
+        // shared, so a handler which removes its own descriptor is not destroyed while it runs
+        std::shared_ptr<handler> on_events{};
+        std::uint32_t generation{0};
+    };
+
+    struct timer
+    {
+        timer_handler on_timer{};
+        clock::duration period{};
+    };
+
+    struct deadline
+    {
+        clock::time_point when;
+        timer_id id;
+
+        bool operator>(deadline const& other) const noexcept { return when > other.when; }
+    };
+
+    std::size_t run_timers();
+    // drops the deadlines of cancelled timers
+    void compact_deadlines() noexcept;
+    int wait_timeout(int timeout_ms) const noexcept;
+
+    int epoll_fd_{-1};
+    // written to by stop(), to wake the thread waiting in epoll_wait()
+    int wake_fd_{-1};
+    std::atomic<bool> stopped_{false};
+
+    std::vector<entry> entries_{};
+    std::size_t size_{0};
+    std::vector<epoll_event> events_;
+
+    std::priority_queue<deadline, std::vector<deadline>, std::greater<>> deadlines_{};
+    std::unordered_map<timer_id, timer> timers_{};
+    timer_id next_timer_id_{1};
+};
+
+} // namespace jam::net
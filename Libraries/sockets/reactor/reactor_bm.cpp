@@ -0,0 +1,388 @@
+// reactor_bm.cpp -- an echo server on select(), poll() and the epoll reactor, under idle connections
+//
+// A number of idle connections is opened and left alone, then a few active clients ping the server
+// in a closed loop - send a message, wait for the echo, send the next one. Reported are the round
+// trips per second. select() and poll() scan every connection on each wakeup, so their cost grows
+// with the idle ones; epoll returns only the ready ones.
+// select() cannot watch descriptors past FD_SETSIZE, it is skipped when they would not fit.
+//
+//   ./reactor_bm [idle connections] [active connections] [seconds]
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <fmt/core.h>
+
+#include <reactor/reactor.h>
+
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+
+constexpr std::uint16_t Port{30400};        // below the ephemeral ports the clients take
+constexpr std::size_t Message_Size{64};
+constexpr auto Stop_Check{std::chrono::milliseconds{100}};
+
+[[noreturn]] void fail(char const* what)
+{
+    fmt::print(stderr, "reactor_bm: {} failed {}\n", what, std::strerror(errno));
+    std::exit(1);
+}
+
+sockaddr_in loopback() noexcept
+{
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(Port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    return addr;
+}
+
+int listen_on_loopback()
+{
+    const int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == -1) { fail("socket"); }
+    int yes{1};
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+    auto const addr{loopback()};
+    if (bind(listener, reinterpret_cast<sockaddr const*>(&addr), sizeof(addr)) == -1) { fail("bind"); }
+    if (listen(listener, SOMAXCONN) == -1) { fail("listen"); }
+    jam::net::reactor::set_non_blocking(listener);
+    return listener;
+}
+
+int connect_to_loopback()
+{
+    const int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1) { fail("socket"); }
+    auto const addr{loopback()};
+    if (connect(fd, reinterpret_cast<sockaddr const*>(&addr), sizeof(addr)) == -1) { fail("connect"); }
+    int yes{1};
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+    return fd;
+}
+
+// closes with a reset, which leaves no connection behind in TIME_WAIT for the next run
+void abort_connection(int fd) noexcept
+{
+    linger l{};
+    l.l_onoff = 1;
+    l.l_linger = 0;
+    setsockopt(fd, SOL_SOCKET, SO_LINGER, &l, sizeof(l));
+    close(fd);
+}
+
+void send_all(int fd, char const* buf, std::size_t len) noexcept
+{
+    std::size_t sent{0};
+    while (sent != len)
+    {
+        const auto n = send(fd, buf + sent, len - sent, MSG_NOSIGNAL);
+        if (n == -1)
+        {
+            if (errno == EAGAIN) { continue; }
+            return;
+        }
+        sent += static_cast<std::size_t>(n);
+    }
+}
+
+// echoes what arrived - once, or until the socket is drained; false once the peer is gone
+bool echo(int fd, bool drain) noexcept
+{
+    char buf[4096];
+    for (;;)
+    {
+        const auto n = recv(fd, buf, sizeof(buf), 0);
+        if (n > 0)
+        {
+            send_all(fd, buf, static_cast<std::size_t>(n));
+            if (!drain) { return true; }
+            continue;
+        }
+        return n == -1 && errno == EAGAIN;
+    }
+}
+
+// accepts every pending connection, non-blocking, and hands it on
+template<typename OnAccepted>
+void accept_all(int listener, std::atomic<std::size_t>& accepted, OnAccepted on_accepted)
+{
+    for (;;)
+    {
+        const int fd = accept(listener, nullptr, nullptr);
+        if (fd == -1) { return; }
+        jam::net::reactor::set_non_blocking(fd);
+        int yes{1};
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &yes, sizeof(yes));
+        on_accepted(fd);
+        accepted.fetch_add(1, std::memory_order_release);
+    }
+}
+
+// --- servers - each runs until stop is set and closes its connections on the way out
+
+void select_server(int listener, std::atomic<bool> const& stop, std::atomic<std::size_t>& accepted)
+{
+    fd_set master;
+    FD_ZERO(&master);
+    FD_SET(listener, &master);
+    int maxfd{listener};
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        fd_set read_fds = master;
+        timeval tv{0, std::chrono::microseconds{Stop_Check}.count()};
+        if (select(maxfd + 1, &read_fds, nullptr, nullptr, &tv) <= 0) { continue; }
+
+        for (int fd{0}; fd <= maxfd; ++fd)
+        {
+            if (!FD_ISSET(fd, &read_fds)) { continue; }
+            if (fd == listener)
+            {
+                accept_all(listener, accepted, [&master, &maxfd](int newfd)
+                {
+                    FD_SET(newfd, &master);
+                    maxfd = std::max(maxfd, newfd);
+                });
+            }
+            else if (!echo(fd, false))
+            {
+                close(fd);
+                FD_CLR(fd, &master);
+            }
+        }
+    }
+    for (int fd{0}; fd <= maxfd; ++fd)
+    {
+        if (fd != listener && FD_ISSET(fd, &master)) { close(fd); }
+    }
+}
+
+void poll_server(int listener, std::atomic<bool> const& stop, std::atomic<std::size_t>& accepted)
+{
+    std::vector<pollfd> pfds{};
+    pfds.push_back({listener, POLLIN, 0});
+    while (!stop.load(std::memory_order_relaxed))
+    {
+        if (poll(pfds.data(), pfds.size(), static_cast<int>(Stop_Check.count())) <= 0) { continue; }
+
+        for (std::size_t i{0}; i != pfds.size(); )
+        {
+            if (!(pfds[i].revents & (POLLIN | POLLHUP | POLLERR))) { ++i; continue; }
+            if (pfds[i].fd == listener)
+            {
+                accept_all(listener, accepted, [&pfds](int newfd) { pfds.push_back({newfd, POLLIN, 0}); });
+                ++i;
+            }
+            else if (!echo(pfds[i].fd, false))
+            {
+                close(pfds[i].fd);
+                pfds[i] = pfds.back();
+                pfds.pop_back();
+            }
+            else
+            {
+                ++i;
+            }
+        }
+    }
+    for (auto const& pfd : pfds)
+    {
+        if (pfd.fd != listener) { close(pfd.fd); }
+    }
+}
+
+void reactor_server(int listener, std::atomic<bool> const& stop, std::atomic<std::size_t>& accepted)
+{
+    jam::net::reactor reactor{};
+    std::vector<int> fds{};
+    reactor.add(listener, EPOLLIN, [&](std::uint32_t)
+    {
+        accept_all(listener, accepted, [&reactor, &fds](int newfd)
+        {
+            fds.push_back(newfd);
+            reactor.add(newfd, EPOLLIN | EPOLLRDHUP, [&reactor, newfd](std::uint32_t)
+            {
+                if (!echo(newfd, true))
+                {
+                    reactor.remove(newfd);
+                    close(newfd);
+                }
+            });
+        });
+    });
+    reactor.add_timer(Stop_Check, [&reactor, &stop]()
+    {
+        if (stop.load(std::memory_order_relaxed)) { reactor.stop(); }
+    }, Stop_Check);
+    reactor.run();
+
+    reactor.remove(listener);
+    for (auto const fd : fds)
+    {
+        if (reactor.contains(fd))
+        {
+            reactor.remove(fd);
+            close(fd);
+        }
+    }
+}
+
+// --- the active clients, all on one thread
+
+struct active_client
+{
+    int fd;
+    std::size_t received;
+};
+
+void run_clients(std::vector<int> const& fds, std::atomic<bool> const& stop, std::atomic<std::uint64_t>& round_trips)
+{
+    static constexpr char Message[Message_Size]{};
+    std::vector<active_client> clients{};
+    clients.reserve(fds.size());
+    jam::net::reactor reactor{};
+    for (auto const fd : fds)
+    {
+        clients.push_back({fd, 0});
+        auto& client{clients.back()};
+        reactor.add(fd, EPOLLIN, [&client, &round_trips](std::uint32_t)
+        {
+            char buf[4096];
+            for (;;)
+            {
+                const auto n = recv(client.fd, buf, sizeof(buf), 0);
+                if (n <= 0) { return; }
+                client.received += static_cast<std::size_t>(n);
+                while (client.received >= Message_Size)
+                {
+                    client.received -= Message_Size;
+                    round_trips.fetch_add(1, std::memory_order_relaxed);
+                    send_all(client.fd, Message, Message_Size);
+                }
+            }
+        });
+        send_all(fd, Message, Message_Size);
+    }
+    reactor.add_timer(Stop_Check, [&reactor, &stop]()
+    {
+        if (stop.load(std::memory_order_relaxed)) { reactor.stop(); }
+    }, Stop_Check);
+    reactor.run();
+    for (auto const& client : clients)
+    {
+        reactor.remove(client.fd);
+    }
+}
+
+using Server = void (*)(int, std::atomic<bool> const&, std::atomic<std::size_t>&);
+
+void run(char const* name, Server server, std::size_t idle, std::size_t active, double seconds)
+{
+    const int listener = listen_on_loopback();
+    std::atomic<bool> server_stop{false};
+    std::atomic<std::size_t> accepted{0};
+    std::thread server_thread{[&]() { server(listener, server_stop, accepted); }};
+
+    std::vector<int> idle_fds{};
+    for (std::size_t i{0}; i != idle; ++i)
+    {
+        idle_fds.push_back(connect_to_loopback());
+    }
+    std::vector<int> active_fds{};
+    for (std::size_t i{0}; i != active; ++i)
+    {
+        active_fds.push_back(connect_to_loopback());
+    }
+    while (accepted.load(std::memory_order_acquire) != idle + active)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds{1});
+    }
+
+    std::atomic<bool> client_stop{false};
+    std::atomic<std::uint64_t> round_trips{0};
+    std::thread client_thread{[&]() { run_clients(active_fds, client_stop, round_trips); }};
+
+    // warm up, then count
+    std::this_thread::sleep_for(std::chrono::milliseconds{200});
+    auto const before{round_trips.load()};
+    auto const start{Clock::now()};
+    std::this_thread::sleep_for(std::chrono::duration<double>{seconds});
+    auto const count{round_trips.load() - before};
+    auto const elapsed{std::chrono::duration<double>(Clock::now() - start).count()};
+
+    client_stop.store(true);
+    client_thread.join();
+    server_stop.store(true);
+    server_thread.join();
+    for (auto const fd : active_fds) { abort_connection(fd); }
+    for (auto const fd : idle_fds) { abort_connection(fd); }
+    close(listener);
+
+    auto const per_second{static_cast<double>(count) / elapsed};
+    fmt::print("{:<8}{:>7} idle{:>5} active{:>12.1f} k round trips/s{:>10.1f} us per round trip\n",
+               name, idle, active, per_second / 1e3, static_cast<double>(active) / per_second * 1e6);
+}
+
+// the server and the clients are in this process - two descriptors per connection
+std::size_t fit_descriptor_limit(std::size_t idle, std::size_t active)
+{
+    rlimit limit{};
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    constexpr std::size_t Spare{64};
+    auto const available{(static_cast<std::size_t>(limit.rlim_cur) - Spare) / 2};
+    if (idle + active > available)
+    {
+        auto const fitting{available > active ? available - active : 0};
+        fmt::print("descriptor limit {} - {} idle connections instead of {}\n", limit.rlim_cur, fitting, idle);
+        return fitting;
+    }
+    return idle;
+}
+} // namespace
+
+
+int main(int argc, char* argv[])
+{
+    std::size_t const active{argc > 2 ? static_cast<std::size_t>(std::atoi(argv[2])) : 100};
+    std::size_t const idle{fit_descriptor_limit(argc > 1 ? static_cast<std::size_t>(std::atoi(argv[1])) : 10000, active)};
+    double const seconds{argc > 3 ? std::atof(argv[3]) : 2.0};
+
+    std::vector<std::size_t> idle_counts{0, 400, idle};
+    std::sort(idle_counts.begin(), idle_counts.end());
+    idle_counts.erase(std::unique(idle_counts.begin(), idle_counts.end()), idle_counts.end());
+    for (auto const count : idle_counts)
+    {
+        // the descriptors of both ends, the listener and the standard streams
+        if (2 * (count + active) + 16 < FD_SETSIZE)
+        {
+            run("select", select_server, count, active, seconds);
+        }
+        else
+        {
+            fmt::print("{:<8}{:>7} idle{:>5} active   skipped - descriptors past FD_SETSIZE {}\n",
+                       "select", count, active, FD_SETSIZE);
+        }
+        run("poll", poll_server, count, active, seconds);
+        run("epoll", reactor_server, count, active, seconds);
+    }
+}
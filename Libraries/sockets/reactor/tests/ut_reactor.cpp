@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <reactor/reactor.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace
+{
+
+using namespace std::chrono_literals;
+using jam::net::reactor;
+
+// a connected pair of sockets, closed when it goes out of scope
+struct socket_pair
+{
+    std::array<int, 2> fds{-1, -1};
+
+    socket_pair()
+    {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds.data()) == -1)
+        {
+            throw std::system_error{errno, std::generic_category(), "socketpair"};
+        }
+    }
+    socket_pair(socket_pair const&) = delete;
+    socket_pair& operator=(socket_pair const&) = delete;
+    ~socket_pair()
+    {
+        for (auto const fd : fds)
+        {
+            if (fd != -1) { close(fd); }
+        }
+    }
+
+    int watched() const noexcept { return fds[0]; }
+    int peer() const noexcept { return fds[1]; }
+};
+
+void send_byte(int fd)
+{
+    char const byte{'x'};
+    ASSERT_EQ(write(fd, &byte, 1), 1);
+}
+
+// reads until the non-blocking socket is drained, returns the number of bytes read
+std::size_t drain(int fd)
+{
+    std::size_t total{0};
+    char buf[64];
+    for (;;)
+    {
+        auto const n{read(fd, buf, sizeof(buf))};
+        if (n <= 0) { return total; }
+        total += static_cast<std::size_t>(n);
+    }
+}
+
+TEST(ReactorTest, handler_is_called_once_per_edge)
+{
+    reactor sut{};
+    socket_pair pair{};
+    int calls{0};
+    std::uint32_t seen{0};
+    sut.add(pair.watched(), EPOLLIN, [&](std::uint32_t events)
+    {
+        ++calls;
+        seen = events;
+        drain(pair.watched());
+    });
+    ASSERT_TRUE(sut.contains(pair.watched()));
+    ASSERT_EQ(sut.size(), 1u);
+
+    send_byte(pair.peer());
+    ASSERT_EQ(sut.run_once(1000), 1u);
+    ASSERT_EQ(calls, 1);
+    ASSERT_NE(seen & EPOLLIN, 0u);
+
+    // nothing new arrived - no edge, no call
+    ASSERT_EQ(sut.run_once(10), 0u);
+    ASSERT_EQ(calls, 1);
+}
+
+TEST(ReactorTest, events_of_a_descriptor_removed_and_reused_in_the_same_wakeup_are_dropped)
+{
+    reactor sut{};
+    socket_pair first{};
+    socket_pair second{};
+    std::array<int, 2> calls{0, 0};
+    int reused_calls{0};
+    int reused_fd{-1};
+
+    // whichever handler runs first replaces the other descriptor by a new socket with the same
+    // number - the event of the old one, already taken from epoll, must not reach the new handler
+    auto replace_other = [&](std::size_t self, socket_pair& other)
+    {
+        ++calls[self];
+        if (reused_fd != -1) { return; }
+        reused_fd = other.watched();
+        sut.remove(reused_fd);
+        socket_pair fresh{};
+        ASSERT_EQ(dup2(fresh.watched(), reused_fd), reused_fd);
+        sut.add(reused_fd, EPOLLIN, [&reused_calls](std::uint32_t) { ++reused_calls; });
+    };
+    sut.add(first.watched(), EPOLLIN, [&](std::uint32_t) { replace_other(0, second); });
+    sut.add(second.watched(), EPOLLIN, [&](std::uint32_t) { replace_other(1, first); });
+
+    send_byte(first.peer());
+    send_byte(second.peer());
+    ASSERT_EQ(sut.run_once(1000), 1u);
+    ASSERT_EQ(calls[0] + calls[1], 1);
+    ASSERT_EQ(reused_calls, 0);
+    ASSERT_TRUE(sut.contains(reused_fd));
+    ASSERT_EQ(sut.size(), 2u);
+}
+
+TEST(ReactorTest, handler_may_remove_its_own_descriptor)
+{
+    reactor sut{};
+    socket_pair pair{};
+    int calls{0};
+    // state captured by the handler, used after the handler removed itself
+    auto const name{std::make_shared<std::string>("watched")};
+    std::string seen{};
+    sut.add(pair.watched(), EPOLLIN, [&, name](std::uint32_t)
+    {
+        ++calls;
+        sut.remove(pair.watched());
+        seen = *name;
+    });
+
+    send_byte(pair.peer());
+    ASSERT_EQ(sut.run_once(1000), 1u);
+    ASSERT_EQ(calls, 1);
+    ASSERT_EQ(seen, "watched");
+    ASSERT_FALSE(sut.contains(pair.watched()));
+    ASSERT_EQ(sut.size(), 0u);
+    ASSERT_EQ(name.use_count(), 1);
+
+    send_byte(pair.peer());
+    ASSERT_EQ(sut.run_once(10), 0u);
+    ASSERT_EQ(calls, 1);
+}
+
+TEST(ReactorTest, periodic_timer_may_cancel_itself)
+{
+    reactor sut{};
+    int calls{0};
+    reactor::timer_id id{0};
+    id = sut.add_timer(1ms, [&]()
+    {
+        if (++calls == 3) { ASSERT_TRUE(sut.cancel_timer(id)); }
+    }, 1ms);
+
+    auto const until{reactor::clock::now() + 100ms};
+    while (reactor::clock::now() < until)
+    {
+        sut.run_once(5);
+    }
+    ASSERT_EQ(calls, 3);
+    ASSERT_FALSE(sut.cancel_timer(id));
+    ASSERT_EQ(sut.queued_deadlines(), 0u);
+}
+
+TEST(ReactorTest, cancelled_deadlines_are_compacted_and_live_timers_still_fire)
+{
+    constexpr int Timers{1000};
+    reactor sut{};
+    std::vector<reactor::timer_id> ids{};
+    std::vector<int> fired{};
+    for (int i{0}; i != Timers; ++i)
+    {
+        // every hundredth timer is kept and due soon, the others are far off
+        auto const delay{i % 100 == 0 ? reactor::clock::duration{5ms} : reactor::clock::duration{1h}};
+        ids.push_back(sut.add_timer(delay, [&fired, i]() { fired.push_back(i); }));
+    }
+    for (int i{0}; i != Timers; ++i)
+    {
+        if (i % 100 != 0) { ASSERT_TRUE(sut.cancel_timer(ids[static_cast<std::size_t>(i)])); }
+    }
+    ASSERT_LE(sut.queued_deadlines(), 64u);
+
+    auto const until{reactor::clock::now() + 1s};
+    while (fired.size() != Timers / 100 && reactor::clock::now() < until)
+    {
+        sut.run_once(100);
+    }
+    ASSERT_EQ(fired.size(), static_cast<std::size_t>(Timers / 100));
+    for (auto const i : fired)
+    {
+        ASSERT_EQ(i % 100, 0);
+    }
+}
+
+TEST(ReactorTest, cancelled_earliest_timer_does_not_cut_the_wait_short)
+{
+    reactor sut{};
+    bool called{false};
+    auto const id{sut.add_timer(1ms, [&called]() { called = true; })};
+    ASSERT_TRUE(sut.cancel_timer(id));
+    ASSERT_EQ(sut.queued_deadlines(), 0u);
+
+    auto const start{reactor::clock::now()};
+    ASSERT_EQ(sut.run_once(50), 0u);
+    ASSERT_GE(reactor::clock::now() - start, 40ms);
+    ASSERT_FALSE(called);
+}
+
+TEST(ReactorTest, stop_from_another_thread_ends_run)
+{
+    reactor sut{};
+    std::thread stopper{[&sut]()
+    {
+        std::this_thread::sleep_for(20ms);
+        sut.stop();
+    }};
+    sut.run();      // returns only once stopped
+    stopper.join();
+
+    // and may run again
+    bool called{false};
+    sut.add_timer(1ms, [&sut, &called]()
+    {
+        called = true;
+        sut.stop();
+    });
+    sut.run();
+    ASSERT_TRUE(called);
+}
+
+} // namespace
@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <array>
+#include <mutex>
 
 [[nodiscard]] inline void* my_aligned_alloc(std::size_t size, std::size_t align) noexcept
 {
@@ -40,9 +41,11 @@ struct NewTracker {
     // static inline size_t total_deleted{0};  // bytes deleted so far
     static inline bool do_trace{false};  // tracing enabled
     // static inline bool in_new{false};    // don't track output inside new overloads
+    static inline std::mutex mtx{};  // allocations may come from any thread
 
     static void reset() noexcept
     {
+        std::lock_guard<std::mutex> lock{mtx};
         allocs.fill(nullptr);
         num_allocs = 0;
         num_delete = 0;
@@ -57,6 +60,7 @@ struct NewTracker {
     [[nodiscard]] static void* allocate(std::size_t size, std::size_t align,
                                         const char* call) noexcept
     {
+        std::lock_guard<std::mutex> lock{mtx};
         ++num_allocs;
         total_allocated += size;
 
@@ -69,55 +73,63 @@ struct NewTracker {
             }
         }();
         if (do_trace) {
-            printf_s("%s   \t#%d: %zu bytes, @ %p  ", call, num_allocs, size, p);
+            std::printf("%s   \t#%d: %zu bytes, @ %p  ", call, num_allocs, size, p);
             if (align > 0) {
-                printf_s("|  %zu-byte aligned  ", align);
+                std::printf("|  %zu-byte aligned  ", align);
             }
             else {
-                printf_s("|  def-aligned  ");
+                std::printf("|  def-aligned  ");
             }
-            printf_s("|  total: %zu bytes\n", total_allocated);
+            std::printf("|  total: %zu bytes\n", total_allocated);
+        }
+        // only the first allocs.size() allocations are remembered for status()
+        if (static_cast<std::size_t>(num_allocs) < allocs.size()) {
+            allocs[static_cast<std::size_t>(num_allocs)] = p;
         }
-        allocs.at(num_allocs) = p;
         return p;
     }
 
     static void deallocate(void* p, std::size_t size, std::size_t align, const char* call) noexcept
     {
+        std::lock_guard<std::mutex> lock{mtx};
         ++num_delete;
         // total_deleted += size;
 
-        auto const idx = std::distance(allocs.cbegin(), std::find(allocs.cbegin(), allocs.cend(), p));
-        allocs.at(idx) = nullptr;
-
-        if (align == 0) {
-            std::free(p);
-        }
-        else {
-            my_aligned_free(p);
+        auto const it = std::find(allocs.begin(), allocs.end(), p);
+        if (it != allocs.end()) {
+            *it = nullptr;
         }
+
+        // traced first - p is not to be touched, even printed, once it is freed
         if (do_trace) {
-            printf_s("%s   \t#%d: %zu bytes, @ %p  ", call, num_delete, size, p);
+            std::printf("%s   \t#%d: %zu bytes, @ %p  ", call, num_delete, size, p);
             if (align > 0) {
-                printf_s("|  %zu-byte aligned  ", align);
+                std::printf("|  %zu-byte aligned  ", align);
             }
             else {
-                printf_s("|  def-aligned  ");
+                std::printf("|  def-aligned  ");
             }
-            // printf_s("|  total: %zu bytes\n", total_deallocated);
+            // std::printf("|  total: %zu bytes\n", total_deallocated);
             puts("");
         }
+
+        if (align == 0) {
+            std::free(p);
+        }
+        else {
+            my_aligned_free(p);
+        }
     }
 
     static void status() noexcept
     {
-        printf_s("Allocations:   %d => %zu bytes\n", num_allocs, total_allocated);
-        printf_s("Deallocations: %d\n", num_delete);
+        std::printf("Allocations:   %d => %zu bytes\n", num_allocs, total_allocated);
+        std::printf("Deallocations: %d\n", num_delete);
         puts("\nNon-deallocated memory");
-        for (auto i{0}; i != allocs.size(); ++i) {
+        for (std::size_t i{0}; i != allocs.size(); ++i) {
             auto const p = allocs[i];
             if (p != nullptr) {
-                printf_s("Allocation #%d, @ %p\n", i, p);
+                std::printf("Allocation #%zu, @ %p\n", i, p);
             }
         }
     }
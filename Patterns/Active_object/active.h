@@ -6,7 +6,10 @@
 #include <mutex>
 #include <memory>
 #include <utility>
+#include <vector>
 
+#include "mpmc_queue.h"
+#include "task.h"
 #include "threadsafe_queue.h"
 
 
@@ -20,19 +23,32 @@ namespace jam
 // Active Objects are generally usefuly wherever a thread would be - to express long running
 // services - physics thread, GUI thread, etc., to decouple independent work - background save,
 // pipeline stages...
+//
+// The message-queue is a policy - any queue class template with the push() and wait_pop_bulk()
+// members of threadsafe_queue. threadsafe_queue (mutex and condition variable, unbounded) is the
+// default, mpmc_queue (lock-free, bounded) takes the mutex off the path of every send() - e.g.
+// jam::BasicActive<mpmc_queue> or Active3<Derived, mpmc_queue>.
+//
+// Messages are jam::Task<> - move-only and stored in place for captures of up to 48 bytes, with
+// mpmc_queue a send() of such a message does not allocate.
+//
+// The thread of the object takes up to Batch messages out of the queue at once - one lock
+// acquisition of threadsafe_queue for all of them - and runs them outside of the queue.
 
-class Active {
+template<template<typename> class Queue = threadsafe_queue>
+class BasicActive {
 public:
-    using Callback = std::function<void()>;
+    using Callback = Task<>;
+    static constexpr std::size_t Batch{64};
 
 
-    Active(Active&&) noexcept = default;
-    Active(Active const&) = default;
-    ~Active();
+    BasicActive(BasicActive&&) noexcept = default;
+    BasicActive(BasicActive const&) = default;
+    ~BasicActive();
 
-    static Active create()
+    static BasicActive create()
     {
-        Active a;
+        BasicActive a;
         a.thread_ = std::thread{[&a](){ a.run(); }};
         return a;
     }
@@ -41,22 +57,26 @@ public:
 
 
 private:
-    Active() = default;
+    BasicActive() = default;
 
     void do_done() noexcept { done_ = true; }
     void run();
 
-    threadsafe_queue<Callback> queue_{};
+    Queue<Callback> queue_{};
     std::thread thread_{};
     bool done_{false};     // to be set only on the active thread via a callback
 
 };
 
+using Active = BasicActive<>;
+
 // Active object base class
 // to be inherited from. Active object instances created using a factory member function
-class Active2 {
+template<template<typename> class Queue = threadsafe_queue>
+class BasicActive2 {
 public:
-    using Callback = std::function<void()>;
+    using Callback = Task<>;
+    static constexpr std::size_t Batch{64};
 
     void send(Callback msg);
 
@@ -65,17 +85,17 @@ public:
     {
         T active{std::forward<Args>(args)...};
         // do_create(static_cast<jam::Active2&>(active));
-        static_cast<Active2&>(active).thread_ = std::thread{[&active](){ active.run(); }};
+        static_cast<BasicActive2&>(active).thread_ = std::thread{[&active](){ active.run(); }};
         return active;
     }
 
 protected:
-    Active2() = default;
-    Active2(Active2 const&) = default;
-    Active2(Active2&&) noexcept = default;
-    Active2& operator=(Active2 const&) = default;
-    Active2& operator=(Active2&&) noexcept = default;
-    ~Active2() noexcept;
+    BasicActive2() = default;
+    BasicActive2(BasicActive2 const&) = default;
+    BasicActive2(BasicActive2&&) noexcept = default;
+    BasicActive2& operator=(BasicActive2 const&) = default;
+    BasicActive2& operator=(BasicActive2&&) noexcept = default;
+    ~BasicActive2() noexcept;
 
 private:
     void run();
@@ -83,19 +103,22 @@ private:
     // void init_thread(std::thread& t);
     // static void do_create(Active2& a);
 
-    threadsafe_queue<Callback> queue_{};
+    Queue<Callback> queue_{};
     std::thread thread_{};
     bool done_{false};
 };
 
+using Active2 = BasicActive2<>;
+
 
 // Active object base class using CRTP.
 // Make use'age safer and allow for non-public inheritance. Creation is done using
 // a non-templated factory member function
-template<typename Derived>
+template<typename Derived, template<typename> class Queue = threadsafe_queue>
 class Active3 {
 public:
-    using Callback = std::function<void()>;
+    using Callback = Task<>;
+    static constexpr std::size_t Batch{64};
 
     void send(Callback msg)
     {
@@ -131,19 +154,85 @@ private:
 
     void run()
     {
+        std::vector<Callback> batch{};
+        batch.reserve(Batch);
         while (!done_) {
-            // wait until a task is available, then pop it and execute it
-            Callback cb;
-            queue_.wait_and_pop(cb);
-            cb();
+            // wait until a task is available, then take up to Batch of them and execute them
+            queue_.wait_pop_bulk(batch, Batch);
+            for (auto& cb : batch) {
+                cb();
+            }
+            batch.clear();
         }
     }
 
     void do_done() noexcept { done_ = true; }
 
-    threadsafe_queue<Callback> queue_{};
+    Queue<Callback> queue_{};
     std::thread thread_{};
     bool done_{false};
 };
 
+
+template<template<typename> class Queue>
+BasicActive<Queue>::~BasicActive()
+{
+    send([this](){ do_done(); });
+    thread_.join();
+}
+
+template<template<typename> class Queue>
+void BasicActive<Queue>::send(Callback msg)
+{
+    queue_.push(std::move(msg));
+}
+
+template<template<typename> class Queue>
+void BasicActive<Queue>::run()
+{
+    std::vector<Callback> batch{};
+    batch.reserve(Batch);
+    while (!done_) {
+        // wait until a task is available, then take up to Batch of them and execute them
+        queue_.wait_pop_bulk(batch, Batch);
+        for (auto& cb : batch) {
+            cb();
+        }
+        batch.clear();
+    }
+}
+
+
+template<template<typename> class Queue>
+BasicActive2<Queue>::~BasicActive2() noexcept
+{
+    send([this](){ do_done(); });
+    thread_.join();
+}
+
+template<template<typename> class Queue>
+void BasicActive2<Queue>::send(Callback msg)
+{
+    queue_.push(std::move(msg));
+}
+
+template<template<typename> class Queue>
+void BasicActive2<Queue>::run()
+{
+    std::vector<Callback> batch{};
+    batch.reserve(Batch);
+    while (!done_) {
+        // wait until a task is available, then take up to Batch of them and execute them
+        queue_.wait_pop_bulk(batch, Batch);
+        for (auto& cb : batch) {
+            cb();
+        }
+        batch.clear();
+    }
+}
+
+// the default queue policy is instantiated once, in active.cpp
+extern template class BasicActive<threadsafe_queue>;
+extern template class BasicActive2<threadsafe_queue>;
+
 } // namespace jam
@@ -35,7 +35,7 @@ public:
 
     void save_data(T value)
     {
-        active_.send([this, v=std::move(value)]{bgStoreData(Data(std::move(v)));});
+        active_.send([this, v=std::move(value)]() mutable {bgStoreData(Data(std::move(v)));});
     }
 };
 
@@ -74,7 +74,7 @@ public:
     ~Backgrounder2() = default;
 
     void save_data(T value) {
-        Base::send([this, v=std::move(value)]{ bgStoreData(Data{std::move(v)}); });
+        Base::send([this, v=std::move(value)]() mutable { bgStoreData(Data{std::move(v)}); });
     }
 };
 
@@ -111,6 +111,6 @@ public:
     ~Backgrounder3() = default;
 
     void save_data(T value) {
-        Base::send([this, v=std::move(value)]{ bgStoreData(Data{std::move(v)}); });
+        Base::send([this, v=std::move(value)]() mutable { bgStoreData(Data{std::move(v)}); });
     }
 };
@@ -0,0 +1,103 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include "active.h"
+#include "executor.h"
+
+// Thousands of actors ping-pong messages in pairs: the first of each pair receives the number of
+// rounds and sends the number minus one to its partner, and so on down to zero. All pairs play at
+// the same time, timed until the last pair has finished.
+//  - PooledActive: every actor is a jam::PooledActive on one jam::Executor with a worker per CPU.
+//  - Active: every actor is a jam::Active with a thread of its own.
+//
+//   ./executor_bm [rounds]
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// the actor is made in place - neither jam::Active nor jam::PooledActive may move once running
+template<typename Actor>
+struct Player {
+    template<typename Make>
+    Player(std::atomic<int>& finished, Make make)
+        : done{finished}, actor{make()} { }
+    Player(Player const&) = delete;
+    Player& operator=(Player const&) = delete;
+
+    Player* partner{nullptr};
+    std::atomic<int>& done;
+    Actor actor;
+
+    void receive(int rounds)
+    {
+        if (rounds == 0) {
+            done.fetch_add(1, std::memory_order_release);
+            return;
+        }
+        partner->actor.send([p = partner, rounds] { p->receive(rounds - 1); });
+    }
+};
+
+template<typename Make>
+void play(std::string const& name, int actors, int rounds, Make make)
+{
+    using Actor = decltype(make());
+    std::atomic<int> done{0};
+    auto const pairs{actors / 2};
+    std::vector<std::unique_ptr<Player<Actor>>> players{};
+    try {
+        for (int i{0}; i != actors; ++i) {
+            players.push_back(std::make_unique<Player<Actor>>(done, make));
+        }
+    }
+    catch (std::system_error const& e) {
+        std::cout << std::left << std::setw(40) << name + " " + std::to_string(actors)
+                  << " could not start: " << e.what() << std::endl;
+        return;
+    }
+    for (std::size_t i{0}; i != players.size(); i += 2) {
+        players[i]->partner = players[i + 1].get();
+        players[i + 1]->partner = players[i].get();
+    }
+
+    auto const start{Clock::now()};
+    for (std::size_t i{0}; i != players.size(); i += 2) {
+        auto* const p{players[i].get()};
+        p->actor.send([p, rounds] { p->receive(rounds); });
+    }
+    while (done.load(std::memory_order_acquire) != pairs) {
+        std::this_thread::sleep_for(std::chrono::microseconds{100});
+    }
+    auto const elapsed{Clock::now() - start};
+
+    auto const messages{static_cast<double>(pairs) * (rounds + 1)};
+    auto const seconds{std::chrono::duration<double>(elapsed).count()};
+    std::cout << std::left << std::setw(40) << name + " " + std::to_string(actors) << std::right
+              << std::setw(10) << std::fixed << std::setprecision(2) << messages / seconds / 1e6
+              << " M messages/s" << std::setw(12) << std::setprecision(1) << seconds * 1e9 / messages
+              << " ns/message" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    int const rounds{argc > 1 ? std::atoi(argv[1]) : 1000};
+    std::cout << rounds << " rounds, " << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    for (int const actors : {100, 1000, 4000}) {
+        {
+            jam::Executor executor{};
+            play("PooledActive", actors, rounds, [&executor] { return jam::PooledActive{executor}; });
+        }
+        play("Active", actors, rounds, [] { return jam::Active::create(); });
+    }
+}
@@ -0,0 +1,163 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "active.h"
+#include "mpmc_queue.h"
+#include "threadsafe_queue.h"
+
+// Producer/consumer throughput of threadsafe_queue and mpmc_queue, with the jam::Task<> messages
+// of the Active objects as elements:
+//  - Queue: P producers push N callbacks in total, C consumers pop and run them.
+//  - Bulk: P producers, one consumer which pops a batch at a time - unbounded, bounded to 1024
+//    with blocking producers, and mpmc_queue.
+//  - Active: one thread sends N callbacks to an Active object, timed until the Active object
+//    has run all of them and joined its thread.
+// Every callback adds its index to a sum, which is checked against the expected one.
+//
+//   ./queue_bm [N]
+namespace {
+
+using Callback = jam::Active::Callback;
+using Clock = std::chrono::steady_clock;
+
+void report(std::string const& name, std::uint64_t items, Clock::duration elapsed, bool valid)
+{
+    auto const seconds{std::chrono::duration<double>(elapsed).count()};
+    std::cout << std::left << std::setw(40) << name << std::right << std::setw(10)
+              << std::fixed << std::setprecision(2) << items / seconds / 1e6 << " M items/s"
+              << std::setw(12) << std::setprecision(1) << seconds * 1e9 / items << " ns/item"
+              << (valid ? "" : "   INVALID SUM") << std::endl;
+}
+
+std::uint64_t expected_sum(std::uint64_t items) { return items * (items - 1) / 2; }
+
+template<template<typename> class Queue>
+void run_queue(std::string const& name, unsigned producers, unsigned consumers, std::uint64_t items)
+{
+    Queue<Callback> queue{};
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<bool> go{false};
+    auto const per_producer{items / producers};
+    auto const per_consumer{items / consumers};
+
+    std::vector<std::thread> threads{};
+    for (unsigned p{0}; p != producers; ++p) {
+        threads.emplace_back([&, p] {
+            while (!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+            for (auto i{p * per_producer}; i != (p + 1) * per_producer; ++i) {
+                queue.push([&sum, i] { sum.fetch_add(i, std::memory_order_relaxed); });
+            }
+        });
+    }
+    for (unsigned c{0}; c != consumers; ++c) {
+        threads.emplace_back([&] {
+            while (!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+            Callback cb;
+            for (std::uint64_t i{0}; i != per_consumer; ++i) {
+                queue.wait_and_pop(cb);
+                cb();
+            }
+        });
+    }
+
+    auto const start{Clock::now()};
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) { t.join(); }
+    auto const elapsed{Clock::now() - start};
+
+    report(name + " " + std::to_string(producers) + "P/" + std::to_string(consumers) + "C",
+           items, elapsed, sum.load() == expected_sum(items));
+}
+
+// One consumer takes up to Batch callbacks per wait_pop_bulk() - with threadsafe_queue one lock
+// acquisition each - instead of one per wait_and_pop(). Reports the callbacks per pop.
+template<typename Queue>
+void run_bulk(std::string const& name, Queue& queue, unsigned producers, std::uint64_t items,
+              std::size_t batch_size)
+{
+    std::atomic<std::uint64_t> sum{0};
+    std::atomic<bool> go{false};
+    std::uint64_t pops{0};
+    auto const per_producer{items / producers};
+
+    std::vector<std::thread> threads{};
+    for (unsigned p{0}; p != producers; ++p) {
+        threads.emplace_back([&, p] {
+            while (!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+            for (auto i{p * per_producer}; i != (p + 1) * per_producer; ++i) {
+                queue.push([&sum, i] { sum.fetch_add(i, std::memory_order_relaxed); });
+            }
+        });
+    }
+    threads.emplace_back([&] {
+        while (!go.load(std::memory_order_acquire)) { std::this_thread::yield(); }
+        std::vector<Callback> batch{};
+        batch.reserve(batch_size);
+        for (std::uint64_t done{0}; done != items; ++pops) {
+            done += queue.wait_pop_bulk(batch, batch_size);
+            for (auto& cb : batch) { cb(); }
+            batch.clear();
+        }
+    });
+
+    auto const start{Clock::now()};
+    go.store(true, std::memory_order_release);
+    for (auto& t : threads) { t.join(); }
+    auto const elapsed{Clock::now() - start};
+
+    report(name + " " + std::to_string(producers) + "P/1C batch " + std::to_string(batch_size),
+           items, elapsed, sum.load() == expected_sum(items));
+    std::cout << std::setw(40) << "" << std::setw(10) << std::setprecision(1)
+              << static_cast<double>(items) / pops << " items/pop" << std::endl;
+}
+
+template<template<typename> class Queue>
+void run_active(std::string const& name, std::uint64_t items)
+{
+    std::uint64_t sum{0};  // only touched on the active thread
+    auto const start{Clock::now()};
+    {
+        auto active{jam::BasicActive<Queue>::create()};
+        for (std::uint64_t i{0}; i != items; ++i) {
+            active.send([&sum, i] { sum += i; });
+        }
+    }
+    auto const elapsed{Clock::now() - start};
+    report(name, items, elapsed, sum == expected_sum(items));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[])
+{
+    std::uint64_t const items{argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1u << 20};
+    std::cout << items << " items, " << std::thread::hardware_concurrency() << " hardware threads\n";
+
+    struct Config { unsigned producers; unsigned consumers; };
+    for (auto const [producers, consumers] : {Config{1, 1}, Config{2, 2}, Config{4, 1}, Config{1, 4}, Config{4, 4}}) {
+        run_queue<threadsafe_queue>("threadsafe_queue", producers, consumers, items);
+        run_queue<mpmc_queue>("mpmc_queue", producers, consumers, items);
+    }
+
+    for (unsigned const producers : {1u, 4u}) {
+        for (std::size_t const batch_size : {std::size_t{1}, std::size_t{64}}) {
+            threadsafe_queue<Callback> unbounded{};
+            run_bulk("threadsafe_queue", unbounded, producers, items, batch_size);
+            // producers wait for room instead of running ahead of the consumer
+            threadsafe_queue<Callback> bounded{1024, overflow_policy::block};
+            run_bulk("threadsafe_queue<1024>", bounded, producers, items, batch_size);
+            mpmc_queue<Callback> ring{};
+            run_bulk("mpmc_queue", ring, producers, items, batch_size);
+        }
+    }
+
+    run_active<threadsafe_queue>("Active<threadsafe_queue>", items);
+    run_active<mpmc_queue>("Active<mpmc_queue>", items);
+}
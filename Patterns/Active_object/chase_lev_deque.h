@@ -0,0 +1,136 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Chase-Lev work-stealing deque of pointers (with the C11 memory orderings of Lê, Pop, Cohen
+ * and Zappa Nardelli, "Correct and Efficient Work-Stealing for Weak Memory Models", 2013).
+ * The owner thread pushes and pops at the bottom, without a CAS unless it races a thief for the
+ * last element. Any other thread steals from the top with one CAS - the oldest work leaves first.
+ *
+ * The circular array grows when full. Arrays replaced by a grow are kept until the deque is
+ * destroyed, a thief may still read from one.
+ */
+
+template <typename T>
+class chase_lev_deque {
+  public:
+    explicit chase_lev_deque(std::size_t capacity = 256)
+        : arrays_{}
+    {
+        std::size_t rounded{2};
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        arrays_.push_back(std::make_unique<Array>(rounded));
+        array_.store(arrays_.back().get(), std::memory_order_relaxed);
+    }
+
+    chase_lev_deque(chase_lev_deque const&) = delete;
+    chase_lev_deque& operator=(chase_lev_deque const&) = delete;
+
+    // owner only
+    void push(T* item)
+    {
+        auto const b{bottom_.load(std::memory_order_relaxed)};
+        auto const t{top_.load(std::memory_order_acquire)};
+        auto* a{array_.load(std::memory_order_relaxed)};
+        if (b - t > static_cast<std::int64_t>(a->mask)) {
+            a = grow(a, t, b);
+        }
+        a->put(b, item);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // owner only, the most recently pushed item or nullptr
+    T* pop() noexcept
+    {
+        auto const b{bottom_.load(std::memory_order_relaxed) - 1};
+        auto* const a{array_.load(std::memory_order_relaxed)};
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto t{top_.load(std::memory_order_relaxed)};
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* item{a->get(b)};
+        if (t == b) {
+            // the last item - a thief may take it at the same time
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // any thread, the oldest item or nullptr - also when it lost a race for it
+    T* steal() noexcept
+    {
+        auto t{top_.load(std::memory_order_acquire)};
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        auto const b{bottom_.load(std::memory_order_acquire)};
+        if (t >= b) {
+            return nullptr;
+        }
+        auto* const a{array_.load(std::memory_order_acquire)};
+        T* const item{a->get(t)};
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+    // a snapshot only
+    bool empty() const noexcept
+    {
+        return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Array {
+        explicit Array(std::size_t capacity)
+            : mask{capacity - 1}
+            , items{std::make_unique<std::atomic<T*>[]>(capacity)}
+        {
+        }
+
+        T* get(std::int64_t i) const noexcept
+        {
+            return items[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, T* item) noexcept
+        {
+            items[static_cast<std::size_t>(i) & mask].store(item, std::memory_order_relaxed);
+        }
+
+        std::size_t mask;
+        std::unique_ptr<std::atomic<T*>[]> items;
+    };
+
+    Array* grow(Array* old, std::int64_t t, std::int64_t b)
+    {
+        arrays_.push_back(std::make_unique<Array>((old->mask + 1) * 2));
+        auto* const a{arrays_.back().get()};
+        for (auto i{t}; i != b; ++i) {
+            a->put(i, old->get(i));
+        }
+        array_.store(a, std::memory_order_release);
+        return a;
+    }
+
+    static constexpr std::size_t Cache_Line{64};
+
+    alignas(Cache_Line) std::atomic<std::int64_t> top_{0};
+    alignas(Cache_Line) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<Array*> array_{nullptr};
+    std::vector<std::unique_ptr<Array>> arrays_;  // owner only
+};
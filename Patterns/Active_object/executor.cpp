@@ -0,0 +1,131 @@
+#include "executor.h"
+
+namespace jam
+{
+
+thread_local Executor::Worker* Executor::current_{nullptr};
+
+Executor::Executor(unsigned workers)
+{
+    workers_.reserve(workers);
+    for (unsigned i{0}; i != workers; ++i) {
+        workers_.push_back(std::unique_ptr<Worker>(new Worker{this}));
+    }
+    // start the threads once all deques exist, the workers steal from each other
+    for (std::size_t i{0}; i != workers_.size(); ++i) {
+        auto& worker{*workers_[i]};
+        worker.thread = std::thread{[this, &worker, i](){ work(worker, i); }};
+    }
+}
+
+Executor::~Executor()
+{
+    {
+        std::lock_guard<std::mutex> lock{park_mtx_};
+        stopping_.store(true, std::memory_order_release);
+    }
+    park_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker->thread.join();
+    }
+}
+
+void Executor::schedule(Schedulable& work)
+{
+    if (current_ != nullptr && current_->executor == this) {
+        current_->deque.push(&work);
+    }
+    else {
+        injection_.push(&work);
+    }
+    notify();
+}
+
+void Executor::work(Worker& worker, std::size_t index)
+{
+    current_ = &worker;
+    for (unsigned round{0}; ; ++round) {
+        auto* const next{find_work(worker, index, round)};
+        if (next == nullptr) {
+            if (stopping_.load(std::memory_order_acquire)) {
+                return;
+            }
+            park();
+            continue;
+        }
+        if (next->run()) {
+            // more to do - behind the work which is already waiting
+            injection_.push(next);
+            notify();
+        }
+    }
+}
+
+Schedulable* Executor::find_work(Worker& worker, std::size_t index, unsigned round)
+{
+    Schedulable* found{nullptr};
+    if (round % Injection_Interval == 0 && injection_.try_pop(found)) {
+        return found;
+    }
+    if ((found = worker.deque.pop()) != nullptr) {
+        return found;
+    }
+    if (injection_.try_pop(found)) {
+        return found;
+    }
+    // visit the other workers starting at a different one each round, so the thieves spread out
+    auto const others{workers_.size() - 1};
+    for (std::size_t i{0}; i != others; ++i) {
+        auto const victim{(index + 1 + (round + i) % others) % workers_.size()};
+        if ((found = workers_[victim]->deque.steal()) != nullptr) {
+            return found;
+        }
+    }
+    return nullptr;
+}
+
+bool Executor::has_work() const
+{
+    if (!injection_.empty()) {
+        return true;
+    }
+    return std::any_of(workers_.cbegin(), workers_.cend(),
+                       [](auto const& worker) { return !worker->deque.empty(); });
+}
+
+// A worker announces itself as sleeping before it looks for work the last time, schedule()
+// looks for sleepers after it queued the work - both behind a full fence, either the worker sees
+// the work or schedule() sees the worker. A wake token tells which sleeper may return.
+void Executor::park()
+{
+    std::unique_lock<std::mutex> lock{park_mtx_};
+    sleeping_.fetch_add(1, std::memory_order_seq_cst);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!stopping_.load(std::memory_order_relaxed) && !has_work()) {
+        park_cv_.wait(lock, [this] {
+            return wake_tokens_ != 0 || stopping_.load(std::memory_order_relaxed);
+        });
+        if (wake_tokens_ != 0) {
+            --wake_tokens_;
+        }
+    }
+    sleeping_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void Executor::notify()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock{park_mtx_};
+        if (wake_tokens_ >= sleeping_.load(std::memory_order_relaxed)) {
+            return;  // enough sleepers are on their way already
+        }
+        ++wake_tokens_;
+    }
+    park_cv_.notify_one();
+}
+
+} // namespace jam
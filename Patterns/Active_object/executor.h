@@ -0,0 +1,146 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "chase_lev_deque.h"
+#include "task.h"
+#include "threadsafe_queue.h"
+
+
+namespace jam
+{
+
+// Work the Executor runs - run() returns whether there is more of it, the Executor then queues it
+// again behind the other work.
+class Schedulable {
+public:
+    virtual bool run() = 0;
+
+protected:
+    Schedulable() = default;
+    Schedulable(Schedulable const&) = default;
+    Schedulable& operator=(Schedulable const&) = default;
+    ~Schedulable() = default;
+};
+
+
+// Work-stealing executor - N worker threads run the Schedulables of any number of pooled actors.
+//
+// Every worker owns a Chase-Lev deque. Work scheduled on a worker thread - a message one actor
+// sends to another - goes to the bottom of that worker's deque and runs next, while its data is
+// still in the cache. Work scheduled from other threads goes to the global injection queue.
+// A worker takes work from its own deque, then from the injection queue (first, every
+// Injection_Interval rounds, so that it cannot be starved), then steals from the top of the other
+// workers' deques, and sleeps when there is none anywhere.
+class Executor {
+public:
+    static constexpr unsigned Injection_Interval{61};
+
+    explicit Executor(unsigned workers = std::max(std::thread::hardware_concurrency(), 1u));
+    Executor(Executor const&) = delete;
+    Executor& operator=(Executor const&) = delete;
+    // all work has to be done - the actors destroyed - before the executor
+    ~Executor();
+
+    void schedule(Schedulable& work);
+
+    std::size_t size() const noexcept { return workers_.size(); }
+
+private:
+    struct Worker {
+        Executor* executor;
+        chase_lev_deque<Schedulable> deque{};
+        std::thread thread{};
+    };
+
+    void work(Worker& worker, std::size_t index);
+    Schedulable* find_work(Worker& worker, std::size_t index, unsigned round);
+    bool has_work() const;
+    void park();
+    void notify();
+
+    static thread_local Worker* current_;
+
+    std::vector<std::unique_ptr<Worker>> workers_{};
+    threadsafe_queue<Schedulable*> injection_{};
+
+    std::atomic<bool> stopping_{false};
+    std::atomic<unsigned> sleeping_{0};
+    std::mutex park_mtx_{};
+    std::condition_variable park_cv_{};
+    unsigned wake_tokens_{0};  // guarded by park_mtx_
+};
+
+
+// Active object without a thread of its own - the messages run on the workers of an Executor,
+// one at a time and in the order they were sent, like on the thread of an Active object.
+// Thousands of them can share a handful of threads.
+//
+// pending_ counts the messages sent and not yet run; the send() which makes it non-zero schedules
+// the actor. A run executes up to Batch messages and gives the worker back to other actors.
+// The destructor waits until all sent messages have run - an actor must not be destroyed by one
+// of its own messages, or on a worker of its executor while it has messages.
+template<template<typename> class Queue = threadsafe_queue>
+class BasicPooledActive final : private Schedulable {
+public:
+    using Callback = Task<>;
+    static constexpr std::size_t Batch{64};
+
+    explicit BasicPooledActive(Executor& executor)
+        : Schedulable{}
+        , executor_{executor}
+    { }
+
+    BasicPooledActive(BasicPooledActive const&) = delete;
+    BasicPooledActive& operator=(BasicPooledActive const&) = delete;
+
+    ~BasicPooledActive()
+    {
+        while (pending_.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    void send(Callback msg)
+    {
+        queue_.push(std::move(msg));
+        if (pending_.fetch_add(1, std::memory_order_acq_rel) == 0) {
+            executor_.schedule(*this);
+        }
+    }
+
+private:
+    // The counted messages were pushed before they were counted - but a message pushed, and not
+    // yet counted, by another sender may be ahead of them. wait_and_pop() waits for the rare
+    // message which has been counted and is still being published.
+    bool run() override
+    {
+        auto const count{std::min(pending_.load(std::memory_order_acquire), Batch)};
+        {
+            // destroyed before the count drops - what the last message captured may refer to
+            // whatever is destroyed along with the actor
+            Callback cb;
+            for (std::size_t i{0}; i != count; ++i) {
+                queue_.wait_and_pop(cb);
+                cb();
+            }
+        }
+        // the last access to this - once pending_ is zero the actor may be destroyed
+        return pending_.fetch_sub(count, std::memory_order_acq_rel) != count;
+    }
+
+    Executor& executor_;
+    Queue<Callback> queue_{};
+    std::atomic<std::size_t> pending_{0};
+};
+
+using PooledActive = BasicPooledActive<>;
+
+} // namespace jam
@@ -0,0 +1,369 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * A bounded lock-free multi-producer multi-consumer queue (D. Vyukov's ring buffer).
+ * Every slot carries a sequence number which tells producers and consumers, whose turn it is
+ * to use the slot - a push or a pop is one CAS on the enqueue or dequeue position and no thread
+ * ever waits for another one, unless the queue is full or empty.
+ * The positions, the slots and the wait state each live on their own cache line, so producers
+ * and consumers do not invalidate each other's lines on every operation.
+ *
+ * try_push() and try_pop() never block. push() and wait_and_pop() spin for a short while and then
+ * sleep on a futex until the queue has room or an element - a push only makes a system call when
+ * a consumer sleeps.
+ *
+ * The interface of push(), emplace(), wait_and_pop(), try_pop(), try_pop_bulk(), wait_pop_bulk()
+ * and empty() matches the one of threadsafe_queue, so either can be used as the queue policy of
+ * the jam::Active objects. Unlike threadsafe_queue push() blocks while the queue is full - a task
+ * must not push to the queue it is executed from, once the queue may be full.
+ */
+
+template <typename T>
+class mpmc_queue {
+    static_assert(std::is_nothrow_move_constructible_v<T> && std::is_nothrow_move_assignable_v<T>,
+                  "mpmc_queue moves elements in and out of claimed slots, which must not fail");
+
+  public:
+    using value_type = T;
+    static constexpr std::size_t Default_Capacity{1024};
+
+    mpmc_queue() : mpmc_queue{Default_Capacity} { }
+
+    // capacity is rounded up to a power of two, at least two
+    explicit mpmc_queue(std::size_t capacity)
+        : mask_{round_up_capacity(capacity) - 1}
+        , slots_{std::make_unique<Slot[]>(mask_ + 1)}
+    {
+        for (std::size_t i{0}; i <= mask_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    mpmc_queue(mpmc_queue const&) = delete;
+    mpmc_queue& operator=(mpmc_queue const&) = delete;
+
+    // Moving is not thread-safe - no thread may use either queue meanwhile.
+    // The moved-from queue may only be destroyed or assigned to.
+    mpmc_queue(mpmc_queue&& other) noexcept
+        : mask_{other.mask_}
+        , slots_{std::move(other.slots_)}
+    {
+        take_positions(other);
+    }
+
+    mpmc_queue& operator=(mpmc_queue&& other) noexcept
+    {
+        if (this == &other) {
+            return *this;
+        }
+        destroy_elements();
+        mask_ = other.mask_;
+        slots_ = std::move(other.slots_);
+        take_positions(other);
+        return *this;
+    }
+
+    ~mpmc_queue() { destroy_elements(); }
+
+    bool try_push(T&& value) noexcept
+    {
+        if (!enqueue(value)) {
+            return false;
+        }
+        notify_not_empty();
+        return true;
+    }
+
+    void push(T value)
+    {
+        wait_until([&] { return enqueue(value); }, not_full_, sleeping_producers_);
+        notify_not_empty();
+    }
+
+    template <typename... Args>
+    std::enable_if_t<std::is_constructible_v<T, Args...>>
+    emplace(Args&&... args)
+    {
+        // construct outside of the slot, so a throwing constructor does not leave a claimed hole
+        push(T(std::forward<Args>(args)...));
+    }
+
+    void wait_and_pop(T& value)
+    {
+        wait_until([&] { return dequeue(value); }, not_empty_, sleeping_consumers_);
+        notify_not_full();
+    }
+
+    bool try_pop(T& value) noexcept
+    {
+        if (!dequeue(value)) {
+            return false;
+        }
+        notify_not_full();
+        return true;
+    }
+
+    // appends up to max elements to batch, returns how many
+    template <typename Container>
+    std::size_t try_pop_bulk(Container& batch, std::size_t max = std::numeric_limits<std::size_t>::max())
+    {
+        auto const count{dequeue_bulk(batch, max)};
+        if (count != 0) {
+            notify_not_full();
+        }
+        return count;
+    }
+
+    // waits for at least one element, then appends up to max elements to batch
+    template <typename Container>
+    std::size_t wait_pop_bulk(Container& batch, std::size_t max = std::numeric_limits<std::size_t>::max())
+    {
+        if (max == 0) {
+            return 0;
+        }
+        T value;
+        wait_until([&] { return dequeue(value); }, not_empty_, sleeping_consumers_);
+        batch.push_back(std::move(value));
+        auto const count{1 + dequeue_bulk(batch, max - 1)};
+        notify_not_full();
+        return count;
+    }
+
+    // a snapshot only, other threads may change it right away
+    bool empty() const noexcept
+    {
+        return dequeue_pos_.load(std::memory_order_acquire) >=
+               enqueue_pos_.load(std::memory_order_acquire);
+    }
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+  private:
+    static constexpr std::size_t Cache_Line{64};
+    static constexpr unsigned Spin_Count{128};
+
+    struct alignas(Cache_Line) Slot {
+        std::atomic<std::size_t> sequence{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+
+        T* value() noexcept { return std::launder(reinterpret_cast<T*>(storage)); }
+    };
+
+    // there is no lock to amortize - every element is still one CAS, but the producers are
+    // notified once for the batch
+    template <typename Container>
+    std::size_t dequeue_bulk(Container& batch, std::size_t max)
+    {
+        std::size_t count{0};
+        for (T value; count != max && dequeue(value); ++count) {
+            batch.push_back(std::move(value));
+        }
+        return count;
+    }
+
+    static std::size_t round_up_capacity(std::size_t capacity) noexcept
+    {
+        std::size_t rounded{2};
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    // Claims the slot at the enqueue position once its sequence says it is free (sequence == pos),
+    // publishes the element with sequence pos + 1. The value is moved from only on success.
+    bool enqueue(T& value) noexcept
+    {
+        auto pos{enqueue_pos_.load(std::memory_order_relaxed)};
+        Slot* slot{nullptr};
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            auto const seq{slot->sequence.load(std::memory_order_acquire)};
+            auto const diff{static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos)};
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;  // the slot still holds the element of the previous lap - full
+            }
+            else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        ::new (static_cast<void*>(slot->storage)) T(std::move(value));
+        slot->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Claims the slot at the dequeue position once it is published (sequence == pos + 1), frees it
+    // for the next lap with sequence pos + capacity.
+    bool dequeue(T& value) noexcept
+    {
+        auto pos{dequeue_pos_.load(std::memory_order_relaxed)};
+        Slot* slot{nullptr};
+        for (;;) {
+            slot = &slots_[pos & mask_];
+            auto const seq{slot->sequence.load(std::memory_order_acquire)};
+            auto const diff{static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos + 1)};
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            }
+            else if (diff < 0) {
+                return false;  // not yet published - empty
+            }
+            else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        auto* const element{slot->value()};
+        value = std::move(*element);
+        element->~T();
+        slot->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Spins on attempt() for a while (not on a single CPU, the other side could not run meanwhile),
+    // then sleeps on the epoch futex. A sleeper registers before its last attempt and the notify
+    // functions check for sleepers after their operation, both behind a full fence - either the
+    // last attempt sees the operation, or the notify sees the sleeper. The epoch is read before
+    // registering, so a wake_all() which unregisters us always changes the epoch we sleep on.
+    template <typename Attempt>
+    static void wait_until(Attempt attempt, std::atomic<std::uint32_t>& epoch,
+                           std::atomic<std::uint32_t>& sleepers) noexcept(noexcept(attempt()))
+    {
+        static unsigned const spin_count{std::thread::hardware_concurrency() > 1 ? Spin_Count : 0};
+        for (unsigned spin{0}; !attempt(); ) {
+            if (spin++ < spin_count) {
+                cpu_relax();
+                continue;
+            }
+            auto const expected{epoch.load(std::memory_order_seq_cst)};
+            sleepers.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (attempt()) {
+                // still registered - costs the next notify one futex wake, unregistering could
+                // take the registration of another sleeper instead
+                return;
+            }
+            futex_wait(epoch, expected);
+        }
+    }
+
+    void notify_not_empty() noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_consumers_.load(std::memory_order_relaxed) != 0) {
+            wake_all(not_empty_, sleeping_consumers_);
+        }
+    }
+
+    // Sleeping producers are woken once the queue is half empty, not for every free slot - that
+    // would wake all of them to fill a single slot.
+    void notify_not_full() noexcept
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_producers_.load(std::memory_order_relaxed) != 0 &&
+            enqueue_pos_.load(std::memory_order_relaxed) - dequeue_pos_.load(std::memory_order_relaxed) <=
+                capacity() / 2) {
+            wake_all(not_full_, sleeping_producers_);
+        }
+    }
+
+    // Wakes all sleepers at once and unregisters them, so until one of them sleeps again the other
+    // side keeps off the system call - even while the woken threads are not scheduled yet.
+    static void wake_all(std::atomic<std::uint32_t>& epoch, std::atomic<std::uint32_t>& sleepers) noexcept
+    {
+        if (sleepers.exchange(0, std::memory_order_seq_cst) != 0) {
+            epoch.fetch_add(1, std::memory_order_seq_cst);
+            futex_wake_all(epoch);
+        }
+    }
+
+    static void cpu_relax() noexcept
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield" ::: "memory");
+#endif
+    }
+
+#if defined(__linux__)
+    static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t) &&
+                      std::atomic<std::uint32_t>::is_always_lock_free,
+                  "the futex word is an std::atomic<std::uint32_t>");
+
+    // sleeps as long as epoch holds the expected value, spurious wake-ups are fine for the callers
+    static void futex_wait(std::atomic<std::uint32_t>& epoch, std::uint32_t expected) noexcept
+    {
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE, expected,
+                  nullptr, nullptr, 0);
+    }
+
+    static void futex_wake_all(std::atomic<std::uint32_t>& epoch) noexcept
+    {
+        ::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch), FUTEX_WAKE_PRIVATE,
+                  std::numeric_limits<int>::max(), nullptr, nullptr, 0);
+    }
+#else
+    static void futex_wait(std::atomic<std::uint32_t>& epoch, std::uint32_t expected) noexcept
+    {
+        if (epoch.load(std::memory_order_acquire) == expected) {
+            std::this_thread::yield();
+        }
+    }
+
+    static void futex_wake_all(std::atomic<std::uint32_t>&) noexcept { }
+#endif
+
+    void take_positions(mpmc_queue& other) noexcept
+    {
+        enqueue_pos_.store(other.enqueue_pos_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        dequeue_pos_.store(other.dequeue_pos_.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        other.enqueue_pos_.store(0, std::memory_order_relaxed);
+        other.dequeue_pos_.store(0, std::memory_order_relaxed);
+    }
+
+    // not thread-safe, for the destructor and assignment only
+    void destroy_elements() noexcept
+    {
+        if (!slots_) {
+            return;
+        }
+        auto const end{enqueue_pos_.load(std::memory_order_relaxed)};
+        for (auto pos{dequeue_pos_.load(std::memory_order_relaxed)}; pos != end; ++pos) {
+            slots_[pos & mask_].value()->~T();
+        }
+    }
+
+    std::size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(Cache_Line) std::atomic<std::size_t> enqueue_pos_{0};
+    alignas(Cache_Line) std::atomic<std::size_t> dequeue_pos_{0};
+
+    alignas(Cache_Line) std::atomic<std::uint32_t> not_empty_{0};
+    std::atomic<std::uint32_t> sleeping_consumers_{0};
+    alignas(Cache_Line) std::atomic<std::uint32_t> not_full_{0};
+    std::atomic<std::uint32_t> sleeping_producers_{0};
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+
+namespace jam
+{
+
+// Move-only void() callable with Capacity bytes of inline storage - the message type of the
+// Active objects.
+//
+// std::function has to be copyable and keeps only a couple of pointers inline (16 bytes with
+// libstdc++), so a callback capturing e.g. this and a std::string allocates on every send().
+// Task stores any nothrow movable callable of up to Capacity bytes (and pointer alignment) in place;
+// with the default of 48 bytes the Task and the sequence number of its mpmc_queue slot make one
+// cache line. Other callables are the slow path - Task then owns them on the heap, use
+// Task<>::fits_inline<F> to check at compile time that a message type takes the fast path.
+//
+// Being move-only a Task can also own move-only captures - unique_ptr, promise, ... - and call
+// mutable lambdas, which may move their captures out.
+
+template<std::size_t Capacity = 48>
+class Task {
+public:
+    template<typename F>
+    static constexpr bool fits_inline = sizeof(F) <= Capacity &&
+                                        alignof(F) <= alignof(void*) &&
+                                        std::is_nothrow_move_constructible_v<F>;
+
+    Task() noexcept = default;
+    Task(std::nullptr_t) noexcept { }
+
+    template<typename F,
+             typename Fn = std::decay_t<F>,
+             typename = std::enable_if_t<!std::is_same_v<Fn, Task> && std::is_invocable_r_v<void, Fn&>>>
+    Task(F&& f)
+    {
+        if constexpr (fits_inline<Fn>) {
+            ::new (static_cast<void*>(&storage_)) Fn(std::forward<F>(f));
+            ops_ = &inline_ops<Fn>;
+        }
+        else {
+            ::new (static_cast<void*>(&storage_)) Fn*(new Fn(std::forward<F>(f)));
+            ops_ = &heap_ops<Fn>;
+        }
+    }
+
+    Task(Task const&) = delete;
+    Task& operator=(Task const&) = delete;
+
+    Task(Task&& other) noexcept { take(other); }
+
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+        return *this;
+    }
+
+    ~Task() { reset(); }
+
+    // calling an empty Task is undefined
+    void operator()()
+    {
+        assert(ops_ != nullptr);
+        ops_->invoke(&storage_);
+    }
+
+    explicit operator bool() const noexcept { return ops_ != nullptr; }
+
+private:
+    // one static table per callable type, the Task only stores a pointer to it
+    struct Ops {
+        void (*invoke)(void* self);
+        void (*relocate)(void* to, void* from) noexcept;  // move-construct to, destroy from
+        void (*destroy)(void* self) noexcept;
+    };
+
+    template<typename Fn>
+    static constexpr Ops inline_ops{
+        [](void* self) { std::invoke(*static_cast<Fn*>(self)); },
+        [](void* to, void* from) noexcept {
+            ::new (to) Fn(std::move(*static_cast<Fn*>(from)));
+            static_cast<Fn*>(from)->~Fn();
+        },
+        [](void* self) noexcept { static_cast<Fn*>(self)->~Fn(); }
+    };
+
+    template<typename Fn>
+    static constexpr Ops heap_ops{
+        [](void* self) { std::invoke(**static_cast<Fn**>(self)); },
+        [](void* to, void* from) noexcept { ::new (to) Fn*(*static_cast<Fn**>(from)); },
+        [](void* self) noexcept { delete *static_cast<Fn**>(self); }
+    };
+
+    void take(Task& other) noexcept
+    {
+        if (other.ops_ != nullptr) {
+            other.ops_->relocate(&storage_, &other.storage_);
+            ops_ = std::exchange(other.ops_, nullptr);
+        }
+    }
+
+    void reset() noexcept
+    {
+        if (ops_ != nullptr) {
+            std::exchange(ops_, nullptr)->destroy(&storage_);
+        }
+    }
+
+    Ops const* ops_{nullptr};
+    std::aligned_storage_t<Capacity, alignof(void*)> storage_{};
+};
+
+} // namespace jam
@@ -0,0 +1,218 @@
+#include <gtest/gtest.h>
+
+#include <active.h>
+#include <chase_lev_deque.h>
+#include <executor.h>
+#include <mpmc_queue.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+template<typename Actor>
+struct Counter {
+    explicit Counter(jam::Executor& executor) : actor{executor} { }
+
+    std::vector<int> received{};  // only touched by the messages
+    std::atomic<bool> busy{false};
+    std::atomic<int> overlaps{0};
+    Actor actor;  // last - destroyed first, waits for the messages which touch the members above
+
+    void receive(int value)
+    {
+        if (busy.exchange(true)) { ++overlaps; }
+        received.push_back(value);
+        busy.store(false);
+    }
+};
+
+template<typename Actor>
+void send_from_threads(std::vector<std::unique_ptr<Counter<Actor>>>& counters, int senders, int messages)
+{
+    std::vector<std::thread> threads{};
+    for (int s{0}; s != senders; ++s) {
+        threads.emplace_back([&counters, s, messages] {
+            for (int i{0}; i != messages; ++i) {
+                for (auto& counter : counters) {
+                    auto* const c{counter.get()};
+                    c->actor.send([c, value = s * messages + i] { c->receive(value); });
+                }
+            }
+        });
+    }
+    for (auto& t : threads) { t.join(); }
+}
+
+// every sender's messages arrive complete, in order and one at a time
+template<typename Actor>
+void expect_serial_in_order(Counter<Actor> const& counter, int senders, int messages)
+{
+    EXPECT_EQ(counter.overlaps, 0);
+    ASSERT_EQ(counter.received.size(), static_cast<std::size_t>(senders * messages));
+    for (int s{0}; s != senders; ++s) {
+        std::vector<int> from_sender{};
+        std::copy_if(counter.received.cbegin(), counter.received.cend(), std::back_inserter(from_sender),
+                     [s, messages](int value) { return value / messages == s; });
+        ASSERT_EQ(from_sender.size(), static_cast<std::size_t>(messages));
+        EXPECT_TRUE(std::is_sorted(from_sender.cbegin(), from_sender.cend()));
+    }
+}
+
+template<typename Actor>
+void run_senders(unsigned workers)
+{
+    constexpr int Actors{50};
+    constexpr int Senders{4};
+    constexpr int Messages{500};
+    jam::Executor executor{workers};
+    std::vector<std::unique_ptr<Counter<Actor>>> counters{};
+    for (int i{0}; i != Actors; ++i) { counters.push_back(std::make_unique<Counter<Actor>>(executor)); }
+
+    send_from_threads(counters, Senders, Messages);
+    // the last message of each actor runs after all the others
+    std::atomic<int> flushed{0};
+    for (auto& counter : counters) { counter->actor.send([&flushed] { ++flushed; }); }
+    while (flushed.load() != Actors) { std::this_thread::yield(); }
+
+    for (auto const& counter : counters) { expect_serial_in_order(*counter, Senders, Messages); }
+}
+
+struct Player {
+    explicit Player(jam::Executor& executor, std::atomic<int>& finished)
+        : done{finished}, actor{executor} { }
+    Player(Player const&) = delete;
+    Player& operator=(Player const&) = delete;
+
+    Player* partner{nullptr};
+    std::atomic<int>& done;
+    jam::PooledActive actor;
+
+    void receive(int rounds)
+    {
+        if (rounds == 0) {
+            ++done;
+            return;
+        }
+        partner->actor.send([p = partner, rounds] { p->receive(rounds - 1); });
+    }
+};
+
+}  // namespace
+
+TEST(ChaseLevDequeTest, owner_pops_newest_thief_steals_oldest)
+{
+    chase_lev_deque<int> sut{2};
+    std::vector<int> values(10);
+    for (auto& value : values) { sut.push(&value); }  // grows twice
+
+    EXPECT_EQ(sut.pop(), &values[9]);
+    EXPECT_EQ(sut.steal(), &values[0]);
+    EXPECT_EQ(sut.steal(), &values[1]);
+    EXPECT_EQ(sut.pop(), &values[8]);
+    for (int i{2}; i != 8; ++i) { EXPECT_EQ(sut.steal(), &values[static_cast<std::size_t>(i)]); }
+    EXPECT_TRUE(sut.empty());
+    EXPECT_EQ(sut.pop(), nullptr);
+    EXPECT_EQ(sut.steal(), nullptr);
+}
+
+TEST(ChaseLevDequeTest, every_item_is_taken_once)
+{
+    constexpr int Items{200000};
+    constexpr int Thieves{3};
+    chase_lev_deque<int> sut{};
+    std::vector<int> values(Items);
+    std::vector<std::atomic<int>> taken(Items);
+    std::atomic<bool> done{false};
+
+    auto take = [&](int* item) { ++taken[static_cast<std::size_t>(item - values.data())]; };
+    std::vector<std::thread> thieves{};
+    for (int t{0}; t != Thieves; ++t) {
+        thieves.emplace_back([&] {
+            while (!done.load()) {
+                if (auto* const item{sut.steal()}) { take(item); }
+            }
+        });
+    }
+    for (int i{0}; i != Items; ++i) {
+        sut.push(&values[static_cast<std::size_t>(i)]);
+        if (i % 3 == 0) {
+            if (auto* const item{sut.pop()}) { take(item); }
+        }
+    }
+    while (auto* const item{sut.pop()}) { take(item); }
+    done.store(true);
+    for (auto& t : thieves) { t.join(); }
+
+    EXPECT_TRUE(std::all_of(taken.cbegin(), taken.cend(), [](auto const& count) { return count == 1; }));
+}
+
+TEST(ExecutorTest, messages_run_serially_and_in_order_on_one_worker)
+{
+    run_senders<jam::PooledActive>(1);
+}
+
+TEST(ExecutorTest, messages_run_serially_and_in_order_on_many_workers)
+{
+    run_senders<jam::PooledActive>(4);
+}
+
+TEST(ExecutorTest, messages_run_serially_and_in_order_with_mpmc_queue)
+{
+    run_senders<jam::BasicPooledActive<mpmc_queue>>(4);
+}
+
+TEST(ExecutorTest, actors_ping_pong_over_workers)
+{
+    constexpr int Pairs{200};
+    constexpr int Rounds{100};
+    std::atomic<int> done{0};
+    jam::Executor executor{3};
+    std::vector<std::unique_ptr<Player>> players{};
+    for (int i{0}; i != 2 * Pairs; ++i) { players.push_back(std::make_unique<Player>(executor, done)); }
+    for (std::size_t i{0}; i != players.size(); i += 2) {
+        players[i]->partner = players[i + 1].get();
+        players[i + 1]->partner = players[i].get();
+    }
+
+    for (std::size_t i{0}; i != players.size(); i += 2) {
+        auto* const p{players[i].get()};
+        p->actor.send([p] { p->receive(Rounds); });
+    }
+    while (done.load() != Pairs) { std::this_thread::yield(); }
+    EXPECT_EQ(done, Pairs);
+}
+
+TEST(ExecutorTest, destructor_waits_for_the_captures_of_the_last_message)
+{
+    // sets the flag when destroyed - late, so that the destructor of the actor would return first
+    struct SlowGuard {
+        std::atomic<bool>* destroyed;
+
+        explicit SlowGuard(std::atomic<bool>& flag) noexcept : destroyed{&flag} { }
+        SlowGuard(SlowGuard&& other) noexcept : destroyed{std::exchange(other.destroyed, nullptr)} { }
+        SlowGuard(SlowGuard const&) = delete;
+        SlowGuard& operator=(SlowGuard const&) = delete;
+        SlowGuard& operator=(SlowGuard&&) = delete;
+        ~SlowGuard()
+        {
+            if (destroyed == nullptr) { return; }
+            std::this_thread::sleep_for(std::chrono::milliseconds{50});
+            destroyed->store(true);
+        }
+    };
+
+    std::atomic<bool> destroyed{false};
+    jam::Executor executor{1};
+    {
+        jam::PooledActive actor{executor};
+        actor.send([guard = SlowGuard{destroyed}] { });
+    }
+    EXPECT_TRUE(destroyed.load());
+}
@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+
+#include <mpmc_queue.h>
+#include <threadsafe_queue.h>
+
+#include <atomic>
+#include <deque>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+template<typename Queue>
+void push_range(Queue& queue, int first, int last)
+{
+    for (int i{first}; i != last; ++i) { queue.push(i); }
+}
+
+}  // namespace
+
+TEST(ThreadsafeQueueTest, try_pop_bulk_takes_up_to_max_in_order)
+{
+    threadsafe_queue<int> sut{};
+    push_range(sut, 0, 10);
+
+    std::vector<int> batch{};
+    EXPECT_EQ(sut.try_pop_bulk(batch, 4), 4u);
+    EXPECT_EQ(sut.try_pop_bulk(batch, 4), 4u);
+    EXPECT_EQ(sut.try_pop_bulk(batch, 4), 2u);
+    EXPECT_EQ(sut.try_pop_bulk(batch, 4), 0u);
+
+    std::vector<int> expected(10);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(batch, expected);
+    EXPECT_TRUE(sut.empty());
+}
+
+TEST(ThreadsafeQueueTest, try_pop_bulk_into_deque_takes_everything)
+{
+    threadsafe_queue<int> sut{};
+    push_range(sut, 0, 100);
+
+    std::deque<int> batch{};
+    EXPECT_EQ(sut.try_pop_bulk(batch), 100u);
+    EXPECT_EQ(batch.front(), 0);
+    EXPECT_EQ(batch.back(), 99);
+    EXPECT_TRUE(sut.empty());
+
+    // appends behind what the batch holds already
+    push_range(sut, 100, 110);
+    EXPECT_EQ(sut.try_pop_bulk(batch), 10u);
+    EXPECT_EQ(batch.size(), 110u);
+    EXPECT_EQ(batch.back(), 109);
+}
+
+TEST(ThreadsafeQueueTest, wait_pop_bulk_waits_for_the_first_element)
+{
+    threadsafe_queue<int> sut{};
+    std::vector<int> batch{};
+    std::thread consumer{[&] { sut.wait_pop_bulk(batch); }};
+    sut.push(7);
+    consumer.join();
+
+    ASSERT_EQ(batch.size(), 1u);
+    EXPECT_EQ(batch.front(), 7);
+}
+
+TEST(ThreadsafeQueueTest, reject_policy_turns_down_push_when_full)
+{
+    threadsafe_queue<int> sut{2, overflow_policy::reject};
+    EXPECT_TRUE(sut.push(1));
+    EXPECT_TRUE(sut.push(2));
+    EXPECT_FALSE(sut.push(3));
+    EXPECT_FALSE(sut.emplace(4));
+
+    std::vector<int> batch{};
+    sut.try_pop_bulk(batch);
+    EXPECT_EQ(batch, (std::vector<int>{1, 2}));
+}
+
+TEST(ThreadsafeQueueTest, drop_oldest_policy_keeps_the_newest)
+{
+    threadsafe_queue<int> sut{3, overflow_policy::drop_oldest};
+    push_range(sut, 0, 10);
+    EXPECT_EQ(sut.size(), 3u);
+
+    std::vector<int> batch{};
+    sut.try_pop_bulk(batch);
+    EXPECT_EQ(batch, (std::vector<int>{7, 8, 9}));
+}
+
+TEST(ThreadsafeQueueTest, block_policy_holds_producers_at_capacity)
+{
+    constexpr int Producers{4};
+    constexpr int Items{20000};
+    constexpr std::size_t Capacity{16};
+    threadsafe_queue<int> sut{Capacity, overflow_policy::block};
+
+    std::vector<std::thread> producers{};
+    for (int p{0}; p != Producers; ++p) {
+        producers.emplace_back([&sut, p] { push_range(sut, p * Items, (p + 1) * Items); });
+    }
+    std::vector<int> received{};
+    std::vector<int> batch{};
+    while (received.size() != static_cast<std::size_t>(Producers * Items)) {
+        EXPECT_LE(sut.size(), Capacity);
+        // single pops and batches wake the producers alike
+        sut.wait_pop_bulk(batch, received.size() % 2 == 0 ? 1 : 8);
+        received.insert(received.end(), batch.cbegin(), batch.cend());
+        batch.clear();
+    }
+    for (auto& t : producers) { t.join(); }
+
+    std::vector<int> last(Producers, -1);
+    for (auto const value : received) {
+        auto& previous{last[static_cast<std::size_t>(value / Items)]};
+        EXPECT_GT(value, previous);
+        previous = value;
+    }
+}
+
+TEST(MpmcQueueTest, bulk_pops_match_threadsafe_queue)
+{
+    mpmc_queue<int> sut{16};
+    push_range(sut, 0, 10);
+
+    std::vector<int> batch{};
+    EXPECT_EQ(sut.try_pop_bulk(batch, 4), 4u);
+    EXPECT_EQ(sut.wait_pop_bulk(batch), 6u);
+    EXPECT_EQ(sut.try_pop_bulk(batch), 0u);
+
+    std::vector<int> expected(10);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT_EQ(batch, expected);
+}
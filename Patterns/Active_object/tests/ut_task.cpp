@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <active.h>
+#include <backgrounder.h>
+#include <new_tracker.h>
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+constexpr int Messages{1000};
+
+// counts its live instances, to check that Task destroys what it holds exactly once
+struct Counted {
+    static inline int live{0};
+
+    Counted() noexcept { ++live; }
+    Counted(Counted const&) noexcept { ++live; }
+    Counted(Counted&&) noexcept { ++live; }
+    Counted& operator=(Counted const&) = default;
+    Counted& operator=(Counted&&) = default;
+    ~Counted() { --live; }
+};
+
+// a message capturing 40 bytes - more than the small buffer of std::function
+struct Payload {
+    std::atomic<int>* done;
+    std::array<char, 32> data;
+};
+
+Payload make_payload(std::atomic<int>& done) { return Payload{&done, {}}; }
+
+void wait_for(std::atomic<int> const& done, int count)
+{
+    while (done.load(std::memory_order_acquire) != count) { std::this_thread::yield(); }
+}
+
+template<typename Active>
+int count_allocations_of_sends(Active& active)
+{
+    std::atomic<int> done{0};
+    // the thread of the object sets up its batch once it runs
+    active.send([&done] { done.fetch_add(1, std::memory_order_release); });
+    wait_for(done, 1);
+    done.store(0);
+    NewTracker::reset();
+    for (int i{0}; i != Messages; ++i) {
+        active.send([p = make_payload(done)] { p.done->fetch_add(1, std::memory_order_release); });
+    }
+    wait_for(done, Messages);
+    return NewTracker::num_allocs;
+}
+
+class Worker2 : public jam::BasicActive2<mpmc_queue> {
+public:
+    Worker2() noexcept { }
+    using jam::BasicActive2<mpmc_queue>::send;
+};
+
+class Worker3 : public jam::Active3<Worker3, mpmc_queue> {
+public:
+    Worker3() noexcept { }
+    using jam::Active3<Worker3, mpmc_queue>::send;
+};
+
+}  // namespace
+
+TEST(TaskTest, default_task_is_empty)
+{
+    jam::Task<> const sut{};
+    EXPECT_FALSE(sut);
+}
+
+TEST(TaskTest, calls_the_callable)
+{
+    int calls{0};
+    jam::Task<> sut{[&calls] { ++calls; }};
+    ASSERT_TRUE(sut);
+    sut();
+    sut();
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(TaskTest, calls_mutable_lambda_with_move_only_capture)
+{
+    std::unique_ptr<int> result{};
+    jam::Task<> sut{[&result, p = std::make_unique<int>(42)]() mutable { result = std::move(p); }};
+    sut();
+    ASSERT_TRUE(result);
+    EXPECT_EQ(*result, 42);
+}
+
+TEST(TaskTest, move_transfers_the_callable)
+{
+    int calls{0};
+    jam::Task<> source{[&calls] { ++calls; }};
+    jam::Task<> sut{std::move(source)};
+    EXPECT_FALSE(source);  // NOLINT(bugprone-use-after-move)
+    ASSERT_TRUE(sut);
+    sut();
+
+    jam::Task<> assigned{};
+    assigned = std::move(sut);
+    assigned();
+    EXPECT_EQ(calls, 2);
+}
+
+TEST(TaskTest, destroys_the_callable_once)
+{
+    Counted::live = 0;
+    {
+        jam::Task<> sut{[c = Counted{}] { }};
+        jam::Task<> moved{std::move(sut)};
+        jam::Task<> assigned{[c = Counted{}] { }};
+        EXPECT_EQ(Counted::live, 2);
+        assigned = std::move(moved);
+        EXPECT_EQ(Counted::live, 1);
+    }
+    EXPECT_EQ(Counted::live, 0);
+}
+
+TEST(TaskTest, small_callable_does_not_allocate)
+{
+    std::atomic<int> done{0};
+    auto callable{[p = make_payload(done)] { p.done->fetch_add(1); }};
+    static_assert(jam::Task<>::fits_inline<decltype(callable)>);
+
+    NewTracker::reset();
+    jam::Task<> sut{std::move(callable)};
+    jam::Task<> moved{std::move(sut)};
+    moved();
+    EXPECT_EQ(NewTracker::num_allocs, 0);
+    EXPECT_EQ(done, 1);
+}
+
+TEST(TaskTest, large_callable_is_held_on_the_heap)
+{
+    Counted::live = 0;
+    std::array<char, 64> large{};
+    large[63] = 'x';
+    char seen{};
+    auto callable{[&seen, large, c = Counted{}] { seen = large[63]; }};
+    static_assert(!jam::Task<>::fits_inline<decltype(callable)>);
+    static_assert(jam::Task<128>::fits_inline<decltype(callable)>);
+
+    NewTracker::reset();
+    {
+        jam::Task<> sut{std::move(callable)};
+        jam::Task<> moved{std::move(sut)};
+        moved();
+    }
+    EXPECT_EQ(NewTracker::num_allocs, 1);
+    EXPECT_EQ(NewTracker::num_delete, 1);
+    EXPECT_EQ(seen, 'x');
+    EXPECT_EQ(Counted::live, 1);  // only the one left in callable
+}
+
+TEST(ActiveAllocationTest, active_send_does_not_allocate)
+{
+    auto active{jam::BasicActive<mpmc_queue>::create()};
+    EXPECT_EQ(count_allocations_of_sends(active), 0);
+}
+
+TEST(ActiveAllocationTest, active2_send_does_not_allocate)
+{
+    auto active{jam::BasicActive2<mpmc_queue>::create<Worker2>()};
+    EXPECT_EQ(count_allocations_of_sends(active), 0);
+}
+
+TEST(ActiveAllocationTest, active3_send_does_not_allocate)
+{
+    auto active{Worker3::create()};
+    EXPECT_EQ(count_allocations_of_sends(active), 0);
+}
+
+TEST(ActiveAllocationTest, backgrounder_moves_the_value_into_the_task)
+{
+    // the value is moved from save_data() through the task into received, what remains are the
+    // blocks of the std::deque in threadsafe_queue - one per nine tasks
+    std::vector<std::string> received{};
+    received.reserve(Messages);
+    std::vector<std::string> values(Messages, std::string(100, 'v'));
+    NewTracker::reset();
+    {
+        Backgrounder<std::string> sut{received};
+        NewTracker::reset();
+        for (auto& value : values) { sut.save_data(std::move(value)); }
+    }
+    ASSERT_EQ(received.size(), static_cast<std::size_t>(Messages));
+    EXPECT_EQ(received.back(), std::string(100, 'v'));
+    // with std::function every message allocated the callback and a copy of the value
+    EXPECT_LT(NewTracker::num_allocs, Messages / 4);
+}
@@ -1,32 +1,60 @@
 #pragma once
 
 #include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <limits>
 #include <memory>
 #include <mutex>
-#include <queue>
 #include <type_traits>
 #include <utility>
 
+/**
+ * What push() does when a bounded threadsafe_queue is full:
+ *  block       - wait until a consumer made room
+ *  drop_oldest - discard the element at the front, the queue keeps the newest ones
+ *  reject      - leave the queue as it is and return false
+ */
+enum class overflow_policy { block, drop_oldest, reject };
+
 /**
  * An alternative implementation of a single-mutex threadsafe queue.
  * Stack data is allocated at the call to push() - bringing allocation outside of the region
  * protected by the mutex - thus increasing opportunity for concurrency.
+ *
+ * try_pop_bulk() and wait_pop_bulk() take up to max elements for one lock acquisition - all of
+ * them by swapping the containers, when the consumer passes an empty std::deque and max does not
+ * limit the batch. By default the queue is unbounded, with a capacity push() follows the
+ * overflow_policy - a slow consumer then no longer lets the queue grow without limit.
  */
 
 template <typename T>
 class threadsafe_queue {
   public:
     using value_type = T;
+    using container_type = std::deque<value_type>;
+    static constexpr std::size_t Unbounded{std::numeric_limits<std::size_t>::max()};
+
     threadsafe_queue() = default;
 
+    explicit threadsafe_queue(std::size_t capacity, overflow_policy policy = overflow_policy::block)
+        : capacity_{capacity}
+        , policy_{policy}
+    {
+    }
+
     threadsafe_queue(threadsafe_queue const& other)
-        : queue_{std::lock_guard<std::mutex>{other.mtx_}, other.queue_}
+        : queue_{(std::lock_guard<std::mutex>{other.mtx_}, other.queue_)}
+        , capacity_{other.capacity_}
+        , policy_{other.policy_}
     {
     }
 
     threadsafe_queue(threadsafe_queue&& other) noexcept(
-        std::is_nothrow_move_constructible_v<std::queue<value_type>>)
+        std::is_nothrow_move_constructible_v<container_type>)
         : queue_{(std::lock_guard<std::mutex>{other.mtx_}, std::move(other.queue_))}
+        , capacity_{other.capacity_}
+        , policy_{other.policy_}
     {
     }
 
@@ -40,12 +68,15 @@ class threadsafe_queue {
             std::lock_guard<std::mutex> lk_this{mtx_, std::adopt_lock};
             std::lock_guard<std::mutex> lk_other{other.mtx_, std::adopt_lock};
             queue_ = other.queue_;
+            capacity_ = other.capacity_;
+            policy_ = other.policy_;
         }
+        not_full_.notify_all();
         return *this;
     }
 
     threadsafe_queue& operator=(threadsafe_queue&& other) noexcept(
-        std::is_move_assignable_v<std::queue<value_type>>)
+        std::is_nothrow_move_assignable_v<container_type>)
     {
         if (this == &other) {
             return *this;
@@ -54,25 +85,37 @@ class threadsafe_queue {
             std::lock(mtx_, other.mtx_);
             std::lock_guard<std::mutex> lk_this{mtx_, std::adopt_lock};
             std::lock_guard<std::mutex> lk_other{other.mtx_, std::adopt_lock};
-            queue_ = other.queue_;
+            queue_ = std::move(other.queue_);
+            capacity_ = other.capacity_;
+            policy_ = other.policy_;
         }
+        not_full_.notify_all();
         return *this;
     }
 
-    void push(T value)
+    // false only when a full queue with the reject policy turned the value down
+    bool push(T value)
     {
-        std::lock_guard<std::mutex> lock{mtx_};
-        queue_.push(std::move(value));
+        std::unique_lock<std::mutex> lock{mtx_};
+        if (!make_room(lock)) {
+            return false;
+        }
+        queue_.push_back(std::move(value));
         cv_.notify_one();
+        return true;
     }
 
     template <typename... Args>
-    std::enable_if_t<std::is_constructible_v<T, Args...>>
+    std::enable_if_t<std::is_constructible_v<T, Args...>, bool>
     emplace(Args&&... args)
     {
-        std::lock_guard<std::mutex> lock{mtx_};
-        queue_.emplace(std::forward<Args>(args)...);
+        std::unique_lock<std::mutex> lock{mtx_};
+        if (!make_room(lock)) {
+            return false;
+        }
+        queue_.emplace_back(std::forward<Args>(args)...);
         cv_.notify_one();
+        return true;
     }
 
     void wait_and_pop(T& value)
@@ -80,8 +123,8 @@ class threadsafe_queue {
         std::unique_lock<std::mutex> lock{mtx_};
         cv_.wait(lock, [this] { return !queue_.empty(); });
         value = std::move(queue_.front());
-        queue_.pop();
-        lock.unlock();
+        queue_.pop_front();
+        notify_not_full(lock, 1);
     }
 
     bool try_pop(T& value)
@@ -91,19 +134,102 @@ class threadsafe_queue {
             return false;
         }
         value = std::move(queue_.front());
-        queue_.pop();
-        lock.unlock();
+        queue_.pop_front();
+        notify_not_full(lock, 1);
         return true;
     }
 
+    // appends up to max elements to batch, returns how many
+    template <typename Container>
+    std::size_t try_pop_bulk(Container& batch, std::size_t max = Unbounded)
+    {
+        std::unique_lock<std::mutex> lock{mtx_};
+        auto const count{take(batch, max)};
+        notify_not_full(lock, count);
+        return count;
+    }
+
+    // waits for at least one element, then appends up to max elements to batch
+    template <typename Container>
+    std::size_t wait_pop_bulk(Container& batch, std::size_t max = Unbounded)
+    {
+        std::unique_lock<std::mutex> lock{mtx_};
+        cv_.wait(lock, [this] { return !queue_.empty(); });
+        auto const count{take(batch, max)};
+        notify_not_full(lock, count);
+        return count;
+    }
+
     bool empty() const
     {
         std::lock_guard<std::mutex> lock{mtx_};
         return queue_.empty();
     }
 
+    std::size_t size() const
+    {
+        std::lock_guard<std::mutex> lock{mtx_};
+        return queue_.size();
+    }
+
+    std::size_t capacity() const noexcept { return capacity_; }
+
   private:
+    bool bounded() const noexcept { return capacity_ != Unbounded; }
+
+    bool make_room(std::unique_lock<std::mutex>& lock)
+    {
+        if (!bounded() || queue_.size() < capacity_) {
+            return true;
+        }
+        switch (policy_) {
+        case overflow_policy::block:
+            ++waiting_producers_;
+            not_full_.wait(lock, [this] { return queue_.size() < capacity_; });
+            --waiting_producers_;
+            return true;
+        case overflow_policy::drop_oldest:
+            queue_.pop_front();
+            return true;
+        case overflow_policy::reject:
+            break;
+        }
+        return false;
+    }
+
+    template <typename Container>
+    std::size_t take(Container& batch, std::size_t max)
+    {
+        if constexpr (std::is_same_v<Container, container_type>) {
+            if (batch.empty() && queue_.size() <= max) {
+                batch.swap(queue_);
+                return batch.size();
+            }
+        }
+        std::size_t count{0};
+        for (; count != max && !queue_.empty(); ++count) {
+            batch.push_back(std::move(queue_.front()));
+            queue_.pop_front();
+        }
+        return count;
+    }
+
+    // Blocked producers are woken once the queue drained to half its capacity, all at once - not
+    // one of them per popped element, which would switch threads for every element.
+    void notify_not_full(std::unique_lock<std::mutex>& lock, std::size_t count)
+    {
+        auto const wake{count != 0 && waiting_producers_ != 0 && queue_.size() <= capacity_ / 2};
+        lock.unlock();
+        if (wake) {
+            not_full_.notify_all();
+        }
+    }
+
     mutable std::mutex mtx_{};
-    std::queue<value_type> queue_{};
+    container_type queue_{};
     std::condition_variable cv_{};
+    std::condition_variable not_full_{};
+    std::size_t capacity_{Unbounded};
+    overflow_policy policy_{overflow_policy::block};
+    std::size_t waiting_producers_{0};  // blocked in push() or emplace()
 };